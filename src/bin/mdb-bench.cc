@@ -0,0 +1,901 @@
+/*
+ * mdb-bench measures the performance of the engine by replaying query files against a database.
+ *
+ * mdb-bench run <database> <queries>...
+ *   Opens the database once and executes every query `--runs` times with `--threads` concurrent workers.
+ *   A run is a pass over all the queries, and `--warmup` untimed runs can be executed before them.
+ *   With `--cold` the unpinned pages are removed from the buffers (and with `--drop-os-cache` from the
+ *   OS page cache too) before each query when using one thread, or before each run when using more threads.
+ *   Each query reports its latency and the page counters of its execution. The summary reports
+ *   p50/p95/p99 latency and throughput, and `--output` writes everything as JSON to compare two builds.
+ *
+ *   Queries are read from files: `.txt` and `.tsv` files have one query per line (optionally preceded by
+ *   a name and a tab), any other file is a single query. Directories are traversed recursively.
+ *
+ * mdb-bench generate <directory>
+ *   Writes a synthetic Wikidata-like graph (graph.nt, to be loaded with mdb-import) and a WDBench-style
+ *   query mix (queries/<category>_<n>.rq) with single BGPs, multiple BGPs, optionals, paths and C2RPQs.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "graph_models/exceptions.h"
+#include "graph_models/quad_model/quad_model.h"
+#include "graph_models/rdf_model/rdf_model.h"
+#include "misc/fatal_error.h"
+#include "misc/logger.h"
+#include "query/exceptions.h"
+#include "query/executor/query_executor/json_ostream_escape.h"
+#include "query/optimizer/quad_model/executor_constructor.h"
+#include "query/optimizer/rdf_model/executor_constructor.h"
+#include "query/parser/grammar/error_listener.h"
+#include "query/parser/mql_query_parser.h"
+#include "query/parser/sparql_query_parser.h"
+#include "query/query_context.h"
+#include "storage/buffer_manager.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/string_manager.h"
+#include "storage/tmp_manager.h"
+
+#include "third_party/cli11/CLI11.hpp"
+
+using DurationMS = std::chrono::duration<double, std::milli>;
+
+namespace {
+
+struct BenchQuery {
+    std::string name;
+    std::string text;
+};
+
+
+enum class ExecutionStatus { OK, TIMEOUT, ERROR };
+
+
+struct Execution {
+    uint64_t        run          = 0;
+    ExecutionStatus status       = ExecutionStatus::OK;
+    uint64_t        results      = 0;
+    double          parser_ms    = 0;
+    double          optimizer_ms = 0;
+    double          execution_ms = 0;
+    ProfileCounters counters;
+    std::string     error;
+
+    double total_ms() const {
+        return parser_ms + optimizer_ms + execution_ms;
+    }
+};
+
+
+struct BenchConfig {
+    std::string              db_directory;
+    std::vector<std::string> query_paths;
+    std::string              output_path;
+    uint64_t                 threads       = 1;
+    uint64_t                 runs          = 3;
+    uint64_t                 warmup        = 0;
+    bool                     cold          = false;
+    bool                     drop_os_cache = false;
+    std::chrono::seconds     timeout { 60 };
+
+    uint64_t load_strings             = StringManager::DEFAULT_LOAD_STR;
+    uint64_t versioned_pages_buffer   = BufferManager::DEFAULT_VERSIONED_PAGES_BUFFER_SIZE;
+    uint64_t private_pages_buffer     = BufferManager::DEFAULT_PRIVATE_PAGES_BUFFER_SIZE;
+    uint64_t unversioned_pages_buffer = BufferManager::DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE;
+};
+
+
+uint64_t read_uint64(std::fstream& fs) {
+    uint64_t res = 0;
+    uint8_t buf[8];
+
+    fs.read((char*)buf, sizeof(buf));
+
+    for (int i = 0; i < 8; i++) {
+        res |= static_cast<uint64_t>(buf[i]) << (i * 8);
+    }
+
+    if (!fs.good()) {
+        throw std::runtime_error("Error reading uint64");
+    }
+
+    return res;
+}
+
+
+void load_query_file(const std::string& path, const std::string& name, std::vector<BenchQuery>& queries) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open query file: " + path);
+    }
+
+    auto extension = Filesystem::get_extension(path);
+    if (extension == ".txt" || extension == ".tsv") {
+        std::string line;
+        uint64_t line_number = 0;
+        while (std::getline(file, line)) {
+            line_number++;
+            if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                continue;
+            }
+            auto tab = line.find('\t');
+            if (tab != std::string::npos) {
+                queries.push_back({ line.substr(0, tab), line.substr(tab + 1) });
+            } else {
+                queries.push_back({ name + ":" + std::to_string(line_number), line });
+            }
+        }
+    } else {
+        std::stringstream ss;
+        ss << file.rdbuf();
+        queries.push_back({ name, ss.str() });
+    }
+}
+
+
+std::vector<BenchQuery> load_queries(const std::vector<std::string>& paths) {
+    std::vector<BenchQuery> queries;
+    for (auto& path : paths) {
+        if (Filesystem::is_directory(path)) {
+            std::vector<std::string> files;
+            for (auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file()) {
+                    files.push_back(entry.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            for (auto& file : files) {
+                load_query_file(file, std::filesystem::relative(file, path).string(), queries);
+            }
+        } else {
+            load_query_file(path, std::filesystem::path(path).filename().string(), queries);
+        }
+    }
+    return queries;
+}
+
+
+class Bench {
+public:
+    Bench(const BenchConfig& config, bool is_rdf, std::vector<BenchQuery>&& queries) :
+        config         (config),
+        is_rdf         (is_rdf),
+        queries        (std::move(queries)),
+        executions     (this->queries.size()),
+        query_contexts (config.threads) { }
+
+    void run() {
+        std::thread timeout_thread(&Bench::execute_timeouts, this);
+
+        for (uint64_t i = 0; i < config.warmup; i++) {
+            std::cout << "Warmup run " << (i + 1) << "/" << config.warmup << std::endl;
+            execute_run(i, false);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < config.runs; i++) {
+            std::cout << "Run " << (i + 1) << "/" << config.runs << std::endl;
+            execute_run(i, true);
+        }
+        wall_time = std::chrono::steady_clock::now() - start;
+
+        finished = true;
+        timeout_thread.join();
+    }
+
+    void write_summary(std::ostream& os) const;
+
+    void write_json(std::ostream& os) const;
+
+private:
+    const BenchConfig& config;
+    bool is_rdf;
+
+    std::vector<BenchQuery> queries;
+
+    // query -> executions of the timed runs
+    std::vector<std::vector<Execution>> executions;
+
+    std::vector<QueryContext> query_contexts;
+
+    std::mutex thread_info_mutex;
+    std::atomic<bool> finished { false };
+
+    // time spent by the timed runs, the time used to clear the caches between runs is included
+    DurationMS wall_time;
+
+    void clear_caches() {
+        buffer_manager.clear_cache();
+        if (config.drop_os_cache) {
+            file_manager.drop_os_cache();
+        }
+    }
+
+    void execute_run(uint64_t run, bool timed) {
+        if (config.cold && config.threads > 1) {
+            clear_caches();
+        }
+
+        std::atomic<uint64_t> next_query { 0 };
+        std::vector<std::thread> workers;
+        for (uint64_t w = 0; w < config.threads; w++) {
+            workers.emplace_back([&, w]() {
+                QueryContext::set_query_ctx(&query_contexts[w]);
+                get_query_ctx().thread_info.worker_index = w;
+
+                uint64_t query;
+                while ((query = next_query.fetch_add(1)) < queries.size()) {
+                    if (config.cold && config.threads == 1) {
+                        clear_caches();
+                    }
+                    auto execution = execute_query(queries[query].text);
+                    execution.run = run;
+                    if (timed) {
+                        // each query is executed by one thread per run, but different queries share the vector
+                        std::lock_guard<std::mutex> lock(thread_info_mutex);
+                        executions[query].push_back(std::move(execution));
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    Execution execute_query(const std::string& query) {
+        Execution execution;
+
+        tmp_manager.reset();
+        get_query_ctx().reset();
+
+        auto start = std::chrono::system_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(thread_info_mutex);
+            get_query_ctx().thread_info.interruption_requested = false;
+            get_query_ctx().thread_info.time_start = start;
+            get_query_ctx().thread_info.timeout = start + config.timeout;
+        }
+
+        // results are written into a stream without buffer, so they are discarded
+        std::ostream discard_os(nullptr);
+
+        auto execution_start = start;
+        try {
+            antlr4::MyErrorListener error_listener;
+            std::unique_ptr<Op> logical_plan;
+            if (is_rdf) {
+                logical_plan = SPARQL::QueryParser::get_query_plan(query, &error_listener);
+            } else {
+                logical_plan = MQL::QueryParser::get_query_plan(query, &error_listener);
+                if (!logical_plan->read_only()) {
+                    throw QueryException("Only read-only queries are supported");
+                }
+            }
+            auto optimizer_start = std::chrono::system_clock::now();
+            execution.parser_ms = DurationMS(optimizer_start - start).count();
+
+            auto version_scope = buffer_manager.init_version_readonly();
+            get_query_ctx().start_version  = version_scope->start_version;
+            get_query_ctx().result_version = version_scope->start_version;
+
+            std::unique_ptr<QueryExecutor> physical_plan;
+            if (is_rdf) {
+                SPARQL::ExecutorConstructor executor_constructor(SPARQL::ResponseType::CSV);
+                logical_plan->accept_visitor(executor_constructor);
+                physical_plan = std::move(executor_constructor.executor);
+            } else {
+                MQL::ExecutorConstructor executor_constructor(MQL::ReturnType::CSV);
+                logical_plan->accept_visitor(executor_constructor);
+                physical_plan = std::move(executor_constructor.executor);
+            }
+            execution_start = std::chrono::system_clock::now();
+            execution.optimizer_ms = DurationMS(execution_start - optimizer_start).count();
+
+            execution.results = physical_plan->execute(discard_os);
+            execution.execution_ms = DurationMS(std::chrono::system_clock::now() - execution_start).count();
+        }
+        catch (const InterruptedException& e) {
+            execution.status = ExecutionStatus::TIMEOUT;
+            execution.execution_ms = DurationMS(std::chrono::system_clock::now() - execution_start).count();
+        }
+        catch (const std::exception& e) {
+            execution.status = ExecutionStatus::ERROR;
+            execution.error = e.what();
+        }
+        execution.counters = get_query_ctx().profile.counters;
+        return execution;
+    }
+
+    void execute_timeouts() {
+        while (!finished) {
+            auto now = std::chrono::system_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(thread_info_mutex);
+                for (auto& query_ctx : query_contexts) {
+                    if (query_ctx.thread_info.timeout <= now) {
+                        query_ctx.thread_info.interruption_requested = true;
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    // nearest-rank percentile of sorted values
+    static double percentile(const std::vector<double>& sorted_values, double p) {
+        if (sorted_values.empty()) {
+            return 0;
+        }
+        auto rank = static_cast<uint64_t>(std::ceil(p / 100 * sorted_values.size()));
+        return sorted_values[std::max<uint64_t>(rank, 1) - 1];
+    }
+
+    struct Summary {
+        uint64_t ok = 0;
+        uint64_t timeouts = 0;
+        uint64_t errors = 0;
+        std::vector<double> latencies; // sorted latencies of the ok executions
+    };
+
+    Summary summarize(const std::vector<Execution>& query_executions) const {
+        Summary summary;
+        for (auto& execution : query_executions) {
+            switch (execution.status) {
+            case ExecutionStatus::OK:      summary.ok++; summary.latencies.push_back(execution.total_ms()); break;
+            case ExecutionStatus::TIMEOUT: summary.timeouts++; break;
+            case ExecutionStatus::ERROR:   summary.errors++; break;
+            }
+        }
+        std::sort(summary.latencies.begin(), summary.latencies.end());
+        return summary;
+    }
+
+    Summary summarize_all() const {
+        std::vector<Execution> all;
+        for (auto& query_executions : executions) {
+            all.insert(all.end(), query_executions.begin(), query_executions.end());
+        }
+        return summarize(all);
+    }
+
+    static const char* status_to_string(ExecutionStatus status) {
+        switch (status) {
+        case ExecutionStatus::OK:      return "ok";
+        case ExecutionStatus::TIMEOUT: return "timeout";
+        case ExecutionStatus::ERROR:   return "error";
+        }
+        return "";
+    }
+
+    static void write_json_string(std::ostream& os, const std::string& str) {
+        os << '"';
+        {
+            JsonOstreamEscape json_escape(os);
+            std::ostream escaped_os(&json_escape);
+            escaped_os << str;
+        }
+        os << '"';
+    }
+};
+
+
+void Bench::write_summary(std::ostream& os) const {
+    os << std::fixed << std::setprecision(3);
+    os << "\n" << std::left << std::setw(40) << "query"
+       << std::right << std::setw(10) << "results"
+       << std::setw(14) << "median ms"
+       << std::setw(14) << "min ms"
+       << std::setw(14) << "max ms"
+       << std::setw(12) << "page reads"
+       << "  status\n";
+
+    for (uint64_t q = 0; q < queries.size(); q++) {
+        auto summary = summarize(executions[q]);
+        auto& last = executions[q].back();
+
+        os << std::left << std::setw(40) << queries[q].name.substr(0, 39)
+           << std::right << std::setw(10) << last.results
+           << std::setw(14) << percentile(summary.latencies, 50)
+           << std::setw(14) << (summary.latencies.empty() ? 0 : summary.latencies.front())
+           << std::setw(14) << (summary.latencies.empty() ? 0 : summary.latencies.back())
+           << std::setw(12) << last.counters.page_reads
+           << "  ";
+        if (summary.timeouts > 0) os << summary.timeouts << " timeouts ";
+        if (summary.errors > 0)   os << summary.errors << " errors (" << last.error << ")";
+        if (summary.timeouts == 0 && summary.errors == 0) os << "ok";
+        os << '\n';
+    }
+
+    auto summary = summarize_all();
+    os << "\nExecutions:  " << (summary.ok + summary.timeouts + summary.errors)
+       << " (" << summary.ok << " ok, " << summary.timeouts << " timeouts, " << summary.errors << " errors)\n"
+       << "Wall time:   " << wall_time.count() / 1000 << " s\n"
+       << "Throughput:  " << summary.ok / (wall_time.count() / 1000) << " queries/s\n"
+       << "Latency p50: " << percentile(summary.latencies, 50) << " ms\n"
+       << "Latency p95: " << percentile(summary.latencies, 95) << " ms\n"
+       << "Latency p99: " << percentile(summary.latencies, 99) << " ms\n";
+}
+
+
+void Bench::write_json(std::ostream& os) const {
+    auto summary = summarize_all();
+
+    os << std::setprecision(6);
+    os << "{\n  \"database\": ";
+    write_json_string(os, config.db_directory);
+    os << ",\n  \"model\": \"" << (is_rdf ? "rdf" : "quad") << '"'
+       << ",\n  \"threads\": " << config.threads
+       << ",\n  \"runs\": " << config.runs
+       << ",\n  \"warmup_runs\": " << config.warmup
+       << ",\n  \"cold\": " << (config.cold ? "true" : "false")
+       << ",\n  \"drop_os_cache\": " << (config.drop_os_cache ? "true" : "false")
+       << ",\n  \"timeout_s\": " << config.timeout.count()
+       << ",\n  \"summary\": {"
+       << "\"executions\": " << (summary.ok + summary.timeouts + summary.errors)
+       << ", \"ok\": " << summary.ok
+       << ", \"timeouts\": " << summary.timeouts
+       << ", \"errors\": " << summary.errors
+       << ", \"wall_time_s\": " << wall_time.count() / 1000
+       << ", \"throughput_qps\": " << summary.ok / (wall_time.count() / 1000)
+       << ", \"p50_ms\": " << percentile(summary.latencies, 50)
+       << ", \"p95_ms\": " << percentile(summary.latencies, 95)
+       << ", \"p99_ms\": " << percentile(summary.latencies, 99)
+       << "},\n  \"queries\": [";
+
+    for (uint64_t q = 0; q < queries.size(); q++) {
+        auto query_summary = summarize(executions[q]);
+
+        os << (q == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        write_json_string(os, queries[q].name);
+        os << ", \"median_ms\": " << percentile(query_summary.latencies, 50)
+           << ", \"executions\": [";
+
+        auto first = true;
+        for (auto& execution : executions[q]) {
+            if (first) first = false; else os << ", ";
+            os << "{\"run\": " << execution.run
+               << ", \"status\": \"" << status_to_string(execution.status) << '"'
+               << ", \"results\": " << execution.results
+               << ", \"total_ms\": " << execution.total_ms()
+               << ", \"parser_ms\": " << execution.parser_ms
+               << ", \"optimizer_ms\": " << execution.optimizer_ms
+               << ", \"execution_ms\": " << execution.execution_ms
+               << ", \"page_hits\": " << execution.counters.page_hits
+               << ", \"page_misses\": " << execution.counters.page_misses
+               << ", \"page_reads\": " << execution.counters.page_reads
+               << ", \"tmp_bytes_written\": " << execution.counters.tmp_bytes_written;
+            if (execution.status == ExecutionStatus::ERROR) {
+                os << ", \"error\": ";
+                write_json_string(os, execution.error);
+            }
+            os << '}';
+        }
+        os << "]}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+
+int run_bench(const BenchConfig& config) {
+    auto queries = load_queries(config.query_paths);
+    if (queries.empty()) {
+        std::cerr << "No queries found\n";
+        return EXIT_FAILURE;
+    }
+
+    auto catalog_path = config.db_directory + "/catalog.dat";
+    auto catalog_fs = std::fstream(catalog_path, std::ios::in | std::ios::binary);
+    if (!catalog_fs.is_open()) {
+        std::cerr << "Could not open catalog: " << catalog_path << "\n";
+        return EXIT_FAILURE;
+    }
+    auto model_identifier = read_uint64(catalog_fs);
+
+    std::unique_ptr<ModelDestroyer> model_destroyer;
+    switch (model_identifier) {
+    case QuadCatalog::MODEL_ID: {
+        model_destroyer = QuadModel::init(config.db_directory,
+                                          config.load_strings,
+                                          config.versioned_pages_buffer,
+                                          config.private_pages_buffer,
+                                          config.unversioned_pages_buffer,
+                                          config.threads);
+        break;
+    }
+    case RdfCatalog::MODEL_ID: {
+        model_destroyer = RdfModel::init(config.db_directory,
+                                         config.load_strings,
+                                         config.versioned_pages_buffer,
+                                         config.private_pages_buffer,
+                                         config.unversioned_pages_buffer,
+                                         config.threads);
+        break;
+    }
+    default:
+        FATAL_ERROR("Unknow model identifier: " + std::to_string(model_identifier) + ". Catalog may be corrupted");
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Loaded " << queries.size() << " queries\n";
+
+    // otherwise the plans and stats of every execution are logged
+    for (auto& [category, category_config] : logger.categories) {
+        category_config.enabled = category == Category::Error;
+    }
+
+    Bench bench(config, model_identifier == RdfCatalog::MODEL_ID, std::move(queries));
+    bench.run();
+    bench.write_summary(std::cout);
+
+    if (!config.output_path.empty()) {
+        std::ofstream output(config.output_path);
+        if (!output.is_open()) {
+            std::cerr << "Could not open output file: " << config.output_path << "\n";
+            return EXIT_FAILURE;
+        }
+        bench.write_json(output);
+        std::cout << "Results written to " << config.output_path << "\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+
+/*
+ * Generator of a Wikidata-like graph: entities are instances of classes organized in a subclass tree,
+ * and both the predicates and the objects of the edges follow a Zipf distribution, so there are a few
+ * very popular properties and hub entities like in Wikidata.
+ */
+class WikidataLikeGenerator {
+public:
+    static constexpr auto WD   = "http://www.wikidata.org/entity/";
+    static constexpr auto WDT  = "http://www.wikidata.org/prop/direct/";
+    static constexpr auto RDFS = "http://www.w3.org/2000/01/rdf-schema#";
+    static constexpr auto XSD  = "http://www.w3.org/2001/XMLSchema#";
+
+    static constexpr uint64_t PROPERTIES  = 50;
+    static constexpr uint64_t INSTANCE_OF = 31;
+    static constexpr uint64_t SUBCLASS_OF = 279;
+    static constexpr uint64_t BIRTH_DATE  = 569;
+    static constexpr uint64_t POPULATION  = 1082;
+
+    WikidataLikeGenerator(uint64_t entities, uint64_t seed) :
+        entities  (entities),
+        classes   (std::max<uint64_t>(10, entities / 100)),
+        rng       (seed),
+        entity_cdf(zipf_cdf(entities)),
+        class_cdf (zipf_cdf(classes)),
+        property_cdf(zipf_cdf(PROPERTIES)) { }
+
+    void write_graph(std::ostream& os) {
+        std::geometric_distribution<uint64_t> out_degree(0.2);
+        std::uniform_real_distribution<double> uniform(0, 1);
+
+        for (uint64_t e = 1; e <= entities; e++) {
+            os << '<' << WD << 'Q' << e << "> <" << RDFS << "label> \"Entity " << e << "\"@en .\n";
+
+            if (e <= classes) {
+                if (e > 1) {
+                    // classes form a tree rooted at Q1
+                    std::uniform_int_distribution<uint64_t> parent(1, e - 1);
+                    write_edge(os, e, SUBCLASS_OF, parent(rng));
+                }
+                continue;
+            }
+
+            write_edge(os, e, INSTANCE_OF, sample(class_cdf));
+
+            auto degree = 1 + out_degree(rng);
+            for (uint64_t i = 0; i < degree; i++) {
+                auto property = sample(property_cdf);
+                auto object = sample(entity_cdf);
+                write_edge(os, e, property, object);
+                if (edge_sample.size() < EDGE_SAMPLE_SIZE) {
+                    edge_sample.push_back({ e, property, object });
+                } else {
+                    // reservoir sampling
+                    std::uniform_int_distribution<uint64_t> pos(0, edges_written);
+                    auto replaced = pos(rng);
+                    if (replaced < EDGE_SAMPLE_SIZE) {
+                        edge_sample[replaced] = { e, property, object };
+                    }
+                }
+                edges_written++;
+            }
+
+            if (uniform(rng) < 0.3) {
+                std::uniform_int_distribution<int> year(1800, 2020), month(1, 12), day(1, 28);
+                os << '<' << WD << 'Q' << e << "> <" << WDT << 'P' << BIRTH_DATE << "> \""
+                   << year(rng) << '-' << std::setw(2) << std::setfill('0') << month(rng) << '-'
+                   << std::setw(2) << day(rng) << std::setfill(' ') << "\"^^<" << XSD << "date> .\n";
+            }
+            if (uniform(rng) < 0.2) {
+                std::uniform_int_distribution<uint64_t> population(1, 10'000'000);
+                os << '<' << WD << 'Q' << e << "> <" << WDT << 'P' << POPULATION << "> \""
+                   << population(rng) << "\"^^<" << XSD << "integer> .\n";
+            }
+        }
+    }
+
+    // Writes queries_per_category queries of each category of WDBench, must be called after write_graph
+    void write_queries(const std::string& directory, uint64_t queries_per_category) {
+        const std::string prefixes = std::string("PREFIX wd: <") + WD + ">\n"
+                                   + "PREFIX wdt: <" + WDT + ">\n"
+                                   + "PREFIX rdfs: <" + RDFS + ">\n";
+
+        auto write_query = [&](const std::string& category, uint64_t i, const std::string& body) {
+            std::stringstream name;
+            name << category << '_' << std::setw(3) << std::setfill('0') << i << ".rq";
+            std::ofstream file(directory + "/" + name.str());
+            file << prefixes << body << "\nLIMIT 100000\n";
+        };
+
+        for (uint64_t i = 0; i < queries_per_category; i++) {
+            auto& edge = random_edge();
+            std::stringstream q;
+            switch (i % 3) {
+            case 0: q << "SELECT * WHERE { ?x wdt:P" << edge.property << " wd:Q" << edge.object << " }"; break;
+            case 1: q << "SELECT * WHERE { wd:Q" << edge.subject << " ?p ?o }"; break;
+            case 2: q << "SELECT * WHERE { ?x wdt:P" << edge.property << " ?y }"; break;
+            }
+            write_query("single_bgps", i, q.str());
+        }
+
+        for (uint64_t i = 0; i < queries_per_category; i++) {
+            auto& edge = random_edge();
+            std::stringstream q;
+            if (i % 2 == 0) {
+                q << "SELECT * WHERE {\n"
+                  << "  ?x wdt:P" << INSTANCE_OF << " wd:Q" << sample(class_cdf) << " .\n"
+                  << "  ?x wdt:P" << edge.property << " ?y .\n"
+                  << "  ?y rdfs:label ?label .\n"
+                  << "}";
+            } else {
+                q << "SELECT * WHERE {\n"
+                  << "  ?x wdt:P" << edge.property << " ?y .\n"
+                  << "  ?y wdt:P" << random_edge().property << " ?z .\n"
+                  << "  ?z wdt:P" << INSTANCE_OF << " ?class .\n"
+                  << "}";
+            }
+            write_query("multiple_bgps", i, q.str());
+        }
+
+        for (uint64_t i = 0; i < queries_per_category; i++) {
+            std::stringstream q;
+            q << "SELECT * WHERE {\n"
+              << "  ?x wdt:P" << INSTANCE_OF << " wd:Q" << sample(class_cdf) << " .\n"
+              << "  OPTIONAL { ?x wdt:P" << BIRTH_DATE << " ?date }\n"
+              << "  OPTIONAL { ?x wdt:P" << POPULATION << " ?population }\n"
+              << "}";
+            write_query("opts", i, q.str());
+        }
+
+        for (uint64_t i = 0; i < queries_per_category; i++) {
+            auto& edge = random_edge();
+            std::stringstream q;
+            switch (i % 3) {
+            case 0: q << "SELECT * WHERE { wd:Q" << edge.subject << " wdt:P" << edge.property << "* ?y }"; break;
+            case 1: q << "SELECT * WHERE { ?x wdt:P" << SUBCLASS_OF << "+ wd:Q" << sample(class_cdf) << " }"; break;
+            case 2: q << "SELECT * WHERE { wd:Q" << edge.subject << " (wdt:P" << edge.property
+                      << "|wdt:P" << random_edge().property << ")+ ?y }"; break;
+            }
+            write_query("paths", i, q.str());
+        }
+
+        for (uint64_t i = 0; i < queries_per_category; i++) {
+            auto& edge = random_edge();
+            std::stringstream q;
+            q << "SELECT * WHERE {\n"
+              << "  ?x wdt:P" << INSTANCE_OF << "/wdt:P" << SUBCLASS_OF << "* wd:Q" << sample(class_cdf) << " .\n"
+              << "  ?x wdt:P" << edge.property << "+ ?y .\n"
+              << "}";
+            write_query("c2rpqs", i, q.str());
+        }
+    }
+
+private:
+    static constexpr uint64_t EDGE_SAMPLE_SIZE = 10'000;
+
+    struct Edge {
+        uint64_t subject;
+        uint64_t property;
+        uint64_t object;
+    };
+
+    uint64_t entities;
+    uint64_t classes;
+
+    std::mt19937_64 rng;
+
+    std::vector<double> entity_cdf;
+    std::vector<double> class_cdf;
+    std::vector<double> property_cdf;
+
+    // uniform sample of the edges between entities, used to choose constants that appear in the graph
+    std::vector<Edge> edge_sample;
+    uint64_t edges_written = 0;
+
+    static std::vector<double> zipf_cdf(uint64_t n) {
+        std::vector<double> cdf(n);
+        double sum = 0;
+        for (uint64_t i = 0; i < n; i++) {
+            sum += 1.0 / (i + 1);
+            cdf[i] = sum;
+        }
+        for (auto& value : cdf) {
+            value /= sum;
+        }
+        return cdf;
+    }
+
+    // returns a value in [1, cdf.size()]
+    uint64_t sample(const std::vector<double>& cdf) {
+        std::uniform_real_distribution<double> uniform(0, 1);
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng));
+        return std::min<uint64_t>(it - cdf.begin(), cdf.size() - 1) + 1;
+    }
+
+    const Edge& random_edge() {
+        std::uniform_int_distribution<uint64_t> pos(0, edge_sample.size() - 1);
+        return edge_sample[pos(rng)];
+    }
+
+    void write_edge(std::ostream& os, uint64_t subject, uint64_t property, uint64_t object) {
+        os << '<' << WD << 'Q' << subject << "> <" << WDT << 'P' << property << "> <" << WD << 'Q' << object << "> .\n";
+    }
+};
+
+
+int run_generate(const std::string& directory, uint64_t entities, uint64_t queries_per_category, uint64_t seed) {
+    Filesystem::create_directories(directory + "/queries");
+
+    WikidataLikeGenerator generator(entities, seed);
+    {
+        std::ofstream graph(directory + "/graph.nt");
+        if (!graph.is_open()) {
+            std::cerr << "Could not create " << directory << "/graph.nt\n";
+            return EXIT_FAILURE;
+        }
+        generator.write_graph(graph);
+    }
+    generator.write_queries(directory + "/queries", queries_per_category);
+
+    std::cout << "Graph written to " << directory << "/graph.nt\n"
+              << "Queries written to " << directory << "/queries\n";
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+
+    std::string generate_directory;
+    uint64_t    generate_entities = 100'000;
+    uint64_t    generate_queries  = 20;
+    uint64_t    generate_seed     = 1;
+
+    CLI::App app{"MillenniumDB benchmark"};
+    app.get_formatter()->column_width(34);
+    app.option_defaults()->always_capture_default();
+    app.require_subcommand(1);
+
+    auto sc_run = app.add_subcommand("run", "Execute query files against a database and report their performance");
+
+    sc_run->add_option("database", config.db_directory)
+        ->description("Database directory")
+        ->type_name("<path>")
+        ->check(CLI::ExistingDirectory.description(""))
+        ->required();
+
+    sc_run->add_option("queries", config.query_paths)
+        ->description("Query files or directories")
+        ->type_name("<path>")
+        ->check(CLI::ExistingPath.description(""))
+        ->required();
+
+    sc_run->add_option("--threads", config.threads)
+        ->description("Number of queries executed concurrently")
+        ->type_name("<num>")
+        ->check(CLI::Range(1, 1024).description(""));
+
+    sc_run->add_option("--runs", config.runs)
+        ->description("Number of timed passes over all the queries")
+        ->type_name("<num>")
+        ->check(CLI::Range(1, 1'000'000).description(""));
+
+    sc_run->add_option("--warmup", config.warmup)
+        ->description("Number of untimed passes executed before the timed runs")
+        ->type_name("<num>");
+
+    sc_run->add_flag("--cold", config.cold)
+        ->description("Remove unpinned pages from the buffers before each query (or each run when threads > 1)");
+
+    sc_run->add_flag("--drop-os-cache", config.drop_os_cache)
+        ->description("When cold, also ask the OS to drop its page cache of the database files");
+
+    sc_run->add_option("--timeout", config.timeout)
+        ->description("Timeout of each query")
+        ->type_name("<seconds>")
+        ->check(CLI::Range(1, 36'000).description(""));
+
+    sc_run->add_option("--output", config.output_path)
+        ->description("Write the results as JSON to this file")
+        ->type_name("<path>");
+
+    sc_run->add_option("--load-strings", config.load_strings)
+        ->description("Total amount of strings to pre-load\nAllows units such as MB and GB")
+        ->option_text("<bytes> [2GB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    sc_run->add_option("--versioned-buffer", config.versioned_pages_buffer)
+        ->description("Size of buffer for versioned pages shared between threads\nAllows units such as MB and GB")
+        ->option_text("<bytes> [1GB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    sc_run->add_option("--private-buffer", config.private_pages_buffer)
+        ->description("Size of private per-thread buffers,\nAllows units such as MB and GB")
+        ->option_text("<bytes> [64MB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    sc_run->add_option("--unversioned-buffer", config.unversioned_pages_buffer)
+        ->description("Size of buffer for unversioned pages shared between threads,\nAllows units such as MB and GB")
+        ->option_text("<bytes> [128MB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    auto sc_generate = app.add_subcommand("generate", "Write a synthetic Wikidata-like graph and a WDBench-style query mix");
+
+    sc_generate->add_option("directory", generate_directory)
+        ->description("Output directory")
+        ->type_name("<path>")
+        ->required();
+
+    sc_generate->add_option("--entities", generate_entities)
+        ->description("Number of entities of the graph")
+        ->type_name("<num>")
+        ->check(CLI::Range(1'000ULL, 1'000'000'000ULL).description(""));
+
+    sc_generate->add_option("--queries", generate_queries)
+        ->description("Number of queries of each category")
+        ->type_name("<num>");
+
+    sc_generate->add_option("--seed", generate_seed)
+        ->description("Seed of the random generator")
+        ->type_name("<num>");
+
+    CLI11_PARSE(app, argc, argv);
+
+    try {
+        if (sc_generate->parsed()) {
+            return run_generate(generate_directory, generate_entities, generate_queries, generate_seed);
+        }
+        return run_bench(config);
+    } catch (WrongModelException& e) {
+        FATAL_ERROR(std::string(e.what()) + ". Catalog may be corrupted");
+        return EXIT_FAILURE;
+    } catch (WrongCatalogVersionException& e) {
+        FATAL_ERROR(std::string(e.what()) + ". The database must be created again to work with this version");
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
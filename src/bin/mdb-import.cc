@@ -65,6 +65,7 @@ int main(int argc, char* argv[]) {
     std::string model_name;
     uint64_t buffer_size = 2ULL * 1024 * 1024 * 1024;
     size_t btree_permutations = 4;
+    bool compressed_leaves = false;
 
     CLI::App app{"MillenniumDB Import"};
     app.get_formatter()->column_width(35);
@@ -97,6 +98,9 @@ int main(int argc, char* argv[]) {
         ->transform(CLI::AsSizeValue(false))
         ->check(CLI::Range(1ULL * 1024 * 1024 * 1024, 1024ULL * 1024 * 1024 * 1024));
 
+    app.add_flag("--compressed-leaves", compressed_leaves)
+        ->description("write B+tree leaves with a compressed read-optimized format");
+
     app.add_option("-m,--model", model_name)
         ->description("graph model")
         ->option_text("quad|rdf")
@@ -147,7 +151,7 @@ int main(int argc, char* argv[]) {
 
     switch (model) {
     case Model::Quad: {
-        Import::QuadModel::OnDiskImport importer(db_directory, buffer_size);
+        Import::QuadModel::OnDiskImport importer(db_directory, buffer_size, compressed_leaves);
         importer.start_import(data_file);
         break;
     }
@@ -155,7 +159,7 @@ int main(int argc, char* argv[]) {
         if (btree_permutations != 3 && btree_permutations != 4 && btree_permutations != 6) {
             std::cerr << "Invalid value for option \"btree-permutations\". Expected 3, 4 or 6\n";
         }
-        Import::Rdf::OnDiskImport importer(db_directory, buffer_size, btree_permutations);
+        Import::Rdf::OnDiskImport importer(db_directory, buffer_size, btree_permutations, compressed_leaves);
         importer.start_import(data_file, prefixes_file);
         break;
     }
@@ -0,0 +1,82 @@
+#include <chrono>
+#include <iostream>
+
+#include "graph_models/rdf_model/conversions.h"
+#include "graph_models/rdf_model/rdf_model.h"
+#include "query/query_context.h"
+#include "storage/buffer_manager.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/index/reachability/reachability_index.h"
+#include "storage/string_manager.h"
+#include "third_party/cli11/CLI11.hpp"
+
+int main(int argc, char* argv[]) {
+    std::string              db_directory;
+    std::vector<std::string> predicates;
+
+    CLI::App app("MillenniumDB Index Paths");
+    app.get_formatter()->column_width(35);
+    app.option_defaults()->always_capture_default();
+
+    app.add_option("db-directory", db_directory)
+      ->description("path to an existing RDF database directory")
+      ->type_name("<path>")
+      ->check(CLI::ExistingDirectory.description(""))
+      ->required();
+
+    app.add_option("predicates", predicates)
+      ->description("IRIs of the predicates whose paths P* and P+ will use a reachability index")
+      ->type_name("<iri>...")
+      ->required();
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::cout << "Initializing a RdfModel...\n";
+    auto model_destroyer = RdfModel::init(db_directory,
+                                          StringManager::DEFAULT_LOAD_STR,
+                                          BufferManager::DEFAULT_VERSIONED_PAGES_BUFFER_SIZE,
+                                          BufferManager::DEFAULT_PRIVATE_PAGES_BUFFER_SIZE,
+                                          BufferManager::DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE,
+                                          1);
+    std::cout << "RdfModel initialized\n";
+
+    QueryContext qc;
+    QueryContext::set_query_ctx(&qc);
+    auto version_scope = buffer_manager.init_version_readonly();
+
+    Filesystem::create_directories(file_manager.get_file_path(ReachabilityIndex::REACHABILITY_DIR));
+
+    for (auto& predicate : predicates) {
+        if (predicate.size() >= 2 && predicate.front() == '<' && predicate.back() == '>') {
+            predicate = predicate.substr(1, predicate.size() - 2);
+        }
+        auto predicate_id = SPARQL::Conversions::pack_iri(predicate);
+        if (predicate_id.is_tmp() || rdf_model.catalog().get_predicate_count(predicate_id.id) == 0) {
+            std::cerr << "The predicate <" << predicate << "> is not used in the database\n";
+            return EXIT_FAILURE;
+        }
+
+        auto path = ReachabilityIndex::get_path(predicate_id.id);
+        if (Filesystem::is_regular_file(path)) {
+            std::cerr << "An index for the predicate <" << predicate
+                      << "> already exists. Please delete the file " << path << " first\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "Building reachability index for <" << predicate << ">..." << std::endl;
+        auto start_build = std::chrono::system_clock::now();
+        ReachabilityIndex index(predicate_id.id);
+        auto end_build = std::chrono::system_clock::now();
+        auto duration_build = std::chrono::duration_cast<std::chrono::milliseconds>(end_build - start_build);
+        std::cout << "  nodes      : " << index.get_node_count() << "\n";
+        std::cout << "  components : " << index.get_component_count() << "\n";
+        std::cout << "  intervals  : " << index.get_interval_count() << "\n";
+        std::cout << "Build took: " << duration_build.count() << " ms\n";
+
+        index.serialize(path);
+        std::cout << "Index saved in " << path << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -35,6 +35,26 @@ void build_forest_index(TensorStore& tensor_store,
 }
 
 
+void build_hnsw_index(TensorStore& tensor_store,
+                      MetricType   metric_type,
+                      uint64_t     M,
+                      uint64_t     ef_construction,
+                      uint64_t     ef_search) {
+    std::cout << "Building HNSW Index..." << std::endl;
+    auto start_build_hnsw_index = std::chrono::system_clock::now();
+    tensor_store.build_hnsw_index(metric_type, M, ef_construction, ef_search);
+    auto end_build_hnsw_index = std::chrono::system_clock::now();
+    auto duration_build_hnsw_index =
+      std::chrono::duration_cast<std::chrono::seconds>(end_build_hnsw_index - start_build_hnsw_index);
+    std::cout << "Build HNSW Index took: " << duration_build_hnsw_index.count() << " seconds\n";
+    std::cout << "Serializing..." << std::endl;
+    tensor_store.serialize();
+    auto end_serialize = std::chrono::system_clock::now();
+    auto duration_serialize = std::chrono::duration_cast<std::chrono::seconds>(end_serialize - end_build_hnsw_index);
+    std::cout << "Serialization took: " << duration_serialize.count() << " seconds\n";
+}
+
+
 int main(int argc, char* argv[]) {
     std::string db_directory;
     std::string tensor_store_name;
@@ -42,8 +62,13 @@ int main(int argc, char* argv[]) {
     uint64_t    num_trees       = 1;
     uint64_t    max_bucket_size = 1024;
     uint64_t    max_depth       = 64;
+    std::string index_type      = "forest";
+    uint64_t    hnsw_m          = 16;
+    uint64_t    ef_construction = 200;
+    uint64_t    ef_search       = 64;
     uint64_t    tensor_buffer   = TensorBufferManager::DEFAULT_TENSOR_PAGES_BUFFER_SIZE;
     bool        preload         = false;
+    bool        quantize        = false;
 
     std::unordered_map<std::string, MetricType> name2metric_type = { { "angular", MetricType::ANGULAR },
                                                                      { "euclidean", MetricType::EUCLIDEAN },
@@ -65,16 +90,20 @@ int main(int argc, char* argv[]) {
       ->required();
 
     app.add_option("metric-type", metric_type)
-      ->description("metric type for the LSH Forest Index")
+      ->description("metric type for the index")
       ->type_name("<type>")
       ->transform(CLI::CheckedTransformer(name2metric_type, CLI::ignore_case))
       ->required();
 
-    app.add_option("num-trees", num_trees)
-      ->description("number of trees in the LSH Forest Index")
+    auto num_trees_option = app.add_option("num-trees", num_trees)
+      ->description("number of trees in the LSH Forest Index (required for the forest index)")
       ->type_name("<num>")
-      ->check(CLI::Range(1, 128))
-      ->required();
+      ->check(CLI::Range(1, 128));
+
+    app.add_option("--index-type", index_type)
+      ->description("type of the index to build")
+      ->type_name("<forest|hnsw>")
+      ->check(CLI::IsMember({ "forest", "hnsw" }, CLI::ignore_case));
 
     app.add_option("--max-bucket-size", max_bucket_size)
       ->description("maximum bucket size for the leaves in the LSH Forest Index trees")
@@ -86,6 +115,21 @@ int main(int argc, char* argv[]) {
       ->type_name("<num>")
       ->check(CLI::Range(2, 1024));
 
+    app.add_option("--hnsw-m", hnsw_m)
+      ->description("maximum number of neighbors of each node in the upper layers of the HNSW Index")
+      ->type_name("<num>")
+      ->check(CLI::Range(2, 256));
+
+    app.add_option("--hnsw-ef-construction", ef_construction)
+      ->description("size of the candidate list used while building the HNSW Index")
+      ->type_name("<num>")
+      ->check(CLI::Range(1, 65536));
+
+    app.add_option("--hnsw-ef-search", ef_search)
+      ->description("size of the candidate list used while querying the HNSW Index")
+      ->type_name("<num>")
+      ->check(CLI::Range(1, 65536));
+
     app.add_option("--tensor-buffer", tensor_buffer)
       ->description("size of buffer for tensor pages shared between threads\nAllows units such as MB and GB")
       ->option_text("<bytes> [2GB]")
@@ -95,11 +139,21 @@ int main(int argc, char* argv[]) {
     app.add_flag("--preload-tensors", preload)
       ->description("Fill the tensor buffer before building the forest index");
 
+    app.add_flag("--quantize", quantize)
+      ->description("Also build int8 quantized tensors, used to score the index candidates in memory");
+
     CLI11_PARSE(app, argc, argv);
 
-    std::cout << "Building forest index...\n";
+    const bool is_hnsw = index_type == "hnsw";
+    if (!is_hnsw && num_trees_option->count() == 0) {
+        std::cerr << "num-trees is required to build a forest index\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Building " << (is_hnsw ? "HNSW" : "forest") << " index...\n";
     std::cout << "  db directory      : " << db_directory << "\n";
     std::cout << "  tensor store name : " << tensor_store_name << "\n";
+    std::cout << "  quantize          : " << (quantize ? "int8" : "no") << "\n";
     std::cout << "  metric type       : ";
     switch (metric_type) {
     case MetricType::ANGULAR:
@@ -116,9 +170,15 @@ int main(int argc, char* argv[]) {
         break;
     }
     std::cout << "\n";
-    std::cout << "  num trees         : " << num_trees << "\n";
-    std::cout << "  max bucket size   : " << max_bucket_size << "\n";
-    std::cout << "  max depth         : " << max_depth << "\n";
+    if (is_hnsw) {
+        std::cout << "  M                 : " << hnsw_m << "\n";
+        std::cout << "  ef construction   : " << ef_construction << "\n";
+        std::cout << "  ef search         : " << ef_search << "\n";
+    } else {
+        std::cout << "  num trees         : " << num_trees << "\n";
+        std::cout << "  max bucket size   : " << max_bucket_size << "\n";
+        std::cout << "  max depth         : " << max_depth << "\n";
+    }
 
     std::cout << "Initializing a QuadModel...\n";
     auto model_destroyer = QuadModel::init(db_directory,
@@ -134,17 +194,31 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    const std::string index_extension = is_hnsw ? ".hnsw" : ".index";
     if (Filesystem::is_regular_file(
-          file_manager.get_file_path(TensorStore::TENSOR_STORES_DIR + "/" + tensor_store_name + ".index")))
+          file_manager.get_file_path(TensorStore::TENSOR_STORES_DIR + "/" + tensor_store_name + index_extension)))
     {
         std::cerr << "An index for the tensor store \"" << tensor_store_name
-                  << "\" already exists. Please delete the .index file first\n";
+                  << "\" already exists. Please delete the " << index_extension << " file first\n";
         return EXIT_FAILURE;
     }
 
     TensorStore tensor_store(tensor_store_name, tensor_buffer, preload);
 
-    build_forest_index(tensor_store, metric_type, num_trees, max_bucket_size, max_depth);
+    if (quantize) {
+        std::cout << "Building quantized tensors..." << std::endl;
+        auto start_quantize = std::chrono::system_clock::now();
+        tensor_store.build_quantized_tensors();
+        auto end_quantize = std::chrono::system_clock::now();
+        auto duration_quantize = std::chrono::duration_cast<std::chrono::seconds>(end_quantize - start_quantize);
+        std::cout << "Build quantized tensors took: " << duration_quantize.count() << " seconds\n";
+    }
+
+    if (is_hnsw) {
+        build_hnsw_index(tensor_store, metric_type, hnsw_m, ef_construction, ef_search);
+    } else {
+        build_forest_index(tensor_store, metric_type, num_trees, max_bucket_size, max_depth);
+    }
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,988 @@
+/*
+ * mdb-microbench measures the cost of single storage and execution primitives, isolated from the
+ * query parser and optimizer, so a regression or improvement can be attributed to a component.
+ *
+ * mdb-microbench <directory>
+ *   Writes a synthetic graph generated with a fixed seed in <directory>, imports it as an RDF database
+ *   (replacing the database of a previous execution) and measures:
+ *   - B+tree range scans, point ranges and point lookups (BPlusTree::get_range + BptIter::next)
+ *   - LeapfrogBptIter::seek
+ *   - StringsHash lookups (StringManager::get_str_id) and StringManager::get_or_create, alone and
+ *     mixed in many threads
+ *   - KeyValueHash and DistinctBindingHash inserts and probes
+ *   - TupleIdCollection sort
+ *   - Conversions::unpack_* of the common value types
+ *   - the JSON and TSV output escapers
+ *
+ *   The primitives that build their own structure are measured with each of the `--sizes`, the ones
+ *   that read the database are measured against the imported graph of `--triples` triples. Read-only
+ *   primitives are also measured with each of the `--threads` counts, every thread executing the same
+ *   amount of operations. Each measurement is repeated `--repetitions` times and the fastest is reported
+ *   as nanoseconds per operation (the latency seen by one thread) and millions of operations per second
+ *   (the throughput of all threads). `--output` writes the measurements as JSON to compare two builds.
+ *
+ *   Nothing is downloaded, the same arguments always produce the same graph and the same operations.
+ *   The page size is fixed when building (MDB_PAGE_SIZE), to compare page sizes run the same arguments
+ *   with builds of each size and compare their `--output`.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "graph_models/common/datatypes/datetime.h"
+#include "graph_models/rdf_model/comparisons.h"
+#include "graph_models/rdf_model/conversions.h"
+#include "graph_models/rdf_model/datatypes/decimal.h"
+#include "graph_models/rdf_model/rdf_model.h"
+#include "import/rdf_model/import.h"
+#include "misc/fatal_error.h"
+#include "misc/logger.h"
+#include "query/executor/query_executor/json_ostream_escape.h"
+#include "query/executor/query_executor/tsv_ostream_escape.h"
+#include "query/query_context.h"
+#include "storage/buffer_manager.h"
+#include "storage/file_manager.h"
+#include "storage/index/hash/distinct_binding_hash/distinct_binding_hash.h"
+#include "storage/index/hash/key_value_hash/key_value_hash.h"
+#include "storage/index/leapfrog/leapfrog_bpt_iter.h"
+#include "storage/string_manager.h"
+#include "storage/tmp_manager.h"
+#include "storage/tuple_collection/tuple_id_collection.h"
+
+#include "third_party/cli11/CLI11.hpp"
+
+using DurationNS = std::chrono::duration<double, std::nano>;
+
+namespace {
+
+struct MicrobenchConfig {
+    std::string              directory;
+    std::string              output_path;
+    std::vector<std::string> filters;
+    std::vector<uint64_t>    sizes       = { 1'000, 100'000, 1'000'000 };
+    std::vector<uint64_t>    threads     = { 1, 2, 4 };
+    uint64_t                 triples     = 1'000'000;
+    uint64_t                 lookups     = 100'000;
+    uint64_t                 repetitions = 3;
+    uint64_t                 seed        = 1;
+
+    uint64_t load_strings             = StringManager::DEFAULT_LOAD_STR;
+    uint64_t versioned_pages_buffer   = BufferManager::DEFAULT_VERSIONED_PAGES_BUFFER_SIZE;
+    uint64_t private_pages_buffer     = BufferManager::DEFAULT_PRIVATE_PAGES_BUFFER_SIZE;
+    uint64_t unversioned_pages_buffer = BufferManager::DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE;
+};
+
+
+constexpr auto ENTITY_IRI   = "http://www.example.org/entity/Q";
+constexpr auto PROPERTY_IRI = "http://www.example.org/prop/P";
+constexpr auto LABEL_IRI    = "http://www.w3.org/2000/01/rdf-schema#label";
+constexpr auto XSD          = "http://www.w3.org/2001/XMLSchema#";
+
+constexpr uint64_t PROPERTIES = 32;
+
+
+std::string get_label(uint64_t entity) {
+    return "Label of entity " + std::to_string(entity) + " in the microbenchmark graph";
+}
+
+
+// Every entity has a label and the rest of the triples link random entities with other entities,
+// integers, decimals, dates and strings.
+void write_graph(const std::string& path, uint64_t triples, uint64_t seed) {
+    std::ofstream os(path);
+    if (os.fail()) {
+        throw std::runtime_error("Could not write file " + path);
+    }
+
+    const uint64_t entities = std::max<uint64_t>(triples / 8, 1);
+    std::mt19937_64 rng(seed);
+
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < entities && written < triples; i++, written++) {
+        os << '<' << ENTITY_IRI << i << "> <" << LABEL_IRI << "> \"" << get_label(i) << "\" .\n";
+    }
+
+    std::uniform_int_distribution<uint64_t> entity_dist(0, entities - 1);
+    std::uniform_int_distribution<uint64_t> property_dist(0, PROPERTIES - 1);
+    std::uniform_int_distribution<uint64_t> kind_dist(0, 99);
+    std::uniform_int_distribution<int64_t>  int_dist(-1'000'000, 1'000'000);
+    std::uniform_int_distribution<int>      year_dist(1900, 2030);
+    std::uniform_int_distribution<int>      month_dist(1, 12);
+    std::uniform_int_distribution<int>      day_dist(1, 28);
+
+    for (; written < triples; written++) {
+        os << '<' << ENTITY_IRI << entity_dist(rng) << "> <" << PROPERTY_IRI << property_dist(rng) << "> ";
+
+        auto kind = kind_dist(rng);
+        if (kind < 60) {
+            os << '<' << ENTITY_IRI << entity_dist(rng) << '>';
+        } else if (kind < 75) {
+            os << '"' << int_dist(rng) << "\"^^<" << XSD << "integer>";
+        } else if (kind < 85) {
+            os << '"' << int_dist(rng) << '.' << std::abs(int_dist(rng)) % 1000 << "\"^^<" << XSD << "decimal>";
+        } else if (kind < 95) {
+            os << '"' << year_dist(rng) << '-'
+               << std::setfill('0') << std::setw(2) << month_dist(rng) << '-'
+               << std::setw(2) << day_dist(rng) << std::setfill(' ')
+               << "T12:00:00Z\"^^<" << XSD << "dateTime>";
+        } else {
+            os << "\"Description " << rng() << " of a random entity\"";
+        }
+        os << " .\n";
+    }
+}
+
+
+// The importer initializes the global FileManager with its own state, it is executed in a child
+// process so the parent can open the database as if it were a different program.
+void import_graph(const std::string& data_path, const std::string& db_directory) {
+    auto pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("Could not create the import process");
+    }
+    if (pid == 0) {
+        try {
+            // only errors are interesting, the import progress is saved next to the data
+            if (freopen((data_path + ".import.log").c_str(), "w", stdout) == nullptr) {
+                _exit(EXIT_FAILURE);
+            }
+            FileManager::init(db_directory);
+            Import::Rdf::OnDiskImport importer(db_directory, 1024ULL * 1024 * 1024, 4, false);
+            importer.start_import(data_path, "");
+        } catch (const std::exception& e) {
+            std::cerr << "Import failed: " << e.what() << "\n";
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+        throw std::runtime_error("Could not import " + data_path);
+    }
+}
+
+
+// Values computed by the workloads are accumulated here so the compiler can't remove them
+std::atomic<uint64_t> sink { 0 };
+
+
+// Executes the timed operations and returns how many were done
+using Workload = std::function<uint64_t()>;
+
+
+struct Microbenchmark {
+    std::string name;
+
+    // Database primitives are measured against the imported graph instead of every size
+    bool uses_database;
+
+    // Whether it can be executed by many threads at the same time
+    bool concurrent;
+
+    // Prepares the state of a thread, is not timed. The structures that depend on the thread
+    // (tmp files of the private buffer) must be created here or inside the workload
+    std::function<Workload(uint64_t size, std::mt19937_64& rng)> prepare;
+};
+
+
+struct Measurement {
+    std::string name;
+    uint64_t    size;
+    uint64_t    threads;
+    uint64_t    operations; // total of all threads
+    double      elapsed_ns;
+
+    double ns_per_op() const {
+        return operations == 0 ? 0 : elapsed_ns * threads / operations;
+    }
+
+    double mops_per_second() const {
+        return elapsed_ns == 0 ? 0 : operations / elapsed_ns * 1000;
+    }
+};
+
+
+class Microbench {
+public:
+    Microbench(const MicrobenchConfig& config, uint64_t max_threads) :
+        config         (config),
+        query_contexts (max_threads) { }
+
+    // Must be called with the query context that has the version used by the readers
+    void init_database_data() {
+        start_version = get_query_ctx().start_version;
+
+        auto& spo = *rdf_model.spo;
+        Record<3> min = { 0, 0, 0 };
+        Record<3> max = { UINT64_MAX, UINT64_MAX, UINT64_MAX };
+
+        bool interruption_requested = false;
+        auto it = spo.get_range(&interruption_requested, min, max);
+        for (auto record = it.next(); record != nullptr; record = it.next()) {
+            if (subjects.empty() || subjects.back() != (*record)[0]) {
+                subjects.push_back((*record)[0]);
+            }
+            if (database_triples % SAMPLED_TRIPLES_STRIDE == 0) {
+                sampled_triples.push_back({ (*record)[0], (*record)[1], (*record)[2] });
+            }
+            database_triples++;
+        }
+        entities = std::max<uint64_t>(config.triples / 8, 1);
+    }
+
+    std::vector<Microbenchmark> get_microbenchmarks();
+
+    void run(const std::vector<Microbenchmark>& microbenchmarks) {
+        for (auto& microbenchmark : microbenchmarks) {
+            auto sizes = microbenchmark.uses_database ? std::vector<uint64_t> { database_triples } : config.sizes;
+
+            for (auto size : sizes) {
+                for (auto threads : config.threads) {
+                    if (threads > 1 && !microbenchmark.concurrent) {
+                        continue;
+                    }
+                    auto measurement = measure(microbenchmark, size, threads);
+                    write_row(std::cout, measurement);
+                    measurements.push_back(std::move(measurement));
+                }
+            }
+        }
+    }
+
+    static void write_header(std::ostream& os) {
+        os << std::left << std::setw(34) << "benchmark"
+           << std::right << std::setw(11) << "size"
+           << std::setw(9)  << "threads"
+           << std::setw(13) << "ops"
+           << std::setw(12) << "ns/op"
+           << std::setw(11) << "Mops/s" << "\n";
+    }
+
+    static void write_row(std::ostream& os, const Measurement& measurement) {
+        os << std::left << std::setw(34) << measurement.name
+           << std::right << std::setw(11) << measurement.size
+           << std::setw(9)  << measurement.threads
+           << std::setw(13) << measurement.operations
+           << std::fixed << std::setprecision(2)
+           << std::setw(12) << measurement.ns_per_op()
+           << std::setw(11) << measurement.mops_per_second()
+           << std::defaultfloat << std::endl;
+    }
+
+    void write_json(std::ostream& os) const {
+        os << "{\n  \"triples\": " << database_triples
+           << ",\n  \"page_size\": " << VPage::SIZE
+           << ",\n  \"seed\": " << config.seed
+           << ",\n  \"repetitions\": " << config.repetitions
+           << ",\n  \"measurements\": [";
+
+        auto first = true;
+        for (auto& measurement : measurements) {
+            if (first) first = false; else os << ',';
+            os << "\n    {\"benchmark\": \"" << measurement.name
+               << "\", \"size\": " << measurement.size
+               << ", \"threads\": " << measurement.threads
+               << ", \"operations\": " << measurement.operations
+               << ", \"ns_per_op\": " << measurement.ns_per_op()
+               << ", \"mops_per_second\": " << measurement.mops_per_second() << '}';
+        }
+        os << "\n  ]\n}\n";
+    }
+
+private:
+    const MicrobenchConfig& config;
+
+    std::vector<QueryContext> query_contexts;
+
+    std::vector<Measurement> measurements;
+
+    // first column of the SPO index without repetitions
+    std::vector<uint64_t> subjects;
+
+    // one of every SAMPLED_TRIPLES_STRIDE triples of the SPO index
+    static constexpr uint64_t SAMPLED_TRIPLES_STRIDE = 16;
+    std::vector<Record<3>> sampled_triples;
+
+    uint64_t database_triples = 0;
+    uint64_t entities = 0;
+    uint64_t start_version = 0;
+
+    // the fastest repetition is kept, the others are slowed down by noise (scheduling, page faults)
+    Measurement measure(const Microbenchmark& microbenchmark, uint64_t size, uint64_t threads) {
+        Measurement best { microbenchmark.name, size, threads, 0, 0 };
+
+        for (uint64_t repetition = 0; repetition < config.repetitions; repetition++) {
+            std::atomic<uint64_t> ready { 0 };
+            std::atomic<bool> start { false };
+            std::atomic<uint64_t> operations { 0 };
+
+            std::vector<std::thread> workers;
+            for (uint64_t t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    QueryContext::set_query_ctx(&query_contexts[t]);
+                    get_query_ctx().thread_info.worker_index = t;
+                    get_query_ctx().thread_info.interruption_requested = false;
+                    get_query_ctx().start_version  = start_version;
+                    get_query_ctx().result_version = start_version;
+                    tmp_manager.reset();
+
+                    // every thread has different values, but they are the same in every execution
+                    std::mt19937_64 rng(config.seed * 1'000'003 + t * 7919 + size);
+                    auto workload = microbenchmark.prepare(size, rng);
+
+                    ready.fetch_add(1);
+                    while (!start.load()) {
+                        std::this_thread::yield();
+                    }
+                    operations.fetch_add(workload());
+                });
+            }
+
+            while (ready.load() < threads) {
+                std::this_thread::yield();
+            }
+            auto start_time = std::chrono::steady_clock::now();
+            start.store(true);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            DurationNS elapsed = std::chrono::steady_clock::now() - start_time;
+
+            if (repetition == 0 || elapsed.count() < best.elapsed_ns) {
+                best.elapsed_ns = elapsed.count();
+                best.operations = operations.load();
+            }
+        }
+        return best;
+    }
+
+    uint64_t random_subject(std::mt19937_64& rng) const {
+        return subjects[std::uniform_int_distribution<uint64_t>(0, subjects.size() - 1)(rng)];
+    }
+
+    Record<3> random_triple(std::mt19937_64& rng) const {
+        return sampled_triples[std::uniform_int_distribution<uint64_t>(0, sampled_triples.size() - 1)(rng)];
+    }
+
+    std::vector<std::string> random_labels(uint64_t count, std::mt19937_64& rng) const {
+        std::uniform_int_distribution<uint64_t> entity_dist(0, entities - 1);
+        std::vector<std::string> labels;
+        labels.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            labels.push_back(get_label(entity_dist(rng)));
+        }
+        return labels;
+    }
+
+    // Random object ids with few repetitions, as the bindings of a join result
+    static std::vector<ObjectId> random_ids(uint64_t count, std::mt19937_64& rng) {
+        std::uniform_int_distribution<uint64_t> dist(0, count * 4);
+        std::vector<ObjectId> ids;
+        ids.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            ids.push_back(Common::Conversions::pack_int(dist(rng)));
+        }
+        return ids;
+    }
+
+    // Values to escape, mostly plain text as the literals of a result
+    static std::vector<std::string> random_texts(uint64_t count, std::mt19937_64& rng) {
+        static constexpr char chars[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789";
+        static constexpr char special_chars[] = "\"\\\n\t\r/";
+
+        std::uniform_int_distribution<uint64_t> length_dist(8, 120);
+        std::uniform_int_distribution<uint64_t> char_dist(0, sizeof(chars) - 2);
+        std::uniform_int_distribution<uint64_t> special_dist(0, sizeof(special_chars) - 2);
+        std::uniform_int_distribution<uint64_t> percent_dist(0, 99);
+
+        std::vector<std::string> texts;
+        texts.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            std::string text(length_dist(rng), ' ');
+            for (auto& c : text) {
+                c = percent_dist(rng) < 2 ? special_chars[special_dist(rng)] : chars[char_dist(rng)];
+            }
+            texts.push_back(std::move(text));
+        }
+        return texts;
+    }
+
+    template <typename Escape>
+    static Workload escape_workload(uint64_t size, std::mt19937_64& rng) {
+        auto texts = std::make_shared<std::vector<std::string>>(random_texts(size, rng));
+        return [texts]() {
+            std::ostringstream output;
+            Escape escape(output);
+            std::ostream escaped_os(&escape);
+
+            uint64_t bytes = 0;
+            for (uint64_t i = 0; i < texts->size(); i++) {
+                escaped_os << (*texts)[i];
+                // keeps the output small enough to stay in cache
+                if (i % 1024 == 1023) {
+                    bytes += output.tellp();
+                    output.str("");
+                }
+            }
+            sink.fetch_add(bytes, std::memory_order_relaxed);
+            return texts->size();
+        };
+    }
+};
+
+
+std::vector<Microbenchmark> Microbench::get_microbenchmarks() {
+    using namespace SPARQL;
+
+    std::vector<Microbenchmark> res;
+
+    res.push_back({ "bpt_scan", true, true,
+        [](uint64_t, std::mt19937_64&) -> Workload {
+            return []() {
+                Record<3> min = { 0, 0, 0 };
+                Record<3> max = { UINT64_MAX, UINT64_MAX, UINT64_MAX };
+                auto it = rdf_model.spo->get_range(&get_query_ctx().thread_info.interruption_requested, min, max);
+
+                uint64_t records = 0;
+                uint64_t checksum = 0;
+                for (auto record = it.next(); record != nullptr; record = it.next()) {
+                    checksum += (*record)[2];
+                    records++;
+                }
+                sink.fetch_add(checksum, std::memory_order_relaxed);
+                return records;
+            };
+        }
+    });
+
+    res.push_back({ "bpt_get_range", true, true,
+        [this](uint64_t, std::mt19937_64& rng) -> Workload {
+            auto keys = std::make_shared<std::vector<uint64_t>>();
+            for (uint64_t i = 0; i < config.lookups; i++) {
+                keys->push_back(random_subject(rng));
+            }
+            return [keys]() {
+                uint64_t checksum = 0;
+                for (auto key : *keys) {
+                    Record<3> min = { key, 0, 0 };
+                    Record<3> max = { key, UINT64_MAX, UINT64_MAX };
+                    auto it = rdf_model.spo->get_range(&get_query_ctx().thread_info.interruption_requested, min, max);
+                    for (auto record = it.next(); record != nullptr; record = it.next()) {
+                        checksum += (*record)[2];
+                    }
+                }
+                sink.fetch_add(checksum, std::memory_order_relaxed);
+                return keys->size();
+            };
+        }
+    });
+
+    res.push_back({ "bpt_point_lookup", true, true,
+        [this](uint64_t, std::mt19937_64& rng) -> Workload {
+            auto triples = std::make_shared<std::vector<Record<3>>>();
+            for (uint64_t i = 0; i < config.lookups; i++) {
+                triples->push_back(random_triple(rng));
+            }
+            return [triples]() {
+                uint64_t found = 0;
+                for (auto& triple : *triples) {
+                    auto it = rdf_model.spo->get_range(&get_query_ctx().thread_info.interruption_requested, triple, triple);
+                    found += it.next() != nullptr;
+                }
+                sink.fetch_add(found, std::memory_order_relaxed);
+                return triples->size();
+            };
+        }
+    });
+
+    res.push_back({ "leapfrog_seek", true, true,
+        [this](uint64_t, std::mt19937_64& rng) -> Workload {
+            auto keys = std::make_shared<std::vector<uint64_t>>();
+            for (uint64_t i = 0; i < config.lookups; i++) {
+                keys->push_back(random_subject(rng));
+            }
+            // a leapfrog join seeks keys in ascending order
+            std::sort(keys->begin(), keys->end());
+
+            return [keys]() {
+                std::vector<VarId> intersection_vars = { VarId(0) };
+                std::vector<VarId> enumeration_vars  = { VarId(1), VarId(2) };
+                LeapfrogBptIter<3> iter(&get_query_ctx().thread_info.interruption_requested,
+                                        *rdf_model.spo,
+                                        {},
+                                        std::move(intersection_vars),
+                                        std::move(enumeration_vars));
+                Binding binding(3);
+                iter.open_terms(binding);
+                iter.down();
+
+                uint64_t checksum = 0;
+                for (auto key : *keys) {
+                    if (iter.seek(key)) {
+                        checksum += iter.get_key();
+                    }
+                }
+                sink.fetch_add(checksum, std::memory_order_relaxed);
+                return keys->size();
+            };
+        }
+    });
+
+    res.push_back({ "strings_hash_get_str_id", true, true,
+        [this](uint64_t, std::mt19937_64& rng) -> Workload {
+            auto labels = std::make_shared<std::vector<std::string>>(random_labels(config.lookups, rng));
+            return [labels]() {
+                uint64_t found = 0;
+                for (auto& label : *labels) {
+                    found += string_manager.get_str_id(label) != ObjectId::MASK_NOT_FOUND;
+                }
+                sink.fetch_add(found, std::memory_order_relaxed);
+                return labels->size();
+            };
+        }
+    });
+
+    res.push_back({ "unpack_string", true, true,
+        [this](uint64_t, std::mt19937_64& rng) -> Workload {
+            auto oids = std::make_shared<std::vector<ObjectId>>();
+            for (auto& label : random_labels(config.lookups, rng)) {
+                oids->push_back(Conversions::pack_string_simple(label));
+            }
+            return [oids]() {
+                uint64_t length = 0;
+                for (auto oid : *oids) {
+                    length += Conversions::unpack_string(oid).size();
+                }
+                sink.fetch_add(length, std::memory_order_relaxed);
+                return oids->size();
+            };
+        }
+    });
+
+    // every repetition needs strings that were not created before
+    static std::atomic<uint64_t> created_strings { 0 };
+    res.push_back({ "string_manager_get_or_create", false, false,
+        [](uint64_t size, std::mt19937_64&) -> Workload {
+            auto strings = std::make_shared<std::vector<std::string>>();
+            for (uint64_t i = 0; i < size; i++) {
+                strings->push_back("Created string " + std::to_string(created_strings++) + " of the microbenchmark");
+            }
+            return [strings]() {
+                uint64_t checksum = 0;
+                for (auto& str : *strings) {
+                    checksum += string_manager.get_or_create(str.data(), str.size());
+                }
+                sink.fetch_add(checksum, std::memory_order_relaxed);
+                return strings->size();
+            };
+        }
+    });
+
+    // each operation creates a string and looks up an existing one, with many threads the lookups
+    // overlap with the bucket splits of the inserts of other threads
+    res.push_back({ "string_manager_create_and_lookup", false, true,
+        [this](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto strings = std::make_shared<std::vector<std::string>>();
+            for (uint64_t i = 0; i < size; i++) {
+                strings->push_back("Created string " + std::to_string(created_strings++) + " of the microbenchmark");
+            }
+            auto labels = std::make_shared<std::vector<std::string>>(random_labels(size, rng));
+            return [strings, labels]() {
+                uint64_t checksum = 0;
+                for (uint64_t i = 0; i < strings->size(); i++) {
+                    checksum += string_manager.get_or_create((*strings)[i].data(), (*strings)[i].size());
+                    checksum += string_manager.get_str_id((*labels)[i]);
+                }
+                sink.fetch_add(checksum, std::memory_order_relaxed);
+                return strings->size();
+            };
+        }
+    });
+
+    res.push_back({ "key_value_hash_insert", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto keys   = std::make_shared<std::vector<ObjectId>>(random_ids(size, rng));
+            auto values = std::make_shared<std::vector<ObjectId>>(random_ids(size, rng));
+            return [keys, values]() {
+                KeyValueHash<ObjectId, ObjectId> hash(1, 1);
+                hash.begin();
+                std::vector<ObjectId> key(1);
+                std::vector<ObjectId> value(1);
+                for (uint64_t i = 0; i < keys->size(); i++) {
+                    key[0]   = (*keys)[i];
+                    value[0] = (*values)[i];
+                    hash.insert(key, value);
+                }
+                hash.sort_buckets();
+                sink.fetch_add(hash.get_depth(), std::memory_order_relaxed);
+                return keys->size();
+            };
+        }
+    });
+
+    res.push_back({ "key_value_hash_probe", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto keys = std::make_shared<std::vector<ObjectId>>(random_ids(size, rng));
+            auto hash = std::make_shared<KeyValueHash<ObjectId, ObjectId>>(1, 1);
+            hash->begin();
+            std::vector<ObjectId> key(1);
+            for (uint64_t i = 0; i < size; i++) {
+                key[0] = (*keys)[i];
+                hash->insert(key, key);
+            }
+            hash->sort_buckets();
+            // half of the probes don't find a match
+            auto probes = std::make_shared<std::vector<ObjectId>>(random_ids(size, rng));
+
+            return [hash, probes]() {
+                std::vector<ObjectId> key(1);
+                uint64_t found = 0;
+                for (auto probe : *probes) {
+                    key[0] = probe;
+                    uint_fast32_t pos;
+                    found += hash->find_first(key, hash->get_bucket(key), &pos);
+                }
+                sink.fetch_add(found, std::memory_order_relaxed);
+                return probes->size();
+            };
+        }
+    });
+
+    res.push_back({ "distinct_binding_hash_insert", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            // random_ids repeat about a quarter of the tuples
+            auto ids = std::make_shared<std::vector<ObjectId>>(random_ids(size * 2, rng));
+            return [ids]() {
+                DistinctBindingHash<ObjectId> hash(2);
+                std::vector<ObjectId> tuple(2);
+                uint64_t repeated = 0;
+                for (uint64_t i = 0; i + 1 < ids->size(); i += 2) {
+                    tuple[0] = (*ids)[i];
+                    tuple[1] = (*ids)[i + 1];
+                    repeated += hash.is_in_or_insert(tuple);
+                }
+                sink.fetch_add(repeated, std::memory_order_relaxed);
+                return ids->size() / 2;
+            };
+        }
+    });
+
+    res.push_back({ "distinct_binding_hash_probe", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto hash = std::make_shared<DistinctBindingHash<ObjectId>>(2);
+            std::vector<ObjectId> tuple(2);
+            for (auto id : random_ids(size, rng)) {
+                tuple[0] = id;
+                tuple[1] = id;
+                hash->is_in_or_insert(tuple);
+            }
+            auto probes = std::make_shared<std::vector<ObjectId>>(random_ids(size, rng));
+
+            return [hash, probes]() {
+                std::vector<ObjectId> tuple(2);
+                uint64_t found = 0;
+                for (auto probe : *probes) {
+                    tuple[0] = probe;
+                    tuple[1] = probe;
+                    found += hash->is_in(tuple);
+                }
+                sink.fetch_add(found, std::memory_order_relaxed);
+                return probes->size();
+            };
+        }
+    });
+
+    res.push_back({ "tuple_id_collection_sort", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto ids = std::make_shared<std::vector<ObjectId>>(random_ids(size * 2, rng));
+            return [ids]() {
+                // same layout as the runs of ORDER BY ?x with the projection (?x ?y)
+                std::map<VarId, uint_fast32_t> saved_vars = { { VarId(0), 0 }, { VarId(1), 1 } };
+                std::vector<VarId> order_vars = { VarId(0) };
+                std::vector<bool> ascending = { true };
+
+                auto file_id = file_manager.get_tmp_file_id();
+                uint64_t sorted = 0;
+                {
+                    TupleIdCollection run(buffer_manager.get_ppage(file_id, 0),
+                                          saved_vars,
+                                          order_vars,
+                                          ascending,
+                                          &SPARQL::Comparisons::compare);
+                    run.reset();
+
+                    std::vector<ObjectId> tuple(2);
+                    for (uint64_t i = 0; i + 1 < ids->size(); i += 2) {
+                        tuple[0] = (*ids)[i];
+                        tuple[1] = (*ids)[i + 1];
+                        run.add(tuple);
+                        if (run.is_full()) {
+                            run.sort();
+                            sorted += run.get_tuple_count();
+                            run.reset();
+                        }
+                    }
+                    run.sort();
+                    sorted += run.get_tuple_count();
+                }
+                file_manager.remove_tmp(file_id);
+                sink.fetch_add(sorted, std::memory_order_relaxed);
+                return ids->size() / 2;
+            };
+        }
+    });
+
+    res.push_back({ "unpack_int", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto oids = std::make_shared<std::vector<ObjectId>>();
+            std::uniform_int_distribution<int64_t> dist(-Common::Conversions::INTEGER_MAX,
+                                                        Common::Conversions::INTEGER_MAX);
+            for (uint64_t i = 0; i < size; i++) {
+                oids->push_back(Common::Conversions::pack_int(dist(rng)));
+            }
+            return [oids]() {
+                int64_t sum = 0;
+                for (auto oid : *oids) {
+                    sum += Common::Conversions::unpack_int(oid);
+                }
+                sink.fetch_add(sum, std::memory_order_relaxed);
+                return oids->size();
+            };
+        }
+    });
+
+    res.push_back({ "unpack_float", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto oids = std::make_shared<std::vector<ObjectId>>();
+            std::uniform_real_distribution<float> dist(-1e6, 1e6);
+            for (uint64_t i = 0; i < size; i++) {
+                oids->push_back(Common::Conversions::pack_float(dist(rng)));
+            }
+            return [oids]() {
+                float sum = 0;
+                for (auto oid : *oids) {
+                    sum += Common::Conversions::unpack_float(oid);
+                }
+                sink.fetch_add(static_cast<uint64_t>(sum != 0), std::memory_order_relaxed);
+                return oids->size();
+            };
+        }
+    });
+
+    res.push_back({ "unpack_decimal", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto oids = std::make_shared<std::vector<ObjectId>>();
+            std::uniform_int_distribution<int64_t> dist(-1'000'000, 1'000'000);
+            for (uint64_t i = 0; i < size; i++) {
+                auto str = std::to_string(dist(rng)) + '.' + std::to_string(std::abs(dist(rng)) % 1000);
+                bool error;
+                oids->push_back(Conversions::pack_decimal(Decimal(str, &error)));
+            }
+            return [oids]() {
+                uint64_t length = 0;
+                for (auto oid : *oids) {
+                    length += Conversions::unpack_decimal(oid).to_string().size();
+                }
+                sink.fetch_add(length, std::memory_order_relaxed);
+                return oids->size();
+            };
+        }
+    });
+
+    res.push_back({ "unpack_datetime", false, true,
+        [](uint64_t size, std::mt19937_64& rng) -> Workload {
+            auto oids = std::make_shared<std::vector<ObjectId>>();
+            std::uniform_int_distribution<int> year_dist(1900, 2030);
+            std::uniform_int_distribution<int> month_dist(1, 12);
+            std::uniform_int_distribution<int> day_dist(1, 28);
+            for (uint64_t i = 0; i < size; i++) {
+                std::stringstream ss;
+                ss << year_dist(rng) << '-' << std::setfill('0') << std::setw(2) << month_dist(rng)
+                   << '-' << std::setw(2) << day_dist(rng) << "T12:00:00Z";
+                oids->push_back(ObjectId(DateTime::from_dateTime(ss.str())));
+            }
+            return [oids]() {
+                uint64_t length = 0;
+                for (auto oid : *oids) {
+                    length += Common::Conversions::unpack_date(oid).get_value_string().size();
+                }
+                sink.fetch_add(length, std::memory_order_relaxed);
+                return oids->size();
+            };
+        }
+    });
+
+    res.push_back({ "json_escape", false, true, &Microbench::escape_workload<JsonOstreamEscape> });
+    res.push_back({ "tsv_escape",  false, true, &Microbench::escape_workload<TSVOstreamEscape> });
+
+    return res;
+}
+
+
+int run_microbench(MicrobenchConfig& config) {
+    namespace fs = std::filesystem;
+
+    if (config.threads.empty() || config.sizes.empty()) {
+        std::cerr << "At least one thread count and one size are needed\n";
+        return EXIT_FAILURE;
+    }
+    std::sort(config.threads.begin(), config.threads.end());
+    auto max_threads = config.threads.back();
+
+    fs::create_directories(config.directory);
+    auto data_path    = config.directory + "/graph.nt";
+    auto db_directory = config.directory + "/db";
+
+    std::cout << "Generating " << config.triples << " triples (seed " << config.seed << ")" << std::endl;
+    write_graph(data_path, config.triples, config.seed);
+
+    std::cout << "Importing into " << db_directory << std::endl;
+    fs::remove_all(db_directory);
+    import_graph(data_path, db_directory);
+
+    auto model_destroyer = RdfModel::init(db_directory,
+                                          config.load_strings,
+                                          config.versioned_pages_buffer,
+                                          config.private_pages_buffer,
+                                          config.unversioned_pages_buffer,
+                                          max_threads);
+
+    for (auto& [category, category_config] : logger.categories) {
+        category_config.enabled = category == Category::Error;
+    }
+
+    Microbench microbench(config, max_threads);
+    auto microbenchmarks = microbench.get_microbenchmarks();
+    if (!config.filters.empty()) {
+        microbenchmarks.erase(
+            std::remove_if(microbenchmarks.begin(), microbenchmarks.end(), [&](const Microbenchmark& m) {
+                return std::none_of(config.filters.begin(), config.filters.end(), [&](const std::string& filter) {
+                    return m.name.find(filter) != std::string::npos;
+                });
+            }),
+            microbenchmarks.end()
+        );
+    }
+
+    // the database is not modified by the readers, every thread uses the same version
+    auto version_scope = buffer_manager.init_version_readonly();
+    QueryContext setup_context;
+    QueryContext::set_query_ctx(&setup_context);
+    setup_context.start_version  = version_scope->start_version;
+    setup_context.result_version = version_scope->start_version;
+    microbench.init_database_data();
+
+    std::cout << "\nPage size: " << VPage::SIZE << " bytes\n\n";
+    Microbench::write_header(std::cout);
+    microbench.run(microbenchmarks);
+
+    if (!config.output_path.empty()) {
+        std::ofstream output(config.output_path);
+        microbench.write_json(output);
+        std::cout << "\nResults written to " << config.output_path << "\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[]) {
+    MicrobenchConfig config;
+
+    CLI::App app{"MillenniumDB microbenchmarks"};
+    app.get_formatter()->column_width(34);
+    app.option_defaults()->always_capture_default();
+
+    app.add_option("directory", config.directory)
+        ->description("Scratch directory for the generated graph and its database")
+        ->type_name("<path>")
+        ->required();
+
+    app.add_option("--triples", config.triples)
+        ->description("Number of triples of the generated graph")
+        ->type_name("<num>")
+        ->check(CLI::Range(1'000ULL, 1'000'000'000ULL).description(""));
+
+    app.add_option("--sizes", config.sizes)
+        ->description("Element counts of the primitives that build their own structure")
+        ->type_name("<num>...")
+        ->delimiter(',');
+
+    app.add_option("--threads", config.threads)
+        ->description("Thread counts of the read-only primitives")
+        ->type_name("<num>...")
+        ->delimiter(',')
+        ->check(CLI::Range(1, 1024).description(""));
+
+    app.add_option("--lookups", config.lookups)
+        ->description("Operations per thread of the primitives that read the database")
+        ->type_name("<num>")
+        ->check(CLI::Range(1ULL, 1'000'000'000ULL).description(""));
+
+    app.add_option("--repetitions", config.repetitions)
+        ->description("Times each measurement is repeated, the fastest is reported")
+        ->type_name("<num>")
+        ->check(CLI::Range(1, 1000).description(""));
+
+    app.add_option("--seed", config.seed)
+        ->description("Seed of the random generators")
+        ->type_name("<num>");
+
+    app.add_option("--filter", config.filters)
+        ->description("Only run the benchmarks whose name contains one of these strings")
+        ->type_name("<str>...")
+        ->delimiter(',');
+
+    app.add_option("--output", config.output_path)
+        ->description("Write the results as JSON to this file")
+        ->type_name("<path>");
+
+    app.add_option("--load-strings", config.load_strings)
+        ->description("Total amount of strings to pre-load\nAllows units such as MB and GB")
+        ->option_text("<bytes> [2GB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    app.add_option("--versioned-buffer", config.versioned_pages_buffer)
+        ->description("Size of buffer for versioned pages shared between threads\nAllows units such as MB and GB")
+        ->option_text("<bytes> [1GB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    app.add_option("--private-buffer", config.private_pages_buffer)
+        ->description("Size of private per-thread buffers,\nAllows units such as MB and GB")
+        ->option_text("<bytes> [64MB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    app.add_option("--unversioned-buffer", config.unversioned_pages_buffer)
+        ->description("Size of buffer for unversioned pages shared between threads,\nAllows units such as MB and GB")
+        ->option_text("<bytes> [128MB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
+
+    CLI11_PARSE(app, argc, argv);
+
+    try {
+        return run_microbench(config);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+}
@@ -12,7 +12,9 @@
 #include "storage/buffer_manager.h"
 #include "storage/file_manager.h"
 #include "storage/filesystem.h"
+#include "storage/index/tensor_store/hnsw/hnsw_index.h"
 #include "storage/index/tensor_store/lsh/forest_index.h"
+#include "storage/index/tensor_store/scalar_quantizer.h"
 #include "storage/index/tensor_store/tensor_buffer_manager.h"
 #include "storage/string_manager.h"
 
@@ -58,6 +60,14 @@ void load_tensor_stores(uint64_t tensor_pages_buffer, bool preload) {
                     std::cout << "  max_bucket_size: " << tensor_store->forest_index->max_bucket_size << std::endl;
                     std::cout << "  max_depth      : " << tensor_store->forest_index->max_depth << std::endl;
                 }
+                if (tensor_store->hnsw_index != nullptr) {
+                    std::cout << "  hnsw M         : " << tensor_store->hnsw_index->M << std::endl;
+                    std::cout << "  hnsw ef_constr.: " << tensor_store->hnsw_index->ef_construction << std::endl;
+                    std::cout << "  hnsw ef_search : " << tensor_store->hnsw_index->ef_search << std::endl;
+                }
+                if (tensor_store->quantizer != nullptr) {
+                    std::cout << "  quantized bytes: " << tensor_store->quantizer->size_in_bytes() << std::endl;
+                }
                 quad_model.catalog().name2tensor_store.emplace(tensor_store_name, std::move(tensor_store));
             }
         }
@@ -76,6 +86,9 @@ int main(int argc, char* argv[]) {
     auto port            = NewServer::Protocol::DEFAULT_PORT;
     auto browser_port    = NewServer::Protocol::DEFAULT_BROWSER_PORT;
     auto max_threads     = std::thread::hardware_concurrency();
+    auto idle_timeout    = NewServer::Protocol::DEFAULT_IDLE_TIMEOUT_SECONDS;
+
+    uint_fast32_t max_queries = 0;
 
     uint64_t limit                    = 0;
     uint64_t load_strings             = StringManager::DEFAULT_LOAD_STR;
@@ -83,6 +96,8 @@ int main(int argc, char* argv[]) {
     uint64_t private_pages_buffer     = BufferManager::DEFAULT_PRIVATE_PAGES_BUFFER_SIZE;
     uint64_t unversioned_pages_buffer = BufferManager::DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE;
     uint64_t tensor_pages_buffer      = TensorBufferManager::DEFAULT_TENSOR_PAGES_BUFFER_SIZE;
+    uint64_t warmup_size              = BufferManager::DEFAULT_WARMUP_SIZE;
+    uint64_t query_memory_limit       = 0;
     bool     preload_tensors          = false;
 
     std::string db_directory;
@@ -124,6 +139,24 @@ int main(int argc, char* argv[]) {
       ->type_name("<number>")
       ->check(CLI::Range(1, 128).description(""));
 
+    app.add_option("--max-queries", max_queries)
+      ->description("Number of queries that can be streaming at the same time, a query waiting\n"
+                    "for a PULL does not use a thread\nPass 0 to use the number of threads")
+      ->type_name("<number>")
+      ->check(CLI::Range(0, 4096).description(""));
+
+    app.add_option("--idle-timeout", idle_timeout)
+      ->description("Seconds a query can wait for a PULL before it is discarded")
+      ->type_name("<seconds>")
+      ->check(CLI::Range(1, 36'000).description(""));
+
+    app.add_option("--query-memory", query_memory_limit)
+      ->description("Memory the operators of a query can use before it is aborted\n"
+                    "Allows units such as MB and GB, pass 0 to set no limit")
+      ->option_text("<bytes> [0]")
+      ->transform(CLI::AsSizeValue(false))
+      ->check(CLI::Range(0ULL, 1024ULL * 1024 * 1024 * 1024));
+
     app.add_option("--load-strings", load_strings)
       ->description("Total amount of strings to pre-load\nAllows units such as MB and GB")
       ->option_text("<bytes> [2GB]")
@@ -148,6 +181,13 @@ int main(int argc, char* argv[]) {
       ->transform(CLI::AsSizeValue(false))
       ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
 
+    app.add_option("--warmup", warmup_size)
+      ->description("Pages of the previous execution loaded in the background at startup\n"
+                    "Pass 0 to disable it, allows units such as MB and GB")
+      ->option_text("<bytes> [1GB]")
+      ->transform(CLI::AsSizeValue(false))
+      ->check(CLI::Range(0ULL, 1024ULL * 1024 * 1024 * 1024));
+
     app.add_option("--path-mode", path_mode)
       ->description("Path mode")
       ->type_name("<mode>")
@@ -176,6 +216,10 @@ int main(int argc, char* argv[]) {
 
     CLI11_PARSE(app, argc, argv);
 
+    if (max_queries == 0) {
+        max_queries = max_threads;
+    }
+
     if (!config_path.empty()) {
         if (!Filesystem::exists(config_path)) {
             std::cerr << "Configuration file does not exist: " << config_path << "\n";
@@ -207,7 +251,7 @@ int main(int argc, char* argv[]) {
                                                    versioned_pages_buffer,
                                                    private_pages_buffer,
                                                    unversioned_pages_buffer,
-                                                   max_threads);
+                                                   max_queries);
 
             if (limit != 0) {
                 quad_model.MAX_LIMIT = limit;
@@ -219,9 +263,16 @@ int main(int argc, char* argv[]) {
 
             quad_model.catalog().print(std::cout);
 
+            if (warmup_size > 0) {
+                buffer_manager.start_warmup(warmup_size);
+            }
+
             load_tensor_stores(tensor_pages_buffer, preload_tensors);
 
             NewServer::Server<QuadCatalog::MODEL_ID> server;
+            server.max_queries        = max_queries;
+            server.idle_timeout       = std::chrono::seconds(idle_timeout);
+            server.query_memory_limit = query_memory_limit;
             server.run(port, browser_port, !no_browser, max_threads, std::chrono::seconds(timeout_seconds));
             return EXIT_SUCCESS;
         }
@@ -233,7 +284,7 @@ int main(int argc, char* argv[]) {
                                                   versioned_pages_buffer,
                                                   private_pages_buffer,
                                                   unversioned_pages_buffer,
-                                                  max_threads);
+                                                  max_queries);
 
             if (limit != 0) {
                 rdf_model.MAX_LIMIT = limit;
@@ -245,7 +296,14 @@ int main(int argc, char* argv[]) {
 
             rdf_model.catalog().print(std::cout);
 
+            if (warmup_size > 0) {
+                buffer_manager.start_warmup(warmup_size);
+            }
+
             NewServer::Server<RdfCatalog::MODEL_ID> server;
+            server.max_queries        = max_queries;
+            server.idle_timeout       = std::chrono::seconds(idle_timeout);
+            server.query_memory_limit = query_memory_limit;
             server.run(port, browser_port, !no_browser, max_threads, std::chrono::seconds(timeout_seconds));
             return EXIT_SUCCESS;
         }
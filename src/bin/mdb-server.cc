@@ -11,7 +11,9 @@
 #include "storage/buffer_manager.h"
 #include "storage/file_manager.h"
 #include "storage/filesystem.h"
+#include "storage/index/tensor_store/hnsw/hnsw_index.h"
 #include "storage/index/tensor_store/lsh/forest_index.h"
+#include "storage/index/tensor_store/scalar_quantizer.h"
 #include "storage/index/tensor_store/tensor_buffer_manager.h"
 #include "storage/index/tensor_store/tensor_store.h"
 #include "storage/string_manager.h"
@@ -58,6 +60,14 @@ void load_tensor_stores(uint64_t tensor_pages_buffer, bool preload) {
                     std::cout << "  max_bucket_size: " << tensor_store->forest_index->max_bucket_size << std::endl;
                     std::cout << "  max_depth      : " << tensor_store->forest_index->max_depth << std::endl;
                 }
+                if (tensor_store->hnsw_index != nullptr) {
+                    std::cout << "  hnsw M         : " << tensor_store->hnsw_index->M << std::endl;
+                    std::cout << "  hnsw ef_constr.: " << tensor_store->hnsw_index->ef_construction << std::endl;
+                    std::cout << "  hnsw ef_search : " << tensor_store->hnsw_index->ef_search << std::endl;
+                }
+                if (tensor_store->quantizer != nullptr) {
+                    std::cout << "  quantized bytes: " << tensor_store->quantizer->size_in_bytes() << std::endl;
+                }
                 quad_model.catalog().name2tensor_store.emplace(tensor_store_name, std::move(tensor_store));
             }
         }
@@ -94,7 +104,9 @@ int main(int argc, char* argv[]) {
     uint64_t private_pages_buffer     = BufferManager::DEFAULT_PRIVATE_PAGES_BUFFER_SIZE;
     uint64_t unversioned_pages_buffer = BufferManager::DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE;
     uint64_t tensor_pages_buffer      = TensorBufferManager::DEFAULT_TENSOR_PAGES_BUFFER_SIZE;
+    uint64_t warmup_size              = BufferManager::DEFAULT_WARMUP_SIZE;
     bool     preload_tensors          = false;
+    uint64_t query_cache_size         = 0;
 
     std::string db_directory;
     std::string config_path;
@@ -159,6 +171,13 @@ int main(int argc, char* argv[]) {
         ->transform(CLI::AsSizeValue(false))
         ->check(CLI::Range(1024ULL * 1024, 1024ULL * 1024 * 1024 * 1024));
 
+    app.add_option("--warmup", warmup_size)
+        ->description("Pages of the previous execution loaded in the background at startup\n"
+                      "Pass 0 to disable it, allows units such as MB and GB")
+        ->option_text("<bytes> [1GB]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(0ULL, 1024ULL * 1024 * 1024 * 1024));
+
     app.add_option("--path-mode", path_mode)
         ->description("Path Mode")
         ->option_text("bfs|dfs")
@@ -173,6 +192,12 @@ int main(int argc, char* argv[]) {
     app.add_flag("--preload-tensors", preload_tensors)
       ->description("Fill the tensor buffer before starting the server");
 
+    app.add_option("--query-cache", query_cache_size)
+        ->description("Memory for caching responses of repeated SPARQL queries\nPass 0 to disable it, allows units such as MB and GB")
+        ->option_text("<bytes> [0]")
+        ->transform(CLI::AsSizeValue(false))
+        ->check(CLI::Range(0ULL, 1024ULL * 1024 * 1024 * 1024));
+
     CLI11_PARSE(app, argc, argv);
 
     if (!config_path.empty()) {
@@ -223,6 +248,10 @@ int main(int argc, char* argv[]) {
 
                 quad_model.catalog().print(std::cout);
 
+                if (warmup_size > 0) {
+                    buffer_manager.start_warmup(warmup_size);
+                }
+
                 load_tensor_stores(tensor_pages_buffer, preload_tensors);
 
                 MQL::Server server;
@@ -255,7 +284,12 @@ int main(int argc, char* argv[]) {
 
                 rdf_model.catalog().print(std::cout);
 
+                if (warmup_size > 0) {
+                    buffer_manager.start_warmup(warmup_size);
+                }
+
                 SPARQL::Server server;
+                server.result_cache.set_capacity(query_cache_size);
                 server.run(port, max_threads, std::chrono::seconds(seconds_timeout));
 
                 return EXIT_SUCCESS;
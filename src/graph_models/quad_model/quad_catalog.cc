@@ -2,12 +2,15 @@
 
 #include <cassert>
 
+#include "storage/page/versioned_page.h"
+
 using namespace std;
 
 QuadCatalog::QuadCatalog(const std::string& filename) :
     Catalog (filename)
 {
     if (is_empty()) {
+        page_size                = VPage::SIZE;
         identifiable_nodes_count = 0;
         anonymous_nodes_count    = 0;
         connections_count        = 0;
@@ -33,9 +36,16 @@ QuadCatalog::QuadCatalog(const std::string& filename) :
         if (read_uint64() != MODEL_ID) {
             throw runtime_error("QuadCatalog: wrong MODEL_ID");
         }
-        if (read_uint64() != VERSION) {
+        auto version = read_uint64();
+        if (version != VERSION && version != VERSION_WITHOUT_PAGE_SIZE) {
             throw runtime_error("QuadCatalog: wrong VERSION");
         }
+        page_size = version == VERSION_WITHOUT_PAGE_SIZE ? 4096 : read_uint64();
+        if (page_size != VPage::SIZE) {
+            throw runtime_error("QuadCatalog: the database uses pages of " + to_string(page_size)
+                                + " bytes, but this build uses pages of " + to_string(VPage::SIZE)
+                                + " bytes (set MDB_PAGE_SIZE when building)");
+        }
         identifiable_nodes_count = read_uint64();
         anonymous_nodes_count    = read_uint64();
         connections_count        = read_uint64();
@@ -121,6 +131,7 @@ void QuadCatalog::save() {
 
     write_uint64(MODEL_ID);
     write_uint64(VERSION);
+    write_uint64(page_size);
 
     write_uint64(identifiable_nodes_count);
     write_uint64(anonymous_nodes_count);
@@ -211,6 +222,7 @@ void QuadCatalog::print(std::ostream& os) {
     os << "  equal_from_type_count:    " << equal_from_type_count    << "\n";
     os << "  equal_to_type_count:      " << equal_to_type_count      << "\n";
     os << "  equal_from_to_type_count: " << equal_from_to_type_count << "\n";
+    os << "  page size:                " << page_size << " bytes\n";
     os << "-------------------------------------\n";
 }
 
@@ -14,7 +14,10 @@ friend class QuadModel;
 friend class BulkImport;
 public:
     static constexpr uint64_t MODEL_ID = 0;
-    static constexpr uint64_t VERSION = 1;
+    static constexpr uint64_t VERSION = 2;
+
+    // catalogs of this version don't have the page size, they always use 4 KB pages
+    static constexpr uint64_t VERSION_WITHOUT_PAGE_SIZE = 1;
 
     QuadCatalog(const std::string& filename);
 
@@ -32,6 +35,9 @@ public:
     uint64_t equal_to_type_with_type      (uint64_t type_id);
 
 // private:
+    // size of the pages used by the database files
+    uint64_t page_size;
+
     uint64_t identifiable_nodes_count; // Does not consider the literals
     uint64_t anonymous_nodes_count;
     uint64_t connections_count;
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "graph_models/exceptions.h"
+#include "storage/page/versioned_page.h"
 
 using namespace std;
 
@@ -20,13 +21,22 @@ RdfCatalog::RdfCatalog(const std::string& filename) : Catalog(filename) {
         throw WrongModelException(error_msg);
     }
     auto version_id = read_uint64();
-    if (version_id != VERSION) {
+    if (version_id != VERSION && version_id != VERSION_WITHOUT_PAGE_SIZE) {
         std::string error_msg = "Wrong version for RdfCatalog, expected: v";
         error_msg += std::to_string(VERSION);
         error_msg += ", got: v";
         error_msg += std::to_string(version_id);
         throw WrongCatalogVersionException(error_msg);
     }
+    page_size = version_id == VERSION_WITHOUT_PAGE_SIZE ? 4096 : read_uint64();
+    if (page_size != VPage::SIZE) {
+        std::string error_msg = "The database uses pages of ";
+        error_msg += std::to_string(page_size);
+        error_msg += " bytes, but this build uses pages of ";
+        error_msg += std::to_string(VPage::SIZE);
+        error_msg += " bytes (set MDB_PAGE_SIZE when building)";
+        throw WrongCatalogVersionException(error_msg);
+    }
     permutations     = read_uint64();
     blank_node_count = read_uint64();
     triples_count    = read_uint64();
@@ -52,7 +62,7 @@ RdfCatalog::RdfCatalog(const std::string& filename) : Catalog(filename) {
 
 // Constructor for new empty catalog
 RdfCatalog::RdfCatalog(const std::string& filename, size_t permutations) :
-    Catalog(filename), permutations(permutations)
+    Catalog(filename), permutations(permutations), page_size(VPage::SIZE)
 {
     assert(is_empty());
     blank_node_count = 0;
@@ -79,6 +89,7 @@ void RdfCatalog::save() {
 
     write_uint64(MODEL_ID);
     write_uint64(VERSION);
+    write_uint64(page_size);
 
     write_uint64(permutations);
     write_uint64(blank_node_count);
@@ -113,6 +124,7 @@ void RdfCatalog::print(std::ostream& os) {
     os << "  triples with S = P:     " << equal_sp_count << "\n";
     os << "  triples with S = O:     " << equal_so_count << "\n";
     os << "  triples with P = O:     " << equal_po_count << "\n";
+    os << "  page size:              " << page_size << " bytes\n";
 
     os << "  Index permutations: ";
     switch (permutations) {
@@ -13,7 +13,10 @@ class RdfCatalog : public Catalog {
 public:
     static constexpr uint64_t MODEL_ID = 1;
 
-    static constexpr uint64_t VERSION  = 4;
+    static constexpr uint64_t VERSION  = 5;
+
+    // catalogs of this version don't have the page size, they always use 4 KB pages
+    static constexpr uint64_t VERSION_WITHOUT_PAGE_SIZE = 4;
 
     // The database can handle more than MAX_LANG_AND_DTT languages and datatypes,
     // but the catalog can save up to this this many
@@ -91,6 +94,9 @@ public:
     // 6: SPO, POS, OSP, PSO, SOP, OPS
     uint64_t permutations;
 
+    // size of the pages used by the database files
+    uint64_t page_size;
+
 private:
     bool has_changes = false;
 
@@ -6,6 +6,7 @@
 #include "storage/buffer_manager.h"
 #include "storage/file_manager.h"
 #include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/reachability/reachability_index.h"
 #include "storage/string_manager.h"
 #include "storage/tmp_manager.h"
 
@@ -79,6 +80,20 @@ RdfModel::RdfModel(const std::string& db_folder,
     equal_sp_inverted = make_unique<BPlusTree<2>>("equal_sp_inverted");
     equal_so_inverted = make_unique<BPlusTree<2>>("equal_so_inverted");
     equal_po_inverted = make_unique<BPlusTree<2>>("equal_po_inverted");
+
+    for (auto& index : ReachabilityIndex::load_all()) {
+        auto predicate_id = index->predicate_id;
+        reachability_indexes.emplace(predicate_id, std::move(index));
+    }
+}
+
+
+const ReachabilityIndex* RdfModel::get_reachability_index(uint64_t predicate_id) const {
+    auto it = reachability_indexes.find(predicate_id);
+    if (it == reachability_indexes.end() || it->second->is_outdated()) {
+        return nullptr;
+    }
+    return it->second.get();
 }
 
 
@@ -101,6 +116,8 @@ RdfModel::~RdfModel() {
     equal_so_inverted.reset();
     equal_po_inverted.reset();
 
+    reachability_indexes.clear();
+
     tmp_manager.~TmpManager();
     string_manager.~StringManager();
     path_manager.~PathManager();
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <type_traits>
+#include <unordered_map>
 
 #include "graph_models/model_destroyer.h"
 #include "query/parser/op/op.h"
@@ -10,6 +11,7 @@
 
 template <std::size_t N> class BPlusTree;
 
+class ReachabilityIndex;
 class SparqlElement;
 
 class RdfModel {
@@ -32,6 +34,9 @@ public:
     std::unique_ptr<BPlusTree<2>> equal_so_inverted; // (predicate, subject=object)
     std::unique_ptr<BPlusTree<2>> equal_po_inverted; // (subject,   predicate=object)
 
+    // Reachability indexes built with mdb-index-paths, indexed by predicate
+    std::unordered_map<uint64_t, std::unique_ptr<ReachabilityIndex>> reachability_indexes;
+
     uint64_t MAX_LIMIT = Op::DEFAULT_LIMIT;
 
     // Path mode to use
@@ -92,6 +97,9 @@ public:
                                                 uint64_t           str_hash_buffer_size,
                                                 uint64_t           workers);
 
+    // Returns the reachability index of the predicate, or nullptr if it doesn't have one or it is outdated
+    const ReachabilityIndex* get_reachability_index(uint64_t predicate_id) const;
+
     inline RdfCatalog& catalog() const noexcept {
         return const_cast<RdfCatalog&>(reinterpret_cast<const RdfCatalog&>(catalog_buf));
     }
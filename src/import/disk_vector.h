@@ -3,31 +3,27 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cerrno>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <queue>
 #include <stdexcept>
+#include <string>
 #include <vector>
-#include <thread>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "import/external_merge.h"
 #include "import/stats_processor.h"
 #include "macros/aligned_alloc.h"
 #include "storage/page/versioned_page.h"
 #include "storage/index/bplus_tree/bpt_mem_import.h"
 
 namespace Import {
-template <std::size_t N>
-struct RunRecordComparator {
-    constexpr bool operator()(const std::pair<std::array<uint64_t, N>, uint64_t>& lhs,
-                              const std::pair<std::array<uint64_t, N>, uint64_t>& rhs) const
-    {
-        return lhs.first > rhs.first;
-    }
-};
-
 template <std::size_t N>
 class DiskVector {
 public:
@@ -59,10 +55,13 @@ public:
         total_tuples = file_length / (N*sizeof(uint64_t));
     }
 
+    // compressed_leaves: write the B+tree leaves with the read-optimized format (see CompressedLeaf)
     void start_indexing(char* new_buffer,
                         uint64_t max_buffer_size,
-                        std::array<uint64_t, N> original_permutation)
+                        std::array<uint64_t, N> original_permutation,
+                        bool compressed_leaves = false)
     {
+        this->compressed_leaves = compressed_leaves;
         // free append buffer
         MDB_ALIGNED_FREE(buffer);
         current_permutation = original_permutation;
@@ -126,16 +125,13 @@ public:
     }
 
 private:
-    constexpr uint64_t division_round_up(uint64_t a, uint64_t b) {
-        return (a / b) + (a % b != 0);
-    }
+    static constexpr uint64_t record_size = N*sizeof(uint64_t);
 
     void merge_sort(const std::string& base_name, StatsProcessor<N>& stat_processor) {
-        BPTLeafWriter<N> leaf_writer(base_name + ".leaf");
-        BPTDirWriter<N> dir_writer(base_name + ".dir");
+        BPTBulkWriter<N> bpt_writer(base_name, compressed_leaves);
 
         if (total_tuples == 0) {
-            leaf_writer.make_empty();
+            bpt_writer.finish();
             return;
         }
 
@@ -146,37 +142,12 @@ private:
         if (buffer_size >= file_length) {
             // we already have everything in buffer from reorder_cols
             auto ptr = reinterpret_cast<std::array<uint64_t, N>*>(buffer);
-            uint32_t leaf_current_block = 0;
-            uint64_t current_tuple = 0;
             uint64_t valid_tuples = total_tuples - repeated_tuples;
-            while (current_tuple < valid_tuples) {
-                // skip first leaf from going into B+tree directory
-                if (current_tuple != 0) {
-                    dir_writer.bulk_insert(ptr, 0, leaf_current_block);
-                }
-
-                uint64_t tuples_written;
-                if (current_tuple + leaf_writer.max_records < valid_tuples) {
-                    // this leaf is full and there are more leaves
-                    tuples_written = leaf_writer.max_records;
-                    leaf_writer.process_block(reinterpret_cast<char*>(ptr),
-                                              leaf_writer.max_records,
-                                              ++leaf_current_block);
-                } else {
-                    // last leaf
-                    tuples_written = valid_tuples - current_tuple;
-                    leaf_writer.process_block(reinterpret_cast<char*>(ptr),
-                                              tuples_written,
-                                              0);
-                }
-                for (uint64_t i = 0; i < tuples_written; i++) {
-                    stat_processor.process_tuple(*(ptr + i));
-                }
-                // Its better to sum a compile-time constant than a variable (tuples_written)
-                // doesn't matter when we overflow
-                current_tuple += leaf_writer.max_records;
-                ptr += leaf_writer.max_records;
+            for (uint64_t i = 0; i < valid_tuples; i++) {
+                stat_processor.process_tuple(ptr[i]);
+                bpt_writer.add(ptr[i]);
             }
+            bpt_writer.finish();
             return;
         }
 
@@ -185,155 +156,172 @@ private:
         // buffer_size was chosen to be a multiple of block_size
         constexpr uint64_t block_size = VPage::SIZE*N*sizeof(uint64_t);
 
-        const uint64_t total_runs = division_round_up(file_length, buffer_size);
-        const uint64_t total_blocks = division_round_up(file_length, block_size);
+        // Each run being merged uses 2 blocks of the buffer (one is consumed while the other
+        // is being read), the remaining blocks are used to buffer the output of intermediate passes
+        constexpr uint64_t output_blocks = 2;
+        const uint64_t buffer_blocks = buffer_size / block_size;
+        if (buffer_blocks < 2*2 + output_blocks) {
+            throw std::logic_error("Can't order tuples, need a buffer size of at least "
+                                   + std::to_string((2*2 + output_blocks) * block_size) + " bytes.");
+        }
+        const uint64_t fan_in = (buffer_blocks - output_blocks) / 2;
 
-        const uint64_t max_tuples_per_block = VPage::SIZE;
-        const uint64_t max_blocks_per_run = buffer_size / block_size;
+        std::vector<MergeRun> runs;
+        for (uint64_t offset = 0; offset < file_length; offset += buffer_size) {
+            runs.push_back(MergeRun { offset, std::min(buffer_size, file_length - offset) / record_size });
+        }
 
-        const uint64_t tuples_in_last_block = (total_tuples % max_tuples_per_block == 0)
-                                            ? max_tuples_per_block
-                                            : (total_tuples % max_tuples_per_block);
+        // reorder_cols wrote the runs through the fstream, runs are read with pread
+        file.flush();
 
-        const uint64_t blocks_in_last_run = (total_blocks % max_blocks_per_run == 0)
-                                            ? max_blocks_per_run
-                                            : (total_blocks % max_blocks_per_run);
+        const std::string pass_filenames[2] = { filename + ".merge0", filename + ".merge1" };
 
+        // closes the open files and removes the files of the intermediate passes,
+        // also when an exception unwinds the merge
+        struct MergeFiles {
+            const std::string* pass_filenames;
+            int input_fd  = -1;
+            int output_fd = -1;
 
-        // throw exception if we can't order with 1 merge
-        if (total_runs*block_size + (BPTLeafWriter<N>::max_records*N*sizeof(uint64_t)) > buffer_size) {
-            throw std::logic_error("Can't order tuples with one merge, need a bigger buffer size.");
-        }
+            ~MergeFiles() {
+                if (input_fd >= 0)  close(input_fd);
+                if (output_fd >= 0) close(output_fd);
+                for (uint_fast32_t i = 0; i < 2; i++) {
+                    std::remove(pass_filenames[i].c_str());
+                }
+            }
+        } merge_files { pass_filenames };
 
-        // When we have only one run we skip the merge
-        std::priority_queue<std::pair<std::array<uint64_t, N>, uint64_t>,               // tuple: (record, run_number)
-                            std::vector< std::pair<std::array<uint64_t, N>, uint64_t>>, // container
-                            RunRecordComparator<N>                                      // comparator
-                            > queue;
-
-        // Fill buffers and put the first tuple of the run in the heap
-        std::array<uint64_t, N>** start_pos   = new std::array<uint64_t, N>*[total_runs];
-        std::array<uint64_t, N>** end_pos     = new std::array<uint64_t, N>*[total_runs];
-        std::array<uint64_t, N>** current_pos = new std::array<uint64_t, N>*[total_runs];
-
-        uint64_t* current_block = new uint64_t[total_runs];
-        uint64_t* end_block     = new uint64_t[total_runs];
-
-        for (uint64_t run = 0; run < total_runs-1; ++run) {
-            start_pos[run] = reinterpret_cast<std::array<uint64_t, N>*>(buffer + (run*block_size));
-            end_pos[run]   = reinterpret_cast<std::array<uint64_t, N>*>(buffer + ((run+1)*block_size));
-            current_pos[run] = start_pos[run];
-            current_block[run] = 0;
-            end_block[run] = max_blocks_per_run;
-
-            file.seekg(buffer_size * run, file.beg);
-            file.read(reinterpret_cast<char*>(start_pos[run]), block_size);
-            queue.push(std::make_pair(*current_pos[run], run));
+        merge_files.input_fd = open(filename.c_str(), O_RDONLY);
+        if (merge_files.input_fd < 0) {
+            throw std::runtime_error("Could not open file " + filename);
         }
-        const auto last_run = total_runs - 1;
-        { // last run case
-            start_pos[last_run] = reinterpret_cast<std::array<uint64_t, N>*>(buffer + (last_run*block_size));
-            if (blocks_in_last_run == 1) {
-                // the last block of the last run may be not full
-                end_pos[last_run] = start_pos[last_run] + tuples_in_last_block;
-            } else {
-                end_pos[last_run] = reinterpret_cast<std::array<uint64_t, N>*>(buffer + ((last_run+1)*block_size));
+
+        // declared after merge_files, so no read is in flight when the files are closed
+        AsyncBlockReader io;
+        uint_fast32_t pass = 0;
+
+        // When there are more runs than fan_in we need intermediate passes. Each pass merges
+        // groups of fan_in runs into a temporary file, the last pass writes the B+tree.
+        while (runs.size() > fan_in) {
+            const auto& output_filename = pass_filenames[pass % 2];
+            merge_files.output_fd = open(output_filename.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+            if (merge_files.output_fd < 0) {
+                throw std::runtime_error("Could not open file " + output_filename);
             }
-            current_pos[last_run] = start_pos[last_run];
-            current_block[last_run] = 0;
-            end_block[last_run] = blocks_in_last_run;
 
-            file.seekg(buffer_size * last_run, file.beg);
-            file.read(reinterpret_cast<char*>(start_pos[last_run]), block_size);
-            queue.push(std::make_pair(*current_pos[last_run], last_run));
+            char* const output_begin = buffer + (2*fan_in*block_size);
+            const uint64_t output_capacity = output_blocks * block_size;
+            uint64_t output_size = 0;
+            uint64_t output_offset = 0;
+
+            auto flush_output = [&]() {
+                write_all(merge_files.output_fd, output_begin, output_size, output_offset);
+                output_offset += output_size;
+                output_size = 0;
+            };
+
+            std::vector<MergeRun> new_runs;
+            for (uint64_t first_run = 0; first_run < runs.size(); first_run += fan_in) {
+                MergeRun new_run { output_offset + output_size, 0 };
+                const uint64_t run_count = std::min(fan_in, runs.size() - first_run);
+
+                merge_runs(io, merge_files.input_fd, &runs[first_run], run_count, block_size,
+                    [&](const std::array<uint64_t, N>& record) {
+                        if (output_size == output_capacity) {
+                            flush_output();
+                        }
+                        std::memcpy(output_begin + output_size, record.data(), record_size);
+                        output_size += record_size;
+                        new_run.tuples++;
+                    });
+                new_runs.push_back(new_run);
+            }
+            flush_output();
+
+            close(merge_files.input_fd);
+            merge_files.input_fd = -1;
+            auto output_fd = merge_files.output_fd;
+            merge_files.output_fd = -1;
+            if (fsync(output_fd) != 0 || close(output_fd) != 0) {
+                throw std::runtime_error("Could not write file " + output_filename);
+            }
+            merge_files.input_fd = open(output_filename.c_str(), O_RDONLY);
+            if (merge_files.input_fd < 0) {
+                throw std::runtime_error("Could not open file " + output_filename);
+            }
+            runs = std::move(new_runs);
+            pass++;
         }
-        if (!file.good()) {
-            std::cout << "WARNING: file not good\n";
-            file.clear();
+
+        // Final merge
+        merge_runs(io, merge_files.input_fd, runs.data(), runs.size(), block_size,
+            [&](const std::array<uint64_t, N>& record) {
+                stat_processor.process_tuple(record);
+                bpt_writer.add(record);
+            });
+        bpt_writer.finish();
+    }
+
+    // Merges the runs calling sink(record) for every distinct record, in order.
+    // Uses 2*run_count blocks at the beginning of the buffer.
+    template <typename Sink>
+    void merge_runs(AsyncBlockReader& io,
+                    int fd,
+                    const MergeRun* runs,
+                    uint64_t run_count,
+                    uint64_t block_size,
+                    Sink&& sink)
+    {
+        // readers must not be moved after begin(), they own the pending read requests
+        std::vector<RunReader<N>> readers(run_count);
+
+        // destroyed before the readers, if an exception unwinds the merge their reads must not be in flight
+        struct CancelReads {
+            AsyncBlockReader& io;
+            ~CancelReads() { io.cancel_all(); }
+        } cancel_reads { io };
+
+        for (uint64_t run = 0; run < run_count; run++) {
+            readers[run].begin(io,
+                               fd,
+                               runs[run],
+                               buffer + (2*run*block_size),
+                               buffer + ((2*run + 1)*block_size),
+                               block_size);
         }
 
-        // the output block is the last block
-        auto output_block = reinterpret_cast<std::array<uint64_t, N>*>(buffer + (total_runs*block_size));
-        auto output_block_curr = 0;
+        LoserTree<N> tree(readers);
 
-        uint32_t leaf_current_block = 0;
-        const uint32_t leaf_last_block = division_round_up(total_tuples, BPTLeafWriter<N>::max_records);
         // set last_seen_record as an impossible record
         std::array<uint64_t, N> last_seen_record; // used to remove duplicates
         for (uint64_t i = 0; i < N; i++) { last_seen_record[i] = UINT64_MAX; }
 
-        // Merge runs
-        while (!queue.empty()) {
-            const auto queue_top_pair = queue.top();
-            queue.pop();
-
-            if (output_block_curr == BPTLeafWriter<N>::max_records) {
-                // skip first leaf
-                if (leaf_current_block > 0) {
-                    dir_writer.bulk_insert(output_block, 0, leaf_current_block);
-                }
-                ++leaf_current_block;
-                uint32_t next_bpt_block = leaf_current_block < leaf_last_block ? leaf_current_block : 0;
-                leaf_writer.process_block((char*)output_block,
-                                          leaf_writer.max_records,
-                                          next_bpt_block);
-                output_block_curr = 0;
-            }
-
+        for (auto record = tree.top(); record != nullptr; record = tree.top()) {
             // add tuple to output only if distinct
-            if (queue_top_pair.first != last_seen_record) {
-                last_seen_record = queue_top_pair.first;
-                stat_processor.process_tuple(queue_top_pair.first);
-                output_block[output_block_curr] = queue_top_pair.first;
-                output_block_curr++;
+            if (*record != last_seen_record) {
+                last_seen_record = *record;
+                sink(last_seen_record);
             }
+            tree.pop();
+        }
+    }
 
-            const auto min_run = queue_top_pair.second;
-            current_pos[min_run]++;
-
-            if (current_pos[min_run] == end_pos[min_run]) {
-                current_pos[min_run] = start_pos[min_run];
-                current_block[min_run]++;
-
-                if (current_block[min_run] == end_block[min_run]) {
-                    continue; // to skip the queue.push
-                } else {
-                    // offset of the run: (buffer_size * min_run)
-                    // offset of the current block: (current_block[min_run] * block_size)
-                    file.seekg((buffer_size * min_run) + (current_block[min_run] * block_size), file.beg);
-                    file.read(reinterpret_cast<char*>(start_pos[min_run]), block_size);
-                    current_pos[min_run] = start_pos[min_run];
-
-                    // update end_pos of the last block of the last run, it may be not full
-                    if (min_run == last_run && current_block[min_run] == blocks_in_last_run - 1) {
-                        end_pos[min_run] = start_pos[min_run] + tuples_in_last_block;
-                    }
-                    file.clear();
+    static void write_all(int fd, const char* data, uint64_t size, uint64_t offset) {
+        while (size > 0) {
+            auto res = pwrite(fd, data, size, offset);
+            if (res < 0) {
+                if (errno == EINTR) {
+                    continue;
                 }
+                throw std::runtime_error("Error writing merge output: " + std::string(std::strerror(errno)));
             }
-
-            queue.push(std::make_pair(*current_pos[min_run], min_run));
-        }
-        // write remaining output_block
-        if (output_block_curr != 0) {
-            // skip first leaf
-            if (leaf_current_block > 0) {
-                dir_writer.bulk_insert(output_block, 0, leaf_current_block);
-            }
-            leaf_writer.process_block((char*)output_block, output_block_curr, 0);
+            data += res;
+            offset += res;
+            size -= res;
         }
-
-        // delete aux arrays
-        delete[](start_pos);
-        delete[](end_pos);
-        delete[](current_pos);
-        delete[](current_block);
-        delete[](end_block);
-
-        return;
     }
 
-
     void reorder_cols(std::array<uint64_t, N>&& new_permutation) {
         file.seekg(0, file.end);
         const uint64_t file_length = file.tellg();
@@ -522,6 +510,8 @@ private:
 
     char* buffer;
 
+    bool compressed_leaves = false;
+
     // will be set and used only when total_runs = 1
     uint64_t repeated_tuples = 0;
 };
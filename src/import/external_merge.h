@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+// Helpers used by DiskVector to do a k-way external merge of sorted runs.
+namespace Import {
+
+// A sorted run inside a file. offset is in bytes.
+struct MergeRun {
+    uint64_t offset;
+    uint64_t tuples;
+};
+
+
+// Executes block reads in a background thread, so the merge can consume a
+// block of a run while the next block of the same run is being read.
+class AsyncBlockReader {
+public:
+    struct Request {
+        int      fd;
+        uint64_t offset;
+        uint64_t size;
+        char*    dest;
+
+        // set by the reader thread, protected by AsyncBlockReader::mutex
+        uint64_t bytes_read;
+        int      error;
+        bool     done;
+    };
+
+    AsyncBlockReader() :
+        worker (&AsyncBlockReader::run, this) { }
+
+    ~AsyncBlockReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        pending_cv.notify_all();
+        worker.join();
+    }
+
+    void submit(Request& request) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            request.bytes_read = 0;
+            request.error = 0;
+            request.done = false;
+            pending.push_back(&request);
+        }
+        pending_cv.notify_one();
+    }
+
+    // returns the number of bytes read
+    uint64_t wait(Request& request) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&request] { return request.done; });
+        if (request.error != 0) {
+            throw std::runtime_error("Error reading run block: " + std::string(std::strerror(request.error)));
+        }
+        return request.bytes_read;
+    }
+
+    // Discards the requests that were not started and waits for the one being read, so the
+    // requests and their destinations can be freed (e.g. when an exception unwinds a merge)
+    void cancel_all() {
+        std::unique_lock<std::mutex> lock(mutex);
+        pending.clear();
+        done_cv.wait(lock, [this] { return reading == nullptr; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable pending_cv;
+    std::condition_variable done_cv;
+    std::deque<Request*> pending;
+    Request* reading = nullptr;
+    bool stop = false;
+
+    // must be the last member, as it starts running in the constructor
+    std::thread worker;
+
+    void run() {
+        while (true) {
+            Request* request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                pending_cv.wait(lock, [this] { return stop || !pending.empty(); });
+                if (pending.empty()) {
+                    return;
+                }
+                request = pending.front();
+                pending.pop_front();
+                reading = request;
+            }
+
+            uint64_t total_read = 0;
+            int error = 0;
+            while (total_read < request->size) {
+                auto res = pread(request->fd,
+                                 request->dest + total_read,
+                                 request->size - total_read,
+                                 request->offset + total_read);
+                if (res < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    error = errno;
+                    break;
+                }
+                if (res == 0) {
+                    break; // EOF
+                }
+                total_read += res;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                request->bytes_read = total_read;
+                request->error = error;
+                request->done = true;
+                reading = nullptr;
+            }
+            done_cv.notify_all();
+        }
+    }
+};
+
+
+// Reads a run using two blocks: while the records of one block are consumed
+// the other block is being filled by the AsyncBlockReader.
+template <std::size_t N>
+class RunReader {
+public:
+    using Record = std::array<uint64_t, N>;
+
+    static constexpr uint64_t RECORD_SIZE = N * sizeof(uint64_t);
+
+    void begin(AsyncBlockReader& io,
+               int fd,
+               const MergeRun& run,
+               char* first_block,
+               char* second_block,
+               uint64_t block_size)
+    {
+        this->io = &io;
+        this->fd = fd;
+        this->block_size = block_size;
+        next_offset = run.offset;
+        remaining_bytes = run.tuples * RECORD_SIZE;
+
+        blocks[0] = first_block;
+        blocks[1] = second_block;
+        issued[0] = false;
+        issued[1] = false;
+
+        // load_next_block() switches to the first block and starts reading the second one
+        issue_read(0);
+        active = 1;
+        load_next_block();
+    }
+
+    // returns nullptr when the run is exhausted
+    inline const Record* current() const {
+        return current_pos;
+    }
+
+    inline void advance() {
+        if (++current_pos == end_pos) {
+            load_next_block();
+        }
+    }
+
+private:
+    AsyncBlockReader* io;
+    int fd;
+    uint64_t block_size;
+    uint64_t next_offset;
+    uint64_t remaining_bytes;
+
+    char* blocks[2];
+    AsyncBlockReader::Request requests[2];
+    bool issued[2];
+    uint_fast8_t active;
+
+    const Record* current_pos;
+    const Record* end_pos;
+
+    void issue_read(uint_fast8_t block) {
+        if (remaining_bytes == 0) {
+            issued[block] = false;
+            return;
+        }
+        auto size = std::min(block_size, remaining_bytes);
+        requests[block].fd = fd;
+        requests[block].offset = next_offset;
+        requests[block].size = size;
+        requests[block].dest = blocks[block];
+        io->submit(requests[block]);
+        issued[block] = true;
+
+        next_offset += size;
+        remaining_bytes -= size;
+    }
+
+    void load_next_block() {
+        // the block we just finished can be refilled once we switch to the other one
+        auto finished = active;
+        active ^= 1;
+
+        if (!issued[active]) {
+            current_pos = nullptr;
+            end_pos = nullptr;
+            return;
+        }
+        auto bytes_read = io->wait(requests[active]);
+        if (bytes_read != requests[active].size) {
+            throw std::runtime_error("Unexpected end of file reading run block");
+        }
+        current_pos = reinterpret_cast<const Record*>(blocks[active]);
+        end_pos = current_pos + (bytes_read / RECORD_SIZE);
+
+        issue_read(finished);
+    }
+};
+
+
+// Tournament tree of losers used for the k-way merge. Each internal node
+// keeps the loser of the match played there and tree[0] keeps the overall
+// winner, so replacing the winner costs exactly log2(k) comparisons.
+template <std::size_t N>
+class LoserTree {
+public:
+    using Record = std::array<uint64_t, N>;
+
+    LoserTree(std::vector<RunReader<N>>& runs) :
+        runs (runs),
+        k    (runs.size()),
+        tree (runs.size() == 0 ? 1 : runs.size(), runs.size())
+    {
+        // every node starts with the sentinel k (that beats everyone),
+        // replaying every leaf pushes the sentinels out of the tree.
+        for (uint32_t i = k; i > 0; i--) {
+            replay(i - 1);
+        }
+    }
+
+    // returns nullptr when every run is exhausted
+    inline const Record* top() const {
+        return runs[tree[0]].current();
+    }
+
+    inline void pop() {
+        const auto winner = tree[0];
+        runs[winner].advance();
+        replay(winner);
+    }
+
+private:
+    std::vector<RunReader<N>>& runs;
+
+    const uint32_t k;
+
+    std::vector<uint32_t> tree;
+
+    // returns true if a must be returned before b
+    inline bool beats(uint32_t a, uint32_t b) const {
+        if (a == k) return true;
+        if (b == k) return false;
+
+        auto a_record = runs[a].current();
+        auto b_record = runs[b].current();
+        if (a_record == nullptr) return false;
+        if (b_record == nullptr) return true;
+        return *a_record < *b_record;
+    }
+
+    inline void replay(uint32_t leaf) {
+        auto winner = leaf;
+        for (auto node = (leaf + k) / 2; node > 0; node /= 2) {
+            if (beats(tree[node], winner)) {
+                std::swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+    }
+};
+} // namespace Import
@@ -155,14 +155,14 @@ void OnDiskImport::start_import(const std::string& input_filename) {
     }
     print_duration("Write table", start);
 
-    declared_nodes.start_indexing(buffer, buffer_size, {0});
-    labels.start_indexing(buffer, buffer_size, {0,1});
-    properties.start_indexing(buffer, buffer_size, {0,1,2});
-    edges.start_indexing(buffer, buffer_size, {0,1,2,3});
-    equal_from_to_type.start_indexing(buffer, buffer_size, {0,1});
-    equal_from_to.start_indexing(buffer, buffer_size, {0,1,2});
-    equal_from_type.start_indexing(buffer, buffer_size, {0,1,2});
-    equal_to_type.start_indexing(buffer, buffer_size, {0,1,2});
+    declared_nodes.start_indexing(buffer, buffer_size, {0}, compressed_leaves);
+    labels.start_indexing(buffer, buffer_size, {0,1}, compressed_leaves);
+    properties.start_indexing(buffer, buffer_size, {0,1,2}, compressed_leaves);
+    edges.start_indexing(buffer, buffer_size, {0,1,2,3}, compressed_leaves);
+    equal_from_to_type.start_indexing(buffer, buffer_size, {0,1}, compressed_leaves);
+    equal_from_to.start_indexing(buffer, buffer_size, {0,1,2}, compressed_leaves);
+    equal_from_type.start_indexing(buffer, buffer_size, {0,1,2}, compressed_leaves);
+    equal_to_type.start_indexing(buffer, buffer_size, {0,1,2}, compressed_leaves);
 
 
     { // Nodes B+Tree
@@ -19,8 +19,9 @@
 namespace Import { namespace QuadModel {
 class OnDiskImport {
 public:
-    OnDiskImport(const std::string& db_folder, uint64_t buffer_size) :
+    OnDiskImport(const std::string& db_folder, uint64_t buffer_size, bool compressed_leaves = false) :
         buffer_size        (buffer_size),
+        compressed_leaves  (compressed_leaves),
         db_folder          (db_folder),
         catalog            (QuadCatalog("catalog.dat")),
         declared_nodes     (db_folder + "/tmp_declared_nodes"),
@@ -45,6 +46,9 @@ public:
 private:
     uint64_t buffer_size;
 
+    // B+tree leaves are written with the read-optimized compressed format
+    bool compressed_leaves;
+
     int* state_transitions;
     std::function<void()> state_funcs[Token::TOTAL_TOKENS * State::TOTAL_STATES];
     Lexer lexer;
@@ -350,11 +350,11 @@ void OnDiskImport::start_import(const std::string& input_filename, const std::st
     equal_po.finish_appends();
     equal_spo.finish_appends();
 
-    triples.start_indexing  (buffer, buffer_size, {0,1,2});
-    equal_sp.start_indexing (buffer, buffer_size, {0,1});
-    equal_so.start_indexing (buffer, buffer_size, {0,1});
-    equal_po.start_indexing (buffer, buffer_size, {0,1});
-    equal_spo.start_indexing(buffer, buffer_size, {0});
+    triples.start_indexing  (buffer, buffer_size, {0,1,2}, compressed_leaves);
+    equal_sp.start_indexing (buffer, buffer_size, {0,1}, compressed_leaves);
+    equal_so.start_indexing (buffer, buffer_size, {0,1}, compressed_leaves);
+    equal_po.start_indexing (buffer, buffer_size, {0,1}, compressed_leaves);
+    equal_spo.start_indexing(buffer, buffer_size, {0}, compressed_leaves);
 
 
     {   // B+tree creation for triple
@@ -28,8 +28,15 @@ public:
 
     size_t index_permutations;
 
-    OnDiskImport(const std::string& db_folder, uint64_t buffer_size, size_t index_permutations = 3) :
+    // B+tree leaves are written with the read-optimized compressed format
+    bool compressed_leaves;
+
+    OnDiskImport(const std::string& db_folder,
+                 uint64_t buffer_size,
+                 size_t index_permutations = 3,
+                 bool compressed_leaves = false) :
         index_permutations (index_permutations),
+        compressed_leaves (compressed_leaves),
         buffer_size (buffer_size),
         db_folder   (db_folder),
         catalog     (RdfCatalog("catalog.dat", index_permutations)),
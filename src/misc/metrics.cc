@@ -0,0 +1,152 @@
+#include "metrics.h"
+
+#include "storage/buffer_manager.h"
+
+// global object
+Metrics metrics;
+
+constexpr std::array<double, 14> Metrics::Histogram::BUCKETS_MS;
+
+
+void Metrics::Histogram::observe(double ms) {
+    uint64_t bucket = 0;
+    while (bucket < BUCKETS_MS.size() && ms > BUCKETS_MS[bucket]) {
+        bucket++;
+    }
+    bucket_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum_us.fetch_add(static_cast<uint64_t>(ms * 1000), std::memory_order_relaxed);
+}
+
+
+void Metrics::Histogram::write(std::ostream& os, const std::string& name, const std::string& labels) const {
+    uint64_t cumulative = 0;
+    for (uint64_t i = 0; i < BUCKETS_MS.size(); i++) {
+        cumulative += bucket_counts[i].load(std::memory_order_relaxed);
+        os << name << "_bucket{" << labels << ",le=\"" << BUCKETS_MS[i] / 1000 << "\"} " << cumulative << '\n';
+    }
+    cumulative += bucket_counts[BUCKETS_MS.size()].load(std::memory_order_relaxed);
+    os << name << "_bucket{" << labels << ",le=\"+Inf\"} " << cumulative << '\n';
+    os << name << "_sum{" << labels << "} " << sum_us.load(std::memory_order_relaxed) / 1e6 << '\n';
+    os << name << "_count{" << labels << "} " << count.load(std::memory_order_relaxed) << '\n';
+}
+
+
+void Metrics::init_workers(uint64_t _workers) {
+    workers = _workers;
+    worker_counters = std::make_unique<WorkerCounters[]>(workers);
+}
+
+
+static void write_header(std::ostream& os, const char* name, const char* type, const char* help) {
+    os << "# HELP " << name << ' ' << help << '\n';
+    os << "# TYPE " << name << ' ' << type << '\n';
+}
+
+
+void Metrics::write_prometheus(std::ostream& os) const {
+    const std::pair<const char*, const PoolCounters*> pools[] = {
+        { "versioned",   &versioned_pool },
+        { "unversioned", &unversioned_pool },
+        { "private",     &private_pool },
+        { "tensor",      &tensor_pool },
+    };
+
+    auto write_pools = [&](const char* name, const char* help, std::atomic<uint64_t> PoolCounters::*counter) {
+        write_header(os, name, "counter", help);
+        for (auto& [pool_name, pool] : pools) {
+            os << name << "{pool=\"" << pool_name << "\"} "
+               << (pool->*counter).load(std::memory_order_relaxed) << '\n';
+        }
+    };
+    write_pools("millenniumdb_buffer_hits_total",
+                "Pages requested that were already in the buffer pool",
+                &PoolCounters::hits);
+    write_pools("millenniumdb_buffer_misses_total",
+                "Pages requested that were not in the buffer pool",
+                &PoolCounters::misses);
+    write_pools("millenniumdb_buffer_evictions_total",
+                "Pages removed from the buffer pool to make room for another page",
+                &PoolCounters::evictions);
+    write_pools("millenniumdb_buffer_dirty_flushes_total",
+                "Modified pages written to disk when evicted",
+                &PoolCounters::dirty_flushes);
+
+    write_header(os, "millenniumdb_mutex_wait_seconds_total", "counter",
+                 "Time spent waiting for a buffer manager mutex held by another thread");
+    os << "millenniumdb_mutex_wait_seconds_total{mutex=\"vp_mutex\"} "
+       << vp_mutex_wait_us.load(std::memory_order_relaxed) / 1e6 << '\n';
+    os << "millenniumdb_mutex_wait_seconds_total{mutex=\"up_mutex\"} "
+       << up_mutex_wait_us.load(std::memory_order_relaxed) / 1e6 << '\n';
+
+    write_header(os, "millenniumdb_mutex_contentions_total", "counter",
+                 "Times a buffer manager mutex was already locked when trying to acquire it");
+    os << "millenniumdb_mutex_contentions_total{mutex=\"vp_mutex\"} "
+       << vp_mutex_contentions.load(std::memory_order_relaxed) << '\n';
+    os << "millenniumdb_mutex_contentions_total{mutex=\"up_mutex\"} "
+       << up_mutex_contentions.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_warmup_pages_total", "counter",
+                 "Pages of the previous execution loaded in the buffers at startup");
+    os << "millenniumdb_warmup_pages_total " << warmup_pages.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_page_delta_bytes", "gauge",
+                 "Memory used by the deltas of old versions of versioned pages");
+    os << "millenniumdb_page_delta_bytes " << page_delta_bytes.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_page_delta_materializations_total", "counter",
+                 "Old versions of versioned pages restored from their deltas into a frame");
+    os << "millenniumdb_page_delta_materializations_total "
+       << page_delta_materializations.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_query_duration_seconds", "histogram", "Duration of each query phase");
+    parser_duration.write(os, "millenniumdb_query_duration_seconds", "phase=\"parse\"");
+    optimizer_duration.write(os, "millenniumdb_query_duration_seconds", "phase=\"optimize\"");
+    execution_duration.write(os, "millenniumdb_query_duration_seconds", "phase=\"execute\"");
+
+    write_header(os, "millenniumdb_query_errors_total", "counter", "Queries that failed with an error");
+    os << "millenniumdb_query_errors_total " << query_errors.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_query_cache_requests_total", "counter",
+                 "Cacheable queries looked up in the result cache");
+    os << "millenniumdb_query_cache_requests_total{result=\"hit\"} "
+       << query_cache_hits.load(std::memory_order_relaxed) << '\n';
+    os << "millenniumdb_query_cache_requests_total{result=\"miss\"} "
+       << query_cache_misses.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_query_cache_evictions_total", "counter",
+                 "Responses removed from the result cache to make room for another response");
+    os << "millenniumdb_query_cache_evictions_total " << query_cache_evictions.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_query_cache_bytes", "gauge", "Memory used by the responses in the result cache");
+    os << "millenniumdb_query_cache_bytes " << query_cache_bytes.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_queued_requests", "gauge",
+                 "Accepted connections waiting for a worker to read their request");
+    os << "millenniumdb_queued_requests " << queued_requests.load(std::memory_order_relaxed) << '\n';
+
+    write_header(os, "millenniumdb_running_versions", "gauge",
+                 "Database versions being used by a running query or update");
+    os << "millenniumdb_running_versions " << buffer_manager.get_running_version_count() << '\n';
+
+    write_header(os, "millenniumdb_worker_active_queries", "gauge", "Queries being executed by the worker");
+    for (uint64_t i = 0; i < workers; i++) {
+        os << "millenniumdb_worker_active_queries{worker=\"" << i << "\"} "
+           << worker_counters[i].active_queries.load(std::memory_order_relaxed) << '\n';
+    }
+    write_header(os, "millenniumdb_worker_queries_total", "counter", "Queries executed by the worker");
+    for (uint64_t i = 0; i < workers; i++) {
+        os << "millenniumdb_worker_queries_total{worker=\"" << i << "\"} "
+           << worker_counters[i].queries.load(std::memory_order_relaxed) << '\n';
+    }
+    write_header(os, "millenniumdb_worker_timeouts_total", "counter", "Queries of the worker that timed out");
+    for (uint64_t i = 0; i < workers; i++) {
+        os << "millenniumdb_worker_timeouts_total{worker=\"" << i << "\"} "
+           << worker_counters[i].timeouts.load(std::memory_order_relaxed) << '\n';
+    }
+    write_header(os, "millenniumdb_worker_busy_seconds_total", "counter", "Time the worker spent executing queries");
+    for (uint64_t i = 0; i < workers; i++) {
+        os << "millenniumdb_worker_busy_seconds_total{worker=\"" << i << "\"} "
+           << worker_counters[i].busy_us.load(std::memory_order_relaxed) / 1e6 << '\n';
+    }
+}
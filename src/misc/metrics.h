@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+/*
+ * Metrics keeps server-wide counters that are exposed in the Prometheus text format by the /metrics
+ * endpoints. Every counter is a relaxed atomic, updating them does not add synchronization between
+ * the threads that use the buffer pools or execute queries.
+ */
+class Metrics {
+public:
+    // Counters of a page buffer pool
+    struct PoolCounters {
+        std::atomic<uint64_t> hits          { 0 };
+        std::atomic<uint64_t> misses        { 0 };
+        std::atomic<uint64_t> evictions     { 0 };
+        std::atomic<uint64_t> dirty_flushes { 0 };
+    };
+
+    // Cumulative histogram of durations in milliseconds
+    class Histogram {
+    public:
+        static constexpr std::array<double, 14> BUCKETS_MS = {
+            1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000
+        };
+
+        void observe(double ms);
+
+        void write(std::ostream& os, const std::string& name, const std::string& labels) const;
+
+    private:
+        // last position counts the observations greater than every bucket (+Inf)
+        std::array<std::atomic<uint64_t>, BUCKETS_MS.size() + 1> bucket_counts {};
+        std::atomic<uint64_t> count  { 0 };
+        std::atomic<uint64_t> sum_us { 0 };
+    };
+
+    struct WorkerCounters {
+        std::atomic<uint64_t> active_queries { 0 };
+        std::atomic<uint64_t> queries        { 0 };
+        std::atomic<uint64_t> timeouts       { 0 };
+        std::atomic<uint64_t> busy_us        { 0 };
+    };
+
+    PoolCounters versioned_pool;
+    PoolCounters unversioned_pool;
+    PoolCounters private_pool;
+    PoolCounters tensor_pool;
+
+    // Time spent waiting to acquire the buffer manager mutexes
+    std::atomic<uint64_t> vp_mutex_wait_us     { 0 };
+    std::atomic<uint64_t> vp_mutex_contentions { 0 };
+    std::atomic<uint64_t> up_mutex_wait_us     { 0 };
+    std::atomic<uint64_t> up_mutex_contentions { 0 };
+
+    // Pages loaded by the buffer warm-up at startup
+    std::atomic<uint64_t> warmup_pages { 0 };
+
+    // Old versions of versioned pages kept as deltas and restored into frames
+    std::atomic<uint64_t> page_delta_bytes            { 0 };
+    std::atomic<uint64_t> page_delta_materializations { 0 };
+
+    Histogram parser_duration;
+    Histogram optimizer_duration;
+    Histogram execution_duration;
+
+    std::atomic<uint64_t> query_errors { 0 };
+
+    // Responses of the SPARQL result cache
+    std::atomic<uint64_t> query_cache_hits      { 0 };
+    std::atomic<uint64_t> query_cache_misses    { 0 };
+    std::atomic<uint64_t> query_cache_evictions { 0 };
+    std::atomic<uint64_t> query_cache_bytes     { 0 };
+
+    // Connections accepted that are waiting for a worker to read their request
+    std::atomic<uint64_t> queued_requests { 0 };
+
+    // Must be called by the server before starting its workers
+    void init_workers(uint64_t workers);
+
+    WorkerCounters& worker(uint64_t worker_index) {
+        return worker_counters[worker_index];
+    }
+
+    // Locks the mutex, measuring the time waited when it is already locked
+    static void lock(std::mutex& mutex, std::atomic<uint64_t>& wait_us, std::atomic<uint64_t>& contentions) {
+        if (mutex.try_lock()) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        mutex.lock();
+        auto waited = std::chrono::steady_clock::now() - start;
+        wait_us.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(waited).count(),
+                          std::memory_order_relaxed);
+        contentions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Writes every metric in the Prometheus text exposition format
+    void write_prometheus(std::ostream& os) const;
+
+private:
+    std::unique_ptr<WorkerCounters[]> worker_counters;
+    uint64_t workers = 0;
+};
+
+// Marks the current worker as busy executing a request while the object is alive
+class ActiveQueryScope {
+public:
+    ActiveQueryScope(Metrics::WorkerCounters& counters) :
+        counters (counters),
+        start    (std::chrono::steady_clock::now())
+    {
+        counters.active_queries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ~ActiveQueryScope() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        counters.busy_us.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(),
+                                   std::memory_order_relaxed);
+        counters.active_queries.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+private:
+    Metrics::WorkerCounters& counters;
+    std::chrono::steady_clock::time_point start;
+};
+
+extern Metrics metrics; // global object
@@ -5,6 +5,7 @@
 #include <boost/asio.hpp>
 
 #include "misc/fatal_error.h"
+#include "misc/metrics.h"
 #include "network/mql/session.h"
 
 namespace MQL {
@@ -75,6 +76,7 @@ private:
             [this](const boost::system::error_code& ec, boost::asio::ip::tcp::socket socket) {
                 if (!ec) {
                     // Create the session and run it
+                    metrics.queued_requests.fetch_add(1, std::memory_order_relaxed);
                     std::make_shared<Session>(server, std::move(socket), timeout)->run();
                 }
                 // Accept another connection
@@ -1,11 +1,14 @@
 #include "session.h"
 
+#include <cstring>
 #include <memory>
 #include <mutex>
+#include <sstream>
 
 #include <boost/bind/bind.hpp>
 
 #include "graph_models/quad_model/quad_model.h"
+#include "misc/metrics.h"
 #include "misc/trim.h"
 #include "network/exceptions.h"
 #include "network/mql/server.h"
@@ -13,7 +16,9 @@
 #include "query/optimizer/quad_model/executor_constructor.h"
 #include "query/parser/grammar/error_listener.h"
 #include "query/parser/mql_query_parser.h"
+#include "storage/buffer_manager.h"
 #include "storage/tmp_manager.h"
+#include "update/mql/update_executor.h"
 
 
 using namespace boost;
@@ -37,11 +42,20 @@ void Session::run() {
 void Session::do_read(const boost::system::error_code& ec, std::size_t /*bytes_transferred*/) {
     std::string query;
 
+    // the connection is no longer waiting for a worker
+    metrics.queued_requests.fetch_sub(1, std::memory_order_relaxed);
+
     if (ec) {
         logger(Category::Error) << "Error receiving the query size";
         return;
     }
 
+    // the query length is never this big, so these bytes can only be the start of an HTTP request
+    if (std::memcmp(query_size_b, "GET ", CommunicationProtocol::BYTES_FOR_QUERY_LENGTH) == 0) {
+        handle_http_request();
+        return;
+    }
+
     try {
         assert(CommunicationProtocol::BYTES_FOR_QUERY_LENGTH == 4);
 
@@ -67,23 +81,43 @@ void Session::do_read(const boost::system::error_code& ec, std::size_t /*bytes_t
     tmp_manager.reset();
     get_query_ctx().reset();
 
+    auto& worker_metrics = metrics.worker(get_query_ctx().thread_info.worker_index);
+    worker_metrics.queries.fetch_add(1, std::memory_order_relaxed);
+    ActiveQueryScope active_query(worker_metrics);
+
+    std::unique_ptr<BufferManager::VersionScope> version_scope;
     std::unique_ptr<QueryExecutor> physical_plan;
     try {
-        std::shared_lock s_lock(server.execution_mutex);
         auto logical_plan = create_logical_plan(query);
+        metrics.parser_duration.observe(parser_duration.count());
         if (logical_plan->read_only()) {
+            std::shared_lock s_lock(server.execution_mutex);
+            version_scope = buffer_manager.init_version_readonly();
+            get_query_ctx().start_version = version_scope->start_version;
+            get_query_ctx().result_version = version_scope->start_version;
+
             physical_plan = create_readonly_physical_plan(*logical_plan);
+            metrics.optimizer_duration.observe(optimizer_duration.count());
         } else {
+            // only one insert at a time, and the catalog is not read by the optimizer meanwhile
             std::unique_lock u_lock(server.execution_mutex);
-            // TODO: implement inserts for quad model
-            // quad_model.exec_inserts(*reinterpret_cast<OpInsert*>(logical_plan.get()));
+            version_scope = buffer_manager.init_version_editable();
+            get_query_ctx().start_version = version_scope->start_version;
+            get_query_ctx().result_version = version_scope->start_version + 1;
+
+            execute_update(*logical_plan);
+            version_scope.reset();
+            tcp_buffer.set_status(CommunicationProtocol::StatusCodes::success);
+            return;
         }
     }
     catch (const QueryException& e) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Error) << "Query Exception: " << e.what();
         tcp_buffer.set_status(CommunicationProtocol::StatusCodes::query_error);
     }
     catch (const LogicException& e) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Error) << "Logic Exception: " << e.what();
         tcp_buffer.set_status(CommunicationProtocol::StatusCodes::logic_error);
     }
@@ -95,6 +129,7 @@ void Session::do_read(const boost::system::error_code& ec, std::size_t /*bytes_t
 
     try {
         execute_plan(*physical_plan, os);
+        metrics.execution_duration.observe(execution_duration.count());
         tcp_buffer.set_status(CommunicationProtocol::StatusCodes::success);
     }
     catch (const ConnectionException& e) {
@@ -102,6 +137,8 @@ void Session::do_read(const boost::system::error_code& ec, std::size_t /*bytes_t
     }
     catch (const InterruptedException& e) {
         execution_duration = std::chrono::system_clock::now() - execution_start;
+        metrics.execution_duration.observe(execution_duration.count());
+        worker_metrics.timeouts.fetch_add(1, std::memory_order_relaxed);
 
         logger.log(Category::ExecutionStats, [&physical_plan](std::ostream& os) {
             physical_plan->analyze(os, true);
@@ -115,6 +152,7 @@ void Session::do_read(const boost::system::error_code& ec, std::size_t /*bytes_t
         tcp_buffer.set_status(CommunicationProtocol::StatusCodes::timeout);
     }
     catch (const QueryExecutionException& e) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Error) << "Query Execution Exception: " << e.what();
         tcp_buffer.set_status(CommunicationProtocol::StatusCodes::unexpected_error);
     }
@@ -159,6 +197,28 @@ void Session::execute_plan(QueryExecutor& physical_plan, std::ostream& os) {
 }
 
 
+void Session::execute_update(Op& logical_plan) {
+    execution_start = std::chrono::system_clock::now();
+
+    UpdateExecutor update_executor;
+    logical_plan.accept_visitor(update_executor);
+    execution_duration = std::chrono::system_clock::now() - execution_start;
+    metrics.execution_duration.observe(execution_duration.count());
+
+    logger.log(Category::ExecutionStats, [&update_executor](std::ostream& os) {
+        os << "Update Stats\n"
+           << "Nodes inserted: "      << update_executor.nodes_inserted      << '\n'
+           << "Labels inserted: "     << update_executor.labels_inserted     << '\n'
+           << "Properties inserted: " << update_executor.properties_inserted << '\n'
+           << "Edges inserted: "      << update_executor.edges_inserted      << '\n';
+    });
+
+    logger(Category::Info)
+        << "Parser duration:    " << parser_duration.count()    << " ms\n"
+        << "Execution duration: " << execution_duration.count() << " ms";
+}
+
+
 std::unique_ptr<QueryExecutor> Session::create_readonly_physical_plan(Op& logical_plan) {
     auto start_optimizer = std::chrono::system_clock::now();
 
@@ -170,6 +230,42 @@ std::unique_ptr<QueryExecutor> Session::create_readonly_physical_plan(Op& logica
 }
 
 
+void Session::handle_http_request() {
+    boost::system::error_code ec;
+    boost::asio::streambuf request;
+    boost::asio::read_until(socket, request, "\r\n\r\n", ec);
+    if (ec) {
+        return fail(ec, "read HTTP request");
+    }
+
+    std::string target;
+    std::istream request_is(&request);
+    request_is >> target;
+
+    std::stringstream body;
+    std::stringstream response;
+    if (target == "/metrics" || target.rfind("/metrics?", 0) == 0) {
+        metrics.write_prometheus(body);
+        response << "HTTP/1.1 200 OK\r\n"
+                 << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    } else {
+        response << "HTTP/1.1 404 Not Found\r\n";
+    }
+    const auto body_str = body.str();
+    response << "Server: MillenniumDB\r\n"
+             << "Content-Length: " << body_str.size() << "\r\n"
+             << "Connection: close\r\n"
+             << "\r\n"
+             << body_str;
+
+    boost::asio::write(socket, boost::asio::buffer(response.str()), ec);
+    if (ec) {
+        return fail(ec, "write HTTP response");
+    }
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+}
+
+
 void Session::fail(boost::system::error_code& ec, char const* what) {
     logger(Category::Error) << what << ": " << ec.message();
 }
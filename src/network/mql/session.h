@@ -57,5 +57,11 @@ private:
     std::unique_ptr<QueryExecutor> create_readonly_physical_plan(Op& logical_plan);
 
     void execute_plan(QueryExecutor& physical_plan, std::ostream& os);
+
+    // Executes an insert query, the caller must hold the unique lock of the execution_mutex
+    void execute_update(Op& logical_plan);
+
+    // Answers a plain HTTP request sent to the query port, only GET /metrics is supported
+    void handle_http_request();
 };
 }
\ No newline at end of file
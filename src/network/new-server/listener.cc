@@ -1,6 +1,7 @@
 #include "listener.h"
 
 #include "misc/logger.h"
+#include "misc/metrics.h"
 #include "network/new-server/protocol.h"
 #include "network/new-server/session/session_dispatcher.h"
 
@@ -61,6 +62,7 @@ void Listener<ModelId>::do_accept() {
           // A new connection is accepted
           logger(Category::Info) << "New client connected";
           if (!ec) {
+              metrics.queued_requests.fetch_add(1, std::memory_order_relaxed);
               std::make_shared<SessionDispatcher<ModelId>>(server, std::move(socket), timeout)->run();
           }
 
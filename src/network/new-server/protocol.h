@@ -34,6 +34,12 @@ static constexpr uint_fast32_t DEFAULT_BROWSER_PORT = 4321;
 
 static constexpr uint_fast32_t DEFAULT_TIMEOUT_SECONDS = 60;
 
+// A query waiting for a PULL longer than this is discarded
+static constexpr uint_fast32_t DEFAULT_IDLE_TIMEOUT_SECONDS = 300;
+
+// Records written before yielding the thread to other sessions while handling a PULL
+static constexpr uint32_t PULL_QUANTUM = 1024;
+
 static constexpr uint64_t QUAD_MODEL_ID = QuadCatalog::MODEL_ID;
 
 static constexpr uint64_t RDF_MODEL_ID = RdfCatalog::MODEL_ID;
@@ -128,6 +134,8 @@ enum class RequestType : uint8_t {
     PULL,
     DISCARD,
     CATALOG,
+    // Same as RUN, but the final PULL response includes the profile of the operators as JSON
+    PROFILE,
 
     TOTAL,
 };
@@ -142,6 +150,8 @@ inline std::string request_type_to_string(const RequestType& request_type) {
         return "DISCARD";
     case RequestType::CATALOG:
         return "CATALOG";
+    case RequestType::PROFILE:
+        return "PROFILE";
     default:
         const auto ch = std::to_string(static_cast<uint8_t>(request_type));
         return "UNKNOWN_REQUEST_TYPE (" + ch + ")";
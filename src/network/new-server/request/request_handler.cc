@@ -1,8 +1,13 @@
 #include "request_handler.h"
 
+#include <algorithm>
+#include <sstream>
+
 #include "misc/logger.h"
+#include "misc/metrics.h"
 #include "network/exceptions.h"
 #include "network/new-server/protocol.h"
+#include "network/new-server/session/streaming_session.h"
 #include "query/query_context.h"
 #include "storage/tmp_manager.h"
 
@@ -21,18 +26,27 @@ void RequestHandler::handle(const uint8_t* request_bytes, std::size_t request_si
 
     const auto request_type = request_reader.read_request_type();
     switch (request_type) {
-    case Protocol::RequestType::RUN: {
+    case Protocol::RequestType::RUN:
+    case Protocol::RequestType::PROFILE: {
+        const auto request_name = Protocol::request_type_to_string(request_type);
         if (session.state != Protocol::ServerState::READY) {
-            throw ProtocolException("Cannot handle RUN request in state: "
+            throw ProtocolException("Cannot handle " + request_name + " request in state: "
                                     + Protocol::server_state_to_string(session.state));
         }
 
         const auto query = request_reader.read_string();
-        logger(Category::Info) << "Request received: RUN(" << query << ")";
-        handle_run(query);
+        logger(Category::Info) << "Request received: " << request_name << "(" << query << ")";
+        discarded_idle = false;
+        handle_run(query, request_type == Protocol::RequestType::PROFILE);
         break;
     }
     case Protocol::RequestType::PULL: {
+        if (session.state != Protocol::ServerState::STREAMING && discarded_idle) {
+            discarded_idle = false;
+            response_writer->write_error("The query was discarded because no PULL was received before the idle timeout");
+            response_writer->flush();
+            return;
+        }
         if (session.state != Protocol::ServerState::STREAMING) {
             throw ProtocolException("Cannot handle PULL request in state: "
                                     + Protocol::server_state_to_string(session.state));
@@ -66,49 +80,164 @@ void RequestHandler::handle(const uint8_t* request_bytes, std::size_t request_si
 }
 
 
+RequestHandler::~RequestHandler() {
+    release_query();
+}
+
+
+void RequestHandler::bind_query_context() {
+    if (query_ctx != nullptr) {
+        QueryContext::set_query_ctx(query_ctx);
+    }
+}
+
+
+void RequestHandler::release_query() {
+    pending_records = 0;
+    session.state   = Protocol::ServerState::READY;
+
+    if (query_ctx == nullptr) {
+        return;
+    }
+    // the operators may use the resources of the QueryContext when they are destroyed
+    bind_query_context();
+    current_physical_plan.reset();
+    version_scope.reset();
+
+    session.release_query_context(*query_ctx);
+    query_ctx = nullptr;
+}
+
+
+void RequestHandler::abort_query(const std::string& msg) {
+    logger(Category::Error) << msg;
+    release_query();
+    response_writer->write_error(msg);
+    response_writer->flush();
+}
+
+
+void RequestHandler::discard_idle() {
+    if (session.state != Protocol::ServerState::STREAMING || has_pending_pull()) {
+        return;
+    }
+    logger(Category::Info) << "Query discarded after being idle";
+    release_query();
+    discarded_idle = true;
+}
+
+
 void RequestHandler::handle_pull(uint32_t num_records) {
-    bool has_next = current_physical_plan->pull(*response_writer, num_records);
+    pending_records = num_records == 0 ? UINT64_MAX : num_records;
+    continue_pull();
+}
+
+
+void RequestHandler::continue_pull() {
+    bind_query_context();
+    ActiveQueryScope active_query(metrics.worker(query_ctx->thread_info.worker_index));
+
+    const auto quantum = std::min<uint64_t>(pending_records, Protocol::PULL_QUANTUM);
+    bool has_next;
+    try {
+        has_next = current_physical_plan->pull(*response_writer, quantum);
+    }
+    catch (const QueryExecutionException& e) {
+        // thrown when the operators exceed the memory limit of the query
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
+        abort_query(std::string("Query Exception: ") + e.what());
+        return;
+    }
+
+    if (pending_records != UINT64_MAX) {
+        pending_records -= quantum;
+    }
 
+    if (!has_next || pending_records == 0) {
+        pending_records = 0;
+        finish_pull(has_next);
+    } else {
+        // send the records written so far, the rest are written when the session continues the PULL
+        response_writer->flush();
+    }
+}
+
+
+void RequestHandler::finish_pull(bool has_next) {
     if (has_next) {
         // There are more records to pull
         response_writer->write_pull_success_has_next();
-    } else {
-        // All records have been pulled
-        execution_duration_ms = get_duration(execution_start);
+        response_writer->flush();
+        return;
+    }
 
-        logger.log(Category::ExecutionStats, [&](std::ostream& os) {
-            current_physical_plan->analyze(os, true);
-            os << '\n';
-        });
+    // All records have been pulled
+    execution_duration_ms = get_duration(execution_start);
+    metrics.execution_duration.observe(execution_duration_ms);
+
+    logger.log(Category::ExecutionStats, [&](std::ostream& os) {
+        current_physical_plan->analyze(os, true);
+        os << '\n';
+    });
+
+    logger(Category::Info)
+        << "Results:            " << current_physical_plan->get_result_count() << '\n'
+        << "Parser duration:    " << parser_duration_ms    << " ms\n"
+        << "Optimizer duration: " << optimizer_duration_ms << " ms\n"
+        << "Execution duration: " << execution_duration_ms << " ms";
+
+    auto& query_profile = get_query_ctx().profile;
+    if (query_profile.enabled) {
+        // analyze links the profiles of the operators with their names
+        std::stringstream plan;
+        current_physical_plan->analyze(plan, true);
 
-        logger(Category::Info)
-            << "Results:            " << current_physical_plan->get_result_count() << '\n'
-            << "Parser duration:    " << parser_duration_ms    << " ms\n"
-            << "Optimizer duration: " << optimizer_duration_ms << " ms\n"
-            << "Execution duration: " << execution_duration_ms << " ms";
+        std::stringstream profile_json;
+        query_profile.write_json(profile_json);
+        response_writer->write_pull_success_final(current_physical_plan->get_result_count(),
+                                                  parser_duration_ms,
+                                                  optimizer_duration_ms,
+                                                  execution_duration_ms,
+                                                  profile_json.str());
+    } else {
         response_writer->write_pull_success_final(current_physical_plan->get_result_count(),
                                                   parser_duration_ms,
                                                   optimizer_duration_ms,
                                                   execution_duration_ms);
-        session.state = Protocol::ServerState::READY;
     }
+    release_query();
 
     response_writer->flush();
 }
 
 
 void RequestHandler::handle_discard() {
-    get_query_ctx().thread_info.interruption_requested = true;
-    session.state = Protocol::ServerState::READY;
+    release_query();
 
     response_writer->write_discard_success();
     response_writer->flush();
 }
 
 
-void RequestHandler::handle_run(const std::string& query) {
+void RequestHandler::handle_run(const std::string& query, bool profile) {
+    query_ctx = session.acquire_query_context();
+    if (query_ctx == nullptr) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
+        response_writer->write_error("Too many running queries, try again later");
+        response_writer->flush();
+        return;
+    }
+    bind_query_context();
+    version_scope = buffer_manager.init_version_readonly();
+
     tmp_manager.reset();
     get_query_ctx().reset();
+    get_query_ctx().start_version  = version_scope->start_version;
+    get_query_ctx().result_version = version_scope->start_version;
+
+    auto& worker_metrics = metrics.worker(get_query_ctx().thread_info.worker_index);
+    worker_metrics.queries.fetch_add(1, std::memory_order_relaxed);
+    ActiveQueryScope active_query(worker_metrics);
 
     try {
         const auto query_start = std::chrono::system_clock::now();
@@ -122,8 +251,10 @@ void RequestHandler::handle_run(const std::string& query) {
         auto parser_start = std::chrono::system_clock::now();
         auto current_logical_plan = create_logical_plan(query);
         parser_duration_ms = get_duration(parser_start);
+        metrics.parser_duration.observe(parser_duration_ms);
 
         if (!current_logical_plan->read_only()) {
+            release_query();
             response_writer->write_error("Only read-only queries are supported");
             response_writer->flush();
             return;
@@ -132,12 +263,15 @@ void RequestHandler::handle_run(const std::string& query) {
         auto optimizer_start  = std::chrono::system_clock::now();
         current_physical_plan = create_readonly_physical_plan(*current_logical_plan);
         optimizer_duration_ms = get_duration(optimizer_start);
+        metrics.optimizer_duration.observe(optimizer_duration_ms);
 
         logger.log(Category::PhysicalPlan, [&](std::ostream& os) {
             current_physical_plan->analyze(os, false);
             os << '\n';
         });
 
+        get_query_ctx().profile.reset(profile);
+        get_query_ctx().profile.memory_limit = session.get_query_memory_limit();
         execution_start = std::chrono::system_clock::now();
 
         const auto projection_vars = current_physical_plan->get_projection_vars();
@@ -147,16 +281,12 @@ void RequestHandler::handle_run(const std::string& query) {
         session.state = Protocol::ServerState::STREAMING;
     }
     catch (const QueryException& e) {
-        const auto msg = std::string("Query Exception: ") + e.what();
-        logger(Category::Error) << msg;
-        response_writer->write_error(msg);
-        response_writer->flush();
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
+        abort_query(std::string("Query Exception: ") + e.what());
     }
     catch (const LogicException& e) {
-        const auto msg = std::string("Logic Exception: ") + e.what();
-        logger(Category::Error) << msg;
-        response_writer->write_error(msg);
-        response_writer->flush();
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
+        abort_query(std::string("Logic Exception: ") + e.what());
     }
 }
 
@@ -6,6 +6,9 @@
 #include "network/new-server/request/request_reader.h"
 #include "query/executor/query_executor/streaming_query_executor.h"
 #include "query/parser/op/op.h"
+#include "storage/buffer_manager.h"
+
+class QueryContext;
 
 namespace NewServer {
 
@@ -21,10 +24,29 @@ public:
         session         (session),
         response_writer (std::move(response_writer)) { }
 
-    virtual ~RequestHandler() = default;
+    virtual ~RequestHandler();
 
     void handle(const uint8_t* request_bytes, std::size_t request_size);
 
+    // True while a PULL has records left to write, the session must call continue_pull until it finishes.
+    // Between calls other sessions can use the thread
+    bool has_pending_pull() const {
+        return pending_records > 0;
+    }
+
+    // Writes up to Protocol::PULL_QUANTUM records of the pending PULL
+    void continue_pull();
+
+    // Discard the query because the client did not send a PULL in time. The next PULL receives an error
+    void discard_idle();
+
+    // Release the query (if any) and its resources, transition to READY state
+    void release_query();
+
+    // Bind the QueryContext of the current query to the thread, must be called before anything that
+    // can access the query
+    void bind_query_context();
+
 private:
     std::chrono::system_clock::time_point execution_start;
 
@@ -34,20 +56,37 @@ private:
 
     RequestReader request_reader;
 
+    // Reserved by RUN, released when the query finishes or is discarded
+    QueryContext* query_ctx = nullptr;
+
+    // The version the query reads is kept until the query is released
+    std::unique_ptr<BufferManager::VersionScope> version_scope;
+
     std::unique_ptr<StreamingQueryExecutor> current_physical_plan;
 
+    // Records the current PULL has yet to write, UINT64_MAX when it requested all of them
+    uint64_t pending_records = 0;
+
+    bool discarded_idle = false;
+
     virtual std::unique_ptr<Op> create_logical_plan(const std::string& query) = 0;
 
     virtual std::unique_ptr<StreamingQueryExecutor> create_readonly_physical_plan(Op& logical_plan) = 0;
 
     // Build the logical and physical plan. On success store the result in current_physical_plan and transition to
-    // STREAMING state.
-    void handle_run(const std::string& query);
+    // STREAMING state. When profile is true the operators are profiled and the final PULL response includes it.
+    void handle_run(const std::string& query, bool profile);
 
-    // Pull num_records from current_physical_plan. On success if no more records are available, transition to READY
-    // state, otherwise keep the STREAMING state.
+    // Start pulling num_records from current_physical_plan, the records are written by continue_pull. On success
+    // if no more records are available, transition to READY state, otherwise keep the STREAMING state.
     void handle_pull(uint32_t num_records);
 
+    // Write the response of a PULL that finished
+    void finish_pull(bool has_next);
+
+    // Write an error and release the query
+    void abort_query(const std::string& msg);
+
     // Discard the current query execution. On success transition to READY state.
     void handle_discard();
 
@@ -81,6 +81,34 @@ void ResponseWriter::write_pull_success_final(uint64_t result_count,
 }
 
 
+void ResponseWriter::write_pull_success_final(uint64_t           result_count,
+                                              uint64_t           parser_duration_ms,
+                                              uint64_t           optimizer_duration_ms,
+                                              uint64_t           execution_duration_ms,
+                                              const std::string& profile_json) {
+    write_map_header(2UL);
+    write_string("type", Protocol::DataType::STRING);
+    write_uint8(static_cast<uint8_t>(Protocol::ResponseType::SUCCESS));
+
+    write_string("payload", Protocol::DataType::STRING);
+    write_map_header(6UL);
+    write_string("hasNext", Protocol::DataType::STRING);
+    write_bool(false);
+    write_string("resultCount", Protocol::DataType::STRING);
+    write_uint64(result_count);
+    write_string("parserDurationMs", Protocol::DataType::STRING);
+    write_uint64(parser_duration_ms);
+    write_string("optimizerDurationMs", Protocol::DataType::STRING);
+    write_uint64(optimizer_duration_ms);
+    write_string("executionDurationMs", Protocol::DataType::STRING);
+    write_uint64(execution_duration_ms);
+    write_string("profile", Protocol::DataType::STRING);
+    write_string(profile_json, Protocol::DataType::STRING);
+
+    seal();
+}
+
+
 void ResponseWriter::write_catalog_success() {
     write_map_header(2UL);
     write_string("type", Protocol::DataType::STRING);
@@ -59,6 +59,12 @@ public:
                                   uint64_t parser_duration_ms,
                                   uint64_t optimizer_duration_ms,
                                   uint64_t execution_duration);
+    // Same as above, including the profile of the operators as a JSON string
+    void write_pull_success_final(uint64_t           result_count,
+                                  uint64_t           parser_duration_ms,
+                                  uint64_t           optimizer_duration_ms,
+                                  uint64_t           execution_duration,
+                                  const std::string& profile_json);
     void write_catalog_success();
     void write_record(const std::vector<VarId>& projection_vars, const Binding& binding);
     void write_error(const std::string& message);
@@ -10,6 +10,7 @@
 #include <boost/beast/http.hpp>
 
 #include "misc/logger.h"
+#include "misc/metrics.h"
 #include "network/new-server/protocol.h"
 #include "network/new-server/listener.h"
 #include "query/query_context.h"
@@ -264,14 +265,16 @@ void Server<ModelId>::run(unsigned short       port,
     // Run the I/O service on the requested number of threads
     std::vector<std::thread> threads;
     threads.reserve(num_workers);
-    query_contexts.resize(num_workers);
+    query_contexts.resize(max_queries);
+    free_query_contexts.clear();
+    for (uint_fast32_t i = 0; i < max_queries; ++i) {
+        query_contexts[i].thread_info.worker_index = i;
+        free_query_contexts.push_back(&query_contexts[max_queries - 1 - i]);
+    }
+    metrics.init_workers(max_queries);
     for (auto i = 0; i < num_workers; ++i) {
-        threads.emplace_back([&, i] {
-            auto& qc = query_contexts[i];
-            QueryContext::set_query_ctx(&qc);
-            get_query_ctx().thread_info.worker_index = i;
-            io_context.run();
-        });
+        // the QueryContext is bound by the session handling a request
+        threads.emplace_back([&] { io_context.run(); });
     }
 
     listener.run();
@@ -308,6 +311,30 @@ void Server<ModelId>::run(unsigned short       port,
 }
 
 
+template <uint64_t ModelId>
+QueryContext* Server<ModelId>::acquire_query_context() {
+    std::lock_guard<std::mutex> lock(free_query_contexts_mutex);
+    if (free_query_contexts.empty()) {
+        return nullptr;
+    }
+    auto res = free_query_contexts.back();
+    free_query_contexts.pop_back();
+    return res;
+}
+
+
+template <uint64_t ModelId>
+void Server<ModelId>::release_query_context(QueryContext& query_ctx) {
+    {
+        // the timeout thread must not interrupt the next query because of this one
+        std::lock_guard<std::mutex> lock(thread_info_vec_mutex);
+        query_ctx.thread_info.timeout = std::chrono::system_clock::time_point::max();
+    }
+    std::lock_guard<std::mutex> lock(free_query_contexts_mutex);
+    free_query_contexts.push_back(&query_ctx);
+}
+
+
 template <uint64_t ModelId>
 void Server<ModelId>::signal_shutdown_server(int) {
     shutdown_server = true;
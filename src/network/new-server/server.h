@@ -6,6 +6,7 @@
 
 #include <boost/asio.hpp>
 
+#include "network/new-server/protocol.h"
 #include "query/query_context.h"
 
 
@@ -22,16 +23,37 @@ public:
              int                  num_threads,
              std::chrono::seconds timeout);
 
+    // Queries that can be executing or waiting for a PULL at the same time. Each one uses the resources
+    // of the worker index of its QueryContext, so it must not exceed the workers the model was initialized with
+    uint_fast32_t max_queries = 1;
+
+    // A query waiting for a PULL longer than this is discarded, releasing its QueryContext and version
+    std::chrono::seconds idle_timeout { Protocol::DEFAULT_IDLE_TIMEOUT_SECONDS };
+
+    // Bytes the operators of a query can allocate, 0 means no limit
+    uint64_t query_memory_limit = 0;
+
+    // Contexts of the queries, they are not bound to threads. A session reserves one with RUN and
+    // binds it to the thread that is handling each of its requests
     std::vector<QueryContext> query_contexts;
 
     // Used to prevent synchronization problems between tht timeout thread and the worker thread
     std::mutex thread_info_vec_mutex;
 
+    // Returns nullptr when max_queries queries are running
+    QueryContext* acquire_query_context();
+
+    void release_query_context(QueryContext& query_ctx);
+
     static void signal_shutdown_server(int signal);
 
     void execute_timeouts();
 
 private:
+    std::mutex free_query_contexts_mutex;
+
+    std::vector<QueryContext*> free_query_contexts;
+
     static void browser_session(boost::asio::ip::tcp::socket&& socket);
 
     static void browser_listener(boost::asio::io_context* browser_io_context, int port);
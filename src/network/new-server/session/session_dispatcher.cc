@@ -1,9 +1,13 @@
 #include "session_dispatcher.h"
 
+#include <sstream>
+#include <vector>
+
 #include <boost/beast.hpp>
 
 #include "boost/bind/bind.hpp"
 #include "misc/logger.h"
+#include "misc/metrics.h"
 #include "network/new-server/protocol.h"
 #include "network/new-server/session/websocket/websocket_streaming_session.h"
 #include "query/exceptions.h"
@@ -25,6 +29,9 @@ void SessionDispatcher<ModelId>::run() {
 
 template<uint64_t ModelId>
 void SessionDispatcher<ModelId>::do_read(const boost::system::error_code& ec_, std::size_t /*bytes_transferred*/) {
+    // the connection is no longer waiting for a worker
+    metrics.queued_requests.fetch_sub(1, std::memory_order_relaxed);
+
     boost::system::error_code ec;
     if (ec_) {
         socket.close();
@@ -52,6 +59,28 @@ void SessionDispatcher<ModelId>::do_read(const boost::system::error_code& ec_, s
             logger(Category::Error) << "Could not read WebSocket upgrade request";
             return;
         }
+
+        // Plain HTTP request for the metrics instead of a WebSocket upgrade
+        const std::string request_line(asio::buffer_cast<const char*>(buffer.data()),
+                                       std::min<std::size_t>(buffer.size(), sizeof("GET /metrics ") - 1));
+        if (request_line == "GET /metrics " || request_line.rfind("GET /metrics?", 0) == 0) {
+            std::stringstream response;
+            metrics.write_prometheus(response);
+            const auto body = response.str();
+
+            std::stringstream header;
+            header << "HTTP/1.1 200 OK\r\n"
+                   << "Server: MillenniumDB\r\n"
+                   << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                   << "Content-Length: " << body.size() << "\r\n"
+                   << "Connection: close\r\n"
+                   << "\r\n";
+            const auto header_str = header.str();
+            asio::write(socket, std::vector<asio::const_buffer> { asio::buffer(header_str), asio::buffer(body) }, ec);
+            socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            socket.close();
+            return;
+        }
         beast::websocket::stream<asio::ip::tcp::socket> stream { std::move(socket) };
         stream.accept(buffer.data(), ec);
         if (ec) {
@@ -6,6 +6,8 @@
 
 #include "network/new-server/protocol.h"
 
+class QueryContext;
+
 namespace NewServer {
 
 class StreamingSession {
@@ -24,5 +26,13 @@ public:
     virtual std::mutex& get_thread_info_vec_mutex() = 0;
 
     virtual std::chrono::seconds get_timeout() = 0;
+
+    // Bytes the operators of a query can allocate, 0 means no limit
+    virtual uint64_t get_query_memory_limit() = 0;
+
+    // Reserve a QueryContext for a query until it is released, returns nullptr if all are in use
+    virtual QueryContext* acquire_query_context() = 0;
+
+    virtual void release_query_context(QueryContext& query_ctx) = 0;
 };
 } // namespace NewServer
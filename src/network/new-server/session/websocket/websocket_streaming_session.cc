@@ -1,11 +1,13 @@
 #include "websocket_streaming_session.h"
 
 #include "misc/logger.h"
+#include "misc/metrics.h"
 #include "network/exceptions.h"
 #include "network/new-server/protocol.h"
 #include "network/new-server/request/quad_request_handler.h"
 #include "network/new-server/request/rdf_request_handler.h"
 #include "network/new-server/server.h"
+#include "query/query_context.h"
 
 
 using namespace NewServer;
@@ -17,9 +19,10 @@ WebSocketStreamingSession<ModelId>::WebSocketStreamingSession(
     std::chrono::seconds    timeout,
     websocket_stream_type&& stream_
 ) :
-    server  (server),
-    timeout (timeout),
-    stream  (std::move(stream_))
+    server     (server),
+    timeout    (timeout),
+    stream     (std::move(stream_)),
+    idle_timer (stream.get_executor())
 {
     if constexpr (ModelId == Protocol::QUAD_MODEL_ID) {
         request_handler = std::make_unique<QuadRequestHandler>(*this);
@@ -36,6 +39,8 @@ WebSocketStreamingSession<ModelId>::WebSocketStreamingSession(
 
 template<uint64_t ModelId>
 WebSocketStreamingSession<ModelId>::~WebSocketStreamingSession() {
+    request_handler->release_query();
+
     if (stream.is_open()) {
         stream.close(boost::beast::websocket::close_code::normal, ec);
         logger(Category::Debug) << "WebSocketSession: connection closed by destructor";
@@ -67,43 +72,117 @@ void WebSocketStreamingSession<ModelId>::write(const uint8_t* bytes, std::size_t
 
 template<uint64_t ModelId>
 void WebSocketStreamingSession<ModelId>::start_session() {
-    while (stream.is_open()) {
-        stream.read(request_buffer, ec);
+    do_read();
+}
 
-        if (ec) {
-            logger(Category::Error) << "WebSocketSession read error: " << ec.message();
-            return;
-        }
 
-        try {
-            const auto request_bytes = boost::asio::buffer_cast<uint8_t*>(request_buffer.data());
-            request_handler->handle(request_bytes, request_buffer.size());
-            request_buffer.consume(request_buffer.size());
-        }
-        catch (const InterruptedException& e) {
-            auto& response_writer = request_handler->response_writer;
-            response_writer->write_error("Interruption exception: Query timed out");
-            response_writer->flush();
-
-            stream.close(boost::beast::websocket::close_code::normal, ec);
-            logger(Category::Error) << "Interruption exception: Query timed out";
-            if (ec) {
-                logger(Category::Debug) << "Close failed:" << ec.what();
-            }
-        }
-        catch (const ProtocolException& e) {
-            logger(Category::Error) << "Protocol exception: " << e.what();
-        }
-        catch (const ConnectionException& e) {
-            logger(Category::Error) << "Connection exception: " << e.what();
-        }
-        catch (const std::exception& e) {
-            logger(Category::Error) << "Uncaught exception: " << e.what();
+template<uint64_t ModelId>
+void WebSocketStreamingSession<ModelId>::do_read() {
+    stream.async_read(
+      request_buffer,
+      boost::beast::bind_front_handler(&WebSocketStreamingSession::on_read, this->shared_from_this()));
+}
+
+
+template<uint64_t ModelId>
+void WebSocketStreamingSession<ModelId>::on_read(boost::beast::error_code read_ec, std::size_t) {
+    if (read_ec) {
+        if (read_ec != boost::beast::websocket::error::closed) {
+            logger(Category::Error) << "WebSocketSession read error: " << read_ec.message();
         }
-        catch (...) {
-            logger(Category::Error) << "Unexpected exception!";
+        idle_timer.cancel();
+        execute([&] { request_handler->release_query(); });
+        return;
+    }
+
+    idle_timer.cancel();
+    execute([&] {
+        request_handler->bind_query_context();
+        const auto request_bytes = boost::asio::buffer_cast<uint8_t*>(request_buffer.data());
+        request_handler->handle(request_bytes, request_buffer.size());
+    });
+    request_buffer.consume(request_buffer.size());
+
+    schedule_next();
+}
+
+
+template<uint64_t ModelId>
+void WebSocketStreamingSession<ModelId>::schedule_next() {
+    if (!stream.is_open()) {
+        execute([&] { request_handler->release_query(); });
+        return;
+    }
+
+    if (request_handler->has_pending_pull()) {
+        boost::asio::post(
+          stream.get_executor(),
+          boost::beast::bind_front_handler(&WebSocketStreamingSession::on_continue_pull, this->shared_from_this()));
+        return;
+    }
+
+    if (state == Protocol::ServerState::STREAMING) {
+        idle_timer.expires_after(server.idle_timeout);
+        idle_timer.async_wait(
+          boost::beast::bind_front_handler(&WebSocketStreamingSession::on_idle_timeout, this->shared_from_this()));
+    }
+    do_read();
+}
+
+
+template<uint64_t ModelId>
+void WebSocketStreamingSession<ModelId>::on_continue_pull() {
+    execute([&] { request_handler->continue_pull(); });
+    schedule_next();
+}
+
+
+template<uint64_t ModelId>
+void WebSocketStreamingSession<ModelId>::on_idle_timeout(boost::beast::error_code timer_ec) {
+    // the timer may have expired just before a request re-armed or cancelled it
+    if (timer_ec == boost::asio::error::operation_aborted
+        || idle_timer.expiry() > boost::asio::steady_timer::clock_type::now())
+    {
+        return;
+    }
+    execute([&] { request_handler->discard_idle(); });
+}
+
+
+template<uint64_t ModelId>
+template<typename Func>
+void WebSocketStreamingSession<ModelId>::execute(Func&& func) {
+    try {
+        func();
+    }
+    catch (const InterruptedException& e) {
+        metrics.worker(get_query_ctx().thread_info.worker_index).timeouts.fetch_add(1, std::memory_order_relaxed);
+        request_handler->release_query();
+        auto& response_writer = request_handler->response_writer;
+        response_writer->write_error("Interruption exception: Query timed out");
+        response_writer->flush();
+
+        stream.close(boost::beast::websocket::close_code::normal, ec);
+        logger(Category::Error) << "Interruption exception: Query timed out";
+        if (ec) {
+            logger(Category::Debug) << "Close failed:" << ec.what();
         }
     }
+    catch (const ProtocolException& e) {
+        logger(Category::Error) << "Protocol exception: " << e.what();
+    }
+    catch (const ConnectionException& e) {
+        logger(Category::Error) << "Connection exception: " << e.what();
+        request_handler->release_query();
+    }
+    catch (const std::exception& e) {
+        logger(Category::Error) << "Uncaught exception: " << e.what();
+        request_handler->release_query();
+    }
+    catch (...) {
+        logger(Category::Error) << "Unexpected exception!";
+        request_handler->release_query();
+    }
 }
 
 
@@ -118,5 +197,23 @@ std::chrono::seconds WebSocketStreamingSession<ModelId>::get_timeout() {
     return timeout;
 }
 
+
+template<uint64_t ModelId>
+uint64_t WebSocketStreamingSession<ModelId>::get_query_memory_limit() {
+    return server.query_memory_limit;
+}
+
+
+template<uint64_t ModelId>
+QueryContext* WebSocketStreamingSession<ModelId>::acquire_query_context() {
+    return server.acquire_query_context();
+}
+
+
+template<uint64_t ModelId>
+void WebSocketStreamingSession<ModelId>::release_query_context(QueryContext& query_ctx) {
+    server.release_query_context(query_ctx);
+}
+
 template class NewServer::WebSocketStreamingSession<NewServer::Protocol::QUAD_MODEL_ID>;
 template class NewServer::WebSocketStreamingSession<NewServer::Protocol::RDF_MODEL_ID>;
@@ -33,6 +33,12 @@ public:
 
     std::chrono::seconds get_timeout() override;
 
+    uint64_t get_query_memory_limit() override;
+
+    QueryContext* acquire_query_context() override;
+
+    void release_query_context(QueryContext& query_ctx) override;
+
 private:
     boost::beast::error_code ec;
 
@@ -46,6 +52,26 @@ private:
 
     std::unique_ptr<RequestHandler> request_handler;
 
+    // Discards the query when the client takes too long to send a PULL
+    boost::asio::steady_timer idle_timer;
+
     void start_session();
+
+    // Requests are read asynchronously, so a session waiting for its client does not use a thread
+    void do_read();
+
+    void on_read(boost::beast::error_code read_ec, std::size_t bytes_transferred);
+
+    // Continues a PULL with pending records or reads the next request. The continuation is posted to
+    // let other sessions use the thread between quanta
+    void schedule_next();
+
+    void on_continue_pull();
+
+    void on_idle_timeout(boost::beast::error_code timer_ec);
+
+    // Executes a step of the request handler, handling its exceptions
+    template<typename Func>
+    void execute(Func&& func);
 };
 } // namespace NewServer
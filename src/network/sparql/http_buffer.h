@@ -71,7 +71,7 @@ private:
 
     void send() {
         boost::system::error_code ec;
-        boost::asio::write(sock, boost::asio::buffer(buffer, CommunicationProtocol::BUFFER_SIZE), ec);
+        boost::asio::write(sock, boost::asio::buffer(buffer, current_pos), ec);
 
         current_pos = 0;
         if (ec) {
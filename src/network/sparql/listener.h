@@ -5,6 +5,7 @@
 #include <boost/asio.hpp>
 
 #include "misc/fatal_error.h"
+#include "misc/metrics.h"
 #include "network/sparql/session.h"
 
 namespace SPARQL {
@@ -74,6 +75,7 @@ private:
             boost::asio::make_strand(io_context),
             [this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket) {
                 if (!ec) {
+                    metrics.queued_requests.fetch_add(1, std::memory_order_relaxed);
                     // Create the session and run it
                     std::make_shared<Session>(server, std::move(socket), timeout)->run();
                 }
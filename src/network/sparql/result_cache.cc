@@ -0,0 +1,192 @@
+#include "result_cache.h"
+
+#include <array>
+#include <cctype>
+
+#include "misc/metrics.h"
+
+using namespace SPARQL;
+
+// Functions whose result changes between executions and SERVICE, whose data is external
+static constexpr std::array<const char*, 6> NON_CACHEABLE_KEYWORDS = {
+    "RAND", "NOW", "UUID", "STRUUID", "BNODE", "SERVICE"
+};
+
+
+static bool is_identifier_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-'
+        || c == '?' || c == '$' || c == ':';
+}
+
+
+// whitespace next to these characters never separates two tokens
+static bool is_bracket(char c) {
+    return c == '{' || c == '}' || c == '(' || c == ')';
+}
+
+
+std::string ResultCache::normalize(const std::string& query) {
+    std::string res;
+    res.reserve(query.size());
+
+    bool pending_space = false;
+    size_t i = 0;
+
+    auto append = [&](char c) {
+        if (pending_space && !res.empty() && !is_bracket(res.back()) && !is_bracket(c)) {
+            res += ' ';
+        }
+        pending_space = false;
+        res += c;
+    };
+
+    while (i < query.size()) {
+        char c = query[i];
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pending_space = true;
+            i++;
+        } else if (c == '#') {
+            // comment until the end of the line
+            while (i < query.size() && query[i] != '\n') {
+                i++;
+            }
+            pending_space = true;
+        } else if (c == '"' || c == '\'') {
+            // literal, possibly long ("""...""" or '''...'''), copied verbatim
+            bool is_long = query.compare(i, 3, std::string(3, c)) == 0;
+            size_t delimiter_size = is_long ? 3 : 1;
+            for (size_t j = 0; j < delimiter_size; j++) {
+                append(query[i++]);
+            }
+            while (i < query.size()) {
+                if (query[i] == '\\' && i + 1 < query.size()) {
+                    append(query[i++]);
+                    append(query[i++]);
+                } else if (query[i] == c
+                           && (!is_long || query.compare(i, 3, std::string(3, c)) == 0))
+                {
+                    for (size_t j = 0; j < delimiter_size; j++) {
+                        append(query[i++]);
+                    }
+                    break;
+                } else {
+                    append(query[i++]);
+                }
+            }
+        } else if (c == '<') {
+            // IRI, copied verbatim. If it is a comparison the rest of the query is copied until a '>'
+            // is found, that only makes the normalization less effective.
+            append(query[i++]);
+            while (i < query.size() && query[i] != '>') {
+                append(query[i++]);
+            }
+            if (i < query.size()) {
+                append(query[i++]);
+            }
+        } else {
+            append(c);
+            i++;
+        }
+    }
+    return res;
+}
+
+
+std::string ResultCache::get_key(const std::string& query, ResponseType response_type) {
+    auto normalized = normalize(query);
+
+    std::string upper(normalized.size(), ' ');
+    for (size_t i = 0; i < normalized.size(); i++) {
+        upper[i] = std::toupper(static_cast<unsigned char>(normalized[i]));
+    }
+
+    // a keyword inside a literal also prevents caching, it is not worth to distinguish it
+    for (auto keyword : NON_CACHEABLE_KEYWORDS) {
+        std::string word(keyword);
+        for (auto pos = upper.find(word); pos != std::string::npos; pos = upper.find(word, pos + 1)) {
+            auto end = pos + word.size();
+            if ((pos == 0 || !is_identifier_char(upper[pos - 1]))
+                && (end == upper.size() || !is_identifier_char(upper[end])))
+            {
+                return "";
+            }
+        }
+    }
+
+    return response_type_to_string(response_type) + '\n' + normalized;
+}
+
+
+bool ResultCache::update_version(uint64_t new_version) {
+    if (new_version > version) {
+        remove_all();
+        version = new_version;
+    }
+    return new_version == version;
+}
+
+
+void ResultCache::remove_all() {
+    entries.clear();
+    key2entry.clear();
+    used_bytes = 0;
+    metrics.query_cache_bytes.store(0, std::memory_order_relaxed);
+}
+
+
+std::shared_ptr<const std::string> ResultCache::get(const std::string& key, uint64_t _version) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!update_version(_version)) {
+        return nullptr;
+    }
+
+    auto it = key2entry.find(key);
+    if (it == key2entry.end()) {
+        return nullptr;
+    }
+    // move to the front of the LRU order
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->response;
+}
+
+
+void ResultCache::insert(const std::string& key, uint64_t _version, std::string&& response) {
+    Entry entry { key, std::make_shared<const std::string>(std::move(response)) };
+    auto size = entry.get_size();
+    if (size > get_max_entry_size()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!update_version(_version)) {
+        return;
+    }
+
+    // another worker may have executed the same query at the same time
+    auto existing = key2entry.find(key);
+    if (existing != key2entry.end()) {
+        return;
+    }
+
+    while (used_bytes + size > capacity && !entries.empty()) {
+        auto& last = entries.back();
+        used_bytes -= last.get_size();
+        key2entry.erase(last.key);
+        entries.pop_back();
+        metrics.query_cache_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    entries.push_front(std::move(entry));
+    key2entry.insert({ key, entries.begin() });
+    used_bytes += size;
+    metrics.query_cache_bytes.store(used_bytes, std::memory_order_relaxed);
+}
+
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    remove_all();
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+
+#include "network/sparql/response_type.h"
+
+namespace SPARQL {
+
+/*
+ * ResultCache keeps the complete HTTP responses of read-only queries, so a query that is sent again
+ * before the database changes is answered without parsing, optimizing or executing it.
+ *
+ * Entries are identified by the normalized query text and the response type, and they are only valid
+ * for the database version they were computed with: when a newer version is seen all the entries are
+ * discarded. Responses are evicted in least recently used order when the capacity is exceeded, and
+ * responses bigger than a fraction of the capacity are not cached.
+ */
+class ResultCache {
+public:
+    // a single response can use at most 1/MAX_ENTRY_FRACTION of the capacity
+    static constexpr uint64_t MAX_ENTRY_FRACTION = 8;
+
+    // Must be called before the server starts, a capacity of 0 disables the cache
+    void set_capacity(uint64_t bytes) {
+        capacity = bytes;
+    }
+
+    bool enabled() const {
+        return capacity > 0;
+    }
+
+    uint64_t get_max_entry_size() const {
+        return capacity / MAX_ENTRY_FRACTION;
+    }
+
+    // Returns the key of the query, or an empty string when its results can't be reused
+    // (e.g. it uses RAND() or NOW())
+    static std::string get_key(const std::string& query, ResponseType response_type);
+
+    // Collapses whitespace, removes the whitespace around brackets and removes comments outside of
+    // IRIs and literals
+    static std::string normalize(const std::string& query);
+
+    // Returns nullptr when the response of the query at the version is not cached
+    std::shared_ptr<const std::string> get(const std::string& key, uint64_t version);
+
+    // Saves the response of a query executed at the version, it is ignored if a newer version exists
+    void insert(const std::string& key, uint64_t version, std::string&& response);
+
+    void clear();
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> response;
+
+        uint64_t get_size() const {
+            // the key is also stored in the map
+            return 2 * key.size() + response->size();
+        }
+    };
+
+    std::mutex mutex;
+
+    uint64_t capacity = 0;
+
+    uint64_t used_bytes = 0;
+
+    // database version of the cached responses
+    uint64_t version = 0;
+
+    // most recently used first
+    std::list<Entry> entries;
+
+    std::unordered_map<std::string, std::list<Entry>::iterator> key2entry;
+
+    // discards the entries if the version is newer, returns false if the version is older
+    bool update_version(uint64_t new_version);
+
+    void remove_all();
+};
+
+
+// Forwards everything written to another stream buffer and keeps a copy of it while the copy is
+// not bigger than max_size
+class CaptureBuffer : public std::streambuf {
+public:
+    CaptureBuffer(std::streambuf& destination, uint64_t max_size) :
+        destination (destination),
+        max_size    (max_size) { }
+
+    // returns false if the copy exceeded max_size and was discarded
+    bool is_complete() const {
+        return complete;
+    }
+
+    std::string&& get_captured() {
+        return std::move(captured);
+    }
+
+protected:
+    int overflow(int i) override {
+        if (i != traits_type::eof()) {
+            char c = static_cast<char>(i);
+            capture(&c, 1);
+            return destination.sputc(c);
+        }
+        return i;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        capture(s, n);
+        return destination.sputn(s, n);
+    }
+
+    int sync() override {
+        return destination.pubsync();
+    }
+
+private:
+    std::streambuf& destination;
+
+    const uint64_t max_size;
+
+    std::string captured;
+
+    bool complete = true;
+
+    void capture(const char* s, std::streamsize n) {
+        if (!complete) {
+            return;
+        }
+        if (captured.size() + n > max_size) {
+            complete = false;
+            captured = std::string();
+            return;
+        }
+        captured.append(s, n);
+    }
+};
+
+} // namespace SPARQL
@@ -8,6 +8,7 @@
 
 #include <boost/asio.hpp>
 
+#include "misc/metrics.h"
 #include "network/sparql/listener.h"
 
 using namespace boost;
@@ -60,6 +61,7 @@ void Server::run(
     std::vector<std::thread> threads;
     threads.reserve(number_of_workers);
     query_contexts.resize(number_of_workers);
+    metrics.init_workers(number_of_workers);
     for (auto i = 0; i < number_of_workers; ++i) {
         threads.emplace_back([&, i] {
             auto& qc = query_contexts[i];
@@ -4,6 +4,7 @@
 #include <mutex>
 #include <vector>
 
+#include "network/sparql/result_cache.h"
 #include "query/query_context.h"
 
 namespace SPARQL {
@@ -20,6 +21,9 @@ public:
     // and the worker thread
     std::mutex thread_info_vec_mutex;
 
+    // disabled unless a capacity is set before calling run()
+    ResultCache result_cache;
+
     void execute_timeouts();
 
     static void signal_shutdown_server(int /*signal*/) {
@@ -1,12 +1,16 @@
 #include "session.h"
 
 #include <memory>
+#include <sstream>
 
 #include "misc/logger.h"
+#include "misc/metrics.h"
 #include "misc/trim.h"
 #include "network/sparql/http_buffer.h"
 #include "network/sparql/request_handler.h"
+#include "network/sparql/result_cache.h"
 #include "network/sparql/server.h"
+#include "query/executor/query_executor/json_ostream_escape.h"
 #include "query/optimizer/rdf_model/executor_constructor.h"
 #include "query/parser/grammar/error_listener.h"
 #include "query/parser/sparql_query_parser.h"
@@ -49,6 +53,9 @@ void Session::fail(boost::beast::error_code& ec, char const* what) {
 
 
 void Session::on_read(beast::error_code ec, std::size_t /*bytes_transferred*/) {
+    // the connection is no longer waiting for a worker
+    metrics.queued_requests.fetch_sub(1, std::memory_order_relaxed);
+
     // This means they closed the connection
     if (ec == beast::http::error::end_of_stream) {
         stream.socket().shutdown(asio::ip::tcp::socket::shutdown_send, ec);
@@ -65,8 +72,18 @@ void Session::on_read(beast::error_code ec, std::size_t /*bytes_transferred*/) {
     os.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 
     bool is_update = false;
-    if (req.target().rfind("/update", 0) != std::string::npos) {
+    bool is_profile = false;
+    if (req.target().rfind("/metrics", 0) != std::string::npos) {
+        os << "HTTP/1.1 200 OK\r\n"
+           << "Server: MillenniumDB\r\n"
+           << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+           << "\r\n";
+        metrics.write_prometheus(os);
+        return;
+    } else if (req.target().rfind("/update", 0) != std::string::npos) {
         is_update = true;
+    } else if (req.target().rfind("/profile", 0) != std::string::npos) {
+        is_profile = true;
     } else if (req.target().rfind("/sparql", 0) == std::string::npos) {
          os << "HTTP/1.1 404 Not Found\r\n"
             << "\r\n";
@@ -83,10 +100,17 @@ void Session::on_read(beast::error_code ec, std::size_t /*bytes_transferred*/) {
     tmp_manager.reset();
     get_query_ctx().reset();
 
+    auto& worker_metrics = metrics.worker(get_query_ctx().thread_info.worker_index);
+    worker_metrics.queries.fetch_add(1, std::memory_order_relaxed);
+    ActiveQueryScope active_query(worker_metrics);
+
     if (is_update) {
         execute_update(query, os);
+        // cached responses would also be discarded when a newer version is seen, but clearing them
+        // now frees their memory
+        server.result_cache.clear();
     } else {
-        execute_query(query, os, response_type);
+        execute_query(query, os, response_type, is_profile);
     }
 }
 
@@ -95,8 +119,25 @@ void Session::on_read(beast::error_code ec, std::size_t /*bytes_transferred*/) {
 void Session::execute_query(
     const std::string& query,
     std::ostream& os,
-    ResponseType response_type)
+    ResponseType response_type,
+    bool profile)
 {
+    std::string cache_key;
+    if (!profile && server.result_cache.enabled()) {
+        cache_key = ResultCache::get_key(query, response_type);
+    }
+
+    if (!cache_key.empty()) {
+        auto response = server.result_cache.get(cache_key, buffer_manager.get_last_stable_version());
+        if (response != nullptr) {
+            metrics.query_cache_hits.fetch_add(1, std::memory_order_relaxed);
+            logger(Category::Info) << "Response found in the result cache";
+            os.write(response->data(), response->size());
+            return;
+        }
+        metrics.query_cache_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
     std::unique_ptr<QueryExecutor> physical_plan;
 
     // declared here because the destruction need to be after calling execute_query_plan
@@ -107,8 +148,11 @@ void Session::execute_query(
         get_query_ctx().start_version = version_scope->start_version;
         get_query_ctx().result_version = version_scope->start_version;
         physical_plan = create_query_physical_plan(*logical_plan, response_type);
+        metrics.parser_duration.observe(parser_duration.count());
+        metrics.optimizer_duration.observe(optimizer_duration.count());
     }
     catch (const QueryParsingException& e) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Error) << "Query Parsing Exception. Line " << e.line << ", col: " << e.column << ": " << e.what();
 
         os << "HTTP/1.1 400 Bad Request\r\n"
@@ -118,6 +162,7 @@ void Session::execute_query(
         return;
     }
     catch (const QueryException& e) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Error) << "Query Exception: " << e.what();
 
         os << "HTTP/1.1 400 Bad Request\r\n"
@@ -126,6 +171,7 @@ void Session::execute_query(
            << std::string(e.what());
     }
     catch (const LogicException& e) {
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Error)  << "Logic Exception: " << e.what();
 
         os << "HTTP/1.1 500 Internal Server Error\r\n"
@@ -139,16 +185,34 @@ void Session::execute_query(
     }
 
     try {
-        execute_query_plan(*physical_plan, os, response_type);
+        if (profile) {
+            execute_query_profile(*physical_plan, os);
+        } else if (!cache_key.empty()) {
+            CaptureBuffer capture_buffer(*os.rdbuf(), server.result_cache.get_max_entry_size());
+            std::ostream capture_os(&capture_buffer);
+            capture_os.exceptions(os.exceptions());
+
+            execute_query_plan(*physical_plan, capture_os, response_type);
+
+            if (capture_buffer.is_complete()) {
+                server.result_cache.insert(cache_key, version_scope->start_version, capture_buffer.get_captured());
+            }
+        } else {
+            execute_query_plan(*physical_plan, os, response_type);
+        }
+        metrics.execution_duration.observe(execution_duration.count());
     }
     catch (const ConnectionException& e) {
         logger(Category::Error) << "Connection Exception: " << e.what();
     }
     catch (const InterruptedException& e) {
         // Handled in execute_query_plan
+        metrics.execution_duration.observe(execution_duration.count());
+        metrics.worker(get_query_ctx().thread_info.worker_index).timeouts.fetch_add(1, std::memory_order_relaxed);
     }
     catch (const QueryExecutionException& e) {
         // Handled in execute_query_plan
+        metrics.query_errors.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
@@ -220,6 +284,7 @@ void Session::execute_update(const std::string& query, std::ostream& os) {
     }
     catch (const InterruptedException& e) {
         execution_duration = std::chrono::system_clock::now() - execution_start;
+        metrics.worker(get_query_ctx().thread_info.worker_index).timeouts.fetch_add(1, std::memory_order_relaxed);
         logger(Category::Info) << "Timeout thrown after "
             << std::chrono::duration_cast<std::chrono::milliseconds>(parser_duration + execution_duration).count()
             << " ms";
@@ -341,6 +406,68 @@ void Session::execute_query_plan(
 }
 
 
+void Session::execute_query_profile(QueryExecutor& physical_plan, std::ostream& os) {
+    // The results are written into a stream without buffer, so they are discarded
+    std::ostream discard_os(nullptr);
+
+    auto& query_profile = get_query_ctx().profile;
+    query_profile.reset(true);
+
+    auto execution_start = std::chrono::system_clock::now();
+    try {
+        auto result_count = physical_plan.execute(discard_os);
+        execution_duration = std::chrono::system_clock::now() - execution_start;
+
+        std::stringstream plan;
+        physical_plan.analyze(plan, true);
+
+        logger.log(Category::ExecutionStats, [&plan](std::ostream& os) {
+            os << plan.str() << '\n';
+        });
+
+        os << "HTTP/1.1 200 OK\r\n"
+           << "Server: MillenniumDB\r\n"
+           << "Content-Type: application/json; charset=utf-8\r\n"
+           << "Access-Control-Allow-Origin: *\r\n"
+           << "Access-Control-Allow-Headers: Origin, X-Requested-With, Content-Type, Accept, Authorization\r\n"
+           << "Access-Control-Allow-Methods: GET, POST\r\n"
+           << "\r\n";
+
+        os << "{\"results\": " << result_count
+           << ", \"parser_duration_ms\": " << parser_duration.count()
+           << ", \"optimizer_duration_ms\": " << optimizer_duration.count()
+           << ", \"execution_duration_ms\": " << execution_duration.count()
+           << ", \"plan\": \"";
+        {
+            JsonOstreamEscape json_escape(os);
+            std::ostream escaped_os(&json_escape);
+            escaped_os << plan.str();
+        }
+        os << "\", \"profile\": ";
+        query_profile.write_json(os);
+        os << "}";
+
+        logger(Category::Info)
+            << "Results: " << result_count << '\n'
+            << "Parser duration:    " << parser_duration.count()    << " ms\n"
+            << "Optimizer duration: " << optimizer_duration.count() << " ms\n"
+            << "Execution duration: " << execution_duration.count() << " ms";
+    }
+    catch (const InterruptedException& e) {
+        execution_duration = std::chrono::system_clock::now() - execution_start;
+        logger(Category::Info) << "Timeout thrown after "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(execution_duration).count()
+            << " ms";
+        throw e;
+    }
+    catch (const QueryExecutionException& e) {
+        execution_duration = std::chrono::system_clock::now() - execution_start;
+        logger(Category::Error) << "\nQuery Execution Exception: " << e.what();
+        throw e;
+    }
+}
+
+
 std::unique_ptr<QueryExecutor> Session::create_query_physical_plan(
     Op& logical_plan,
     ResponseType response_type)
@@ -74,7 +74,8 @@ private:
     void execute_query(
         const std::string& query,
         std::ostream& os,
-        ResponseType response_type
+        ResponseType response_type,
+        bool profile
     );
 
     void execute_query_plan(
@@ -83,6 +84,13 @@ private:
         ResponseType response_type
     );
 
+    // Executes the query with profiling enabled, discarding its results, and responds with the
+    // profile of each operator as JSON
+    void execute_query_profile(
+        QueryExecutor& physical_plan,
+        std::ostream& os
+    );
+
     std::unique_ptr<OpUpdate> create_update_logical_plan(
         const std::string& query
     );
@@ -0,0 +1,59 @@
+#include "binding_iter.h"
+
+namespace {
+// Measures the ticks and counters of one call of a profiled BindingIter. Calls to the children
+// are also accumulated in the parent, so its self counters can be computed
+class ProfileScope {
+public:
+    ProfileScope(IterProfile& profile) :
+        query_profile (get_query_ctx().profile),
+        profile       (profile),
+        parent        (query_profile.current)
+    {
+        query_profile.current = &profile;
+        query_profile.counters.ticks = QueryProfile::read_ticks();
+        start = query_profile.counters;
+    }
+
+    ~ProfileScope() {
+        query_profile.counters.ticks = QueryProfile::read_ticks();
+        profile.inclusive.add_difference(query_profile.counters, start);
+        if (parent != nullptr) {
+            parent->children_inclusive.add_difference(query_profile.counters, start);
+        }
+        query_profile.current = parent;
+    }
+
+private:
+    QueryProfile& query_profile;
+    IterProfile&  profile;
+    IterProfile*  parent;
+
+    ProfileCounters start;
+};
+} // namespace
+
+
+void BindingIter::profiled_begin(Binding& parent_binding) {
+    if (!profile) {
+        profile = std::make_unique<IterProfile>();
+    }
+    auto& query_profile = get_query_ctx().profile;
+    if (query_profile.root == nullptr) {
+        query_profile.root = profile.get();
+    }
+    ProfileScope scope(*profile);
+    _begin(parent_binding);
+}
+
+
+bool BindingIter::profiled_next() {
+    ProfileScope scope(*profile);
+    return _next();
+}
+
+
+void BindingIter::profiled_reset() {
+    ProfileScope scope(*profile);
+    _reset();
+}
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <memory>
+
 #include "query/executor/binding.h"
 #include "query/executor/binding_iter/binding_expr/binding_expr_printer.h"
 #include "query/executor/binding_iter_visitor.h"
+#include "query/query_context.h"
 
+namespace HashJoin {
+class JoinKeyFilter;
+}
 
 // Abstract class
 class BindingIter {
@@ -19,7 +25,9 @@ public:
 
     // Starts with -1 to account for the last next being false
     uint64_t results = 0;
-    // uint64_t elapsed_time;
+
+    // Only created when the query is executed with profiling enabled
+    std::unique_ptr<IterProfile> profile;
 
     virtual ~BindingIter() = default;
 
@@ -27,14 +35,22 @@ public:
     // It will look at the parent_binding to know the value of the assigned variables
     inline void begin(Binding& parent_binding) {
         stat_begin++;
-        _begin(parent_binding);
+        if (get_query_ctx().profile.enabled) {
+            profiled_begin(parent_binding);
+        } else {
+            _begin(parent_binding);
+        }
     }
 
     // Iterator starts again.
     // It will look at the parent_binding to know the value of the assigned variables
     inline void reset() {
         stat_reset++;
-        _reset();
+        if (profile) {
+            profiled_reset();
+        } else {
+            _reset();
+        }
     }
 
     // Returns true if there is a next binding or false otherwise.
@@ -42,7 +58,7 @@ public:
     inline bool next() {
         stat_next++;
 
-        bool result = _next();
+        bool result = profile ? profiled_next() : _next();
         results += static_cast<uint64_t>(result);
         return result;
     }
@@ -50,5 +66,17 @@ public:
     // Every var that the iter sets in the binding when next() returns true is set to null
     virtual void assign_nulls() = 0;
 
+    // Called by a hash join with the filter of the values of `var` in its build side, the results whose
+    // value of `var` is rejected by the filter have no match and the iter may skip them. The filter lives
+    // as long as the join and it is updated each time the join builds its hash table.
+    // Iterators that don't know how to use the filter ignore it.
+    virtual void push_join_filter(VarId /*var*/, const HashJoin::JoinKeyFilter& /*filter*/) { }
+
     virtual void accept_visitor(BindingIterVisitor&) = 0;
+
+private:
+    // Same as _begin, _next and _reset but measuring the time and counters of the call
+    void profiled_begin(Binding& parent_binding);
+    bool profiled_next();
+    void profiled_reset();
 };
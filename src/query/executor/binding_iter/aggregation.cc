@@ -18,6 +18,8 @@ void Aggregation::_begin(Binding& _parent_binding) {
 
 void Aggregation::_reset() {
     this->child->reset();
+    new_group = child->next();
+    groups = 0;
 }
 
 
@@ -0,0 +1,75 @@
+#include "count_all.h"
+
+#include "graph_models/common/conversions.h"
+#include "query/executor/binding_iter/index_scan.h"
+#include "query/executor/binding_iter/leapfrog_join.h"
+
+void CountAll::_begin(Binding& _parent_binding) {
+    parent_binding = &_parent_binding;
+    child_binding = Binding(parent_binding->size);
+
+    child->begin(child_binding);
+    returned = false;
+}
+
+
+void CountAll::_reset() {
+    child->reset();
+    returned = false;
+}
+
+
+bool CountAll::_next() {
+    if (returned) {
+        return false;
+    }
+    // Aggregations without grouping always return exactly one binding
+    returned = true;
+    parent_binding->add(count_var, Common::Conversions::pack_int(count_child()));
+    return true;
+}
+
+
+bool CountAll::is_countable(BindingIter& binding_iter) {
+    return dynamic_cast<LeapfrogJoin*>(&binding_iter) != nullptr
+        || dynamic_cast<IndexScan<1>*>(&binding_iter) != nullptr
+        || dynamic_cast<IndexScan<2>*>(&binding_iter) != nullptr
+        || dynamic_cast<IndexScan<3>*>(&binding_iter) != nullptr
+        || dynamic_cast<IndexScan<4>*>(&binding_iter) != nullptr;
+}
+
+
+uint64_t CountAll::count_child() {
+    if (auto leapfrog_join = dynamic_cast<LeapfrogJoin*>(child.get())) {
+        return leapfrog_join->count();
+    }
+    if (auto index_scan = dynamic_cast<IndexScan<1>*>(child.get())) {
+        return index_scan->count();
+    }
+    if (auto index_scan = dynamic_cast<IndexScan<2>*>(child.get())) {
+        return index_scan->count();
+    }
+    if (auto index_scan = dynamic_cast<IndexScan<3>*>(child.get())) {
+        return index_scan->count();
+    }
+    if (auto index_scan = dynamic_cast<IndexScan<4>*>(child.get())) {
+        return index_scan->count();
+    }
+
+    uint64_t count = 0;
+    while (child->next()) {
+        count++;
+    }
+    return count;
+}
+
+
+void CountAll::assign_nulls() {
+    parent_binding->add(count_var, ObjectId::get_null());
+    child->assign_nulls();
+}
+
+
+void CountAll::accept_visitor(BindingIterVisitor& visitor) {
+    visitor.visit(*this);
+}
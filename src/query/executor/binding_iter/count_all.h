@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+
+#include "query/executor/binding_iter.h"
+
+// Used instead of an Aggregation when COUNT(*) is the only aggregate and there is no grouping.
+// When the child is a LeapfrogJoin or an IndexScan its results are counted without enumerating them,
+// otherwise each binding of the child is counted.
+class CountAll : public BindingIter {
+public:
+    CountAll(
+        std::unique_ptr<BindingIter> child,
+        VarId                        count_var
+    ) :
+        child       (std::move(child)),
+        count_var   (count_var),
+        pushed_down (is_countable(*this->child)) { }
+
+    void _begin(Binding& parent_binding) override;
+    void _reset() override;
+    bool _next() override;
+    void assign_nulls() override;
+
+    void accept_visitor(BindingIterVisitor& visitor) override;
+
+    std::unique_ptr<BindingIter> child;
+
+    const VarId count_var;
+
+    // true if the child supports counting without enumerating its results
+    const bool pushed_down;
+
+    static bool is_countable(BindingIter& binding_iter);
+
+private:
+    Binding* parent_binding;
+    Binding child_binding;
+
+    bool returned;
+
+    uint64_t count_child();
+};
@@ -0,0 +1,66 @@
+#include "distinct_ordered.h"
+
+#include <cstring>
+
+using namespace std;
+
+void DistinctOrdered::_begin(Binding& parent_binding) {
+    this->parent_binding = &parent_binding;
+    child_iter->begin(parent_binding);
+    current_tuple = std::vector<ObjectId>(projected_vars.size());
+    group_tuples.clear();
+}
+
+
+void DistinctOrdered::_reset() {
+    child_iter->reset();
+    group_tuples.clear();
+}
+
+
+bool DistinctOrdered::_next() {
+    while (child_iter->next()) {
+        processed++;
+        // load current objects
+        for (size_t i = 0; i < projected_vars.size(); i++) {
+            current_tuple[i] = (*parent_binding)[projected_vars[i]];
+        }
+        if (current_tuple_distinct()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void DistinctOrdered::assign_nulls() {
+    child_iter->assign_nulls();
+}
+
+
+bool DistinctOrdered::current_tuple_distinct() {
+    const auto tuple_size = current_tuple.size();
+
+    // A tuple that is not equal to the first one of the group starts a new group
+    bool same_group = !group_tuples.empty();
+    for (size_t i = 0; i < tuple_size && same_group; i++) {
+        same_group = compare(current_tuple[i], group_tuples[i]) == 0;
+    }
+    if (!same_group) {
+        group_tuples.assign(current_tuple.begin(), current_tuple.end());
+        return true;
+    }
+
+    for (size_t pos = 0; pos < group_tuples.size(); pos += tuple_size) {
+        if (std::memcmp(&group_tuples[pos], current_tuple.data(), tuple_size * sizeof(ObjectId)) == 0) {
+            return false;
+        }
+    }
+    group_tuples.insert(group_tuples.end(), current_tuple.begin(), current_tuple.end());
+    return true;
+}
+
+
+void DistinctOrdered::accept_visitor(BindingIterVisitor& visitor) {
+    visitor.visit(*this);
+}
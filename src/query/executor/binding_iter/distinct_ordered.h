@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory>
+#include <set>
+
+#include "query/executor/binding_iter.h"
+
+// Removes duplicates from a child whose rows are ordered by the projected vars, so only the tuples
+// equal (according to compare) to the previous one need to be remembered
+class DistinctOrdered : public BindingIter {
+public:
+    DistinctOrdered(
+        std::unique_ptr<BindingIter> child_iter,
+        std::vector<VarId>&&         _projected_vars,
+        int64_t(*_compare)(ObjectId, ObjectId)
+    ) :
+        child_iter     (std::move(child_iter)),
+        projected_vars (std::move(_projected_vars)),
+        compare        (_compare) { }
+
+    // Rows ordered by order_vars have equal projected tuples together if the first
+    // order_vars are exactly the projected vars
+    static bool can_use(const std::vector<VarId>& projected_vars, const std::vector<VarId>& order_vars) {
+        std::set<VarId> projected_set(projected_vars.begin(), projected_vars.end());
+        if (projected_set.empty() || order_vars.size() < projected_set.size())
+            return false;
+        std::set<VarId> order_prefix(order_vars.begin(), order_vars.begin() + projected_set.size());
+        return projected_set == order_prefix;
+    }
+
+    void _begin(Binding& parent_binding) override;
+    void _reset() override;
+    bool _next() override;
+    void assign_nulls() override;
+
+    void accept_visitor(BindingIterVisitor& visitor) override;
+
+    uint64_t processed  = 0;
+    std::unique_ptr<BindingIter> child_iter;
+
+private:
+    std::vector<VarId> projected_vars;
+
+    int64_t(*compare)(ObjectId, ObjectId);
+
+    // Distinct tuples of the current group of equal tuples. Different ObjectIds may be equal
+    // according to compare (e.g. numbers of different types), so the group can have more than one
+    std::vector<ObjectId> group_tuples;
+
+    std::vector<ObjectId> current_tuple;
+    Binding* parent_binding;
+
+    bool current_tuple_distinct();
+};
@@ -38,6 +38,11 @@ void Filter::assign_nulls() {
 }
 
 
+void Filter::push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) {
+    child_iter->push_join_filter(var, filter);
+}
+
+
 void Filter::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
 }
@@ -22,6 +22,7 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) override;
 
     ObjectId(*to_boolean)(ObjectId);
 
@@ -39,6 +39,9 @@ Join<N>::Join(
     // Set chunk index in 0
     key_chunk_index = 0;
 
+    for (size_t i = 0; i < N; i++) {
+        probe_rel->push_join_filter(join_vars[i], key_filters[i]);
+    }
 }
 
 
@@ -57,6 +60,11 @@ Join<N>::~Join() {
 
 template<std::size_t N>
 void Join<N>::_begin(Binding& _parent_binding) {
+    // the children must not use the filters of a previous build
+    for (auto& filter : key_filters) {
+        filter.disable();
+    }
+
     // set hash join in start state, always must be non enumerating_row
     enumerating_rows = nullptr;
 
@@ -70,6 +78,8 @@ void Join<N>::_begin(Binding& _parent_binding) {
     probe_rel->begin(_parent_binding);
 
     build_hash_table();
+    build_key_filters();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -126,6 +136,11 @@ template<std::size_t N>
 void Join<N>::_reset() {
     hash_table.clear();
 
+    // the children must not use the filters of the previous build
+    for (auto& filter : key_filters) {
+        filter.disable();
+    }
+
     // Delete chunks except first to avoid an unnecessary
     // request for space
     for (size_t i = 1; i < data_chunks_dir.size(); i++) {
@@ -162,6 +177,8 @@ void Join<N>::_reset() {
     probe_rel->reset();
 
     build_hash_table();
+    build_key_filters();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -172,6 +189,12 @@ void Join<N>::assign_nulls() {
 }
 
 
+template<std::size_t N>
+void Join<N>::push_join_filter(VarId var, const JoinKeyFilter& filter) {
+    probe_rel->push_join_filter(var, filter);
+}
+
+
 template<std::size_t N>
 void Join<N>::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
@@ -264,6 +287,34 @@ void Join<N>::build_hash_table() {
 }
 
 
+template<std::size_t N>
+void Join<N>::build_key_filters() {
+    for (size_t i = 0; i < N; i++) {
+        key_filters[i].reset(hash_table.size());
+    }
+    if (!key_filters[0].is_enabled()) {
+        return;
+    }
+    for (auto& [key, value] : hash_table) {
+        for (size_t i = 0; i < N; i++) {
+            key_filters[i].insert(key.start[i]);
+        }
+    }
+}
+
+
+
+template<std::size_t N>
+uint64_t Join<N>::memory_in_use() const {
+    auto chunk_ids = data_chunks_dir.size() * (build_vars.size() + 1) + key_chunks_dir.size() * N;
+    auto res = chunk_ids * PPage::SIZE * sizeof(uint64_t)
+             + hash_table.size() * (sizeof(Key<N>) + sizeof(HashJoin::Value));
+    for (auto& filter : key_filters) {
+        res += filter.memory();
+    }
+    return res;
+}
+
 template class HashJoin::BGP::InMemory::Join<2>;
 template class HashJoin::BGP::InMemory::Join<3>;
 template class HashJoin::BGP::InMemory::Join<4>;
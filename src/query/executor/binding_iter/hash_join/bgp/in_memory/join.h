@@ -7,6 +7,7 @@
 #include "query/executor/binding_iter.h"
 #include "query/executor/binding_iter/hash_join/value.h"
 #include "query/executor/binding_iter/hash_join/bgp/base.h"
+#include "query/executor/binding_iter/hash_join/join_key_filter.h"
 
 namespace HashJoin { namespace BGP { namespace InMemory {
 
@@ -26,6 +27,7 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const JoinKeyFilter& filter) override;
 
     // Optimizer decide which relation is probe and which is build
     std::unique_ptr<BindingIter> probe_rel;
@@ -62,6 +64,14 @@ private:
                                    HashJoin::BGP::Hasher<N>> hash_table;
     void build_hash_table();
 
+    // Filters of the values of each join var in the build side, pushed into the probe side
+    std::array<JoinKeyFilter, N> key_filters;
+    void build_key_filters();
+
+    // Approximate bytes used by the chunks, the hash table and the key filters, reported to the query profile
+    uint64_t memory_in_use() const;
+    ProfiledMemory profiled_memory;
+
     // probe key: Avoid to ask for an uint64 array in each next call
     uint64_t pk_start [N];
     uint64_t last_pk_start[N];
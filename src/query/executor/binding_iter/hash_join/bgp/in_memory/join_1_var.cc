@@ -25,6 +25,8 @@ Join1Var::Join1Var(
     data_chunk = new uint64_t[(build_vars.size() + 1) * PPage::SIZE];
     data_chunks_dir.push_back(data_chunk);
     data_chunk_index = 0;
+
+    probe_rel->push_join_filter(join_var, key_filter);
 }
 
 
@@ -37,6 +39,9 @@ Join1Var::~Join1Var() {
 
 
 void Join1Var::_begin(Binding& _parent_binding) {
+    // the children must not use the filter of a previous build
+    key_filter.disable();
+
     // set hash join in start state, always must be non enumerating_row
     enumerating_rows = nullptr;
 
@@ -45,6 +50,8 @@ void Join1Var::_begin(Binding& _parent_binding) {
     probe_rel->begin(_parent_binding);
 
     build_hash_table();
+    build_key_filter();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -75,6 +82,9 @@ bool Join1Var::_next() {
 void Join1Var::_reset() {
     hash_table.clear();
 
+    // the children must not use the filter of the previous build
+    key_filter.disable();
+
     // Delete chunks except first to avoid an unnecessary
     // request for space
     for (size_t i = 1; i < data_chunks_dir.size(); i++) {
@@ -94,6 +104,8 @@ void Join1Var::_reset() {
     probe_rel->reset();
 
     build_hash_table();
+    build_key_filter();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -103,6 +115,11 @@ void Join1Var::assign_nulls() {
 }
 
 
+void Join1Var::push_join_filter(VarId var, const JoinKeyFilter& filter) {
+    probe_rel->push_join_filter(var, filter);
+}
+
+
 void Join1Var::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
 }
@@ -143,3 +160,21 @@ void Join1Var::build_hash_table() {
         }
     }
 }
+
+
+void Join1Var::build_key_filter() {
+    key_filter.reset(hash_table.size());
+    if (!key_filter.is_enabled()) {
+        return;
+    }
+    for (auto& [key, value] : hash_table) {
+        key_filter.insert(key.id);
+    }
+}
+
+
+uint64_t Join1Var::memory_in_use() const {
+    return data_chunks_dir.size() * (build_vars.size() + 1) * PPage::SIZE * sizeof(uint64_t)
+         + hash_table.size() * (sizeof(ObjectId) + sizeof(HashJoin::Value))
+         + key_filter.memory();
+}
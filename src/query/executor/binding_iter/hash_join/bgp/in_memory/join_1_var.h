@@ -7,6 +7,7 @@
 #include "query/executor/binding_iter.h"
 #include "query/executor/binding_iter/hash_join/value.h"
 #include "query/executor/binding_iter/hash_join/bgp/base.h"
+#include "query/executor/binding_iter/hash_join/join_key_filter.h"
 
 namespace HashJoin { namespace BGP { namespace InMemory {
 
@@ -27,6 +28,7 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const JoinKeyFilter& filter) override;
 
     // Optimizer decide which relation is probe and which is build
     std::unique_ptr<BindingIter> probe_rel;
@@ -52,5 +54,13 @@ private:
                               HashJoin::Value,
                               HashJoin::BGP::ObjectIdHasher> hash_table;
     void build_hash_table();
+
+    // Filter of the values of the join var in the build side, pushed into the probe side
+    JoinKeyFilter key_filter;
+    void build_key_filter();
+
+    // Approximate bytes used by the chunks, the hash table and the key filter, reported to the query profile
+    uint64_t memory_in_use() const;
+    ProfiledMemory profiled_memory;
 };
 }}}
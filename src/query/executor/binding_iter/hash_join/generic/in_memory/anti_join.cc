@@ -46,6 +46,7 @@ void AntiJoin::_begin(Binding& _parent_binding) {
     lhs->begin(*lhs_binding);
     rhs->begin(*rhs_binding);
     build_hash_table();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -95,7 +96,7 @@ void AntiJoin::_reset() {
     lhs->reset();
 
     build_hash_table();
-
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -158,3 +159,9 @@ void AntiJoin::build_hash_table() {
     delete[] (dummy_last_key);
     delete[] (key_pointer);
 }
+
+
+uint64_t AntiJoin::memory_in_use() const {
+    return key_chunks_dir.size() * N * PPage::SIZE * sizeof(uint64_t)
+         + hash_table.size() * sizeof(HashJoin::Generic::Key);
+}
@@ -41,6 +41,10 @@ Join::Join(
     // Set chunk index in 0
     key_chunk_index = 0;
 
+    key_filters.resize(N);
+    for (size_t i = 0; i < N; i++) {
+        rhs->push_join_filter(join_vars[i], key_filters[i]);
+    }
 }
 
 
@@ -58,6 +62,11 @@ Join::~Join() {
 
 
 void Join::_begin(Binding& _parent_binding) {
+    // the children must not use the filters of a previous build
+    for (auto& filter : key_filters) {
+        filter.disable();
+    }
+
     // set hash join in start state, always must be non enumerating_row
     enumerating_rows = nullptr;
 
@@ -74,6 +83,8 @@ void Join::_begin(Binding& _parent_binding) {
     rhs->begin(*rhs_binding);
 
     build_hash_table();
+    build_key_filters();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -138,6 +149,11 @@ bool Join::_next() {
 
 
 void Join::_reset() {
+    // the children must not use the filters of the previous build
+    for (auto& filter : key_filters) {
+        filter.disable();
+    }
+
     hash_table.clear();
 
     // Delete chunks except first to avoid an unnecessary
@@ -176,6 +192,8 @@ void Join::_reset() {
     rhs->reset();
 
     build_hash_table();
+    build_key_filters();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -194,6 +212,11 @@ void Join::assign_nulls() {
 }
 
 
+void Join::push_join_filter(VarId var, const JoinKeyFilter& filter) {
+    rhs->push_join_filter(var, filter);
+}
+
+
 void Join::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
 }
@@ -285,3 +308,29 @@ void Join::build_hash_table() {
     delete[](dummy_last_key);
     delete[](start_key);
 }
+
+
+uint64_t Join::memory_in_use() const {
+    auto chunk_ids = data_chunks_dir.size() * (lhs_vars.size() + 1) + key_chunks_dir.size() * N;
+    auto res = chunk_ids * PPage::SIZE * sizeof(uint64_t)
+             + hash_table.size() * (sizeof(HashJoin::Generic::Key) + sizeof(HashJoin::Value));
+    for (auto& filter : key_filters) {
+        res += filter.memory();
+    }
+    return res;
+}
+
+
+void Join::build_key_filters() {
+    for (auto& filter : key_filters) {
+        filter.reset(hash_table.size());
+    }
+    if (N == 0 || !key_filters[0].is_enabled()) {
+        return;
+    }
+    for (auto& [key, value] : hash_table) {
+        for (size_t i = 0; i < N; i++) {
+            key_filters[i].insert(key.start[i]);
+        }
+    }
+}
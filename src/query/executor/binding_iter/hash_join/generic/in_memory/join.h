@@ -8,6 +8,7 @@
 #include "query/executor/binding_iter.h"
 #include "query/executor/binding_iter/hash_join/value.h"
 #include "query/executor/binding_iter/hash_join/generic/base.h"
+#include "query/executor/binding_iter/hash_join/join_key_filter.h"
 
 namespace HashJoin { namespace Generic { namespace InMemory {
 
@@ -28,6 +29,7 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const JoinKeyFilter& filter) override;
 
     // Optimizer decide which relation is rhs and which is lhs
     std::unique_ptr<BindingIter> rhs;
@@ -69,6 +71,14 @@ private:
                               HashJoin::Generic::Hasher> hash_table;
     void build_hash_table();
 
+    // Filters of the values of each join var in the build side, pushed into the rhs
+    std::vector<JoinKeyFilter> key_filters;
+    void build_key_filters();
+
+    // Approximate bytes used by the chunks, the hash table and the key filters, reported to the query profile
+    uint64_t memory_in_use() const;
+    ProfiledMemory profiled_memory;
+
     // rhs key: Avoid to ask for an uint64 array in each next call
     uint64_t* pk_start;
     uint64_t* last_pk_start;
@@ -57,6 +57,7 @@ void LeftJoin::_begin(Binding& _parent_binding) {
     rhs->begin(*rhs_binding);
 
     build_hash_table();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -140,6 +141,7 @@ void LeftJoin::_reset() {
     lhs->reset();
 
     build_hash_table();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -246,3 +248,10 @@ void LeftJoin::build_hash_table() {
     delete[](dummy_last_key);
     delete[](key_pointer);
 }
+
+
+uint64_t LeftJoin::memory_in_use() const {
+    auto chunk_ids = data_chunks_dir.size() * (rhs_vars.size() + 1) + key_chunks_dir.size() * N;
+    return chunk_ids * PPage::SIZE * sizeof(uint64_t)
+         + hash_table.size() * (sizeof(HashJoin::Generic::Key) + sizeof(HashJoin::Value));
+}
@@ -63,6 +63,10 @@ private:
     boost::unordered_flat_map<Key, Value, Hasher> hash_table;
     void build_hash_table();
 
+    // Approximate bytes used by the chunks and the hash table, reported to the query profile
+    uint64_t memory_in_use() const;
+    ProfiledMemory profiled_memory;
+
     // probe key: Avoid to ask for an uint64 array in each next call
     uint64_t* pk_start;
     Key probe_key;
@@ -27,6 +27,11 @@ SemiJoin::SemiJoin(
     key_chunk = new uint64_t[N * PPage::SIZE];
     key_chunks_dir.push_back(key_chunk);
     key_chunk_index = 0;
+
+    key_filters.resize(N);
+    for (size_t i = 0; i < N; i++) {
+        lhs->push_join_filter(join_vars[i], key_filters[i]);
+    }
 }
 
 
@@ -40,6 +45,11 @@ SemiJoin::~SemiJoin() {
 
 
 void SemiJoin::_begin(Binding& _parent_binding) {
+    // the children must not use the filters of a previous build
+    for (auto& filter : key_filters) {
+        filter.disable();
+    }
+
     this->parent_binding = &_parent_binding;
     rhs_binding = make_unique<Binding>(parent_binding->size);
     lhs_binding = make_unique<Binding>(parent_binding->size);
@@ -48,6 +58,8 @@ void SemiJoin::_begin(Binding& _parent_binding) {
     rhs->begin(*rhs_binding);
 
     build_hash_table();
+    build_key_filters();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -72,6 +84,11 @@ bool SemiJoin::_next() {
 
 
 void SemiJoin::_reset() {
+    // the children must not use the filters of the previous build
+    for (auto& filter : key_filters) {
+        filter.disable();
+    }
+
     hash_table.clear();
 
     // Delete chunks except first to avoid an unnecessary
@@ -98,6 +115,8 @@ void SemiJoin::_reset() {
     lhs->reset();
 
     build_hash_table();
+    build_key_filters();
+    profiled_memory.set(get_query_ctx().profile, memory_in_use());
 }
 
 
@@ -116,6 +135,11 @@ void SemiJoin::assign_nulls() {
 }
 
 
+void SemiJoin::push_join_filter(VarId var, const JoinKeyFilter& filter) {
+    lhs->push_join_filter(var, filter);
+}
+
+
 void SemiJoin::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
 }
@@ -151,3 +175,28 @@ void SemiJoin::build_hash_table() {
     }
     delete[](key_pointer);
 }
+
+
+void SemiJoin::build_key_filters() {
+    for (auto& filter : key_filters) {
+        filter.reset(hash_table.size());
+    }
+    if (N == 0 || !key_filters[0].is_enabled()) {
+        return;
+    }
+    for (auto& key : hash_table) {
+        for (size_t i = 0; i < N; i++) {
+            key_filters[i].insert(key.start[i]);
+        }
+    }
+}
+
+
+uint64_t SemiJoin::memory_in_use() const {
+    auto res = key_chunks_dir.size() * N * PPage::SIZE * sizeof(uint64_t)
+             + hash_table.size() * sizeof(HashJoin::Generic::Key);
+    for (auto& filter : key_filters) {
+        res += filter.memory();
+    }
+    return res;
+}
@@ -6,6 +6,7 @@
 
 #include "query/executor/binding_iter.h"
 #include "query/executor/binding_iter/hash_join/generic/base.h"
+#include "query/executor/binding_iter/hash_join/join_key_filter.h"
 
 namespace HashJoin { namespace Generic { namespace InMemory {
 class SemiJoin : public BindingIter {
@@ -25,6 +26,7 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const JoinKeyFilter& filter) override;
 
     std::unique_ptr<BindingIter> lhs;
     std::unique_ptr<BindingIter> rhs;
@@ -48,6 +50,14 @@ private:
     boost::unordered_flat_set<Key, Hasher> hash_table;
     void build_hash_table();
 
+    // Filters of the values of each join var in the build side, pushed into the lhs
+    std::vector<JoinKeyFilter> key_filters;
+    void build_key_filters();
+
+    // Approximate bytes used by the chunks, the hash table and the key filters, reported to the query profile
+    uint64_t memory_in_use() const;
+    ProfiledMemory profiled_memory;
+
     // probe key: Avoid to ask for an uint64 array in each next call
     uint64_t* lhs_key_start;
     Key lhs_key;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+JoinKeyFilter is a split block Bloom filter over the values that a join var takes in the build side of a
+hash join. After building its hash table the join pushes one filter for each join var into the iterators
+of the probe side (see BindingIter::push_join_filter), so they can discard the records without a match
+before assigning them to the binding and passing them through the rest of the probe side.
+
+Each value sets one bit in each of the 8 words of a 256 bit block, so a lookup reads a single cache line.
+A disabled filter (before the hash table is built, or when the build side is too large) accepts every value.
+*/
+
+namespace HashJoin {
+class JoinKeyFilter {
+public:
+    static constexpr uint64_t BITS_PER_KEY = 16;
+
+    // With more distinct keys the filter is not built, it would be too large to be cheaper than probing
+    static constexpr uint64_t MAX_KEYS = 1ULL << 22;
+
+    // Empties the filter and prepares it for `key_count` keys. It is enabled unless there are too many keys
+    void reset(uint64_t key_count) {
+        enabled = key_count <= MAX_KEYS;
+        if (!enabled) {
+            blocks.clear();
+            return;
+        }
+        uint64_t block_count = 1;
+        while (block_count * 256 < key_count * BITS_PER_KEY) {
+            block_count *= 2;
+        }
+        blocks.assign(block_count, Block());
+        block_mask = block_count - 1;
+    }
+
+    void disable() {
+        enabled = false;
+    }
+
+    bool is_enabled() const {
+        return enabled;
+    }
+
+    uint64_t memory() const {
+        return blocks.capacity() * sizeof(Block);
+    }
+
+    void insert(uint64_t key) {
+        auto h = hash(key);
+        auto& block = blocks[(h >> 32) & block_mask];
+        for (int i = 0; i < 8; i++) {
+            block.words[i] |= bit(static_cast<uint32_t>(h), i);
+        }
+    }
+
+    // Returns false only if the key was not inserted
+    bool might_contain(uint64_t key) const {
+        if (!enabled) {
+            return true;
+        }
+        auto h = hash(key);
+        auto& block = blocks[(h >> 32) & block_mask];
+        for (int i = 0; i < 8; i++) {
+            if ((block.words[i] & bit(static_cast<uint32_t>(h), i)) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    struct alignas(32) Block {
+        uint32_t words[8] = { 0 };
+    };
+
+    std::vector<Block> blocks;
+
+    uint64_t block_mask = 0;
+
+    bool enabled = false;
+
+    static uint64_t hash(uint64_t key) {
+        // finalizer of MurmurHash3, the ObjectIds of similar values differ only in their lower bits
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    static uint32_t bit(uint32_t h, int word) {
+        static constexpr uint32_t SALT[8] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        return 1U << ((h * SALT[word]) >> 27);
+    }
+};
+} // namespace HashJoin
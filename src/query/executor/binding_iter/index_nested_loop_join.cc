@@ -48,6 +48,12 @@ void IndexNestedLoopJoin::assign_nulls() {
 }
 
 
+void IndexNestedLoopJoin::push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) {
+    lhs->push_join_filter(var, filter);
+    original_rhs->push_join_filter(var, filter);
+}
+
+
 void IndexNestedLoopJoin::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
 }
@@ -19,6 +19,7 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) override;
 
     std::unique_ptr<BindingIter> lhs;
     std::unique_ptr<BindingIter> original_rhs;
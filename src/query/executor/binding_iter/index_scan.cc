@@ -3,6 +3,7 @@
 #include <cassert>
 #include <vector>
 
+#include "query/executor/binding_iter/hash_join/join_key_filter.h"
 #include "query/var_id.h"
 #include "storage/index/record.h"
 #include "storage/index/bplus_tree/bplus_tree.h"
@@ -33,15 +34,25 @@ void IndexScan<N>::_begin(Binding& parent_binding) {
 
 template <std::size_t N>
 bool IndexScan<N>::_next() {
-    auto next = it.next();
-    if (next != nullptr) {
+    for (auto next = it.next(); next != nullptr; next = it.next()) {
+        bool rejected = false;
+        for (auto& [pos, filter] : join_filters) {
+            if (!filter->might_contain((*next)[pos])) {
+                rejected = true;
+                break;
+            }
+        }
+        if (rejected) {
+            ++join_filtered;
+            continue;
+        }
+
         for (uint_fast32_t i = 0; i < N; ++i) {
             ranges[i]->try_assign(*parent_binding, ObjectId((*next)[i]));
         }
         return true;
-    } else {
-        return false;
     }
+    return false;
 }
 
 
@@ -72,6 +83,17 @@ void IndexScan<N>::assign_nulls() {
 }
 
 
+template <std::size_t N>
+void IndexScan<N>::push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) {
+    for (uint_fast32_t i = 0; i < N; ++i) {
+        if (ranges[i]->assigns(var)) {
+            join_filters.emplace_back(i, &filter);
+            return;
+        }
+    }
+}
+
+
 template <std::size_t N>
 void IndexScan<N>::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
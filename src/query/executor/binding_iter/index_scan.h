@@ -2,6 +2,8 @@
 
 #include <array>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "query/executor/binding_iter.h"
 #include "storage/index/bplus_tree/bplus_tree.h"
@@ -22,9 +24,18 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) override;
+
+    // Returns the number of remaining results without assigning them
+    uint64_t count() { return it.count(); }
 
     // statistics
     uint_fast32_t bpt_searches = 0;
+    uint64_t join_filtered = 0;
+
+    // Filters pushed by hash joins, with the position of the record they check
+    std::vector<std::pair<uint_fast32_t, const HashJoin::JoinKeyFilter*>> join_filters;
+
     std::array<std::unique_ptr<ScanRange>, N> ranges;
 
 private:
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "macros/likely.h"
+#include "query/executor/binding_iter/hash_join/join_key_filter.h"
 #include "query/exceptions.h"
 
 using std::vector;
@@ -29,6 +30,31 @@ void LeapfrogJoin::_begin(Binding& _parent_binding) {
         }
     }
 
+    // initialize enumeration_iters, existential_iters and last_needed_level
+    for (const auto& leapfrog_iter : leapfrog_iters) {
+        bool needed = false;
+        for (const auto& enumeration_var : leapfrog_iter->get_enumeration_vars()) {
+            if (existential_vars.find(enumeration_var) == existential_vars.end()) {
+                needed = true;
+                break;
+            }
+        }
+        if (needed || existential_vars.empty()) {
+            enumeration_iters.push_back(leapfrog_iter.get());
+        } else {
+            existential_iters.push_back(leapfrog_iter.get());
+        }
+    }
+
+    last_needed_level = enumeration_level - 1;
+    if (enumeration_iters.empty()) {
+        while (last_needed_level >= 0
+               && existential_vars.find(var_order[last_needed_level]) != existential_vars.end())
+        {
+            last_needed_level--;
+        }
+    }
+
     // open terms
     bool open_terms = true;
     for (auto& lf_iter : leapfrog_iters) {
@@ -50,54 +76,102 @@ bool LeapfrogJoin::_next() {
     }
 
     while (level >= 0) {
-        while (level < enumeration_level) {
-            // We try to bind the variable for the current level
-            if (find_intersection_for_current_level()) {
-                down();
-            } else {
-                // We are in a previous intersection, so we need to move the last iterator forward
-                // to avoid having the same intersection
-                while (true) {
-                    if (level == 0) {
-                        level = -1; // assign level to -1 so the upcoming calls returns false
-                        return false;
-                    } else {
-                        up();
-                        if (iters_for_var[level][iters_for_var[level].size() - 1]->next()) {
-                            break;
-                        }
-                    }
-                }
-            }
+        if (!reach_enumeration_level()) {
+            return false;
         }
-        assert(level == enumeration_level);
 
-        for (size_t i = 0; i < leapfrog_iters.size(); i++) {
-            if (leapfrog_iters[i]->next_enumeration(*parent_binding)) {
+        if (enumeration_iters.empty()) {
+            if (!existential_match_returned) {
+                existential_match_returned = true;
+                return true;
+            }
+        }
+        for (size_t i = 0; i < enumeration_iters.size(); i++) {
+            if (enumeration_iters[i]->next_enumeration(*parent_binding)) {
                 while (i > 0) {
                     i--;
-                    leapfrog_iters[i]->reset_enumeration();
-                    leapfrog_iters[i]->next_enumeration(*parent_binding);
+                    enumeration_iters[i]->reset_enumeration();
+                    enumeration_iters[i]->next_enumeration(*parent_binding);
                 }
                 return true;
             }
         }
 
-        // when enumeration is over backtrack to previous level (not through up())
-        level--;
+        backtrack_enumeration_level();
+    }
+    return false;
+}
+
+
+uint64_t LeapfrogJoin::count() {
+    count_only = true;
+
+    uint64_t res = 0;
+    while (level >= 0) {
+        if (MDB_unlikely(*leapfrog_iters[0]->interruption_requested)) {
+            throw InterruptedException();
+        }
+        if (!reach_enumeration_level()) {
+            break;
+        }
+
+        // the results of an intersection are the cross product of the enumerations
+        uint64_t combinations = 1;
+        for (auto enumeration_iter : enumeration_iters) {
+            combinations *= enumeration_iter->count_enumeration(*parent_binding);
+        }
+        res += combinations;
 
-        if (iters_for_var.size() == 0) {
-            level = -1; // assign level to -1 so the upcoming calls returns false
-            return false;
+        backtrack_enumeration_level();
+    }
+    return res;
+}
+
+
+bool LeapfrogJoin::reach_enumeration_level() {
+    while (level < enumeration_level) {
+        // We try to bind the variable for the current level
+        if (find_intersection_for_current_level()) {
+            down();
         } else {
             // We are in a previous intersection, so we need to move the last iterator forward
             // to avoid having the same intersection
-            while (level >= 0 && !iters_for_var[level][iters_for_var[level].size() -  1]->next()) {
-                up();
+            while (true) {
+                if (level == 0) {
+                    level = -1; // assign level to -1 so the upcoming calls returns false
+                    return false;
+                } else {
+                    up();
+                    if (iters_for_var[level][iters_for_var[level].size() - 1]->next()) {
+                        break;
+                    }
+                }
             }
         }
     }
-    return false;
+    assert(level == enumeration_level);
+    return true;
+}
+
+
+void LeapfrogJoin::backtrack_enumeration_level() {
+    // when enumeration is over backtrack to previous level (not through up())
+    level--;
+
+    // levels of existential vars don't need to look for other matches
+    while (level > last_needed_level) {
+        up();
+    }
+
+    if (iters_for_var.size() == 0) {
+        level = -1; // assign level to -1 so the upcoming calls returns false
+    } else {
+        // We are in a previous intersection, so we need to move the last iterator forward
+        // to avoid having the same intersection
+        while (level >= 0 && !iters_for_var[level][iters_for_var[level].size() -  1]->next()) {
+            up();
+        }
+    }
 }
 
 
@@ -143,12 +217,20 @@ void LeapfrogJoin::down() {
             }
             iters_for_var[level][j + 1] = aux;
         }
-    } else { // level == enumeration_level
+    } else if (!count_only) { // level == enumeration_level
         // prepare for enumeration phase
-        leapfrog_iters[0]->begin_enumeration();
-        for (uint_fast32_t i = 1; i < leapfrog_iters.size(); i++) {
-            leapfrog_iters[i]->begin_enumeration();
-            leapfrog_iters[i]->next_enumeration(*parent_binding);
+        for (auto existential_iter : existential_iters) {
+            existential_iter->begin_enumeration();
+            existential_iter->next_enumeration(*parent_binding);
+        }
+        existential_match_returned = false;
+
+        if (enumeration_iters.size() > 0) {
+            enumeration_iters[0]->begin_enumeration();
+        }
+        for (uint_fast32_t i = 1; i < enumeration_iters.size(); i++) {
+            enumeration_iters[i]->begin_enumeration();
+            enumeration_iters[i]->next_enumeration(*parent_binding);
         }
     }
 }
@@ -160,32 +242,72 @@ bool LeapfrogJoin::find_intersection_for_current_level() {
     auto min = iters_for_var[level][p]->get_key();
     auto max = iters_for_var[level][iters_for_var[level].size() - 1]->get_key();
 
-    while (min != max) { // min = max means all are equal
-        assert(max > min);
-        if (MDB_unlikely(*leapfrog_iters[0]->interruption_requested)) {
-            throw InterruptedException();
+    while (true) {
+        while (min != max) { // min = max means all are equal
+            assert(max > min);
+            if (MDB_unlikely(*leapfrog_iters[0]->interruption_requested)) {
+                throw InterruptedException();
+            }
+            seeks++;
+            if (iters_for_var[level][p]->seek(max)) {
+                // after the seek, the previous min is the max
+                auto new_max = iters_for_var[level][p]->get_key();
+                assert(new_max >= max);
+                max = new_max;
+
+                // update the min
+                p = (p + 1) % iters_for_var[level].size();
+                auto new_min = iters_for_var[level][p]->get_key();
+                assert(new_min >= min);
+                min = new_min;
+            } else {
+                return false;
+            }
         }
-        seeks++;
-        if (iters_for_var[level][p]->seek(max)) {
-            // after the seek, the previous min is the max
-            auto new_max = iters_for_var[level][p]->get_key();
-            assert(new_max >= max);
-            max = new_max;
-
-            // update the min
-            p = (p + 1) % iters_for_var[level].size();
-            auto new_min = iters_for_var[level][p]->get_key();
-            assert(new_min >= min);
-            min = new_min;
-        } else {
+
+        if (passes_join_filters(min)) {
+            break;
+        }
+
+        // The intersection has no match in a hash join above, skip it without going down.
+        // All the keys are equal, so after moving the last iterator they are still sorted starting at 0
+        join_filtered++;
+        p = 0;
+        if (!iters_for_var[level][iters_for_var[level].size() - 1]->next()) {
             return false;
         }
+        min = iters_for_var[level][0]->get_key();
+        max = iters_for_var[level][iters_for_var[level].size() - 1]->get_key();
     }
     parent_binding->add(var_order[level], ObjectId(min));
     return true;
 }
 
 
+bool LeapfrogJoin::passes_join_filters(uint64_t key) const {
+    if (join_filters.empty()) {
+        return true;
+    }
+    for (auto filter : join_filters[level]) {
+        if (!filter->might_contain(key)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void LeapfrogJoin::push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) {
+    for (int_fast32_t i = 0; i < enumeration_level; i++) {
+        if (var_order[i] == var) {
+            join_filters.resize(enumeration_level);
+            join_filters[i].push_back(&filter);
+            return;
+        }
+    }
+}
+
+
 void LeapfrogJoin::accept_visitor(BindingIterVisitor& visitor) {
     visitor.visit(*this);
 }
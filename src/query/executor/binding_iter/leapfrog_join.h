@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "query/executor/binding_iter.h"
@@ -16,11 +17,13 @@ public:
     LeapfrogJoin(
         std::vector<std::unique_ptr<LeapfrogIter>>&& leapfrog_iters,
         std::vector<VarId>&&                         var_order,
-        int_fast32_t                                 enumeration_level
+        int_fast32_t                                 enumeration_level,
+        std::set<VarId>&&                            existential_vars
     ) :
         leapfrog_iters    (std::move(leapfrog_iters)),
         var_order         (std::move(var_order)),
         enumeration_level (enumeration_level),
+        existential_vars  (std::move(existential_vars)),
         level             (-1) { }
 
     void accept_visitor(BindingIterVisitor& visitor) override;
@@ -28,8 +31,14 @@ public:
     bool _next() override;
     void _reset() override;
     void assign_nulls() override;
+    void push_join_filter(VarId var, const HashJoin::JoinKeyFilter& filter) override;
+
+    // Returns the number of results after begin() without enumerating them, at each intersection
+    // the sizes of the enumerations are multiplied. The join can't be used with next() afterwards
+    uint64_t count();
 
     uint_fast32_t seeks = 0;
+    uint64_t join_filtered = 0;
     std::vector<std::unique_ptr<LeapfrogIter>> leapfrog_iters;
 
     // At first it contains variables from intersection_vars
@@ -38,6 +47,10 @@ public:
 
     const int_fast32_t enumeration_level;
 
+    // Variables whose values are not needed (e.g. not projected by a DISTINCT), only one
+    // of their matches is returned for each combination of the other variables
+    const std::set<VarId> existential_vars;
+
 private:
     Binding* parent_binding;
 
@@ -48,7 +61,32 @@ private:
     // iters_for_var[i] is a list of (not-null) pointers of iterators for the variable at var_order[base_level+i].
     std::vector<std::vector<LeapfrogIter*>> iters_for_var;
 
+    // Iterators with a needed enumeration var, the others enumerate only their first match
+    std::vector<LeapfrogIter*> enumeration_iters;
+    std::vector<LeapfrogIter*> existential_iters;
+
+    // Deepest level of a needed intersection var. After a match the deeper levels are not explored
+    // if there are no enumeration_iters, because they would only produce different existential vars
+    int_fast32_t last_needed_level;
+
+    // Used when there are no enumeration_iters, true if the current intersection was already returned
+    bool existential_match_returned;
+
+    // Set by count(), the enumeration phase is not prepared
+    bool count_only = false;
+
+    // join_filters[level] are the filters pushed by hash joins for the intersection var of that level
+    std::vector<std::vector<const HashJoin::JoinKeyFilter*>> join_filters;
+
     void up();
     void down();
     bool find_intersection_for_current_level();
+
+    bool passes_join_filters(uint64_t key) const;
+
+    // Moves down until all the intersection vars are bound, returns false if there are no more intersections
+    bool reach_enumeration_level();
+
+    // Moves to the next intersection after the enumeration of the current one is over
+    void backtrack_enumeration_level();
 };
@@ -0,0 +1,124 @@
+#include "memoize.h"
+
+#include <set>
+
+void Memoize::_begin(Binding& _parent_binding) {
+    parent_binding = &_parent_binding;
+    child->begin(*parent_binding);
+
+    lookup_pending = true;
+}
+
+
+void Memoize::_reset() {
+    lookup_pending = true;
+}
+
+
+bool Memoize::_next() {
+    if (lookup_pending) {
+        lookup();
+        lookup_pending = false;
+    }
+
+    if (current_row < current_row_count) {
+        auto row = &(*current_values)[current_row * output_vars.size()];
+        for (size_t i = 0; i < output_vars.size(); i++) {
+            parent_binding->add(output_vars[i], row[i]);
+        }
+        current_row++;
+        return true;
+    }
+
+    if (streaming) {
+        return child->next();
+    }
+    return false;
+}
+
+
+void Memoize::lookup() {
+    Key key(key_vars.size());
+    for (size_t i = 0; i < key_vars.size(); i++) {
+        key[i] = (*parent_binding)[key_vars[i]];
+    }
+
+    current_row = 0;
+    streaming = false;
+
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        cache_hits++;
+        lru.splice(lru.begin(), lru, it->second);
+        current_values    = &it->second->values;
+        current_row_count = it->second->row_count;
+        return;
+    }
+
+    cache_misses++;
+    // the child may have begun before the key values were assigned, reset it so it reads them
+    child->reset();
+
+    pending.key = std::move(key);
+    if (materialize()) {
+        const uint64_t entry_ids = pending.key.size() + pending.values.size();
+        while (cached_ids + entry_ids > MAX_CACHED_IDS) {
+            auto& evicted = lru.back();
+            const uint64_t evicted_ids = evicted.key.size() + evicted.values.size();
+            cached_ids -= evicted_ids;
+            entries.erase(evicted.key);
+            lru.pop_back();
+        }
+        lru.push_front(std::move(pending));
+        entries.emplace(lru.front().key, lru.begin());
+        cached_ids += entry_ids;
+        cached_memory.set(get_query_ctx().profile, cached_ids * sizeof(ObjectId));
+
+        current_values    = &lru.front().values;
+        current_row_count = lru.front().row_count;
+        pending = Entry();
+    } else {
+        streaming         = true;
+        current_values    = &pending.values;
+        current_row_count = pending.row_count;
+    }
+}
+
+
+bool Memoize::materialize() {
+    pending.values.clear();
+    pending.row_count = 0;
+
+    std::set<std::vector<ObjectId>> distinct_rows;
+    std::vector<ObjectId> row(output_vars.size());
+
+    while (pending.key.size() + pending.values.size() + output_vars.size() <= MAX_CACHED_IDS) {
+        if (!keep_duplicates && output_vars.empty() && pending.row_count == 1) {
+            return true;
+        }
+        if (!child->next()) {
+            return true;
+        }
+        for (size_t i = 0; i < output_vars.size(); i++) {
+            row[i] = (*parent_binding)[output_vars[i]];
+        }
+        if (!keep_duplicates && !output_vars.empty() && !distinct_rows.insert(row).second) {
+            continue;
+        }
+        pending.values.insert(pending.values.end(), row.begin(), row.end());
+        pending.row_count++;
+    }
+    return false;
+}
+
+
+void Memoize::assign_nulls() {
+    for (auto var : output_vars) {
+        parent_binding->add(var, ObjectId::get_null());
+    }
+}
+
+
+void Memoize::accept_visitor(BindingIterVisitor& visitor) {
+    visitor.visit(*this);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "query/executor/binding_iter.h"
+#include "query/query_profile.h"
+#include "storage/index/hash/key_value_hash/key_value_pair_hasher.h"
+
+/* Memoize wraps a child that is reset many times, like a sub-select or the right side of a nested
+ * loop semi/anti join, and caches its results keyed by the values of key_vars (the variables the
+ * child receives from its parent). Outer bindings that repeat the same key values replay the
+ * cached rows instead of executing the child again.
+ *
+ * The cache keeps at most MAX_CACHED_IDS ObjectIds, evicting the least recently used keys. When the
+ * results of a key don't fit they are not cached, the rows read so far are returned and then the
+ * child continues normally.
+ *
+ * If keep_duplicates is false only distinct rows are cached, it must be used only when the parent
+ * doesn't depend on the multiplicity of the results (semi and anti joins). In that case if there
+ * are no output_vars only the first result of the child is needed.
+ */
+class Memoize : public BindingIter {
+public:
+    static constexpr uint64_t MAX_CACHED_IDS = 1024 * 1024;
+
+    Memoize(
+        std::unique_ptr<BindingIter> child,
+        std::vector<VarId>&&         key_vars,
+        std::vector<VarId>&&         output_vars,
+        bool                         keep_duplicates
+    ) :
+        child           (std::move(child)),
+        key_vars        (std::move(key_vars)),
+        output_vars     (std::move(output_vars)),
+        keep_duplicates (keep_duplicates) { }
+
+    void _begin(Binding& parent_binding) override;
+    void _reset() override;
+    bool _next() override;
+    void assign_nulls() override;
+
+    void accept_visitor(BindingIterVisitor& visitor) override;
+
+    std::unique_ptr<BindingIter> child;
+
+    const std::vector<VarId> key_vars;
+    const std::vector<VarId> output_vars;
+    const bool keep_duplicates;
+
+    // statistics
+    uint64_t cache_hits   = 0;
+    uint64_t cache_misses = 0;
+
+private:
+    using Key = std::vector<ObjectId>;
+
+    struct Entry {
+        Key key;
+
+        // output_vars.size() values for each row
+        std::vector<ObjectId> values;
+        uint64_t row_count;
+    };
+
+    // most recently used first
+    std::list<Entry> lru;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyValuePairHasher> entries;
+    uint64_t cached_ids = 0;
+
+    // Bytes of the cached ObjectIds reported to the query profile
+    ProfiledMemory cached_memory;
+
+    Binding* parent_binding;
+
+    // the lookup is done in the first next() after begin() or reset(),
+    // parents may begin their child before assigning the key values
+    bool lookup_pending;
+
+    // rows of the current key that are being returned
+    const std::vector<ObjectId>* current_values;
+    uint64_t current_row_count;
+    uint64_t current_row;
+
+    // used when the results of the current key don't fit in the cache
+    Entry pending;
+
+    // true if after returning the current rows the next results come from the child
+    bool streaming;
+
+    void lookup();
+
+    // returns false if the results of the child don't fit in the cache
+    bool materialize();
+};
@@ -71,6 +71,7 @@ void OrderBy::_begin(Binding& _parent_binding) {
 void OrderBy::_reset() {
     current_page = 0;
     page_position = 0;
+    run = get_run(buffer_manager.get_ppage(*output_file_id, 0));
 }
 
 
@@ -0,0 +1,37 @@
+#include "index_check.h"
+
+using namespace Paths::Reachability;
+
+void IndexCheck::_begin(Binding& _parent_binding) {
+    parent_binding = &_parent_binding;
+    first_next = true;
+}
+
+
+void IndexCheck::_reset() {
+    first_next = true;
+}
+
+
+bool IndexCheck::_next() {
+    if (!first_next) {
+        return false;
+    }
+    first_next = false;
+
+    ObjectId start_object_id = start.is_var() ? (*parent_binding)[start.get_var()] : start.get_OID();
+    ObjectId end_object_id   = end.is_var()   ? (*parent_binding)[end.get_var()]   : end.get_OID();
+
+    idx_searches++;
+    if (index.reaches(start_object_id.id, end_object_id.id, inverse, plus)) {
+        // the index doesn't know the edges of the path
+        parent_binding->add(path_var, ObjectId::get_null());
+        return true;
+    }
+    return false;
+}
+
+
+void IndexCheck::accept_visitor(BindingIterVisitor& visitor) {
+    visitor.visit(*this);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "query/executor/binding_iter.h"
+#include "storage/index/reachability/reachability_index.h"
+
+namespace Paths { namespace Reachability {
+
+/*
+IndexCheck checks if there's a path `P*` or `P+` between two fixed nodes, using the ReachabilityIndex of P.
+*/
+class IndexCheck : public BindingIter {
+private:
+    // Attributes determined in the constructor
+    VarId path_var;
+    Id    start;
+    Id    end;
+    const ReachabilityIndex& index;
+    bool  inverse;
+    bool  plus;
+
+    // where the results will be written, determined in begin()
+    Binding* parent_binding;
+
+    // true in the first call of next() and after a reset()
+    bool first_next = true;
+
+public:
+    // Statistics
+    uint_fast32_t idx_searches = 0;
+
+    IndexCheck(
+        VarId                    path_var,
+        Id                       start,
+        Id                       end,
+        const ReachabilityIndex& index,
+        bool                     inverse,
+        bool                     plus
+    ) :
+        path_var (path_var),
+        start    (start),
+        end      (end),
+        index    (index),
+        inverse  (inverse),
+        plus     (plus) { }
+
+    void accept_visitor(BindingIterVisitor& visitor) override;
+    void _begin(Binding& parent_binding) override;
+    bool _next() override;
+    void _reset() override;
+
+    void assign_nulls() override {
+        parent_binding->add(path_var, ObjectId::get_null());
+    }
+};
+}} // namespace Paths::Reachability
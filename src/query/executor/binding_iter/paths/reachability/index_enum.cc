@@ -0,0 +1,37 @@
+#include "index_enum.h"
+
+using namespace Paths::Reachability;
+
+void IndexEnum::_begin(Binding& _parent_binding) {
+    parent_binding = &_parent_binding;
+    first_next = true;
+}
+
+
+void IndexEnum::_reset() {
+    first_next = true;
+}
+
+
+bool IndexEnum::_next() {
+    if (first_next) {
+        first_next = false;
+
+        ObjectId start_object_id = start.is_var() ? (*parent_binding)[start.get_var()] : start.get_OID();
+        reached = index.get_reached(start_object_id.id, inverse, plus);
+        idx_searches++;
+    }
+
+    if (reached.next()) {
+        parent_binding->add(end, ObjectId(reached.get()));
+        // the index doesn't know the edges of the path
+        parent_binding->add(path_var, ObjectId::get_null());
+        return true;
+    }
+    return false;
+}
+
+
+void IndexEnum::accept_visitor(BindingIterVisitor& visitor) {
+    visitor.visit(*this);
+}
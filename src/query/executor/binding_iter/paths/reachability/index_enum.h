@@ -0,0 +1,60 @@
+#pragma once
+
+#include "query/executor/binding_iter.h"
+#include "storage/index/reachability/reachability_index.h"
+
+namespace Paths { namespace Reachability {
+
+/*
+IndexEnum returns all the nodes reachable from a starting node through `P*` or `P+`, using the
+ReachabilityIndex of P. Each node is returned once, as BFS does with the default path semantic.
+*/
+class IndexEnum : public BindingIter {
+private:
+    // Attributes determined in the constructor
+    VarId path_var;
+    Id    start;
+    VarId end;
+    const ReachabilityIndex& index;
+    bool  inverse;
+    bool  plus;
+
+    // where the results will be written, determined in begin()
+    Binding* parent_binding;
+
+    // Nodes reached from the start, the iterator is obtained in the first call of next()
+    ReachabilityIndex::ReachedIter reached;
+
+    // true in the first call of next() and after a reset()
+    bool first_next = true;
+
+public:
+    // Statistics
+    uint_fast32_t idx_searches = 0;
+
+    IndexEnum(
+        VarId                    path_var,
+        Id                       start,
+        VarId                    end,
+        const ReachabilityIndex& index,
+        bool                     inverse,
+        bool                     plus
+    ) :
+        path_var (path_var),
+        start    (start),
+        end      (end),
+        index    (index),
+        inverse  (inverse),
+        plus     (plus) { }
+
+    void accept_visitor(BindingIterVisitor& visitor) override;
+    void _begin(Binding& parent_binding) override;
+    bool _next() override;
+    void _reset() override;
+
+    void assign_nulls() override {
+        parent_binding->add(end, ObjectId::get_null());
+        parent_binding->add(path_var, ObjectId::get_null());
+    }
+};
+}} // namespace Paths::Reachability
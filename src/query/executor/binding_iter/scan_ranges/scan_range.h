@@ -16,6 +16,9 @@ public:
     virtual void try_assign(Binding& binding, ObjectId) = 0;
     virtual void print(std::ostream& os) const = 0;
 
+    // Returns true if the range assigns `var` in try_assign()
+    virtual bool assigns(VarId /*var*/) const { return false; }
+
     static std::unique_ptr<ScanRange> get(Id id, bool assigned);
     static std::unique_ptr<ScanRange> get(ObjectId id);
 };
@@ -26,4 +26,8 @@ public:
     void try_assign(Binding& binding, ObjectId obj_id) override {
         binding.add(var, obj_id);
     }
+
+    bool assigns(VarId _var) const override {
+        return var == _var;
+    }
 };
@@ -3,6 +3,7 @@
 #include "query/executor/binding_iter.h"
 #include "query/executor/binding_iters.h"
 #include "query/parser/op/op.h"
+#include "storage/index/tensor_store/lsh/binding_iters/filtered_index_top_k.h"
 #include "storage/index/tensor_store/lsh/binding_iters/forest_index_top_k.h"
 #include "storage/index/tensor_store/lsh/binding_iters/forest_index_top_all.h"
 #include "storage/index/tensor_store/lsh/binding_iters/project_tensor_similarity.h"
@@ -11,6 +12,7 @@
 
 class BindingIterPrinterHelper {
     BindingIterPrinter& printer;
+    IterProfile*        parent_profile;
 
 public:
     BindingIterPrinterHelper(
@@ -19,7 +21,8 @@ public:
         BindingIter&        binding_iter,
         const std::string   stats = ""
     ) :
-        printer(printer)
+        printer        (printer),
+        parent_profile (printer.parent_profile)
     {
         if (printer.print_stats) {
             printer.os << std::string(printer.indent, ' ');
@@ -30,16 +33,54 @@ public:
             if (stats != "") {
                 printer.os << ", " << stats;
             }
+            if (binding_iter.profile) {
+                print_profile(binding_iter);
+            }
             printer.os << "]\n";
         }
 
         printer.os << std::string(printer.indent, ' ') << name << '(';
 
         printer.indent += 2;
+
+        // Link the profiles with the operator names so they can be written as JSON
+        if (binding_iter.profile) {
+            auto& profile = *binding_iter.profile;
+            profile.name = name;
+            profile.children.clear();
+            profile.stat_begin = binding_iter.stat_begin;
+            profile.stat_next  = binding_iter.stat_next;
+            profile.stat_reset = binding_iter.stat_reset;
+            profile.results    = binding_iter.results;
+            if (parent_profile != nullptr) {
+                parent_profile->children.push_back(&profile);
+            }
+            printer.parent_profile = &profile;
+        }
     }
 
     ~BindingIterPrinterHelper() {
         printer.indent -= 2;
+        printer.parent_profile = parent_profile;
+    }
+
+private:
+    void print_profile(BindingIter& binding_iter) {
+        auto& query_profile = get_query_ctx().profile;
+        auto& profile = *binding_iter.profile;
+        auto self = profile.self();
+
+        printer.os << ", time: " << query_profile.ticks_to_ms(profile.inclusive.ticks) << " ms";
+        printer.os << ", self time: " << query_profile.ticks_to_ms(self.ticks) << " ms";
+        printer.os << ", page hits: " << self.page_hits;
+        printer.os << ", page misses: " << self.page_misses;
+        printer.os << ", page reads: " << self.page_reads;
+        if (self.tmp_bytes_written > 0) {
+            printer.os << ", tmp bytes written: " << self.tmp_bytes_written;
+        }
+        if (profile.peak_memory > 0) {
+            printer.os << ", peak memory: " << profile.peak_memory;
+        }
     }
 };
 
@@ -164,6 +205,16 @@ void BindingIterPrinter::visit(DistinctHash& binding_iter) {
 }
 
 
+void BindingIterPrinter::visit(DistinctOrdered& binding_iter) {
+    std::stringstream ss;
+    ss << "processed: " << binding_iter.processed;
+    auto helper = BindingIterPrinterHelper("DistinctOrdered", *this, binding_iter, ss.str());
+
+    os << ")\n";
+    binding_iter.child_iter->accept_visitor(*this);
+}
+
+
 void BindingIterPrinter::visit(EdgeTableLookup& binding_iter) {
     std::stringstream ss;
     ss << "lookups: " << binding_iter.lookups;
@@ -261,6 +312,9 @@ template <size_t N>
 void BindingIterPrinter::print_index_scan(IndexScan<N>& binding_iter) {
     std::stringstream ss;
     ss << "bpt_searches: " << binding_iter.bpt_searches;
+    if (!binding_iter.join_filters.empty()) {
+        ss << ", join_filtered: " << binding_iter.join_filtered;
+    }
     auto helper = BindingIterPrinterHelper("IndexScan", *this, binding_iter, ss.str());
 
     os  << "ranges:";
@@ -295,6 +349,9 @@ void BindingIterPrinter::visit(IndexScan<4>& binding_iter) {
 void BindingIterPrinter::visit(LeapfrogJoin& binding_iter) {
     std::stringstream ss;
     ss << "seeks: " << binding_iter.seeks;
+    if (binding_iter.join_filtered > 0) {
+        ss << ", join_filtered: " << binding_iter.join_filtered;
+    }
     auto helper = BindingIterPrinterHelper("LeapfrogJoin", *this, binding_iter, ss.str());
 
     if (binding_iter.enumeration_level > 0) {
@@ -303,6 +360,12 @@ void BindingIterPrinter::visit(LeapfrogJoin& binding_iter) {
     for (int i = 1; i < binding_iter.enumeration_level; i++) {
         os << ", ?" << get_query_ctx().get_var_name(binding_iter.var_order[i]);
     }
+    if (binding_iter.existential_vars.size() > 0) {
+        os << "; existential:";
+        for (auto& var : binding_iter.existential_vars) {
+            os << " ?" << get_query_ctx().get_var_name(var);
+        }
+    }
 
     os << ")\n";
 
@@ -347,6 +410,27 @@ void BindingIterPrinter::visit(NestedLoopAntiJoin<true>& binding_iter) {
 }
 
 
+void BindingIterPrinter::visit(Memoize& binding_iter) {
+    std::stringstream ss;
+    ss << "cache_hits: " << binding_iter.cache_hits << ", cache_misses: " << binding_iter.cache_misses;
+    auto helper = BindingIterPrinterHelper("Memoize", *this, binding_iter, ss.str());
+
+    os << "key_vars:";
+    for (auto& var : binding_iter.key_vars) {
+        os << " ?" << get_query_ctx().get_var_name(var);
+    }
+    os << ", output_vars:";
+    for (auto& var : binding_iter.output_vars) {
+        os << " ?" << get_query_ctx().get_var_name(var);
+    }
+    if (!binding_iter.keep_duplicates) {
+        os << ", distinct";
+    }
+    os << ")\n";
+    binding_iter.child->accept_visitor(*this);
+}
+
+
 void BindingIterPrinter::visit(NestedLoopJoin& binding_iter) {
     auto helper = BindingIterPrinterHelper("NestedLoopJoin", *this, binding_iter);
     print_join(binding_iter.parent_safe_vars,
@@ -582,6 +666,18 @@ void BindingIterPrinter::visit(Values& binding_iter) {
 }
 
 
+void BindingIterPrinter::visit(CountAll& binding_iter) {
+    auto helper = BindingIterPrinterHelper("CountAll", *this, binding_iter);
+
+    os << '?' << get_query_ctx().get_var_name(binding_iter.count_var) << "=COUNT(*)";
+    if (binding_iter.pushed_down) {
+        os << ", pushed down";
+    }
+    os << ")\n";
+    binding_iter.child->accept_visitor(*this);
+}
+
+
 void BindingIterPrinter::visit(CrossProduct& binding_iter) {
     auto helper = BindingIterPrinterHelper("CrossProduct", *this, binding_iter);
     os << ")\n";
@@ -1111,6 +1207,33 @@ void BindingIterPrinter::visit(Paths::AnyTrails::DFSEnum& binding_iter) {
 }
 
 
+void BindingIterPrinter::visit(Paths::Reachability::IndexCheck& binding_iter) {
+    std::stringstream ss;
+    ss << "idx_searches: " << binding_iter.idx_searches;
+    auto helper = BindingIterPrinterHelper("Paths::Reachability::IndexCheck", *this, binding_iter, ss.str());
+    os << ")\n";
+}
+
+
+void BindingIterPrinter::visit(Paths::Reachability::IndexEnum& binding_iter) {
+    std::stringstream ss;
+    ss << "idx_searches: " << binding_iter.idx_searches;
+    auto helper = BindingIterPrinterHelper("Paths::Reachability::IndexEnum", *this, binding_iter, ss.str());
+    os << ")\n";
+}
+
+
+void BindingIterPrinter::visit(LSH::FilteredIndexTopK& binding_iter) {
+    auto helper = BindingIterPrinterHelper("FilteredIndexTopK", *this, binding_iter);
+    os << "object: ?" << get_query_ctx().get_var_name(binding_iter.object_var);
+    os << ", similarity: ?" << get_query_ctx().get_var_name(binding_iter.similarity_var);
+    os << ", tensor_store: " << binding_iter.tensor_store.name;
+    os << ", k: " << binding_iter.k;
+    os << ")\n";
+    binding_iter.child_iter->accept_visitor(*this);
+}
+
+
 void BindingIterPrinter::visit(LSH::ForestIndexTopK& binding_iter) {
     auto helper = BindingIterPrinterHelper("ForestIndexTopK", *this, binding_iter);
     os << "object: ?" << get_query_ctx().get_var_name(binding_iter.object_var);
@@ -17,6 +17,9 @@ private:
     bool print_stats;
     int indent;
 
+    // Profile of the iter being printed, used to link the profiles of its children
+    IterProfile* parent_profile = nullptr;
+
 public:
     BindingIterPrinter(std::ostream& os, bool print_stats, int indent) :
         os(os), print_stats(print_stats), indent(indent) { }
@@ -34,8 +37,10 @@ public:
 
     virtual void visit(Aggregation&)               override;
     virtual void visit(Bind&)                      override;
+    virtual void visit(CountAll&)                  override;
     virtual void visit(CrossProduct&)              override;
     virtual void visit(DistinctHash&)              override;
+    virtual void visit(DistinctOrdered&)           override;
     virtual void visit(EdgeTableLookup&)           override;
     virtual void visit(EmptyBindingIter&)          override;
     virtual void visit(Filter&)                    override;
@@ -47,6 +52,7 @@ public:
     virtual void visit(IndexScan<3>&)              override;
     virtual void visit(IndexScan<4>&)              override;
     virtual void visit(LeapfrogJoin&)              override;
+    virtual void visit(Memoize&)                   override;
     virtual void visit(NestedLoopAntiJoin<false>&) override;
     virtual void visit(NestedLoopAntiJoin<true>&)  override;
     virtual void visit(NestedLoopJoin&)            override;
@@ -127,7 +133,10 @@ public:
     virtual void visit(Paths::AnyTrails::BFSEnum&)                 override;
     virtual void visit(Paths::AnyTrails::DFSCheck&)                override;
     virtual void visit(Paths::AnyTrails::DFSEnum&)                 override;
+    virtual void visit(Paths::Reachability::IndexCheck&)           override;
+    virtual void visit(Paths::Reachability::IndexEnum&)            override;
 
+    virtual void visit(LSH::FilteredIndexTopK&) override;
     virtual void visit(LSH::ForestIndexTopK&)   override;
     virtual void visit(LSH::ForestIndexTopAll&) override;
     virtual void visit(LSH::ProjectTensorSimilarity&) override;
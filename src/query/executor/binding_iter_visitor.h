@@ -5,8 +5,10 @@
 
 class Aggregation;
 class Bind;
+class CountAll;
 class CrossProduct;
 class DistinctHash;
+class DistinctOrdered;
 class EdgeTableLookup;
 class EmptyBindingIter;
 class Filter;
@@ -14,6 +16,7 @@ class IndexLeftOuterJoin;
 class IndexNestedLoopJoin;
 template <std::size_t> class IndexScan;
 class LeapfrogJoin;
+class Memoize;
 template<bool> class NestedLoopAntiJoin;
 class NestedLoopJoin;
 class NestedLoopLeftJoin;
@@ -37,6 +40,7 @@ class HashJoinInMemory;
 class LeftCrossProduct;
 
 namespace LSH {
+class FilteredIndexTopK;
 class ForestIndexTopK;
 class ForestIndexTopAll;
 class ProjectTensorSimilarity;
@@ -124,6 +128,10 @@ namespace Paths {
         class DFSCheck;
         class DFSEnum;
     }
+    namespace Reachability {
+        class IndexCheck;
+        class IndexEnum;
+    }
 } // namespace Paths
 
 
@@ -131,8 +139,10 @@ class BindingIterVisitor {
 public:
     virtual void visit(Aggregation&)               = 0;
     virtual void visit(Bind&)                      = 0;
+    virtual void visit(CountAll&)                  = 0;
     virtual void visit(CrossProduct&)              = 0;
     virtual void visit(DistinctHash&)              = 0;
+    virtual void visit(DistinctOrdered&)           = 0;
     virtual void visit(EdgeTableLookup&)           = 0;
     virtual void visit(EmptyBindingIter&)          = 0;
     virtual void visit(Filter&)                    = 0;
@@ -144,6 +154,7 @@ public:
     virtual void visit(IndexScan<3>&)              = 0;
     virtual void visit(IndexScan<4>&)              = 0;
     virtual void visit(LeapfrogJoin&)              = 0;
+    virtual void visit(Memoize&)                   = 0;
     virtual void visit(NestedLoopAntiJoin<false>&) = 0;
     virtual void visit(NestedLoopAntiJoin<true>&)  = 0;
     virtual void visit(NestedLoopJoin&)            = 0;
@@ -225,7 +236,10 @@ public:
     virtual void visit(Paths::AnyTrails::BFSEnum&)                 = 0;
     virtual void visit(Paths::AnyTrails::DFSCheck&)                = 0;
     virtual void visit(Paths::AnyTrails::DFSEnum&)                 = 0;
+    virtual void visit(Paths::Reachability::IndexCheck&)           = 0;
+    virtual void visit(Paths::Reachability::IndexEnum&)            = 0;
 
+    virtual void visit(LSH::FilteredIndexTopK&) = 0;
     virtual void visit(LSH::ForestIndexTopK&) = 0;
     virtual void visit(LSH::ForestIndexTopAll&) = 0;
     virtual void visit(LSH::ProjectTensorSimilarity&) = 0;
@@ -1,7 +1,9 @@
 #include "query/executor/binding_iter/aggregation.h"
 #include "query/executor/binding_iter/bind.h"
+#include "query/executor/binding_iter/count_all.h"
 #include "query/executor/binding_iter/cross_product.h"
 #include "query/executor/binding_iter/distinct_hash.h"
+#include "query/executor/binding_iter/distinct_ordered.h"
 #include "query/executor/binding_iter/edge_table_lookup.h"
 #include "query/executor/binding_iter/empty_binding_iter.h"
 #include "query/executor/binding_iter/expr_evaluator.h"
@@ -10,6 +12,7 @@
 #include "query/executor/binding_iter/index_nested_loop_join.h"
 #include "query/executor/binding_iter/index_scan.h"
 #include "query/executor/binding_iter/leapfrog_join.h"
+#include "query/executor/binding_iter/memoize.h"
 #include "query/executor/binding_iter/nested_loop_anti_join.h"
 #include "query/executor/binding_iter/nested_loop_join.h"
 #include "query/executor/binding_iter/nested_loop_left_join.h"
@@ -70,4 +73,6 @@
 #include "query/executor/binding_iter/paths/experimental/bfs_rdpq_enum.h"
 #include "query/executor/binding_iter/paths/experimental/dijkstra_check.h"
 #include "query/executor/binding_iter/paths/experimental/dijkstra_enum.h"
+#include "query/executor/binding_iter/paths/reachability/index_check.h"
+#include "query/executor/binding_iter/paths/reachability/index_enum.h"
 #include "query/executor/binding_iter/paths/unfixed_composite.h"
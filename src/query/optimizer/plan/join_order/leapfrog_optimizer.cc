@@ -11,7 +11,8 @@ using namespace std;
 
 unique_ptr<BindingIter> LeapfrogOptimizer::try_get_iter_without_assigned(
     const vector<unique_ptr<Plan>>& base_plans,
-    const size_t binding_size)
+    const size_t binding_size,
+    const set<VarId>& existential_vars)
 {
     map<VarId, vector<Plan*>> var2plans;
     set<VarId> intersection_vars;
@@ -239,14 +240,16 @@ begin_while:
     return make_unique<LeapfrogJoin>(
         std::move(leapfrog_iters),
         std::move(var_order),
-        enumeration_level
+        enumeration_level,
+        set<VarId>(existential_vars)
     );
 }
 
 
 unique_ptr<BindingIter> LeapfrogOptimizer::try_get_iter_with_assigned(
     const vector<unique_ptr<Plan>>& base_plans,
-    const size_t binding_size)
+    const size_t binding_size,
+    const set<VarId>& existential_vars)
 {
     map<VarId, vector<Plan*>> var2plans;
     map<VarId, pair<double, std::size_t>> var2cost;
@@ -353,6 +356,7 @@ unique_ptr<BindingIter> LeapfrogOptimizer::try_get_iter_with_assigned(
     return make_unique<LeapfrogJoin>(
         std::move(leapfrog_iters),
         std::move(var_order),
-        enumeration_level
+        enumeration_level,
+        set<VarId>(existential_vars)
     );
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <set>
 #include <vector>
 
 #include "query/executor/binding_iter.h"
@@ -27,12 +28,16 @@ how many seeks we would need to finish the join on the first level.
 */
 class LeapfrogOptimizer {
 public:
-    // may return nullptr if leapfrog is not possible
+    // may return nullptr if leapfrog is not possible.
+    // existential_vars are variables whose values are not needed, the join returns only one match of them
+    // for each combination of the other variables
     static std::unique_ptr<BindingIter> try_get_iter_with_assigned(
         const std::vector<std::unique_ptr<Plan>>& base_plans,
-        const std::size_t binding_size);
+        const std::size_t binding_size,
+        const std::set<VarId>& existential_vars = {});
 
     static std::unique_ptr<BindingIter> try_get_iter_without_assigned(
         const std::vector<std::unique_ptr<Plan>>& base_plans,
-        const std::size_t binding_size);
+        const std::size_t binding_size,
+        const std::set<VarId>& existential_vars = {});
 };
@@ -10,7 +10,10 @@
 #include "query/executor/binding_iters.h"
 #include "storage/index/tensor_store/lsh/binding_iters/project_tensor_similarity.h"
 #include "query/executor/binding_iter/aggregation.h"
+#include "query/executor/binding_iter/aggregation/mql/agg_count_all.h"
+#include "query/executor/binding_iter/count_all.h"
 #include "query/executor/binding_iter/distinct_hash.h"
+#include "query/executor/binding_iter/distinct_ordered.h"
 #include "query/executor/binding_iter/empty_binding_iter.h"
 #include "query/executor/binding_iter/filter.h"
 #include "query/executor/binding_iter/hash_join/bgp/in_memory/join_1_var.h"
@@ -185,17 +188,31 @@ void BindingIterConstructor::visit(OpBasicGraphPattern& op_basic_graph_pattern)
             plan->set_input_vars(safe_assigned_vars);
         }
 
+        // variables that only need one match when the pattern is below a RETURN DISTINCT
+        std::set<VarId> existential_vars;
+        if (&op_basic_graph_pattern == distinct_bgp) {
+            for (auto& plan : base_plans) {
+                for (auto var : plan->get_vars()) {
+                    if (distinct_needed_vars.find(var) == distinct_needed_vars.end()) {
+                        existential_vars.insert(var);
+                    }
+                }
+            }
+        }
+
         // try to use leapfrog if there is a join
         if (base_plans.size() > 1) {
             if (safe_assigned_vars.size() > 0) {
                 tmp = LeapfrogOptimizer::try_get_iter_with_assigned(
                     base_plans,
-                    get_query_ctx().get_var_size()
+                    get_query_ctx().get_var_size(),
+                    existential_vars
                 );
             } else {
                 tmp = LeapfrogOptimizer::try_get_iter_without_assigned(
                     base_plans,
-                    get_query_ctx().get_var_size()
+                    get_query_ctx().get_var_size(),
+                    existential_vars
                 );
             }
         }
@@ -229,8 +246,6 @@ void BindingIterConstructor::visit(OpBasicGraphPattern& op_basic_graph_pattern)
 
     if (op_basic_graph_pattern.similarity_searches.size() > 0) {
         // Handle similarity search
-        auto sim_iter = similarity_search_plans[0]->get_binding_iter();
-
         // Check if there is a join between the base plans and the similarity search
         std::set<VarId> base_plan_vars;
         for (auto& plan : base_plans) {
@@ -239,8 +254,20 @@ void BindingIterConstructor::visit(OpBasicGraphPattern& op_basic_graph_pattern)
         }
         auto object_var = similarity_search_plans[0]->get_object_var();
 
-        if (base_plan_vars.find(object_var) != base_plan_vars.end()) {
+        if (base_plan_vars.find(object_var) != base_plan_vars.end() && similarity_search_plans[0]->get_k() > 0) {
+            // Handle join with a bounded k, the objects of the bgp are pushed into the similarity search
+            // so the result has the k most similar objects that match the bgp
+            build_bgp_iter();
+            std::vector<VarId> child_vars;
+            for (auto& var : base_plan_vars) {
+                if (var != object_var)
+                    child_vars.push_back(var);
+            }
+            tmp = similarity_search_plans[0]->get_filtered_binding_iter(std::move(tmp), std::move(child_vars));
+        }
+        else if (base_plan_vars.find(object_var) != base_plan_vars.end()) {
             // Handle join
+            auto sim_iter = similarity_search_plans[0]->get_binding_iter();
 
             // 1. HashJoin(build=bgp, probe=sim)
             build_bgp_iter();
@@ -301,6 +328,7 @@ void BindingIterConstructor::visit(OpBasicGraphPattern& op_basic_graph_pattern)
         }
         else {
             // Handle cross product
+            auto sim_iter = similarity_search_plans[0]->get_binding_iter();
             build_bgp_iter();
             tmp = std::make_unique<CrossProduct>(
                 std::move(tmp),
@@ -485,6 +513,9 @@ void BindingIterConstructor::visit(OpReturn& op_return) {
             break;
         }
     }
+    if (op_return.distinct && !grouping) {
+        set_distinct_bgp(op_return);
+    }
     op_return.op->accept_visitor(*this);
 
     for (auto&& [var, expr] : op_return.projection) {
@@ -518,7 +549,13 @@ void BindingIterConstructor::visit(OpReturn& op_return) {
         );
     }
 
-    if (aggregations.size() > 0) {
+    if (group_vars.empty() && aggregations.size() == 1
+        && dynamic_cast<MQL::AggCountAll*>(aggregations.begin()->second.get()) != nullptr)
+    {
+        // a single COUNT(*) doesn't need to enumerate the results when the child can count them
+        tmp = std::make_unique<CountAll>(std::move(tmp), aggregations.begin()->first);
+        aggregations.clear();
+    } else if (aggregations.size() > 0) {
         tmp = std::make_unique<Aggregation>(
             std::move(tmp),
             std::move(aggregations),
@@ -526,6 +563,9 @@ void BindingIterConstructor::visit(OpReturn& op_return) {
         );
     }
 
+    // The distinct can be done in a streaming way if the rows are ordered by the projected vars
+    bool distinct_ordered = op_return.distinct && DistinctOrdered::can_use(projected_vars, order_by_vars);
+
     if (order_by_vars.size() > 0) {
         tmp = std::make_unique<OrderBy>(
             std::move(tmp),
@@ -536,8 +576,13 @@ void BindingIterConstructor::visit(OpReturn& op_return) {
         );
     }
 
-    if (op_return.distinct) {
-        // TODO: if everything is ordered having the distinct variables at first we can avoid the hash
+    if (distinct_ordered) {
+        tmp = std::make_unique<DistinctOrdered>(
+            std::move(tmp),
+            std::move(projected_vars),
+            &MQL::Comparisons::compare
+        );
+    } else if (op_return.distinct) {
         tmp = std::make_unique<DistinctHash>(
             std::move(tmp),
             std::move(projected_vars)
@@ -546,6 +591,61 @@ void BindingIterConstructor::visit(OpReturn& op_return) {
 }
 
 
+void BindingIterConstructor::set_distinct_bgp(OpReturn& op_return) {
+    std::set<VarId> needed_vars;
+    auto add_expr_vars = [&](Expr* expr) {
+        if (expr != nullptr) {
+            auto expr_vars = expr->get_all_vars();
+            needed_vars.insert(expr_vars.begin(), expr_vars.end());
+        }
+    };
+
+    for (auto&& [var, expr] : op_return.projection) {
+        needed_vars.insert(var);
+        add_expr_vars(expr.get());
+    }
+
+    // Only operators that don't change the multiplicity of the distinct results are allowed
+    // between the RETURN and the basic graph pattern
+    Op* op = op_return.op.get();
+    while (true) {
+        if (auto op_order_by = dynamic_cast<OpOrderBy*>(op)) {
+            for (auto&& [var, expr] : op_order_by->items) {
+                if (expr != nullptr && expr->has_aggregation()) {
+                    return;
+                }
+                needed_vars.insert(var);
+                add_expr_vars(expr.get());
+            }
+            op = op_order_by->op.get();
+        } else if (auto op_where = dynamic_cast<OpWhere*>(op)) {
+            add_expr_vars(op_where->expr.get());
+            op = op_where->op.get();
+        } else if (auto op_match = dynamic_cast<OpMatch*>(op)) {
+            for (auto& property : op_match->optional_properties) {
+                if (property.node.is_var()) {
+                    needed_vars.insert(property.node.get_var());
+                }
+            }
+            op = op_match->op.get();
+        } else if (auto op_project_similarity = dynamic_cast<OpProjectSimilarity*>(op)) {
+            needed_vars.insert(op_project_similarity->object_var);
+            op = op_project_similarity->op.get();
+        } else {
+            break;
+        }
+    }
+
+    if (auto op_basic_graph_pattern = dynamic_cast<OpBasicGraphPattern*>(op)) {
+        for (auto& similarity_search : op_basic_graph_pattern->similarity_searches) {
+            needed_vars.insert(similarity_search.object_var);
+        }
+        distinct_bgp         = op_basic_graph_pattern;
+        distinct_needed_vars = std::move(needed_vars);
+    }
+}
+
+
 Id BindingIterConstructor::replace_setted_var(Id id) const {
     if (id.is_var()) {
         auto var = id.get_var();
@@ -59,6 +59,11 @@ public:
     // True when a group is needed (Aggregation or Group By are present)
     bool grouping = false;
 
+    // Basic graph pattern below a RETURN DISTINCT where only distinct_needed_vars are used, so the other
+    // variables of the pattern don't need to be enumerated. nullptr if there is no such pattern
+    OpBasicGraphPattern* distinct_bgp = nullptr;
+    std::set<VarId> distinct_needed_vars;
+
     void visit(MQL::OpMatch&)             override;
     void visit(MQL::OpBasicGraphPattern&) override;
     void visit(MQL::OpOptional&)          override;
@@ -83,6 +88,9 @@ public:
 private:
     bool term_exists(ObjectId) const;
 
+    // Sets distinct_bgp and distinct_needed_vars if the RETURN DISTINCT is over a basic graph pattern
+    void set_distinct_bgp(MQL::OpReturn&);
+
     // transform Vars in setted_vars to the assigned ObjectId
     Id replace_setted_var(Id) const;
 };
@@ -6,9 +6,10 @@
 #include "graph_models/quad_model/conversions.h"
 #include "graph_models/quad_model/quad_model.h"
 #include "storage/index/leapfrog/leapfrog_similarity_search_iter.h"
+#include "storage/index/tensor_store/lsh/binding_iters/filtered_index_top_k.h"
 #include "storage/index/tensor_store/lsh/binding_iters/forest_index_top_k.h"
 #include "storage/index/tensor_store/lsh/binding_iters/forest_index_top_all.h"
-#include "storage/index/tensor_store/lsh/forest_index_query_iter.h"
+#include "storage/index/tensor_store/tensor_query_iter.h"
 
 SimilaritySearchPlan::SimilaritySearchPlan(VarId                     object_var_,
                                            VarId                     similarity_var_,
@@ -89,6 +90,19 @@ std::unique_ptr<BindingIter> SimilaritySearchPlan::get_binding_iter() const {
 }
 
 
+std::unique_ptr<BindingIter> SimilaritySearchPlan::get_filtered_binding_iter(std::unique_ptr<BindingIter> child_iter,
+                                                                          std::vector<VarId>&&         child_vars) const {
+    assert(k > 0);
+    return std::make_unique<LSH::FilteredIndexTopK>(std::move(child_iter),
+                                                    object_var,
+                                                    similarity_var,
+                                                    std::move(child_vars),
+                                                    *quad_model.catalog().name2tensor_store.at(tensor_store_name),
+                                                    query_tensor,
+                                                    k);
+}
+
+
 bool SimilaritySearchPlan::get_leapfrog_iter(std::vector<std::unique_ptr<LeapfrogIter>>& leapfrog_iters,
                                              std::vector<VarId>&                         /*var_order*/,
                                              uint_fast32_t&                              /*enumeration_level*/) const {
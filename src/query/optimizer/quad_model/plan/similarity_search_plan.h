@@ -32,6 +32,10 @@ public:
 
     std::unique_ptr<BindingIter> get_binding_iter() const override;
 
+    // Similarity search restricted to the objects of child_iter, it requires a positive k
+    std::unique_ptr<BindingIter> get_filtered_binding_iter(std::unique_ptr<BindingIter> child_iter,
+                                                           std::vector<VarId>&&         child_vars) const;
+
     bool get_leapfrog_iter(std::vector<std::unique_ptr<LeapfrogIter>>& leapfrog_iters,
                            std::vector<VarId>&                         var_order,
                            uint_fast32_t&                              enumeration_level) const override;
@@ -40,6 +44,7 @@ public:
 
     VarId get_object_var() const { return object_var; }
     VarId get_similarity_var() const { return similarity_var; }
+    int64_t get_k() const { return k; }
 
 private:
     VarId              object_var;
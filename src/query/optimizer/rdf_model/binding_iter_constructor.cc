@@ -9,6 +9,7 @@
 #include "graph_models/rdf_model/rdf_model.h"
 #include "misc/set_operations.h"
 #include "query/exceptions.h"
+#include "query/executor/binding_iter/aggregation/sparql/agg_count_all.h"
 #include "query/executor/binding_iters.h"
 #include "query/optimizer/plan/join_order/greedy_optimizer.h"
 #include "query/optimizer/plan/join_order/leapfrog_optimizer.h"
@@ -111,7 +112,13 @@ void BindingIterConstructor::make_solution_modifier_operators(bool is_root_query
     }
 
     // Create the Aggregation if necessary.
-    if (aggregations.size() > 0 || group_vars.size() > 0) {
+    if (group_vars.empty() && aggregations.size() == 1
+        && dynamic_cast<SPARQL::AggCountAll*>(aggregations.begin()->second.get()) != nullptr)
+    {
+        // a single COUNT(*) doesn't need to enumerate the results when the child can count them
+        tmp = std::make_unique<CountAll>(std::move(tmp), aggregations.begin()->first);
+        aggregations.clear();
+    } else if (aggregations.size() > 0 || group_vars.size() > 0) {
         tmp = std::make_unique<Aggregation>(
             std::move(tmp),
             std::move(aggregations),
@@ -137,6 +144,9 @@ void BindingIterConstructor::make_solution_modifier_operators(bool is_root_query
         );
     }
 
+    // The distinct can be done in a streaming way if the rows are ordered by the projected vars
+    bool distinct_ordered = distinct && op_order_by && DistinctOrdered::can_use(projection_vars, order_vars);
+
     if (op_order_by) {
         for (auto& var : projection_vars) {
             order_saved_vars.insert(var);
@@ -152,29 +162,16 @@ void BindingIterConstructor::make_solution_modifier_operators(bool is_root_query
         op_order_by = nullptr; // important for subqueries
     }
 
-    if (distinct) {
+    if (distinct_ordered) {
+        auto projection_vars_copy = projection_vars;
+        tmp = std::make_unique<DistinctOrdered>(std::move(tmp),
+                                                std::move(projection_vars_copy),
+                                                &SPARQL::Comparisons::compare);
+    } else if (distinct) {
         auto projection_vars_copy = projection_vars;
         tmp = std::make_unique<DistinctHash>(std::move(tmp), std::move(projection_vars_copy));
     }
 
-    // TODO: Take advantage of order for DISTINCT
-    // if (op_select.distinct) {
-    //     vector<VarId> projected_var_ids;
-    //     for (const auto& [var, var_id] : projection_vars) {
-    //         projected_var_ids.push_back(var_id);
-    //     }
-    //     // TODO: Use DistinctOrdered when possible
-    //     if (distinct_ordered_possible) {
-    //         tmp = make_unique<DistinctOrdered>(std::move(tmp), std::move(projected_var_ids));
-    //     } else {
-    //         // TODO: This would never happen with the current operators
-    //         if (!distinct_into_id) {
-    //             tmp = make_unique<DistinctHash>(std::move(tmp), std::move(projected_var_ids));
-    //         }
-    //         // else DistinctHash was created when visiting OpWhere
-    //     }
-    // }
-
     if (offset != Op::DEFAULT_OFFSET || limit != Op::DEFAULT_LIMIT || rdf_model.MAX_LIMIT != Op::DEFAULT_LIMIT) {
         if (limit > rdf_model.MAX_LIMIT && is_root_query) {
             limit = rdf_model.MAX_LIMIT;
@@ -245,6 +242,10 @@ void BindingIterConstructor::handle_select(OpSelect& op_select) {
         }
     }
 
+    if (op_select.distinct && !grouping) {
+        set_distinct_bgp(op_select);
+    }
+
     op_select.op->accept_visitor(*this);
 
     for (size_t i = 0; i < op_select.vars.size(); i++) {
@@ -279,6 +280,53 @@ void BindingIterConstructor::handle_select(OpSelect& op_select) {
 }
 
 
+void BindingIterConstructor::set_distinct_bgp(OpSelect& op_select) {
+    std::set<VarId> needed_vars(op_select.vars.begin(), op_select.vars.end());
+    auto add_expr_vars = [&](Expr& expr) {
+        auto expr_vars = expr.get_all_vars();
+        needed_vars.insert(expr_vars.begin(), expr_vars.end());
+    };
+
+    for (auto& expr : op_select.vars_exprs) {
+        if (expr != nullptr) {
+            add_expr_vars(*expr);
+        }
+    }
+
+    // Only operators that don't change the multiplicity of the distinct results are allowed
+    // between the SELECT and the basic graph pattern
+    Op* op = op_select.op.get();
+    while (true) {
+        if (auto op_order_by = dynamic_cast<OpOrderBy*>(op)) {
+            for (auto& item : op_order_by->items) {
+                if (std::holds_alternative<VarId>(item)) {
+                    needed_vars.insert(std::get<VarId>(item));
+                } else {
+                    auto& expr = std::get<std::unique_ptr<Expr>>(item);
+                    if (expr->has_aggregation()) {
+                        return;
+                    }
+                    add_expr_vars(*expr);
+                }
+            }
+            op = op_order_by->op.get();
+        } else if (auto op_filter = dynamic_cast<OpFilter*>(op)) {
+            for (auto& filter : op_filter->filters) {
+                add_expr_vars(*filter);
+            }
+            op = op_filter->op.get();
+        } else {
+            break;
+        }
+    }
+
+    if (auto op_basic_graph_pattern = dynamic_cast<OpBasicGraphPattern*>(op)) {
+        distinct_bgp         = op_basic_graph_pattern;
+        distinct_needed_vars = std::move(needed_vars);
+    }
+}
+
+
 void BindingIterConstructor::visit(OpSelect& op_select) {
     if (op_select.is_sub_select) {
         auto old_grouping = grouping;
@@ -406,12 +454,24 @@ void BindingIterConstructor::visit(OpBasicGraphPattern& op_basic_graph_pattern)
         // plan->print(std::cout, 0);
     }
 
+    // variables that only need one match when the pattern is below a SELECT DISTINCT
+    std::set<VarId> existential_vars;
+    if (&op_basic_graph_pattern == distinct_bgp) {
+        for (auto& plan : base_plans) {
+            for (auto var : plan->get_vars()) {
+                if (distinct_needed_vars.find(var) == distinct_needed_vars.end()) {
+                    existential_vars.insert(var);
+                }
+            }
+        }
+    }
+
     // try to use leapfrog if there is a join
     if (base_plans.size() > 1) {
         if (safe_assigned_vars.size() > 0) {
-            tmp = LeapfrogOptimizer::try_get_iter_with_assigned(base_plans, binding_size);
+            tmp = LeapfrogOptimizer::try_get_iter_with_assigned(base_plans, binding_size, existential_vars);
         } else {
-            tmp = LeapfrogOptimizer::try_get_iter_without_assigned(base_plans, binding_size);
+            tmp = LeapfrogOptimizer::try_get_iter_without_assigned(base_plans, binding_size, existential_vars);
         }
     }
 
@@ -504,6 +564,41 @@ void BindingIterConstructor::visit(OpSequence& op_sequence) {
         safe_assigned_vars = fixable_vars;
         op->accept_visitor(*this);
 
+        auto is_sub_select = dynamic_cast<OpSelect*>(op.get()) != nullptr;
+
+        // A sub-select that doesn't receive any variable (e.g. it has aggregations) and whose join
+        // variables are always bound at both sides is evaluated once and joined by hashing its results
+        if (is_sub_select
+            && fixable_vars.empty()
+            && original_safe_assigned_vars.empty()
+            && unsafe_join_vars.size() > 0
+            && set_difference(unsafe_join_vars, acc_safe_assigned_vars).empty()
+            && set_difference(unsafe_join_vars, op->get_safe_vars()).empty())
+        {
+            old_tmp = std::make_unique<HashJoin::Generic::InMemory::Join>(
+                std::move(tmp),
+                std::move(old_tmp),
+                set_to_vector(unsafe_join_vars),
+                set_to_vector(set_difference(op_scope_vars, join_vars)),
+                set_to_vector(set_difference(acc_scope_vars, join_vars))
+            );
+
+            acc_safe_assigned_vars = set_union(acc_safe_assigned_vars, safe_assigned_vars);
+            acc_scope_vars = set_union(acc_scope_vars, op_scope_vars);
+            continue;
+        }
+
+        // the sub-select is executed again for each result of the previous operators, remember
+        // its results for the values it receives
+        if (is_sub_select) {
+            tmp = std::make_unique<Memoize>(
+                std::move(tmp),
+                set_to_vector(fixable_vars),
+                set_to_vector(set_difference(op_scope_vars, fixable_vars)),
+                true // keep_duplicates
+            );
+        }
+
         if (unsafe_join_vars.size() == 0) {
             old_tmp = std::make_unique<IndexNestedLoopJoin>(std::move(old_tmp), std::move(tmp));
         } else {
@@ -553,6 +648,20 @@ JoinVars BindingIterConstructor::calculate_join_vars(Op& lhs, Op& rhs) {
 }
 
 
+// The right side of semi and anti joins without unsafe join vars is only checked for having
+// a result, which depends only on the values it receives from the left side
+void BindingIterConstructor::memoize_rhs_existence(const JoinVars& vars) {
+    if (vars.unsafe_join_vars.empty()) {
+        tmp = std::make_unique<Memoize>(
+            std::move(tmp),
+            set_to_vector(vars.rhs_fixable_vars),
+            std::vector<VarId>(),
+            false // keep_duplicates
+        );
+    }
+}
+
+
 void BindingIterConstructor::visit(OpOptional& op_optional) {
     auto vars = calculate_join_vars(*op_optional.lhs, *op_optional.rhs);
 
@@ -594,8 +703,9 @@ void BindingIterConstructor::visit(OpMinus& op_minus) {
 
     auto lhs_iter = std::move(tmp);
 
-    safe_assigned_vars = std::move(vars.rhs_fixable_vars);
+    safe_assigned_vars = vars.rhs_fixable_vars;
     op_minus.rhs->accept_visitor(*this);
+    memoize_rhs_existence(vars);
 
     if (vars.common_vars.size() == 0) {
         tmp = std::move(lhs_iter);
@@ -627,8 +737,9 @@ void BindingIterConstructor::visit(OpNotExists& op_not_exists) {
 
     auto lhs_iter = std::move(tmp);
 
-    safe_assigned_vars = std::move(vars.rhs_fixable_vars);
+    safe_assigned_vars = vars.rhs_fixable_vars;
     op_not_exists.rhs->accept_visitor(*this);
+    memoize_rhs_existence(vars);
 
     if (vars.common_vars.size() == 0) {
         tmp = std::move(lhs_iter);
@@ -659,8 +770,9 @@ void BindingIterConstructor::visit(OpSemiJoin& op_semi_join) {
 
     auto lhs_iter = std::move(tmp);
 
-    safe_assigned_vars = std::move(vars.rhs_fixable_vars);
+    safe_assigned_vars = vars.rhs_fixable_vars;
     op_semi_join.rhs->accept_visitor(*this);
+    memoize_rhs_existence(vars);
 
     tmp = std::make_unique<NestedLoopSemiJoin>(
         std::move(lhs_iter),
@@ -85,6 +85,14 @@ public:
 
     bool grouping = false;
 
+    // Basic graph pattern below a SELECT DISTINCT where only distinct_needed_vars are used, so the other
+    // variables of the pattern don't need to be enumerated. nullptr if there is no such pattern
+    OpBasicGraphPattern* distinct_bgp = nullptr;
+    std::set<VarId> distinct_needed_vars;
+
+    // Sets distinct_bgp and distinct_needed_vars if the SELECT DISTINCT is over a basic graph pattern
+    void set_distinct_bgp(OpSelect& op_select);
+
     void print_set(const std::set<VarId>& set) const;
 
     // Checks if the variable is a GROUP BY variable or if it
@@ -101,6 +109,10 @@ public:
     // Calculates the various variable sets needed when making joins.
     JoinVars calculate_join_vars(Op& lhs, Op& rhs);
 
+    // Wraps tmp (the right side of a semi or anti join) to remember if it has results for each
+    // value of the vars it receives
+    void memoize_rhs_existence(const JoinVars& vars);
+
 public:
     void visit(OpOrderBy&)           override;
     void visit(OpGroupBy&)           override;
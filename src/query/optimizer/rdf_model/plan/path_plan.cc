@@ -23,9 +23,15 @@
 #include "query/executor/binding_iter/paths/experimental/all_shortest_walks_count/bfs_check.h"
 #include "query/executor/binding_iter/paths/experimental/all_shortest_walks_count/bfs_enum.h"
 #include "query/executor/binding_iter/paths/index_provider/rdf_model_index_provider.h"
+#include "query/executor/binding_iter/paths/reachability/index_check.h"
+#include "query/executor/binding_iter/paths/reachability/index_enum.h"
 #include "query/executor/binding_iter/paths/unfixed_composite.h"
 #include "query/parser/paths/automaton/rpq_automaton.h"
+#include "query/parser/paths/path_atom.h"
+#include "query/parser/paths/path_kleene_plus.h"
+#include "query/parser/paths/path_kleene_star.h"
 #include "query/parser/paths/regular_path_expr.h"
+#include "storage/index/reachability/reachability_index.h"
 
 using namespace SPARQL;
 
@@ -298,6 +304,50 @@ std::unique_ptr<BindingIter> PathPlan::get_unfixed(const RPQ_DFA& automaton, Var
 }
 
 
+std::unique_ptr<BindingIter> PathPlan::get_reachability_iter() const {
+    // The index only knows which nodes are reached, so it can't return the paths of other semantics
+    if (path_semantic != PathSemantic::DEFAULT || (!subject_assigned && !object_assigned)) {
+        return nullptr;
+    }
+
+    RegularPathExpr* inner;
+    bool plus;
+    if (path.type() == PathType::PATH_KLEENE_STAR) {
+        inner = static_cast<PathKleeneStar&>(path).path.get();
+        plus = false;
+    } else if (path.type() == PathType::PATH_KLEENE_PLUS) {
+        inner = static_cast<PathKleenePlus&>(path).path.get();
+        plus = true;
+    } else {
+        return nullptr;
+    }
+    if (inner->type() != PathType::PATH_ATOM) {
+        return nullptr;
+    }
+    auto& atom = static_cast<PathAtom&>(*inner);
+    if (!atom.property_checks.empty()) {
+        return nullptr;
+    }
+
+    auto index = rdf_model.get_reachability_index(SPARQL::Conversions::pack_iri(atom.atom).id);
+    if (index == nullptr) {
+        return nullptr;
+    }
+
+    if (subject_assigned) {
+        begin_at_left[path_var.id] = true;
+        if (object_assigned) {
+            return std::make_unique<Paths::Reachability::IndexCheck>(path_var, subject, object, *index, atom.inverse, plus);
+        }
+        return std::make_unique<Paths::Reachability::IndexEnum>(path_var, subject, object.get_var(), *index, atom.inverse, plus);
+    } else {
+        // enum starting on object, following the edges in the other direction
+        begin_at_left[path_var.id] = false;
+        return std::make_unique<Paths::Reachability::IndexEnum>(path_var, object, subject.get_var(), *index, !atom.inverse, plus);
+    }
+}
+
+
 bool PathPlan::subject_is_better_start_direction() const {
     if (automaton.total_states == 1 || automaton.is_final_state[0]) {
         return true;
@@ -325,6 +375,10 @@ bool PathPlan::subject_is_better_start_direction() const {
 
 
 std::unique_ptr<BindingIter> PathPlan::get_binding_iter() const {
+    if (auto reachability_iter = get_reachability_iter()) {
+        return reachability_iter;
+    }
+
     if (subject_assigned) {
         if (object_assigned) {
             auto star_at_subject = subject_is_better_start_direction();
@@ -55,6 +55,10 @@ public:
     std::unique_ptr<BindingIter> get_enum(const RPQ_DFA& automaton, Id start, VarId end) const;
     std::unique_ptr<BindingIter> get_unfixed(const RPQ_DFA& automaton, VarId start, VarId end) const;
 
+    // Returns an iterator using a reachability index if the path is `P*` or `P+` and P has an index,
+    // otherwise returns nullptr
+    std::unique_ptr<BindingIter> get_reachability_iter() const;
+
 private:
     std::vector<bool>& begin_at_left;
     VarId path_var;
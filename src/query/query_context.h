@@ -11,6 +11,7 @@
 
 #include "graph_models/object_id.h"
 #include "query/id.h"
+#include "query/query_profile.h"
 #include "query/var_id.h"
 
 class BindingExprPrinter;
@@ -41,6 +42,9 @@ public:
     uint64_t start_version = 0;
     uint64_t result_version = 0;
 
+    // Counters and operator profiles, BindingIters are profiled only when profile.enabled is true
+    QueryProfile profile;
+
     // Used only by BindingExprBNode of the RDF model.
     std::unordered_map<std::string, uint64_t> blank_node_ids;
 
@@ -66,6 +70,8 @@ private:
 public:
     // Cleans up everything. Must be called before parsing the query
     void reset() {
+        profile.reset(false);
+
         blank_node_ids.clear();
         blank_node_count = 0;
 
@@ -0,0 +1,45 @@
+#include "query_profile.h"
+
+#include "query/executor/query_executor/json_ostream_escape.h"
+
+void QueryProfile::write_json(std::ostream& os) const {
+    if (root == nullptr) {
+        os << "null";
+    } else {
+        write_json(os, *root);
+    }
+}
+
+
+void QueryProfile::write_json(std::ostream& os, const IterProfile& profile) const {
+    JsonOstreamEscape json_escape(os);
+    std::ostream escaped_os(&json_escape);
+
+    auto self = profile.self();
+
+    os << "{\"operator\": \"";
+    escaped_os << profile.name;
+    os << "\", \"begin\": "            << profile.stat_begin
+       << ", \"next\": "               << profile.stat_next
+       << ", \"reset\": "              << profile.stat_reset
+       << ", \"results\": "            << profile.results
+       << ", \"time_ms\": "            << ticks_to_ms(profile.inclusive.ticks)
+       << ", \"self_time_ms\": "       << ticks_to_ms(self.ticks)
+       << ", \"page_hits\": "          << profile.inclusive.page_hits
+       << ", \"self_page_hits\": "     << self.page_hits
+       << ", \"page_misses\": "        << profile.inclusive.page_misses
+       << ", \"self_page_misses\": "   << self.page_misses
+       << ", \"page_reads\": "         << profile.inclusive.page_reads
+       << ", \"self_page_reads\": "    << self.page_reads
+       << ", \"tmp_bytes_written\": "  << profile.inclusive.tmp_bytes_written
+       << ", \"self_tmp_bytes_written\": " << self.tmp_bytes_written
+       << ", \"peak_memory\": "        << profile.peak_memory
+       << ", \"children\": [";
+
+    auto first = true;
+    for (auto child : profile.children) {
+        if (first) first = false; else os << ", ";
+        write_json(os, *child);
+    }
+    os << "]}";
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "query/exceptions.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Counters of the work done while executing a query. The buffer manager updates the counters of the
+// QueryProfile of the current thread, and each profiled BindingIter accumulates the difference observed
+// during its calls.
+struct ProfileCounters {
+    uint64_t ticks             = 0;
+    uint64_t page_hits         = 0; // pages found in the buffer
+    uint64_t page_misses       = 0; // pages that had to be brought into the buffer
+    uint64_t page_reads        = 0; // pages read from a file (new temporal pages are not read)
+    uint64_t tmp_bytes_written = 0; // bytes spilled to temporal files
+
+    void add_difference(const ProfileCounters& end, const ProfileCounters& start) {
+        ticks             += end.ticks             - start.ticks;
+        page_hits         += end.page_hits         - start.page_hits;
+        page_misses       += end.page_misses       - start.page_misses;
+        page_reads        += end.page_reads        - start.page_reads;
+        tmp_bytes_written += end.tmp_bytes_written - start.tmp_bytes_written;
+    }
+};
+
+
+// Profile of one BindingIter, it only exists when the query is executed with profiling enabled
+struct IterProfile {
+    // Name, children and stats of the iter are set by the BindingIterPrinter
+    std::string name;
+    std::vector<IterProfile*> children;
+    uint64_t stat_begin = 0;
+    uint64_t stat_next  = 0;
+    uint64_t stat_reset = 0;
+    uint64_t results    = 0;
+
+    // Counters including the work done by the children
+    ProfileCounters inclusive;
+
+    // Counters of the calls to the children (to subtract them from inclusive)
+    ProfileCounters children_inclusive;
+
+    // Bytes currently allocated by the iter and the maximum observed
+    uint64_t memory      = 0;
+    uint64_t peak_memory = 0;
+
+    ProfileCounters self() const {
+        ProfileCounters res;
+        res.add_difference(inclusive, children_inclusive);
+        return res;
+    }
+};
+
+
+class QueryProfile {
+public:
+    // When false BindingIters are executed without profiling
+    bool enabled = false;
+
+    // Global counters of the query, ticks is updated only when a profiled iter starts or ends a call
+    ProfileCounters counters;
+
+    // Profile of the iter that is executing, memory allocations are attributed to it
+    IterProfile* current = nullptr;
+
+    // Profile of the first iter that began
+    IterProfile* root = nullptr;
+
+    // Bytes currently allocated by all the iters of the query, tracked even when profiling is disabled
+    // so the server can limit the memory of a query. It counts the structures that grow with the data:
+    // hash tables of the in-memory hash joins and their key filters, in-memory distinct and memoized
+    // results. Sorting and spilled structures use pages of the buffer manager, whose memory is allocated
+    // at startup
+    uint64_t memory = 0;
+
+    // When memory exceeds it the allocation throws, 0 means no limit. It is kept by reset()
+    uint64_t memory_limit = 0;
+
+    static uint64_t read_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+#endif
+    }
+
+    void reset(bool _enabled) {
+        enabled  = _enabled;
+        counters = ProfileCounters();
+        current  = nullptr;
+        root     = nullptr;
+        memory   = 0;
+
+        start_ticks = read_ticks();
+        start_time  = std::chrono::steady_clock::now();
+    }
+
+    // Converts ticks to milliseconds, calibrating the tick rate against the steady clock since reset()
+    double ticks_to_ms(uint64_t ticks) const {
+        auto elapsed_ticks = read_ticks() - start_ticks;
+        std::chrono::duration<double, std::milli> elapsed_ms = std::chrono::steady_clock::now() - start_time;
+        if (elapsed_ticks == 0) {
+            return 0;
+        }
+        return ticks * (elapsed_ms.count() / elapsed_ticks);
+    }
+
+    void allocated(uint64_t bytes) {
+        memory += bytes;
+        if (current != nullptr) {
+            current->memory += bytes;
+            current->peak_memory = std::max(current->peak_memory, current->memory);
+        }
+        if (memory_limit != 0 && memory > memory_limit) {
+            throw QueryExecutionException("memory limit of " + std::to_string(memory_limit) + " bytes exceeded");
+        }
+    }
+
+    void released(uint64_t bytes) {
+        memory -= std::min(bytes, memory);
+        if (current != nullptr) {
+            current->memory -= std::min(bytes, current->memory);
+        }
+    }
+
+    // Releases bytes of an iter that is being destroyed. The profile of the iter is not updated, it is
+    // not the one executing
+    void released_on_destroy(uint64_t bytes) {
+        memory -= std::min(bytes, memory);
+    }
+
+    // Writes the operator tree of root as JSON. The names and children of the profiles are set
+    // by the BindingIterPrinter, so the plan must have been printed with stats before
+    void write_json(std::ostream& os) const;
+
+private:
+    uint64_t start_ticks = 0;
+    std::chrono::steady_clock::time_point start_time;
+
+    void write_json(std::ostream& os, const IterProfile& profile) const;
+};
+
+
+// Bytes held by an iter (or a structure it owns) counted in the QueryProfile of its query. Setting the
+// bytes in use reports the difference, and they are released when it is destroyed
+class ProfiledMemory {
+public:
+    ProfiledMemory() = default;
+
+    ProfiledMemory(const ProfiledMemory&) = delete;
+    ProfiledMemory& operator=(const ProfiledMemory&) = delete;
+
+    ~ProfiledMemory() {
+        if (profile != nullptr) {
+            profile->released_on_destroy(bytes);
+        }
+    }
+
+    // Can throw if the memory limit of the query is exceeded, the bytes are counted anyway
+    void set(QueryProfile& query_profile, uint64_t new_bytes) {
+        profile = &query_profile;
+        auto old_bytes = bytes;
+        bytes = new_bytes;
+        if (new_bytes > old_bytes) {
+            profile->allocated(new_bytes - old_bytes);
+        } else {
+            profile->released(old_bytes - new_bytes);
+        }
+    }
+
+    uint64_t get() const { return bytes; }
+
+private:
+    QueryProfile* profile = nullptr;
+
+    uint64_t bytes = 0;
+};
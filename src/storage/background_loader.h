@@ -0,0 +1,61 @@
+/*
+ * BackgroundLoader runs tasks in their own threads to bring data into memory without making the
+ * startup wait for them, so the database can be used while it warms up.
+ *
+ * Tasks receive the loader and must check `is_stopped()` often, since the owner stops the loader
+ * (and waits for its threads) before releasing the memory the tasks use.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class BackgroundLoader {
+public:
+    ~BackgroundLoader() {
+        stop();
+    }
+
+    void run(std::function<void(BackgroundLoader&)> task) {
+        threads.emplace_back(std::move(task), std::ref(*this));
+    }
+
+    bool is_stopped() const {
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    // Waits for the duration or until the loader is stopped, returns false if it was stopped
+    template<typename Rep, typename Period>
+    bool sleep_for(std::chrono::duration<Rep, Period> duration) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return !stop_condition.wait_for(lock, duration, [this] { return is_stopped(); });
+    }
+
+    // Stops the tasks and waits for them to finish
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        stop_condition.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+private:
+    std::atomic<bool> stopped { false };
+
+    std::mutex mutex;
+
+    std::condition_variable stop_condition;
+
+    std::vector<std::thread> threads;
+};
@@ -1,10 +1,18 @@
 #include "buffer_manager.h"
 
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
 #include <type_traits>
 
 #include "macros/aligned_alloc.h"
 #include "misc/fatal_error.h"
+#include "misc/metrics.h"
 #include "query/query_context.h"
 #include "storage/file_manager.h"
 
@@ -65,6 +73,10 @@ BufferManager::BufferManager(uint64_t vpage_buffer_pool_size,
 
 
 BufferManager::~BufferManager() {
+    warmup_loader.stop();
+    if (save_hot_pages_on_exit) {
+        save_hot_pages();
+    }
     flush();
     delete[] (vp_pool);
     delete[] (up_pool);
@@ -112,6 +124,272 @@ void BufferManager::flush() {
 }
 
 
+void BufferManager::clear_cache() {
+    {
+        std::lock_guard<std::mutex> lck(vp_mutex);
+        for (uint64_t i = 0; i < vp_pool_size; i++) {
+            VPage& page = vp_pool[i];
+            if (page.pins != 0
+                || page.page_id.file_id.id == FileId::UNASSIGNED
+                || page.prev_version != nullptr
+                || page.next_version != nullptr
+                || !discard_old_deltas(page.page_id))
+            {
+                continue;
+            }
+            if (page.dirty) {
+                file_manager.flush(page);
+            }
+            vp_map.erase(page.page_id);
+            page.page_id       = PageId(FileId(FileId::UNASSIGNED), 0);
+            page.second_chance = false;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lck(up_mutex);
+        for (uint64_t i = 0; i < up_pool_size; i++) {
+            UPage& page = up_pool[i];
+            if (page.pins != 0 || page.page_id.file_id.id == FileId::UNASSIGNED) {
+                continue;
+            }
+            if (page.dirty) {
+                file_manager.flush(page);
+            }
+            up_map.erase(page.page_id);
+            page.page_id       = PageId(FileId(FileId::UNASSIGNED), 0);
+            page.second_chance = false;
+        }
+    }
+}
+
+
+namespace {
+
+struct HotPage {
+    PageId page_id;
+    bool   versioned;
+};
+
+constexpr uint64_t HOT_PAGES_MAGIC = 0x4D'44'42'48'4F'54'50'31ULL; // "MDBHOTP1"
+
+void write_uint64(std::ostream& os, uint64_t value) {
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint64_t read_uint64(std::istream& is) {
+    uint64_t value = 0;
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+} // namespace
+
+
+void BufferManager::save_hot_pages() {
+    std::vector<HotPage> hot_pages;
+    {
+        std::lock_guard<std::mutex> lck(vp_mutex);
+        for (uint64_t i = 1; i <= vp_pool_size; i++) {
+            auto& page = vp_pool[(vp_clock + i) % vp_pool_size];
+            // versions of the same page have the same id, only the oldest one is saved
+            if (page.page_id.file_id.id != FileId::UNASSIGNED && page.prev_version == nullptr) {
+                hot_pages.push_back({ page.page_id, true });
+            }
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lck(up_mutex);
+        for (uint64_t i = 1; i <= up_pool_size; i++) {
+            auto& page = up_pool[(up_clock + i) % up_pool_size];
+            if (page.page_id.file_id.id != FileId::UNASSIGNED) {
+                hot_pages.push_back({ page.page_id, false });
+            }
+        }
+    }
+
+    // file ids are descriptors, they are saved as an index in the list of filenames
+    std::vector<std::string> filenames;
+    robin_hood::unordered_flat_map<int, uint64_t> file_id2index;
+    for (auto& [filename, file_id] : file_manager.get_files()) {
+        file_id2index.insert({ file_id.id, filenames.size() });
+        filenames.push_back(filename);
+    }
+
+    const auto path     = file_manager.get_file_path(HOT_PAGES_FILENAME);
+    const auto tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        write_uint64(file, HOT_PAGES_MAGIC);
+        write_uint64(file, filenames.size());
+        for (auto& filename : filenames) {
+            write_uint64(file, filename.size());
+            file.write(filename.data(), filename.size());
+        }
+        write_uint64(file, hot_pages.size());
+        for (auto& hot_page : hot_pages) {
+            auto it = file_id2index.find(hot_page.page_id.file_id.id);
+            // pages of files opened without the file manager can't be identified later
+            uint64_t file_index = it == file_id2index.end() ? UINT64_MAX : it->second;
+            write_uint64(file, (file_index << 1) | (hot_page.versioned ? 1 : 0));
+            write_uint64(file, hot_page.page_id.page_number);
+        }
+        if (!file.good()) {
+            return;
+        }
+    }
+    // the previous file is replaced only when the new one is complete
+    std::rename(tmp_path.c_str(), path.c_str());
+}
+
+
+void BufferManager::start_warmup(uint64_t budget) {
+    save_hot_pages_on_exit = true;
+
+    std::vector<HotPage> hot_pages;
+
+    std::ifstream file(file_manager.get_file_path(HOT_PAGES_FILENAME), std::ios::in | std::ios::binary);
+    if (file.is_open() && read_uint64(file) == HOT_PAGES_MAGIC) {
+        // file ids and page counts of the saved filenames, files that are not opened by the model are skipped
+        std::vector<std::pair<int, uint64_t>> files;
+        const auto opened_files = file_manager.get_files();
+        auto num_files = read_uint64(file);
+        for (uint64_t i = 0; i < num_files && file.good(); i++) {
+            std::string filename(read_uint64(file), '\0');
+            file.read(filename.data(), filename.size());
+
+            auto it = opened_files.find(filename);
+            if (it == opened_files.end()) {
+                files.push_back({ FileId::UNASSIGNED, 0 });
+            } else {
+                files.push_back({ it->second.id, file_manager.count_pages(it->second) });
+            }
+        }
+
+        auto num_pages = read_uint64(file);
+        for (uint64_t i = 0; i < num_pages && file.good(); i++) {
+            auto file_index  = read_uint64(file);
+            auto page_number = read_uint64(file);
+            if (!file.good() || (file_index >> 1) >= files.size()) {
+                continue;
+            }
+            auto [fd, file_pages] = files[file_index >> 1];
+            if (fd != FileId::UNASSIGNED && page_number < file_pages) {
+                hot_pages.push_back({ PageId(FileId(fd), page_number), (file_index & 1) == 1 });
+            }
+        }
+    }
+
+    // the pages were saved in clock order, when not all of them fit the last ones are kept
+    auto vpages_left = vp_pool_size;
+    auto upages_left = up_pool_size;
+    auto pages_left  = budget / VPage::SIZE;
+    std::vector<HotPage> selected;
+    for (auto it = hot_pages.rbegin(); it != hot_pages.rend() && pages_left > 0; ++it) {
+        auto& left = it->versioned ? vpages_left : upages_left;
+        if (left > 0) {
+            left--;
+            pages_left--;
+            selected.push_back(*it);
+        }
+    }
+    std::reverse(selected.begin(), selected.end());
+
+    auto shared_selected = std::make_shared<std::vector<HotPage>>(std::move(selected));
+    for (uint_fast32_t t = 0; t < WARMUP_THREADS; t++) {
+        warmup_loader.run([this, t, shared_selected](BackgroundLoader& loader) {
+            auto& pages = *shared_selected;
+            constexpr uint64_t BATCH_SIZE = 64;
+
+            // each thread loads every WARMUP_THREADS-th page, so the pages are loaded roughly in the saved order
+            for (uint64_t batch_start = t; batch_start < pages.size(); batch_start += BATCH_SIZE * WARMUP_THREADS) {
+                if (loader.is_stopped()) {
+                    return;
+                }
+                auto batch_end = std::min<uint64_t>(batch_start + BATCH_SIZE * WARMUP_THREADS, pages.size());
+
+#ifdef POSIX_FADV_WILLNEED
+                // the OS reads the batch ahead while the pages are copied into the buffers
+                for (auto i = batch_start; i < batch_end; i += WARMUP_THREADS) {
+                    auto& page_id = pages[i].page_id;
+                    posix_fadvise(page_id.file_id.id, page_id.page_number * VPage::SIZE, VPage::SIZE,
+                                  POSIX_FADV_WILLNEED);
+                }
+#endif
+                for (auto i = batch_start; i < batch_end; i += WARMUP_THREADS) {
+                    auto& hot_page = pages[i];
+                    if (!(hot_page.versioned ? warm_vpage(hot_page.page_id) : warm_upage(hot_page.page_id))) {
+                        return;
+                    }
+                }
+            }
+        });
+    }
+
+    warmup_loader.run([this](BackgroundLoader& loader) {
+        while (loader.sleep_for(HOT_PAGES_SAVE_INTERVAL)) {
+            save_hot_pages();
+        }
+    });
+}
+
+
+bool BufferManager::warm_vpage(PageId page_id) {
+    std::lock_guard<std::mutex> lck(vp_mutex);
+    if (vp_map.find(page_id) != vp_map.end()) {
+        return true;
+    }
+
+    // only frames that don't hold a page are used, the clock would evict pages that queries loaded
+    while (vp_warm_cursor < vp_pool_size && vp_pool[vp_warm_cursor].page_id.file_id.id != FileId::UNASSIGNED) {
+        vp_warm_cursor++;
+    }
+    if (vp_warm_cursor == vp_pool_size) {
+        return false;
+    }
+    auto& page = vp_pool[vp_warm_cursor++];
+    assert(page.pins == 0 && !page.dirty);
+
+    page.reassign(page_id);
+    page.version_number = last_stable_version.load();
+    page.prev_version = nullptr;
+    page.next_version = nullptr;
+    vp_map.insert({ page_id, &page });
+
+    file_manager.read_existing_page(page_id, page.get_bytes());
+    page.unpin();
+
+    metrics.warmup_pages.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+bool BufferManager::warm_upage(PageId page_id) {
+    std::lock_guard<std::mutex> lck(up_mutex);
+    if (up_map.find(page_id) != up_map.end()) {
+        return true;
+    }
+
+    // only frames that don't hold a page are used, the clock would evict pages that queries loaded
+    while (up_warm_cursor < up_pool_size && up_pool[up_warm_cursor].page_id.file_id.id != FileId::UNASSIGNED) {
+        up_warm_cursor++;
+    }
+    if (up_warm_cursor == up_pool_size) {
+        return false;
+    }
+    auto& page = up_pool[up_warm_cursor++];
+    assert(page.pins == 0 && !page.dirty);
+
+    page.reassign(page_id);
+    up_map.insert({ page_id, &page });
+
+    file_manager.read_existing_page(page_id, page.get_bytes());
+    page.unpin();
+
+    metrics.warmup_pages.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
 // We assume this executes on one thread at a time, controlled by vp_mutex
 VPage& BufferManager::get_vpage_available() {
     while (true) {
@@ -128,68 +406,49 @@ VPage& BufferManager::get_vpage_available() {
             continue;
         }
         if (page.prev_version == nullptr && page.next_version == nullptr) {
+            // the deltas of the older versions are restored from this page, it stays while they are read
+            if (!vp_deltas.empty() && !discard_old_deltas(page.page_id)) {
+                continue;
+            }
             if (page.page_id.file_id.id != FileId::UNASSIGNED) {
                 vp_map.erase(page.page_id);
+                metrics.versioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
             }
             if (page.dirty) {
                 // TODO: reduce counter of version writing pending for page version
                 // (we know this is the last version and there is no previous version)
                 file_manager.flush(page);
+                metrics.versioned_pool.dirty_flushes.fetch_add(1, std::memory_order_relaxed);
             }
             return page;
         }
 
+        // the version can be materialized again from its delta, even if running queries read it
+        if (page.has_delta) {
+            metrics.versioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
+            unlink_version(page);
+            return page;
+        }
 
-        running_version_count_mutex.lock();
-        auto it = running_version_count.find(page.version_number);
-        bool version_not_being_used = it == running_version_count.end();
-        running_version_count_mutex.unlock();
+        // The newest version is read by the running queries that started after it and also by every query that
+        // starts later, so it is evicted only once it is the single version of the page (above). Any other
+        // version is read by the queries that started between it and the next version, the oldest one also
+        // by the queries that started before it. The oldest version without a delta is needed to materialize
+        // the versions that have one
+        if (page.next_version == nullptr || vp_deltas.find(page.page_id) != vp_deltas.end()) {
+            continue;
+        }
+        bool version_not_being_used = !running_versions.is_running(
+            page.prev_version == nullptr ? 0 : page.version_number,
+            page.next_version->version_number
+        );
 
 
         if (version_not_being_used) {
-            if (page.dirty) {
-                // TODO: reduce counter of version writing pending for page version
-                // (we know this is the last version and there is no previous version)
-            }
-
-            if (page.prev_version != nullptr) {
-                page.prev_version->next_version = page.next_version;
-            } else { // page is the first in the linked list
-                // we know page.next_version != nullptr
-                // if it is the first version and there are more versions we need to
-                // edit vp_map to point to the new oldest version
-                if (page.page_id.file_id.id != FileId::UNASSIGNED) {
-                    auto it2 = vp_map.find(page.page_id);
-                    assert(it2 != vp_map.end());
-                    vp_map.erase(it2);
-                    vp_map.insert({ page.page_id, page.next_version });
-                }
-            }
-
-            if (page.next_version != nullptr) {
-                page.next_version->prev_version = page.prev_version;
-            } else { // page is the last in the linked list
-                // flush when dirty and there is no next version
-                if (page.dirty) {
-                    file_manager.flush(page);
-
-                    // we know page.prev_version != nullptr
-                    VPage* p = page.prev_version;
-                    // all previous dirty vp_map are no longer dirty because a newer version
-                    // was written to disk, and we only have one update at a time, so previous versions
-                    // must have ended
-                    do {
-                        if (p->dirty) {
-                            p->dirty = false;
-                            // TODO: reduce counter of version writing pending for page p version
-                            // (we know this is the last version and there is no previous version)
-                        }
-
-                        p = page.prev_version;
-                    } while (p != nullptr);
-                }
-            }
+            metrics.versioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
 
+            // a newer version exists, so the content of this one is never written to disk
+            unlink_version(page);
             return page;
         }
     }
@@ -222,13 +481,18 @@ PPage& BufferManager::get_ppage_available(uint_fast32_t thread_pos) {
 VPage& BufferManager::get_page_readonly(FileId file_id, uint64_t page_number) noexcept {
     const PageId page_id(file_id, page_number);
 
-    uint64_t start_version  = get_query_ctx().start_version;
-    uint64_t result_version = get_query_ctx().result_version;
+    auto& query_ctx = get_query_ctx();
+    uint64_t start_version  = query_ctx.start_version;
+    uint64_t result_version = query_ctx.result_version;
 
-    vp_mutex.lock();
+    Metrics::lock(vp_mutex, metrics.vp_mutex_wait_us, metrics.vp_mutex_contentions);
     auto it = vp_map.find(page_id);
 
     if (it == vp_map.end()) {
+        metrics.versioned_pool.misses.fetch_add(1, std::memory_order_relaxed);
+        query_ctx.profile.counters.page_misses++;
+        query_ctx.profile.counters.page_reads++;
+
         auto& page = get_vpage_available();
 
         page.reassign(page_id);
@@ -242,6 +506,9 @@ VPage& BufferManager::get_page_readonly(FileId file_id, uint64_t page_number) no
 
         return page;
     } else {
+        metrics.versioned_pool.hits.fetch_add(1, std::memory_order_relaxed);
+        query_ctx.profile.counters.page_hits++;
+
         // page is the buffer, search the corresponding version
         VPage* page = it->second;
 
@@ -249,6 +516,27 @@ VPage& BufferManager::get_page_readonly(FileId file_id, uint64_t page_number) no
             page = page->next_version;
         }
 
+        // a newer version than the one found may only have a delta
+        auto deltas_it = vp_deltas.find(page_id);
+        if (deltas_it != vp_deltas.end()) {
+            auto& deltas = deltas_it->second;
+            auto delta = std::upper_bound(deltas.begin(), deltas.end(), result_version,
+                [](uint64_t version, const VPageDelta& d) { return version < d.version_number; });
+            // the newest delta that is not newer than the result version, or the oldest one
+            if (delta != deltas.begin()) {
+                --delta;
+            }
+            if (page->version_number != delta->version_number
+                && (page->version_number > result_version
+                    || (delta->version_number <= result_version && page->version_number < delta->version_number)))
+            {
+                auto& materialized = materialize_version(page_id, delta->version_number);
+                vp_mutex.unlock();
+
+                return materialized;
+            }
+        }
+
         assert(page->version_number <= result_version);
 
         page->pin();
@@ -272,10 +560,13 @@ VPage& BufferManager::get_page_editable(FileId file_id, uint64_t page_number) no
     uint64_t start_version  = get_query_ctx().start_version;
     uint64_t result_version = get_query_ctx().result_version;
 
-    std::lock_guard<std::mutex> lck(vp_mutex);
+    Metrics::lock(vp_mutex, metrics.vp_mutex_wait_us, metrics.vp_mutex_contentions);
+    std::lock_guard<std::mutex> lck(vp_mutex, std::adopt_lock);
     auto it = vp_map.find(page_id);
 
     if (it == vp_map.end()) {
+        metrics.versioned_pool.misses.fetch_add(1, std::memory_order_relaxed);
+
         auto& old_page = get_vpage_available();
         auto& new_page = get_vpage_available();
 
@@ -300,6 +591,8 @@ VPage& BufferManager::get_page_editable(FileId file_id, uint64_t page_number) no
 
         return new_page;
     } else {
+        metrics.versioned_pool.hits.fetch_add(1, std::memory_order_relaxed);
+
         // page is in the buffer, search the corresponding version
         VPage* page = it->second;
 
@@ -334,7 +627,8 @@ VPage& BufferManager::get_page_editable(FileId file_id, uint64_t page_number) no
 VPage& BufferManager::append_vpage(FileId file_id) {
     uint64_t result_version = get_query_ctx().result_version;
 
-    std::lock_guard<std::mutex> lck(vp_mutex);
+    Metrics::lock(vp_mutex, metrics.vp_mutex_wait_us, metrics.vp_mutex_contentions);
+    std::lock_guard<std::mutex> lck(vp_mutex, std::adopt_lock);
 
     auto& new_page = get_vpage_available(); // need to have vp_mutex locked
 
@@ -378,18 +672,22 @@ UPage& BufferManager::get_upage_available() {
 UPage& BufferManager::get_unversioned_page(FileId file_id, uint64_t page_number) noexcept {
     const PageId page_id(file_id, page_number);
 
-    up_mutex.lock();
+    Metrics::lock(up_mutex, metrics.up_mutex_wait_us, metrics.up_mutex_contentions);
     auto it = up_map.find(page_id);
 
     if (it == up_map.end()) {
+        metrics.unversioned_pool.misses.fetch_add(1, std::memory_order_relaxed);
+
         auto& page = get_upage_available();
 
         if (page.page_id.file_id.id != FileId::UNASSIGNED) {
             up_map.erase(page.page_id);
+            metrics.unversioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
         }
 
         if (page.dirty) {
             file_manager.flush(page);
+            metrics.unversioned_pool.dirty_flushes.fetch_add(1, std::memory_order_relaxed);
         }
 
         page.reassign(page_id);
@@ -400,6 +698,8 @@ UPage& BufferManager::get_unversioned_page(FileId file_id, uint64_t page_number)
 
         return page;
     } else {
+        metrics.unversioned_pool.hits.fetch_add(1, std::memory_order_relaxed);
+
         UPage* page = it->second;
         page->pin();
         up_mutex.unlock();
@@ -410,9 +710,19 @@ UPage& BufferManager::get_unversioned_page(FileId file_id, uint64_t page_number)
 
 
 UPage& BufferManager::append_unversioned_page(FileId file_id) noexcept {
-    up_mutex.lock();
+    Metrics::lock(up_mutex, metrics.up_mutex_wait_us, metrics.up_mutex_contentions);
 
     auto& new_page = get_upage_available();
+    if (new_page.page_id.file_id.id != FileId::UNASSIGNED) {
+        up_map.erase(new_page.page_id);
+        metrics.unversioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (new_page.dirty) {
+        file_manager.flush(new_page);
+        metrics.unversioned_pool.dirty_flushes.fetch_add(1, std::memory_order_relaxed);
+    }
+
     auto page_number = file_manager.append_page(file_id, new_page.get_bytes());
     PageId page_id(file_id, page_number);
     new_page.reassign(page_id);
@@ -433,22 +743,34 @@ PPage& BufferManager::get_ppage(TmpFileId tmp_file_id, uint64_t page_number) noe
     // assigned to one specific thread.
     // If we change this in the future we might need a mutex lock.
 
+    auto& counters = get_query_ctx().profile.counters;
+
     auto it = pp_map[thread_pos].find(page_id);
     if (it == pp_map[thread_pos].end()) {
+        counters.page_misses++;
+        metrics.private_pool.misses.fetch_add(1, std::memory_order_relaxed);
+
         auto& page = get_ppage_available(thread_pos);
         if (page.page_id.file_id.id != FileId::UNASSIGNED) {
             pp_map[thread_pos].erase(page.page_id);
+            metrics.private_pool.evictions.fetch_add(1, std::memory_order_relaxed);
         }
 
         if (page.dirty) {
             file_manager.flush(page);
+            counters.tmp_bytes_written += PPage::SIZE;
+            metrics.private_pool.dirty_flushes.fetch_add(1, std::memory_order_relaxed);
         }
         page.reassign(page_id);
 
-        file_manager.read_tmp_page(page_id, page.get_bytes());
+        if (file_manager.read_tmp_page(page_id, page.get_bytes())) {
+            counters.page_reads++;
+        }
         pp_map[thread_pos].insert({ page_id, &page });
         return page;
     } else {
+        counters.page_hits++;
+        metrics.private_pool.hits.fetch_add(1, std::memory_order_relaxed);
         it->second->pins++;
         return *it->second;
     }
@@ -474,30 +796,189 @@ BufferManager::VersionScope::~VersionScope() {
 
 
 void BufferManager::terminate(const VersionScope& version_scope) {
-    std::lock_guard<std::mutex> lck(running_version_count_mutex);
-    auto it1 = running_version_count.find(version_scope.start_version);
-    assert(it1 != running_version_count.end());
+    if (version_scope.is_editable) {
+        // the result version becomes stable before its slot is released, so it is always in use or stable
+        last_stable_version.fetch_add(1);
+        running_versions.release(version_scope.result_slot);
+        running_versions.release(version_scope.start_slot);
+
+        // the versions replaced by the update are kept as deltas, and discarded now if no query can read them
+        // instead of waiting for the page replacement
+        Metrics::lock(vp_mutex, metrics.vp_mutex_wait_us, metrics.vp_mutex_contentions);
+        std::lock_guard<std::mutex> lck(vp_mutex, std::adopt_lock);
+        for (auto& page_id : current_modifications) {
+            make_deltas(page_id);
+            discard_old_versions(page_id);
+        }
+
+        // TODO: write to log
+        // for (auto& page_id : current_modifications) {
+        // }
+        current_modifications.clear();
+    } else {
+        running_versions.release(version_scope.start_slot);
+    }
+}
+
+
+void BufferManager::unlink_version(VPage& page) {
+    if (page.prev_version != nullptr) {
+        page.prev_version->next_version = page.next_version;
+    } else if (page.next_version != nullptr) {
+        // it was the oldest version and vp_map has to point to the new oldest one
+        vp_map[page.page_id] = page.next_version;
+    } else {
+        vp_map.erase(page.page_id);
+    }
+    if (page.next_version != nullptr) {
+        page.next_version->prev_version = page.prev_version;
+    }
+
+    page.prev_version = nullptr;
+    page.next_version = nullptr;
+    page.dirty        = false;
+    page.has_delta    = false;
+}
 
-    it1->second--;
 
-    if (it1->second == 0) {
-        running_version_count.erase(it1);
+void BufferManager::make_deltas(PageId page_id) {
+    auto it = vp_map.find(page_id);
+    if (it == vp_map.end()) {
+        return;
+    }
+
+    VPage* newest = it->second;
+    while (newest->next_version != nullptr) {
+        newest = newest->next_version;
+    }
+
+    // the versions without a delta before the committed one, the newest first. Usually there is
+    // only the version the update started from
+    std::vector<VPageDelta> new_deltas;
+    for (VPage* page = newest->prev_version; page != nullptr && !page->has_delta; page = page->prev_version) {
+        new_deltas.emplace_back(page->version_number, page->get_bytes(), page->next_version->get_bytes());
+        page->has_delta = true;
+        metrics.page_delta_bytes.fetch_add(new_deltas.back().size(), std::memory_order_relaxed);
+    }
+
+    if (!new_deltas.empty()) {
+        auto& deltas = vp_deltas[page_id];
+        deltas.insert(deltas.end(),
+                      std::make_move_iterator(new_deltas.rbegin()),
+                      std::make_move_iterator(new_deltas.rend()));
+    }
+}
+
+
+VPage& BufferManager::materialize_version(PageId page_id, uint64_t version_number) {
+    // the frame is taken first, the page replacement may unlink versions of this page
+    auto& page = get_vpage_available();
+
+    // the content of the closest newer version that has a frame, the deltas between them are applied
+    // from the newest to the oldest
+    VPage* prev = nullptr;
+    VPage* next = vp_map.find(page_id)->second;
+    while (next->version_number < version_number) {
+        prev = next;
+        next = next->next_version;
+    }
+    std::memcpy(page.get_bytes(), next->get_bytes(), VPage::SIZE);
+
+    auto& deltas = vp_deltas.find(page_id)->second;
+    auto delta = std::lower_bound(deltas.begin(), deltas.end(), next->version_number,
+        [](const VPageDelta& d, uint64_t version) { return d.version_number < version; });
+    while (delta != deltas.begin() && (delta - 1)->version_number >= version_number) {
+        --delta;
+        delta->apply(page.get_bytes());
+    }
+    assert(delta->version_number == version_number);
+
+    page.reassign(page_id);
+    page.version_number = version_number;
+    page.has_delta      = true;
+    page.prev_version   = prev;
+    page.next_version   = next;
+    next->prev_version  = &page;
+    if (prev != nullptr) {
+        prev->next_version = &page;
+    } else {
+        vp_map[page_id] = &page;
     }
-    if (version_scope.is_editable) {
-        auto it2 = running_version_count.find(version_scope.start_version + 1);
-        assert(it2 != running_version_count.end());
 
-        it2->second--;
+    metrics.page_delta_materializations.fetch_add(1, std::memory_order_relaxed);
+    return page;
+}
+
+
+void BufferManager::discard_old_versions(PageId page_id) {
+    auto it = vp_map.find(page_id);
+    if (it == vp_map.end()) {
+        return;
+    }
 
-        if (it2->second == 0) {
-            running_version_count.erase(it2);
+    VPage* page = it->second;
+    while (page->next_version != nullptr) {
+        VPage* next = page->next_version;
+
+        // the version is read by the queries that started between it and the next version
+        if (page->pins == 0 && !running_versions.is_running(page->version_number, next->version_number)) {
+            // a newer version exists, so the content of this one is never written to disk
+            unlink_version(*page);
+
+            page->page_id       = PageId(FileId(FileId::UNASSIGNED), 0);
+            page->second_chance = false;
+            metrics.versioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
         }
+        page = next;
+    }
 
-        last_stable_version++;
+    discard_old_deltas(page_id);
+}
 
-        // TODO: write to log
-        // for (auto& page_id : current_modifications) {
-        // }
-        current_modifications.clear();
+
+bool BufferManager::discard_old_deltas(PageId page_id) {
+    auto it = vp_deltas.find(page_id);
+    if (it == vp_deltas.end()) {
+        return true;
+    }
+    auto& deltas = it->second;
+
+    // the oldest version without a delta, the newest delta restores its version from it
+    VPage* base = vp_map.find(page_id)->second;
+    while (base->has_delta) {
+        base = base->next_version;
+    }
+
+    // the deltas are applied one after the other, only the oldest ones can be discarded. The oldest version
+    // is read by the queries that started before the next version
+    uint64_t discarded = 0;
+    while (discarded < deltas.size()) {
+        auto next_version_number = discarded + 1 < deltas.size() ? deltas[discarded + 1].version_number
+                                                                 : base->version_number;
+        if (running_versions.is_running(0, next_version_number)) {
+            break;
+        }
+        metrics.page_delta_bytes.fetch_sub(deltas[discarded].size(), std::memory_order_relaxed);
+        discarded++;
+    }
+    deltas.erase(deltas.begin(), deltas.begin() + discarded);
+
+    // frames of the discarded versions, no query can have them pinned
+    auto oldest_version_number = deltas.empty() ? base->version_number : deltas.front().version_number;
+    VPage* page = vp_map.find(page_id)->second;
+    while (page->version_number < oldest_version_number && page->pins == 0) {
+        VPage* next = page->next_version;
+        unlink_version(*page);
+
+        page->page_id       = PageId(FileId(FileId::UNASSIGNED), 0);
+        page->second_chance = false;
+        metrics.versioned_pool.evictions.fetch_add(1, std::memory_order_relaxed);
+        page = next;
+    }
+
+    if (deltas.empty()) {
+        vp_deltas.erase(it);
+        return true;
     }
+    return false;
 }
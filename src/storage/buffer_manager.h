@@ -13,6 +13,10 @@ Versioned (VPage), Private (PPage) and Unversioned (UPage)
 Each page type has its own buffer.
 
 For concurrency control the system implements MVCC using VPages.
+When an update commits, the versions of the pages it replaced are kept as
+deltas against the next version (VPageDelta). Their frames become a cache
+that the page replacement can reuse while queries still read them, and
+a version without a frame is materialized again when it is pinned.
 PPages doesn't need concurrency control since they are assigned to a single
 certain worker.
 UPages don't have concurrency control, since they relay on a higher logic
@@ -23,15 +27,20 @@ are not performed or delayed. For example this is used in the StringHash.
 
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <vector>
 
+#include "storage/background_loader.h"
 #include "storage/file_id.h"
 #include "storage/page/private_page.h"
 #include "storage/page/unversioned_page.h"
 #include "storage/page/versioned_page.h"
+#include "storage/page/versioned_page_delta.h"
+#include "storage/running_versions.h"
 #include "third_party/robin_hood/robin_hood.h"
 
 class BufferManager {
@@ -42,9 +51,15 @@ public:
 
         bool is_editable;
 
-        VersionScope(uint64_t start_version, bool is_editable) :
+        // slots in running_versions of the start version and, for editable scopes, the result version
+        uint64_t start_slot;
+        uint64_t result_slot;
+
+        VersionScope(uint64_t start_version, bool is_editable, uint64_t start_slot, uint64_t result_slot) :
             start_version(start_version),
-            is_editable(is_editable) { }
+            is_editable(is_editable),
+            start_slot(start_slot),
+            result_slot(result_slot) { }
 
         ~VersionScope();
     };
@@ -63,6 +78,15 @@ public:
     static_assert(DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE % UPage::SIZE == 0,
                   "DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE should be multiple of UPage::SIZE");
 
+    // maximum bytes of pages loaded by the warm-up at startup
+    static constexpr uint64_t DEFAULT_WARMUP_SIZE = 1024ULL * 1024 * 1024; // 1 GB
+
+    static constexpr uint_fast32_t WARMUP_THREADS = 4;
+
+    static constexpr std::chrono::minutes HOT_PAGES_SAVE_INTERVAL { 10 };
+
+    static constexpr const char* HOT_PAGES_FILENAME = "hot_pages.dat";
+
     ~BufferManager();
 
     // necessary to be called before first usage
@@ -108,6 +132,20 @@ public:
     // write all dirty pages to disk
     void flush();
 
+    // write all dirty pages to disk and remove from the versioned and unversioned buffers every page that
+    // is not pinned and has a single version, so the next accesses have to read them again.
+    // Must not be called while a query is running
+    void clear_cache();
+
+    // Loads in the background up to `budget` bytes of the pages that were in the versioned and unversioned
+    // buffers when the hot pages were saved, so queries can run while the buffers warm up. Afterwards the hot
+    // pages are saved every HOT_PAGES_SAVE_INTERVAL and when the buffer manager is destroyed.
+    // Must be called after the model opened its files
+    void start_warmup(uint64_t budget);
+
+    // Writes the pages of the versioned and unversioned buffers in clock order, the next to be evicted first
+    void save_hot_pages();
+
     // increases the count of objects using the page. When you get a page using the methods of the buffer manager
     // the page is already pinned, so you shouldn't call this method unless you want to pin the page more than once
     void pin(VPage& page) {
@@ -137,18 +175,33 @@ public:
     void remove_tmp(TmpFileId tmp_file_id);
 
     std::unique_ptr<VersionScope> init_version_readonly() {
-        std::lock_guard<std::mutex> lck(running_version_count_mutex);
-        auto ver = last_stable_version;
-        running_version_count[ver]++;
-        return std::make_unique<VersionScope>(ver, false);
+        auto ver  = last_stable_version.load();
+        auto slot = running_versions.acquire(ver);
+        // an update may have finished before the version was registered, and its old page versions may have
+        // been discarded. The registered version must be the last stable version at some point after registering it
+        for (auto current = last_stable_version.load(); current != ver; current = last_stable_version.load()) {
+            ver = current;
+            running_versions.set(slot, ver);
+        }
+        return std::make_unique<VersionScope>(ver, false, slot, RunningVersions::EMPTY);
     }
 
+    // Only one editable version can exist at a time, callers must prevent concurrent updates
     std::unique_ptr<VersionScope> init_version_editable() {
-        std::lock_guard<std::mutex> lck(running_version_count_mutex);
-        auto ver = last_stable_version;
-        running_version_count[ver]++;
-        running_version_count[ver+1]++;
-        return std::make_unique<VersionScope>(ver, true);
+        auto ver         = last_stable_version.load();
+        auto start_slot  = running_versions.acquire(ver);
+        auto result_slot = running_versions.acquire(ver + 1);
+        return std::make_unique<VersionScope>(ver, true, start_slot, result_slot);
+    }
+
+    // version that new read-only queries will use
+    uint64_t get_last_stable_version() {
+        return last_stable_version.load();
+    }
+
+    // number of versions that have a running query or update
+    uint64_t get_running_version_count() {
+        return running_versions.count();
     }
 
 private:
@@ -174,14 +227,15 @@ private:
     // it points to the oldest version present in the pool
     robin_hood::unordered_flat_map<PageId, VPage*> vp_map;
 
-    // last version that finished its execution
-    uint64_t last_stable_version = 0;
+    // deltas of the old versions of each page, oldest first. Each one restores its version from the
+    // next one, the newest delta from the oldest version that has no delta, which is always in vp_pool
+    robin_hood::unordered_flat_map<PageId, std::vector<VPageDelta>> vp_deltas;
 
-    // prevents concurrent modifications in running_version_count
-    std::mutex running_version_count_mutex;
+    // last version that finished its execution
+    std::atomic<uint64_t> last_stable_version { 0 };
 
-    // version -> count, count cannot be 0 (must be deleted when it reaches 0)
-    std::map<uint64_t, uint64_t> running_version_count;
+    // versions of the running queries and updates
+    RunningVersions running_versions;
 
     // TODO: maybe would be useful to execute delayed deletes
     // version -> count
@@ -234,6 +288,18 @@ private:
     robin_hood::unordered_flat_map<PageId, UPage*> up_map;
 
 
+    ////////////////////// WARM-UP //////////////////////
+
+    // loads the hot pages and saves them periodically
+    BackgroundLoader warmup_loader;
+
+    // only the buffer manager of a server that started the warm-up saves the hot pages
+    bool save_hot_pages_on_exit = false;
+
+    // next frames of the pools the warm-up checks for being free, the frames before them are never used by it
+    uint64_t vp_warm_cursor = 0;
+    uint64_t up_warm_cursor = 0;
+
     ////////////////////// PRIVATE METHODS //////////////////////
     BufferManager(uint64_t versioned_page_buffer_pool_size,
                   uint64_t private_page_buffer_pool_size_per_worker,
@@ -249,6 +315,32 @@ private:
     // returns an unpinned page from up_pool
     UPage& get_upage_available();
 
+    // Removes the version from the list of versions of its page. Needs vp_mutex locked
+    void unlink_version(VPage& page);
+
+    // Keeps a delta of the versions of the page replaced by the update that is committing. Needs vp_mutex locked
+    void make_deltas(PageId page_id);
+
+    // Returns a pinned frame with the content of a version of the page that only has a delta.
+    // Needs vp_mutex locked
+    VPage& materialize_version(PageId page_id, uint64_t version_number);
+
+    // Discards the versions of the page that are not the newest one and no running query can read,
+    // returning their frames to the pool. Needs vp_mutex locked
+    void discard_old_versions(PageId page_id);
+
+    // Discards the oldest deltas of the page while no running query can read them. Returns true if the
+    // page has no deltas left. Needs vp_mutex locked
+    bool discard_old_deltas(PageId page_id);
+
+    // Reads the page into a free frame of the versioned buffer if it is not already there. Returns false
+    // when there are no free frames left, so the warm-up doesn't evict pages
+    bool warm_vpage(PageId page_id);
+
+    // Reads the page into a free frame of the unversioned buffer if it is not already there. Returns false
+    // when there are no free frames left, so the warm-up doesn't evict pages
+    bool warm_upage(PageId page_id);
+
     // Only meant to be called by the VersionScope destructor
     void terminate(const VersionScope& version_scope);
 };
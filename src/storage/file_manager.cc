@@ -40,6 +40,17 @@ void FileManager::init(const std::string& db_folder) {
 }
 
 
+void FileManager::drop_os_cache() const {
+#ifdef POSIX_FADV_DONTNEED
+    std::lock_guard<std::mutex> lck(files_mutex);
+    for (auto& [filename, file_id] : filename2file_id) {
+        fdatasync(file_id.id);
+        posix_fadvise(file_id.id, 0, 0, POSIX_FADV_DONTNEED);
+    }
+#endif
+}
+
+
 void FileManager::flush(VPage& page) const {
     auto fd = page.page_id.file_id.id;
     lseek(fd, page.page_id.page_number*VPage::SIZE, SEEK_SET);
@@ -84,7 +95,7 @@ void FileManager::flush(TensorPage& page) const {
 }
 
 
-void FileManager::read_tmp_page(PageId page_id, char* bytes) const {
+bool FileManager::read_tmp_page(PageId page_id, char* bytes) const {
     auto fd = page_id.file_id.id;
     lseek(fd, 0, SEEK_END);
 
@@ -101,12 +112,14 @@ void FileManager::read_tmp_page(PageId page_id, char* bytes) const {
         if (write_res == -1) {
             throw std::runtime_error("Could not write into file");
         }
+        return false;
     } else {
         // reading existing file page
         auto read_res = read(fd, bytes, VPage::SIZE);
         if (read_res == -1) {
             throw std::runtime_error("Could not read file page");
         }
+        return true;
     }
 }
 
@@ -152,7 +165,14 @@ uint32_t FileManager::append_page(FileId file_id, char* bytes) const {
 }
 
 
+std::map<std::string, FileId> FileManager::get_files() const {
+    std::lock_guard<std::mutex> lck(files_mutex);
+    return filename2file_id;
+}
+
+
 FileId FileManager::get_file_id(const string& filename) {
+    std::lock_guard<std::mutex> lck(files_mutex);
     auto search = filename2file_id.find(filename);
     if (search != filename2file_id.end()) {
         return search->second;
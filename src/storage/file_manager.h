@@ -22,6 +22,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <string>
 
 #ifdef _MSC_VER
@@ -50,6 +51,9 @@ public:
     // Get an id for the corresponding file, creating it if it's necessary
     FileId get_file_id(const std::string& filename);
 
+    // Returns a copy of the opened files and their ids, as other threads may be opening files
+    std::map<std::string, FileId> get_files() const;
+
     // Create a new temporary file id
     TmpFileId get_tmp_file_id();
 
@@ -63,6 +67,9 @@ public:
     // // delete the file represented by `tmp_file_id`, pages in private buffer using that tmp_file_id are cleared
     void remove_tmp(TmpFileId tmp_file_id);
 
+    // ask the OS to drop the cached pages of the database files, so the next reads go to the disk
+    void drop_os_cache() const;
+
     inline const std::string get_file_path(const std::string& filename) const noexcept {
         return db_folder + "/" + filename;
     }
@@ -73,6 +80,9 @@ private:
 
     std::map<std::string, FileId> filename2file_id;
 
+    // protects filename2file_id, files can be opened while the server runs (e.g. when an index is created)
+    mutable std::mutex files_mutex;
+
     // private constructor, other classes must use the global object `file_manager`
     FileManager(const std::string& db_folder);
 
@@ -89,7 +99,8 @@ private:
     void flush(TensorPage& page) const;
 
     // read a tmp page from disk into memory pointed by `bytes`.
-    void read_tmp_page(PageId page_id, char* bytes) const;
+    // Returns false if the page didn't exist in the file and was initialized with zeros
+    bool read_tmp_page(PageId page_id, char* bytes) const;
 
     // read a page from disk into memory pointed by `bytes`.
     void read_existing_page(PageId page_id, char* bytes) const;
@@ -157,6 +157,44 @@ const Record<N>* BptIter<N>::next() {
 }
 
 
+template <std::size_t N>
+uint64_t BptIter<N>::count() {
+    uint64_t res = 0;
+    while (true) {
+        if (MDB_unlikely(*interruption_requested)) {
+            throw InterruptedException();
+        }
+        const uint_fast32_t value_count = current_leaf.get_value_count();
+        if (current_pos < value_count) {
+            current_leaf.get_record(value_count - 1, &current_record);
+            if (current_record <= max) {
+                res += value_count - current_pos;
+                current_pos = value_count;
+            } else {
+                // the range ends in this leaf, end is the position of the first record greater than max
+                auto end = current_leaf.search_index(max);
+                current_leaf.get_record(end, &current_record);
+                if (current_record == max) {
+                    ++end;
+                }
+                if (end > current_pos) {
+                    res += end - current_pos;
+                }
+                current_pos = value_count;
+                return res;
+            }
+        }
+
+        if (current_leaf.has_next()) {
+            current_leaf.update_to_next_leaf();
+            current_pos = 0;
+        } else {
+            return res;
+        }
+    }
+}
+
+
 template class BPlusTree<1>;
 template class BPlusTree<2>;
 template class BPlusTree<3>;
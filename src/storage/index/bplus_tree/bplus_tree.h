@@ -40,6 +40,10 @@ public:
 
     const Record<N>* next();
 
+    // Returns the number of remaining records in the range, consuming them. Leaves whose last
+    // record is in the range are counted with their value count instead of reading each record
+    uint64_t count();
+
     inline bool is_null() const {
         return interruption_requested == nullptr;
     }
@@ -7,6 +7,7 @@
 #include "storage/buffer_manager.h"
 #include "storage/index/bplus_tree/bplus_tree_leaf.h"
 #include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/bplus_tree/bplus_tree_search.h"
 #include "storage/index/record.h"
 
 
@@ -90,6 +91,9 @@ std::unique_ptr<BPlusTreeSplit<N>> BPlusTreeDir<N>::insert(const Record<N>& reco
             update_key(splitted_index, split->record);
             update_child(splitted_index+1, split->encoded_page_number);
             ++(*key_count);
+            if (split->retry_insert) {
+                return insert(record, error);
+            }
             return nullptr;
         }
         // Case 2: we need to split this node and this node is the root
@@ -170,6 +174,9 @@ std::unique_ptr<BPlusTreeSplit<N>> BPlusTreeDir<N>::insert(const Record<N>& reco
             );
             children[0] = static_cast<int32_t>(new_lhs_dir.page->get_page_number()) * -1;
             children[1] = static_cast<int32_t>(new_rhs_dir.page->get_page_number()) * -1;
+            if (split->retry_insert) {
+                return insert(record, error);
+            }
             return nullptr;
         }
         // Case 3: normal split (this node is not the root)
@@ -231,9 +238,11 @@ std::unique_ptr<BPlusTreeSplit<N>> BPlusTreeDir<N>::insert(const Record<N>& reco
                 &keys[middle_index*N],
                 N * sizeof(uint64_t)
             );
-            return std::make_unique<BPlusTreeSplit<N>>(
+            auto new_split = std::make_unique<BPlusTreeSplit<N>>(
                 std::move(split_key),
                 new_page.get_page_number()*-1);
+            new_split->retry_insert = split->retry_insert;
+            return new_split;
         }
     }
     return nullptr;
@@ -316,30 +325,10 @@ SearchLeafResult<N> BPlusTreeDir<N>::search_leaf(
 }
 
 
+// returns how many keys are less or equal than the record
 template <std::size_t N>
 size_t BPlusTreeDir<N>::search_child_index(const Record<N>& record) const noexcept {
-    int_fast32_t dir_from = 0;
-    int_fast32_t dir_to = *key_count;
-search_child_index_begin:
-    if (dir_from == dir_to) {
-        return dir_from;
-    }
-    int_fast32_t middle_dir = (dir_from + dir_to + 1) / 2;
-    int_fast32_t middle_record = middle_dir-1;
-
-    for (uint_fast32_t i = 0; i < N; i++) {
-        auto id = keys[middle_record*N + i];
-        if (record[i] < id) {
-            dir_to = middle_record;
-            goto search_child_index_begin;
-        } else if (record[i] > id) {
-            dir_from = middle_record+1;
-            goto search_child_index_begin;
-        }
-        // continue if they were equal
-    }
-    dir_from = middle_record+1;
-    goto search_child_index_begin;
+    return BPlusTreeSearch::count_before<N, true>(keys, *key_count, record);
 }
 
 
@@ -418,9 +407,7 @@ bool BPlusTreeDir<N>::check(std::ostream& os) const {
         else { // positive number: pointer to leaf
             auto& left_page = buffer_manager.get_page_readonly(leaf_file_id, left_pointer);
             BPlusTreeLeaf<N> left_child(&left_page);
-            for (uint_fast32_t j = 0; j < N; j++) {
-                greatest_left_key[j] = left_child.records[((*left_child.value_count-1) * N) + j];
-            }
+            left_child.get_record(left_child.get_value_count() - 1, &greatest_left_key);
         }
 
         // Set smallest_right_key
@@ -439,11 +426,10 @@ bool BPlusTreeDir<N>::check(std::ostream& os) const {
         else { // positive number: pointer to leaf
             auto& right_page = buffer_manager.get_page_readonly(leaf_file_id, right_pointer);
             BPlusTreeLeaf<N> right_child(&right_page);
-            for (uint_fast32_t j = 0; j < N; j++) {
-                smallest_right_key[j] = right_child.records[j];
-            }
-            if (*right_child.value_count == 0) {
+            if (right_child.get_value_count() == 0) {
                 right_empty = true;
+            } else {
+                right_child.get_record(0, &smallest_right_key);
             }
         }
 
@@ -4,6 +4,7 @@
 
 #include "storage/buffer_manager.h"
 #include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/bplus_tree/bplus_tree_search.h"
 
 using namespace std;
 
@@ -29,10 +30,21 @@ void BPlusTreeLeaf<N>::update_to_next_leaf() {
 
     buffer_manager.unpin(*page);
 
-    page        = &buffer_manager.get_page_readonly(leaf_file_id, next_page_number);
+    page = &buffer_manager.get_page_readonly(leaf_file_id, next_page_number);
+    load_page_format();
+}
+
+
+template <std::size_t N>
+void BPlusTreeLeaf<N>::load_page_format() noexcept {
     records     = reinterpret_cast<uint64_t*>(page->get_bytes() + (2*sizeof(uint32_t)) );
     value_count = reinterpret_cast<uint32_t*>(page->get_bytes());
     next_leaf   = reinterpret_cast<uint32_t*>(page->get_bytes() + sizeof(uint32_t));
+
+    compressed = CompressedLeaf<N>::is_compressed(page->get_bytes());
+    if (compressed) {
+        compressed_leaf.load(page->get_bytes());
+    }
 }
 
 
@@ -43,10 +55,7 @@ void BPlusTreeLeaf<N>::upgrade_to_editable() {
         auto new_page = &buffer_manager.get_page_editable(leaf_file_id, page->get_page_number());
         buffer_manager.unpin(*page);
         page = new_page;
-
-        records     = reinterpret_cast<uint64_t*>(page->get_bytes() + (2*sizeof(uint32_t)) );
-        value_count = reinterpret_cast<uint32_t*>(page->get_bytes());
-        next_leaf   = reinterpret_cast<uint32_t*>(page->get_bytes() + sizeof(uint32_t));
+        load_page_format();
     }
 }
 
@@ -54,19 +63,34 @@ void BPlusTreeLeaf<N>::upgrade_to_editable() {
 template <std::size_t N>
 void BPlusTreeLeaf<N>::get_record(uint_fast32_t pos, Record<N>* out) const {
     for (uint_fast32_t i = 0; i < N; i++) {
-        (*out)[i] = records[pos*N + i];
+        (*out)[i] = get_value(pos, i);
+    }
+}
+
+
+template <std::size_t N>
+void BPlusTreeLeaf<N>::decode_all(std::vector<uint64_t>& out) const {
+    auto count = get_value_count();
+    out.resize(count * N);
+    for (uint_fast32_t pos = 0; pos < count; pos++) {
+        for (uint_fast32_t i = 0; i < N; i++) {
+            out[pos*N + i] = compressed_leaf.get(pos, i);
+        }
     }
 }
 
 
 template <std::size_t N>
 bool BPlusTreeLeaf<N>::delete_record(const Record<N>& record) {
-    if (*value_count == 0) {
+    if (get_value_count() == 0) {
         return false;
     }
+    if (compressed) {
+        return delete_record_compressed(record);
+    }
 
     uint_fast32_t index = search_index(record);
-    if (equal_record(record, index)) {
+    if (index < *value_count && equal_record(record, index)) {
         upgrade_to_editable();
         --(*value_count);
         for (auto i = index; i < (*value_count); i++) {
@@ -83,6 +107,9 @@ bool BPlusTreeLeaf<N>::delete_record(const Record<N>& record) {
 
 template <std::size_t N>
 unique_ptr<BPlusTreeSplit<N>> BPlusTreeLeaf<N>::insert(const Record<N>& record, bool& error) {
+    if (compressed) {
+        return insert_compressed(record, error);
+    }
     if (*value_count == 0) {
         upgrade_to_editable();
 
@@ -96,7 +123,7 @@ unique_ptr<BPlusTreeSplit<N>> BPlusTreeLeaf<N>::insert(const Record<N>& record,
     uint_fast32_t index = search_index(record);
 
     // avoid inserting duplicated record
-    if (equal_record(record, index)) {
+    if (index < *value_count && equal_record(record, index)) {
         error = true;
         return nullptr;
     }
@@ -170,18 +197,114 @@ unique_ptr<BPlusTreeSplit<N>> BPlusTreeLeaf<N>::insert(const Record<N>& record,
 }
 
 
+// Compressed leaves are rewritten entirely. If the records don't fit anymore the leaf
+// falls back to the raw format when possible, otherwise it is split in two compressed
+// leaves without inserting the record, and split->retry_insert tells the caller to
+// search the leaf again.
+template <std::size_t N>
+unique_ptr<BPlusTreeSplit<N>> BPlusTreeLeaf<N>::insert_compressed(const Record<N>& record, bool& error) {
+    uint_fast32_t index = search_index(record);
+    auto count = get_value_count();
+
+    // avoid inserting duplicated record
+    if (index < count && equal_record(record, index)) {
+        error = true;
+        return nullptr;
+    }
+    error = false;
+
+    std::vector<uint64_t> all_records;
+    decode_all(all_records);
+    all_records.insert(all_records.begin() + index*N, record.begin(), record.end());
+
+    upgrade_to_editable();
+
+    if (CompressedLeaf<N>::encode(all_records.data(), count + 1, page->get_bytes())) {
+        load_page_format();
+        return nullptr;
+    }
+
+    if (count + 1 <= BPlusTree<N>::leaf_max_records) {
+        *value_count = count + 1;
+        std::memcpy(records, all_records.data(), (count + 1) * N * sizeof(uint64_t));
+        load_page_format();
+        return nullptr;
+    }
+
+    // split the old records, each half fits because they were a single compressed leaf
+    all_records.erase(all_records.begin() + index*N, all_records.begin() + (index+1)*N);
+    auto middle_index = count / 2;
+
+    auto& new_page = buffer_manager.append_vpage(leaf_file_id);
+    auto new_leaf = BPlusTreeLeaf<N>(&new_page);
+
+    *new_leaf.next_leaf = *next_leaf;
+    *next_leaf = new_leaf.page->get_page_number();
+
+    CompressedLeaf<N>::encode(&all_records[middle_index*N], count - middle_index, new_page.get_bytes());
+    CompressedLeaf<N>::encode(all_records.data(), middle_index, page->get_bytes());
+    load_page_format();
+
+    std::array<uint64_t, N> split_key;
+    for (uint_fast32_t i = 0; i < N; i++) {
+        split_key[i] = all_records[middle_index*N + i];
+    }
+    auto split = make_unique<BPlusTreeSplit<N>>(Record<N>(std::move(split_key)), new_page.get_page_number());
+    split->retry_insert = true;
+    return split;
+}
+
+
+template <std::size_t N>
+bool BPlusTreeLeaf<N>::delete_record_compressed(const Record<N>& record) {
+    uint_fast32_t index = search_index(record);
+    auto count = get_value_count();
+
+    if (index >= count || !equal_record(record, index)) {
+        return false;
+    }
+
+    std::vector<uint64_t> all_records;
+    decode_all(all_records);
+    all_records.erase(all_records.begin() + index*N, all_records.begin() + (index+1)*N);
+
+    upgrade_to_editable();
+    if (count == 1) {
+        // empty leaves always use the raw format
+        *value_count = 0;
+    } else {
+        // removing a record never makes the encoding bigger
+        CompressedLeaf<N>::encode(all_records.data(), count - 1, page->get_bytes());
+    }
+    load_page_format();
+    return true;
+}
+
+
 // returns the position of the minimum key greater or equal than the record given.
 // if there is no such key, returns (to + 1)
 template <std::size_t N>
 uint_fast32_t BPlusTreeLeaf<N>::search_index(const Record<N>& record) const noexcept {
+    if (MDB_likely(!compressed)) {
+        return BPlusTreeSearch::count_before<N, false>(records, *value_count, record);
+    }
+    return search_index(record, [this](uint_fast32_t pos, uint_fast32_t col) {
+        return compressed_leaf.get(pos, col);
+    });
+}
+
+
+template <std::size_t N>
+template <typename Getter>
+uint_fast32_t BPlusTreeLeaf<N>::search_index(const Record<N>& record, Getter&& get) const noexcept {
     int_fast32_t from = 0;
-    int_fast32_t to = static_cast<int_fast32_t>(*value_count)-1;
+    int_fast32_t to = static_cast<int_fast32_t>(get_value_count())-1;
 search_index_begin:
     if (from < to) {
         auto middle = (from + to) / 2;
 
         for (uint_fast32_t i = 0; i < N; i++) {
-            auto id = records[middle*N + i];
+            auto id = get(middle, i);
             if (record[i] < id) { // record is smaller
                 to = middle - 1;
                 goto search_index_begin;
@@ -195,7 +318,7 @@ search_index_begin:
     }
     // from >= to
     for (uint_fast32_t i = 0; i < N; ++i) {
-        auto id = records[from*N + i];
+        auto id = get(from, i);
         if (record[i] < id) {
             return from;
         } else if (record[i] > id) {
@@ -220,7 +343,7 @@ void BPlusTreeLeaf<N>::shift_right_records(int_fast32_t from, int_fast32_t to) {
 template <std::size_t N>
 bool BPlusTreeLeaf<N>::equal_record(const Record<N>& record, uint_fast32_t index) {
     for (uint_fast32_t i = 0; i < N; i++) {
-        if (records[N*index + i] != record[i]) {
+        if (get_value(index, i) != record[i]) {
             return false;
         }
     }
@@ -230,14 +353,15 @@ bool BPlusTreeLeaf<N>::equal_record(const Record<N>& record, uint_fast32_t index
 
 template <std::size_t N>
 bool BPlusTreeLeaf<N>::check_range(const Record<N>& r) const {
-    if (*value_count == 0) {
+    auto count = get_value_count();
+    if (count == 0) {
         return false;
     }
     std::array<uint64_t, N> min;
     std::array<uint64_t, N> max;
     for (uint_fast32_t i = 0; i < N; i++) {
-        min[i] = records[0*N + i];
-        max[i] = records[(*value_count-1)*N + i];
+        min[i] = get_value(0, i);
+        max[i] = get_value(count-1, i);
     }
 
     return min <= r && r <= max;
@@ -247,12 +371,12 @@ bool BPlusTreeLeaf<N>::check_range(const Record<N>& r) const {
 template <std::size_t N>
 void BPlusTreeLeaf<N>::print(std::ostream& os) const {
     os << "Printing Leaf:\n";
-    for (uint_fast32_t i = 0; i < (*value_count); i++) {
+    for (uint_fast32_t i = 0; i < get_value_count(); i++) {
         os << "  (";
         for (uint_fast32_t j = 0; j < N; j++) {
             if (j != 0)
                 os << ", ";
-            os << records[i*N + j];
+            os << get_value(i, j);
         }
         os << ")\n";
     }
@@ -261,7 +385,8 @@ void BPlusTreeLeaf<N>::print(std::ostream& os) const {
 
 template <std::size_t N>
 bool BPlusTreeLeaf<N>::check(std::ostream& os) const {
-    if ((*value_count) == 0) {
+    auto count = get_value_count();
+    if (count == 0) {
         if (page->get_page_number() == 0) {
             os << "  WARNING: empty leaf. Ok only if the b+tree is empty.\n";
         } else {
@@ -273,19 +398,17 @@ bool BPlusTreeLeaf<N>::check(std::ostream& os) const {
         std::array<uint64_t, N> x;
         std::array<uint64_t, N> y;
 
-        uint_fast32_t current_pos = 0;
-        while (current_pos < N) {
-            if (records[current_pos] == 0xFFFF'FFFF'FFFF'FFFF) {
+        for (uint_fast32_t i = 0; i < N; i++) {
+            x[i] = get_value(0, i);
+            if (x[i] == 0xFFFF'FFFF'FFFF'FFFF) {
                 os << "  ERROR: record not_found(0xFFFF'FFFF'FFFF'FFFF) at BPlusTreeLeaf\n";
                 return false;
             }
-            x[current_pos] = records[current_pos];
-            current_pos++;
         }
 
-        for (uint_fast32_t k = 1; k < (*value_count); k++) {
+        for (uint_fast32_t k = 1; k < count; k++) {
             for (uint_fast32_t i = 0; i < N; i++) {
-                y[i] = records[current_pos++];
+                y[i] = get_value(k, i);
             }
             if (y <= x) {
                 os << "  ERROR: bad record order at BPlusTreeLeaf(page: " << page->get_page_number() << ")\n";
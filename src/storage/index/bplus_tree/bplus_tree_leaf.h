@@ -3,7 +3,10 @@
 #include <memory>
 #include <ostream>
 #include <utility>
+#include <vector>
 
+#include "macros/likely.h"
+#include "storage/index/bplus_tree/bplus_tree_leaf_codec.h"
 #include "storage/index/bplus_tree/bplus_tree_split.h"
 #include "storage/index/record.h"
 #include "storage/page/versioned_page.h"
@@ -37,26 +40,30 @@ public:
         leaf_file_id (FileId::UNASSIGNED) { }
 
     BPlusTreeLeaf(VPage* page) noexcept :
-        records      ( reinterpret_cast<uint64_t*>(page->get_bytes() + (2*sizeof(uint32_t)) ) ),
-        value_count  ( reinterpret_cast<uint32_t*>(page->get_bytes()) ),
-        next_leaf    ( reinterpret_cast<uint32_t*>(page->get_bytes() + sizeof(uint32_t)) ),
         page         (page),
-        leaf_file_id (page->page_id.file_id) { }
+        leaf_file_id (page->page_id.file_id)
+    {
+        load_page_format();
+    }
 
     BPlusTreeLeaf(BPlusTreeLeaf&& other) noexcept :
-        records      (other.records),
-        value_count  (other.value_count),
-        next_leaf    (other.next_leaf),
-        page         (std::exchange(other.page, nullptr)),
-        leaf_file_id (other.leaf_file_id) { }
+        records         (other.records),
+        value_count     (other.value_count),
+        next_leaf       (other.next_leaf),
+        compressed      (other.compressed),
+        compressed_leaf (other.compressed_leaf),
+        page            (std::exchange(other.page, nullptr)),
+        leaf_file_id    (other.leaf_file_id) { }
 
     ~BPlusTreeLeaf();
 
     void operator=(BPlusTreeLeaf&& other) noexcept {
-        records      = other.records;
-        value_count  = other.value_count;
-        next_leaf    = other.next_leaf;
-        leaf_file_id = other.leaf_file_id;
+        records         = other.records;
+        value_count     = other.value_count;
+        next_leaf       = other.next_leaf;
+        compressed      = other.compressed;
+        compressed_leaf = other.compressed_leaf;
+        leaf_file_id    = other.leaf_file_id;
 
         this->page = std::exchange(other.page, this->page);
     }
@@ -66,7 +73,8 @@ public:
     void update_to_next_leaf();
 
     inline VPage& get_page()          const { return *page; }
-    inline uint32_t get_value_count() const { return *value_count; }
+    inline uint32_t get_value_count() const { return *value_count & ~CompressedLeaf<N>::FLAG; }
+    inline bool is_compressed()       const { return compressed; }
     inline bool has_next()            const { return *next_leaf != 0; }
 
     // returns false if an error in this leaf is found
@@ -95,15 +103,40 @@ public:
     bool check_range(const Record<N>& r) const;
 
 private:
+    // only valid when the leaf is not compressed
     uint64_t* records;
     uint32_t* value_count;
     uint32_t* next_leaf;
 
+    bool compressed;
+
+    // only valid when the leaf is compressed
+    CompressedLeaf<N> compressed_leaf;
+
     VPage* page;
     FileId leaf_file_id;
 
+    // sets the pointers to the page data, must be called every time the page changes
+    void load_page_format() noexcept;
+
+    inline uint64_t get_value(uint_fast32_t pos, uint_fast32_t col) const {
+        if (MDB_likely(!compressed)) {
+            return records[pos*N + col];
+        }
+        return compressed_leaf.get(pos, col);
+    }
+
+    template <typename Getter>
+    uint_fast32_t search_index(const Record<N>& record, Getter&& get) const noexcept;
+
     void upgrade_to_editable();
 
+    // copies all the records of the compressed leaf into out
+    void decode_all(std::vector<uint64_t>& out) const;
+
+    std::unique_ptr<BPlusTreeSplit<N>> insert_compressed(const Record<N>& record, bool& error);
+    bool delete_record_compressed(const Record<N>& record);
+
     bool equal_record(const Record<N>& record, uint_fast32_t index);
     void shift_right_records(int_fast32_t from, int_fast32_t to);
 };
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "storage/page/versioned_page.h"
+
+// Read-optimized format for B+tree leaves.
+//
+// Each column is stored as the difference against the minimum value of that column
+// in the leaf (base), bit-packed using the minimum number of bits that represents
+// the greatest difference. A column that has the same value in every record of the
+// leaf (e.g. the first column of a permutation with long runs of equal prefixes) uses
+// 0 bits, so it is stored only once in the base.
+// Records are packed one after another, so the record at any position can be decoded
+// without decoding the previous ones, and binary search inside the leaf still works.
+//
+// Layout:
+// [value_count | FLAG] [next_leaf] [base: N * uint64_t] [bits: 8 * uint8_t] [packed data]
+//
+// Raw leaves never have the FLAG bit set in value_count, so both formats can coexist
+// in the same B+tree.
+template <std::size_t N>
+class CompressedLeaf {
+    static_assert(N <= 8, "bits array of the header is 8 bytes long");
+
+public:
+    static constexpr uint32_t FLAG = 0x8000'0000;
+
+    static constexpr uint64_t BASE_OFFSET = 2*sizeof(uint32_t);
+    static constexpr uint64_t BITS_OFFSET = BASE_OFFSET + N*sizeof(uint64_t);
+    static constexpr uint64_t DATA_OFFSET = BITS_OFFSET + 8;
+    static constexpr uint64_t DATA_WORDS  = (VPage::SIZE - DATA_OFFSET) / sizeof(uint64_t);
+
+    static inline bool is_compressed(const char* page_bytes) {
+        return (*reinterpret_cast<const uint32_t*>(page_bytes) & FLAG) != 0;
+    }
+
+    static inline uint64_t bits_needed(uint64_t range) {
+        return range == 0 ? 0 : 64 - __builtin_clzll(range);
+    }
+
+    static inline uint64_t words_needed(uint64_t count, uint64_t record_bits) {
+        return (count * record_bits + 63) / 64;
+    }
+
+    CompressedLeaf() = default;
+
+    // page_bytes must point to a page with a compressed leaf
+    void load(const char* page_bytes) {
+        auto bits_ptr = reinterpret_cast<const uint8_t*>(page_bytes + BITS_OFFSET);
+        std::memcpy(base.data(), page_bytes + BASE_OFFSET, N*sizeof(uint64_t));
+
+        record_bits = 0;
+        for (std::size_t col = 0; col < N; col++) {
+            bits[col]    = bits_ptr[col];
+            offsets[col] = record_bits;
+            masks[col]   = bits[col] == 64 ? UINT64_MAX : (1ULL << bits[col]) - 1;
+            record_bits += bits[col];
+        }
+        data = reinterpret_cast<const uint64_t*>(page_bytes + DATA_OFFSET);
+    }
+
+    inline uint64_t get(uint_fast32_t pos, uint_fast32_t col) const {
+        const uint64_t bit   = pos * record_bits + offsets[col];
+        const uint64_t word  = bit / 64;
+        const uint64_t shift = bit % 64;
+
+        uint64_t value = data[word] >> shift;
+        if (shift + bits[col] > 64) {
+            value |= data[word + 1] << (64 - shift);
+        }
+        return base[col] + (value & masks[col]);
+    }
+
+    // Writes `count` records (ordered) in the page with the compressed format,
+    // next_leaf is not modified. Returns false (without modifying the page) if they don't fit.
+    static bool encode(const uint64_t* records, uint32_t count, char* page_bytes) {
+        std::array<uint64_t, N> min;
+        std::array<uint64_t, N> max;
+        for (std::size_t col = 0; col < N; col++) {
+            min[col] = UINT64_MAX;
+            max[col] = 0;
+        }
+        for (uint_fast32_t i = 0; i < count; i++) {
+            for (std::size_t col = 0; col < N; col++) {
+                auto value = records[i*N + col];
+                if (value < min[col]) min[col] = value;
+                if (value > max[col]) max[col] = value;
+            }
+        }
+
+        std::array<uint8_t, 8> new_bits = {};
+        uint64_t new_record_bits = 0;
+        for (std::size_t col = 0; col < N; col++) {
+            if (count == 0) {
+                min[col] = 0;
+            }
+            new_bits[col] = bits_needed(max[col] - min[col]);
+            new_record_bits += new_bits[col];
+        }
+
+        if (words_needed(count, new_record_bits) > DATA_WORDS) {
+            return false;
+        }
+
+        *reinterpret_cast<uint32_t*>(page_bytes) = count | FLAG;
+        std::memcpy(page_bytes + BASE_OFFSET, min.data(), N*sizeof(uint64_t));
+        std::memcpy(page_bytes + BITS_OFFSET, new_bits.data(), 8);
+
+        auto out = reinterpret_cast<uint64_t*>(page_bytes + DATA_OFFSET);
+        std::memset(out, 0, DATA_WORDS*sizeof(uint64_t));
+
+        uint64_t bit = 0;
+        for (uint_fast32_t i = 0; i < count; i++) {
+            for (std::size_t col = 0; col < N; col++) {
+                if (new_bits[col] == 0) {
+                    continue;
+                }
+                const uint64_t value = records[i*N + col] - min[col];
+                const uint64_t word  = bit / 64;
+                const uint64_t shift = bit % 64;
+
+                out[word] |= value << shift;
+                if (shift + new_bits[col] > 64) {
+                    out[word + 1] |= value >> (64 - shift);
+                }
+                bit += new_bits[col];
+            }
+        }
+        return true;
+    }
+
+private:
+    std::array<uint64_t, N> base;
+    std::array<uint64_t, N> masks;
+    std::array<uint8_t, N>  bits;
+    std::array<uint32_t, N> offsets;
+    uint64_t record_bits;
+    const uint64_t* data;
+};
+
+
+// Used by the bulk import to know how many ordered records fit in a compressed leaf,
+// records are added one by one until one doesn't fit.
+template <std::size_t N>
+class CompressedLeafSizer {
+public:
+    CompressedLeafSizer() {
+        clear();
+    }
+
+    void clear() {
+        count = 0;
+        for (std::size_t col = 0; col < N; col++) {
+            min[col] = UINT64_MAX;
+            max[col] = 0;
+        }
+    }
+
+    // returns false if the leaf can't hold the record, in that case it is not added
+    bool add(const std::array<uint64_t, N>& record) {
+        std::array<uint64_t, N> new_min;
+        std::array<uint64_t, N> new_max;
+        uint64_t record_bits = 0;
+        for (std::size_t col = 0; col < N; col++) {
+            new_min[col] = std::min(min[col], record[col]);
+            new_max[col] = std::max(max[col], record[col]);
+            record_bits += CompressedLeaf<N>::bits_needed(new_max[col] - new_min[col]);
+        }
+
+        if (CompressedLeaf<N>::words_needed(count + 1, record_bits) > CompressedLeaf<N>::DATA_WORDS) {
+            return false;
+        }
+        min = new_min;
+        max = new_max;
+        count++;
+        return true;
+    }
+
+    uint32_t get_count() const { return count; }
+
+private:
+    std::array<uint64_t, N> min;
+    std::array<uint64_t, N> max;
+    uint32_t count;
+};
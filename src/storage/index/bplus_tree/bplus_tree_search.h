@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "macros/count_zeros.h"
+#include "storage/index/record.h"
+
+// Search of a record inside the sorted records of a B+tree page (raw leaves and directories).
+//
+// A branchless binary search narrows the range down to WINDOW records, and the window is scanned
+// comparing the first column of its records (4 at a time with AVX2). Only the records whose first
+// column is equal to the searched one need to compare the rest of the columns.
+namespace BPlusTreeSearch {
+    static constexpr uint_fast32_t WINDOW = 8;
+
+    // If INCLUSIVE is false returns true if rec < key, otherwise returns true if rec <= key
+    template <std::size_t N, bool INCLUSIVE>
+    inline bool before(const uint64_t* rec, const Record<N>& key) noexcept {
+        bool res = INCLUSIVE;
+        for (std::size_t i = N; i-- > 0;) {
+            res = (rec[i] < key[i]) | ((rec[i] == key[i]) & res);
+        }
+        return res;
+    }
+
+
+    // Returns how many of the `count` records (N columns each) are before the key. With INCLUSIVE
+    // false it is the position of the first record >= key, otherwise the first record > key.
+    template <std::size_t N, bool INCLUSIVE>
+    inline uint_fast32_t count_before(const uint64_t* records, uint_fast32_t count, const Record<N>& key) noexcept {
+        uint_fast32_t base = 0;
+        uint_fast32_t n = count;
+
+        // records before `base` are before the key, records at `base + n` or after are not
+        while (n > WINDOW) {
+            auto half = n / 2;
+            bool is_before = before<N, INCLUSIVE>(records + (base + half)*N, key);
+            base = is_before ? base + half : base;
+            n    = is_before ? n - half : half;
+        }
+
+        uint_fast32_t i = base;
+        const uint_fast32_t end = base + n;
+        uint_fast32_t res = base;
+
+#if defined(__AVX2__)
+        if constexpr (N > 1) {
+            // unsigned comparison using the signed one
+            const __m256i sign  = _mm256_set1_epi64x(static_cast<int64_t>(0x8000'0000'0000'0000ULL));
+            const __m256i key0  = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key[0])), sign);
+            const __m256i index = _mm256_setr_epi64x(0, N, 2*N, 3*N);
+
+            for (; i + 4 <= end; i += 4) {
+                auto first = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(records + i*N), index, 8);
+                first = _mm256_xor_si256(first, sign);
+
+                auto less  = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key0, first)));
+                auto equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(key0, first)));
+                // the records are sorted, so the lanes with a smaller first column are a prefix
+                res += MDB_COUNT_TRAILING_ZEROS_64(~static_cast<uint64_t>(less));
+
+                while (equal != 0) {
+                    auto pos = i + MDB_COUNT_TRAILING_ZEROS_64(equal);
+                    res += before<N, INCLUSIVE>(records + pos*N, key);
+                    equal &= equal - 1;
+                }
+            }
+        }
+#endif
+        for (; i < end; i++) {
+            res += before<N, INCLUSIVE>(records + i*N, key);
+        }
+        return res;
+    }
+} // namespace BPlusTreeSearch
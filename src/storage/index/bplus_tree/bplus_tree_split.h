@@ -11,4 +11,8 @@ struct BPlusTreeSplit {
     Record<N> record;
     // positive number: pointer to leaf, negative number: pointer to dir
     int_fast32_t encoded_page_number;
+
+    // true when the split was done without inserting the record (compressed leaves),
+    // so the insertion must be repeated once the split is applied
+    bool retry_insert = false;
 };
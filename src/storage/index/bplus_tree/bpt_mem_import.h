@@ -7,6 +7,7 @@
 #include <iostream>
 #include <vector>
 
+#include "storage/index/bplus_tree/bplus_tree_leaf_codec.h"
 #include "storage/page/versioned_page.h"
 
 template <std::size_t N>
@@ -35,6 +36,15 @@ public:
         file.write(buffer, VPage::SIZE);
     }
 
+    void process_compressed_block(const uint64_t* records, uint32_t size, uint32_t next_block) {
+        auto next_leaf = reinterpret_cast<uint32_t*>(buffer + sizeof(uint32_t));
+
+        memset(buffer, 0, VPage::SIZE);
+        CompressedLeaf<N>::encode(records, size, buffer);
+        *next_leaf = next_block;
+        file.write(buffer, VPage::SIZE);
+    }
+
     void make_empty() {
         memset(buffer, 0, VPage::SIZE);
         file.write(buffer, VPage::SIZE);
@@ -189,3 +199,71 @@ public:
         }
     }
 };
+
+
+// Receives the ordered records one by one and groups them into leaves,
+// writing the leaves and the directory of the B+tree.
+template <std::size_t N>
+class BPTBulkWriter {
+public:
+    BPTBulkWriter(const std::string& base_name, bool compressed_leaves) :
+        leaf_writer       (base_name + ".leaf"),
+        dir_writer        (base_name + ".dir"),
+        compressed_leaves (compressed_leaves)
+    {
+        pending.reserve(BPTLeafWriter<N>::max_records * N);
+    }
+
+    void add(const std::array<uint64_t, N>& record) {
+        if (compressed_leaves) {
+            if (!sizer.add(record)) {
+                write_leaf(leaf_current_block + 1);
+                sizer.add(record);
+            }
+        } else if (pending.size() == BPTLeafWriter<N>::max_records * N) {
+            write_leaf(leaf_current_block + 1);
+        }
+        pending.insert(pending.end(), record.begin(), record.end());
+    }
+
+    // must be called after the last record is added
+    void finish() {
+        if (pending.empty() && leaf_current_block == 0) {
+            leaf_writer.make_empty();
+        } else {
+            write_leaf(0);
+        }
+    }
+
+private:
+    BPTLeafWriter<N> leaf_writer;
+    BPTDirWriter<N> dir_writer;
+
+    bool compressed_leaves;
+
+    CompressedLeafSizer<N> sizer;
+
+    // records of the current leaf
+    std::vector<uint64_t> pending;
+
+    uint32_t leaf_current_block = 0;
+
+    void write_leaf(uint32_t next_block) {
+        auto first_record = reinterpret_cast<const std::array<uint64_t, N>*>(pending.data());
+        uint32_t record_count = pending.size() / N;
+
+        // skip first leaf from going into B+tree directory
+        if (leaf_current_block > 0) {
+            dir_writer.bulk_insert(first_record, 0, leaf_current_block);
+        }
+
+        if (compressed_leaves) {
+            leaf_writer.process_compressed_block(pending.data(), record_count, next_block);
+            sizer.clear();
+        } else {
+            leaf_writer.process_block(reinterpret_cast<char*>(pending.data()), record_count, next_block);
+        }
+        pending.clear();
+        leaf_current_block++;
+    }
+};
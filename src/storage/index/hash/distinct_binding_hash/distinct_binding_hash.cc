@@ -6,16 +6,96 @@
 #include <cstring>
 
 #include "graph_models/object_id.h"
+#include "query/query_context.h"
 #include "storage/file_manager.h"
 #include "storage/index/hash/distinct_binding_hash/distinct_binding_hash_bucket.h"
 #include "third_party/hashes/hash_function_wrapper.h"
 
 template <class T>
-DistinctBindingHash<T>::DistinctBindingHash(std::size_t tuple_size) :
-    tuple_size      (tuple_size),
-    buckets_file_id (file_manager.get_tmp_file_id())
-{
+DistinctBindingHash<T>::DistinctBindingHash(std::size_t tuple_size, uint64_t max_in_memory_bytes) :
+    tuple_size          (tuple_size),
+    max_in_memory_bytes (max_in_memory_bytes),
+    slot_positions      (INITIAL_SLOTS, EMPTY_SLOT),
+    slot_hashes         (INITIAL_SLOTS),
+    buckets_file_id     (0, FileId(FileId::UNASSIGNED)) { }
+
+
+template <class T>
+DistinctBindingHash<T>::~DistinctBindingHash() {
+    if (dir != nullptr) {
+        delete[] dir;
+        file_manager.remove_tmp(buckets_file_id);
+    }
+}
+
+
+template <class T>
+uint64_t DistinctBindingHash<T>::find_slot(const T* tuple, uint64_t hash) const {
+    const auto mask = slot_positions.size() - 1;
+    auto slot = hash & mask;
+    // linear probing, the table is never full
+    while (slot_positions[slot] != EMPTY_SLOT) {
+        if (slot_hashes[slot] == hash
+            && std::memcmp(&mem_tuples[slot_positions[slot] * tuple_size], tuple, tuple_size * sizeof(T)) == 0)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+
+template <class T>
+void DistinctBindingHash<T>::grow() {
+    // slots and the tuples they can hold with the maximum load factor
+    const auto new_slots = 2 * slot_positions.size();
+    const auto new_bytes = new_slots * (sizeof(uint32_t) + sizeof(uint64_t))
+                         + (new_slots / 2) * tuple_size * sizeof(T);
+    if (new_bytes > max_in_memory_bytes) {
+        spill();
+        return;
+    }
+
+    mem_tuples.reserve((new_slots / 2) * tuple_size);
+
+    std::vector<uint32_t> old_positions(new_slots, EMPTY_SLOT);
+    std::vector<uint64_t> old_hashes(new_slots);
+    old_positions.swap(slot_positions);
+    old_hashes.swap(slot_hashes);
+
+    // The hashes are stored so the tuples are not hashed again
+    const auto mask = new_slots - 1;
+    for (uint64_t i = 0; i < old_positions.size(); i++) {
+        if (old_positions[i] == EMPTY_SLOT)
+            continue;
+        auto slot = old_hashes[i] & mask;
+        while (slot_positions[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & mask;
+        }
+        slot_positions[slot] = old_positions[i];
+        slot_hashes[slot]    = old_hashes[i];
+    }
+    update_profiled_bytes();
+}
+
+
+template <class T>
+void DistinctBindingHash<T>::update_profiled_bytes() {
+    const uint64_t bytes = mem_tuples.capacity() * sizeof(T)
+                         + slot_positions.capacity() * sizeof(uint32_t)
+                         + slot_hashes.capacity() * sizeof(uint64_t);
+    profiled_memory.set(get_query_ctx().profile, bytes);
+}
+
+
+template <class T>
+void DistinctBindingHash<T>::spill() {
+    assert(dir == nullptr);
+    buckets_file_id = file_manager.get_tmp_file_id();
+
     // create directory with 2^global_depth empty buckets
+    global_depth = DEFAULT_GLOBAL_DEPTH;
     uint_fast32_t dir_size = 1 << global_depth;
     dir = new uint_fast32_t[dir_size];
     for (uint_fast32_t i = 0; i < dir_size; ++i) {
@@ -25,22 +105,69 @@ DistinctBindingHash<T>::DistinctBindingHash(std::size_t tuple_size) :
         dir[i] = i;
         bucket.page.make_dirty();
     }
+
+    for (uint64_t i = 0; i < slot_positions.size(); i++) {
+        if (slot_positions[i] != EMPTY_SLOT) {
+            disk_is_in_or_insert(&mem_tuples[slot_positions[i] * tuple_size], slot_hashes[i]);
+        }
+    }
+
+    // free the memory
+    std::vector<T>().swap(mem_tuples);
+    std::vector<uint32_t>().swap(slot_positions);
+    std::vector<uint64_t>().swap(slot_hashes);
+    mem_count = 0;
+    update_profiled_bytes();
 }
 
 
 template <class T>
-DistinctBindingHash<T>::~DistinctBindingHash() {
-    delete[] dir;
-    file_manager.remove_tmp(buckets_file_id);
+bool DistinctBindingHash<T>::is_in(const std::vector<T>& tuple) {
+    assert(tuple.size() == tuple_size);
+
+    uint64_t hash = HashFunctionWrapper(tuple.data(), tuple.size() * sizeof(T));
+
+    if (dir != nullptr) {
+        return disk_is_in(tuple.data(), hash);
+    }
+    return slot_positions[find_slot(tuple.data(), hash)] != EMPTY_SLOT;
 }
 
 
 template <class T>
-bool DistinctBindingHash<T>::is_in(const std::vector<T>& tuple) {
+bool DistinctBindingHash<T>::is_in_or_insert(const std::vector<T>& tuple) {
     assert(tuple.size() == tuple_size);
 
     uint64_t hash = HashFunctionWrapper(tuple.data(), tuple.size() * sizeof(T));
 
+    if (dir != nullptr) {
+        return disk_is_in_or_insert(tuple.data(), hash);
+    }
+
+    auto slot = find_slot(tuple.data(), hash);
+    if (slot_positions[slot] != EMPTY_SLOT) {
+        return true;
+    }
+
+    // keep the load factor under 1/2
+    if (2 * (mem_count + 1) > slot_positions.size()) {
+        grow();
+        if (dir != nullptr) {
+            return disk_is_in_or_insert(tuple.data(), hash);
+        }
+        slot = find_slot(tuple.data(), hash);
+    }
+
+    slot_positions[slot] = mem_count;
+    slot_hashes[slot]    = hash;
+    mem_tuples.insert(mem_tuples.end(), tuple.begin(), tuple.end());
+    mem_count++;
+    return false;
+}
+
+
+template <class T>
+bool DistinctBindingHash<T>::disk_is_in(const T* tuple, uint64_t hash) {
     // global_depth must be <= 64
     auto mask = 0xFFFF'FFFF'FFFF'FFFF >> (64 - global_depth);
     auto suffix = hash & mask;
@@ -52,11 +179,7 @@ bool DistinctBindingHash<T>::is_in(const std::vector<T>& tuple) {
 
 
 template <class T>
-bool DistinctBindingHash<T>::is_in_or_insert(const std::vector<T>& tuple) {
-    assert(tuple.size() == tuple_size);
-
-    uint64_t hash = HashFunctionWrapper(tuple.data(), tuple.size() * sizeof(T));
-
+bool DistinctBindingHash<T>::disk_is_in_or_insert(const T* tuple, uint64_t hash) {
     // After a bucket split, need to try insert again.
     while (true) {
         // global_depth must be <= 64
@@ -140,15 +263,17 @@ void DistinctBindingHash<T>::duplicate_dirs() {
 
 template <class T>
 void DistinctBindingHash<T>::reset() {
-    uint64_t dir_size = 1UL << global_depth;
-
-    for (uint_fast32_t i = 0; i < dir_size; ++i) {
-        DistinctBindingHashBucket<T> bucket(buckets_file_id, i, tuple_size);
-        *bucket.tuple_count = 0;
-        *bucket.local_depth = DEFAULT_GLOBAL_DEPTH;
-        dir[i]              = i;
-        bucket.page.make_dirty();
+    if (dir != nullptr) {
+        delete[] dir;
+        dir = nullptr;
+        file_manager.remove_tmp(buckets_file_id);
     }
+
+    mem_tuples.clear();
+    slot_positions.assign(INITIAL_SLOTS, EMPTY_SLOT);
+    slot_hashes.assign(INITIAL_SLOTS, 0);
+    mem_count = 0;
+    update_profiled_bytes();
 }
 
 
@@ -3,15 +3,25 @@
 #include <cstdint>
 #include <vector>
 
+#include "query/query_profile.h"
 #include "query/var_id.h"
 #include "storage/file_id.h"
 
+/*
+ * Set of fixed-size tuples. Tuples are kept in an in-memory open addressing table and only when it needs more
+ * than max_in_memory_bytes they are moved to an extendible hash whose buckets are pages of a temporal file.
+ */
 template <class T>
 class DistinctBindingHash {
 public:
     static constexpr auto DEFAULT_GLOBAL_DEPTH = 10;
 
-    DistinctBindingHash(std::size_t vars_size);
+    // Default memory the in-memory table can use before spilling to disk
+    static constexpr uint64_t MAX_IN_MEMORY_BYTES = 32 * 1024 * 1024;
+
+    static constexpr uint64_t INITIAL_SLOTS = 64;
+
+    DistinctBindingHash(std::size_t vars_size, uint64_t max_in_memory_bytes = MAX_IN_MEMORY_BYTES);
     ~DistinctBindingHash();
 
     // Clears all stored tuples
@@ -22,14 +32,48 @@ public:
     // returns true if tuple is present, insert it otherwise
     bool is_in_or_insert(const std::vector<T>& tuple);
 
+    bool is_spilled() const { return dir != nullptr; }
+
 private:
-    uint_fast8_t global_depth = DEFAULT_GLOBAL_DEPTH;
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
     std::size_t tuple_size;
 
-    const TmpFileId buckets_file_id;
+    const uint64_t max_in_memory_bytes;
+
+    // In-memory table: tuples are stored contiguously in insertion order, and each slot has the
+    // position of a tuple (EMPTY_SLOT if empty) and its hash to avoid comparing different tuples
+    std::vector<T>        mem_tuples;
+    std::vector<uint32_t> slot_positions;
+    std::vector<uint64_t> slot_hashes;
+    uint64_t              mem_count = 0;
+
+    // Bytes of the in-memory table reported to the query profile
+    ProfiledMemory profiled_memory;
+
+    // Extendible hash, only used after spilling
+    uint_fast8_t global_depth = DEFAULT_GLOBAL_DEPTH;
+
+    TmpFileId buckets_file_id;
+
+    // array of size 2^global_depth, nullptr if not spilled
+    uint_fast32_t* dir = nullptr;
+
+    // Returns the slot of the tuple, or the empty slot where it should be inserted
+    uint64_t find_slot(const T* tuple, uint64_t hash) const;
+
+    // Doubles the number of slots, or spills to disk if the table would exceed max_in_memory_bytes
+    void grow();
+
+    // Moves every tuple of the in-memory table to the extendible hash
+    void spill();
+
+    // Reports the change in the size of the in-memory table to the query profile
+    void update_profiled_bytes();
+
+    bool disk_is_in(const T* tuple, uint64_t hash);
 
-    // array of size 2^global_depth
-    uint_fast32_t* dir;
+    bool disk_is_in_or_insert(const T* tuple, uint64_t hash);
 
     void duplicate_dirs();
 };
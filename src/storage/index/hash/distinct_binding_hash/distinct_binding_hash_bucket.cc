@@ -17,7 +17,7 @@ DistinctBindingHashBucket<T>::DistinctBindingHashBucket(const TmpFileId file_id,
                   / (sizeof(*hashes) + tuple_size*sizeof(T) ) ),
     tuples      (reinterpret_cast<T*>(page.get_bytes())),
     hashes      (reinterpret_cast<uint64_t*>(page.get_bytes() + tuple_size*max_tuples*sizeof(T))),
-    tuple_count (reinterpret_cast<uint8_t*> (reinterpret_cast<uint8_t*>(hashes) + max_tuples*sizeof(*hashes))),
+    tuple_count (reinterpret_cast<uint32_t*>(reinterpret_cast<uint8_t*>(hashes) + max_tuples*sizeof(*hashes))),
     local_depth (reinterpret_cast<uint8_t*> (reinterpret_cast<uint8_t*>(tuple_count) + sizeof(*tuple_count))) { }
 
 
@@ -28,9 +28,9 @@ DistinctBindingHashBucket<T>::~DistinctBindingHashBucket() {
 
 
 template <class T>
-bool DistinctBindingHashBucket<T>::is_in(const std::vector<T>& tuple, uint64_t hash)
+bool DistinctBindingHashBucket<T>::is_in(const T* tuple, uint64_t hash)
 {
-    for (uint8_t i = 0; i < *tuple_count; ++i) {
+    for (uint32_t i = 0; i < *tuple_count; ++i) {
         if (hashes[i] == hash) {
             bool tuple_found = true;
             // compare objects (in case we have a collision)
@@ -50,11 +50,11 @@ bool DistinctBindingHashBucket<T>::is_in(const std::vector<T>& tuple, uint64_t h
 
 
 template <class T>
-bool DistinctBindingHashBucket<T>::is_in_or_insert(const std::vector<T>& tuple,
+bool DistinctBindingHashBucket<T>::is_in_or_insert(const T* tuple,
                                                    uint64_t hash,
                                                    bool* const need_split)
 {
-    for (uint8_t i = 0; i < *tuple_count; ++i) {
+    for (uint32_t i = 0; i < *tuple_count; ++i) {
         if (hashes[i] == hash) {
             bool tuple_found = true;
             // compare objects (in case we have a collision)
@@ -93,10 +93,10 @@ void DistinctBindingHashBucket<T>::redistribute(DistinctBindingHashBucket<T>& ot
                                                 const uint64_t mask,
                                                 const uint64_t other_suffix)
 {
-    uint8_t other_pos = 0;
-    uint8_t this_pos = 0;
+    uint32_t other_pos = 0;
+    uint32_t this_pos = 0;
 
-    for (uint8_t i = 0; i < *tuple_count; i++) {
+    for (uint32_t i = 0; i < *tuple_count; i++) {
         auto suffix = mask & hashes[i];
 
         if (suffix == other_suffix) {
@@ -22,8 +22,8 @@ public:
     DistinctBindingHashBucket(const TmpFileId file_id, const uint_fast32_t bucket_number, std::size_t tuple_size);
     ~DistinctBindingHashBucket();
 
-    bool is_in(const std::vector<T>& tuple, uint64_t hash);
-    bool is_in_or_insert(const std::vector<T>& tuple, uint64_t hash, bool* const need_split);
+    bool is_in(const T* tuple, uint64_t hash);
+    bool is_in_or_insert(const T* tuple, uint64_t hash, bool* const need_split);
 
 private:
     PPage& page;
@@ -33,7 +33,7 @@ private:
 
     T*        const tuples;
     uint64_t* const hashes; // each tuple is (hash1, hash2)
-    uint8_t*  const tuple_count;
+    uint32_t* const tuple_count; // 32 bits, with pages bigger than 4KB a bucket can have more than 255 tuples
     uint8_t*  const local_depth;
 
     void redistribute(DistinctBindingHashBucket<T>& other, uint64_t mask, uint64_t other_suffix);
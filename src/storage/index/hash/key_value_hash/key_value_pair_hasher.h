@@ -7,6 +7,6 @@
 
 struct KeyValuePairHasher {
     uint64_t operator()(const std::vector<ObjectId>& key) const {
-        return HashFunctionWrapper(key.data(), key.size());
+        return HashFunctionWrapper(key.data(), key.size() * sizeof(ObjectId));
     }
 };
@@ -2,7 +2,9 @@
 
 #include <cassert>
 #include <cstring>
+#include <thread>
 
+#include "graph_models/object_id.h"
 #include "query/exceptions.h"
 #include "storage/buffer_manager.h"
 #include "storage/file_manager.h"
@@ -25,15 +27,19 @@ StringsHash::StringsHash(const std::string& filename) :
         throw LogicException("String Hash must exists and cannot be empty");
     }
 
+    uint_fast8_t global_depth;
     dir_file.seekg(0, dir_file.beg);
     dir_file.read(reinterpret_cast<char*>(&global_depth), sizeof(global_depth));
     dir_file.read(reinterpret_cast<char*>(&total_pages), sizeof(total_pages));
 
+    directories.push_back(std::make_unique<Directory>(global_depth));
+    auto directory = directories.back().get();
+
     uint_fast32_t dir_size = 1ULL << global_depth;
-    dir = new uint32_t[dir_size];
     for (uint_fast32_t i = 0; i < dir_size; ++i) {
-        dir_file.read(reinterpret_cast<char*>(&dir[i]), sizeof(dir[i]));
+        dir_file.read(reinterpret_cast<char*>(&directory->buckets[i]), sizeof(directory->buckets[i]));
     }
+    dir.store(directory);
 
     // check eofbit/failbit/badbit to ensure the values were read correctly
     if (!dir_file.good()) {
@@ -44,107 +50,151 @@ StringsHash::StringsHash(const std::string& filename) :
 
 StringsHash::~StringsHash() {
     if (directory_modified) {
+        auto directory = dir.load();
         dir_file.seekg(0, dir_file.beg);
-        dir_file.write(reinterpret_cast<const char*>(&global_depth), sizeof(global_depth));
+        dir_file.write(reinterpret_cast<const char*>(&directory->global_depth), sizeof(directory->global_depth));
         dir_file.write(reinterpret_cast<const char*>(&total_pages), sizeof(total_pages));
 
-        uint_fast32_t dir_size = 1ULL << global_depth;
+        uint_fast32_t dir_size = 1ULL << directory->global_depth;
         for (uint_fast32_t i = 0; i < dir_size; ++i) {
-            dir_file.write(reinterpret_cast<const char*>(&dir[i]), sizeof(dir[i]));
+            dir_file.write(reinterpret_cast<const char*>(&directory->buckets[i]), sizeof(directory->buckets[i]));
         }
     }
-    delete[](dir);
     dir_file.close();
 }
 
 
 void StringsHash::duplicate_dir() {
     directory_modified = true;
-    uint_fast32_t old_dir_size = 1ULL << global_depth;
-    ++global_depth;
-    auto new_dir_size = 1ULL << global_depth;
-    auto new_dir = new uint32_t[new_dir_size];
+    auto old_dir = dir.load();
+    uint_fast32_t old_dir_size = 1ULL << old_dir->global_depth;
+    auto new_dir = std::make_unique<Directory>(old_dir->global_depth + 1);
 
     std::memcpy(
-        new_dir,
-        dir,
+        new_dir->buckets.get(),
+        old_dir->buckets.get(),
         old_dir_size * sizeof(uint32_t)
     );
 
     std::memcpy(
-        &new_dir[old_dir_size],
-        dir,
+        &new_dir->buckets[old_dir_size],
+        old_dir->buckets.get(),
         old_dir_size * sizeof(uint32_t)
     );
 
-    delete[](dir);
-    dir = new_dir;
+    // the old directory is not deleted, a lookup may be reading it
+    dir.store(new_dir.get());
+    directories.push_back(std::move(new_dir));
+}
+
+
+void StringsHash::split(uint64_t hash) {
+    auto directory = dir.load();
+    auto bucket_number = directory->buckets[hash & get_mask(directory->global_depth)];
+
+    auto& bucket_page = buffer_manager.get_unversioned_page(buckets_file_id, bucket_number);
+    StringsHashBucket bucket(bucket_page);
+
+    // another insert may have split it first
+    if (*bucket.key_count < bucket.MAX_KEYS) {
+        return;
+    }
+
+    split_sequence.fetch_add(1);
+
+    directory_modified = true;
+    auto new_bucket_number = total_pages;
+    total_pages++;
+
+    ++(*bucket.local_depth);
+    auto& new_bucket_page = buffer_manager.append_unversioned_page(buckets_file_id);
+    assert(new_bucket_number == new_bucket_page.get_page_number());
+    StringsHashBucket new_bucket(new_bucket_page);
+    *new_bucket.key_count = 0;
+    *new_bucket.local_depth = *bucket.local_depth;
+
+    auto new_mask = get_mask(*bucket.local_depth);
+    auto new_suffix = (hash & new_mask) | (1ULL << (*bucket.local_depth-1));
+
+    if (*bucket.local_depth <= directory->global_depth) {
+        // update dirs having `new_suffix`, point them to the new_bucket
+        auto update_dir_count = 1ULL << (directory->global_depth - (*bucket.local_depth));
+        for (uint_fast32_t i = 0; i < update_dir_count; ++i) {
+            auto new_dir_pos = new_suffix | (i << *bucket.local_depth);
+            directory->buckets[new_dir_pos] = new_bucket_number;
+        }
+    } else { // *bucket.local_depth == global_depth + 1
+        duplicate_dir();
+        dir.load()->buckets[new_suffix] = new_bucket_number;
+    }
+    bucket.redistribute(new_bucket, new_mask, new_suffix);
+    assert(*bucket.key_count + *new_bucket.key_count == StringsHashBucket::MAX_KEYS
+        && "EXTENDIBLE HASH INCONSISTENCY: sum of keys must be MAX_KEYS after a split");
+
+    split_sequence.fetch_add(1);
 }
 
 
-void StringsHash::create_str_id(const char* bytes, uint64_t size, uint64_t new_id) {
+uint64_t StringsHash::get_or_create_str_id(const char* bytes,
+                                           uint64_t size,
+                                           const std::function<uint64_t()>& create_id)
+{
     uint64_t hash = HashFunctionWrapper(bytes, size);
 
     // After a bucket split, need to try insert again.
     while (true) {
-        auto global_mask = 0xFFFF'FFFF'FFFF'FFFFULL >> (64 - global_depth);
-        auto global_suffix = hash & global_mask;
-        auto bucket_number = dir[global_suffix];
-
-        auto& bucket_page = buffer_manager.get_unversioned_page(buckets_file_id, bucket_number);
-        StringsHashBucket bucket(bucket_page);
-
-
-        if (*bucket.key_count < bucket.MAX_KEYS) {
-            bucket.create_str_id(new_id, hash);
-            return;
-        } else {
-            // split bucket
-            directory_modified = true;
-            auto new_bucket_number = total_pages;
-            total_pages++;
-
-            ++(*bucket.local_depth);
-            auto& new_bucket_page = buffer_manager.append_unversioned_page(buckets_file_id);
-            assert(new_bucket_number == new_bucket_page.get_page_number());
-            StringsHashBucket new_bucket(new_bucket_page);
-            *new_bucket.key_count = 0;
-            *new_bucket.local_depth = *bucket.local_depth;
-
-            auto new_mask = 0xFFFF'FFFF'FFFF'FFFFULL >> (64 - (*bucket.local_depth));
-            auto new_suffix = (hash & new_mask) | (1ULL << (*bucket.local_depth-1));
-
-            if (*bucket.local_depth <= global_depth) {
-                // update dirs having `new_suffix`, point them to the new_bucket
-                auto update_dir_count = 1ULL << (global_depth - (*bucket.local_depth));
-                for (uint_fast32_t i = 0; i < update_dir_count; ++i) {
-                    auto new_dir_pos = new_suffix | (i << *bucket.local_depth);
-                    dir[new_dir_pos] = new_bucket_number;
-                }
-            } else { // *bucket.local_depth == global_depth + 1
-                duplicate_dir();
-                dir[new_suffix] = new_bucket_number;
+        {
+            std::shared_lock<std::shared_mutex> lock(split_mutex);
+
+            auto directory = dir.load();
+            auto bucket_number = directory->buckets[hash & get_mask(directory->global_depth)];
+            std::lock_guard<std::mutex> latch(bucket_latches[bucket_number % BUCKET_LATCHES]);
+
+            auto& bucket_page = buffer_manager.get_unversioned_page(buckets_file_id, bucket_number);
+            StringsHashBucket bucket(bucket_page);
+
+            // it may have been inserted since the caller looked for it
+            auto existing_id = bucket.get_id(bytes, size, hash);
+            if (existing_id != ObjectId::MASK_NOT_FOUND) {
+                return existing_id;
+            }
+
+            if (*bucket.key_count < bucket.MAX_KEYS) {
+                auto new_id = create_id();
+                bucket.create_str_id(new_id, hash);
+                return new_id;
             }
-            bucket.redistribute(new_bucket, new_mask, new_suffix);
-            assert(*bucket.key_count + *new_bucket.key_count == StringsHashBucket::MAX_KEYS
-                && "EXTENDIBLE HASH INCONSISTENCY: sum of keys must be MAX_KEYS after a split");
         }
+        std::unique_lock<std::shared_mutex> lock(split_mutex);
+        split(hash);
     }
 }
 
 
-
 uint64_t StringsHash::get_str_id(const char* bytes, uint64_t size) const {
     uint64_t hash = HashFunctionWrapper(bytes, size);
 
-    // global_depth must be <= 64
-    uint64_t mask = 0xFFFF'FFFF'FFFF'FFFFULL >> (64ULL - global_depth);
-    uint64_t suffix = hash & mask;
+    while (true) {
+        auto sequence = split_sequence.load(std::memory_order_acquire);
+        if (sequence % 2 == 1) {
+            std::this_thread::yield();
+            continue;
+        }
 
-    auto bucket_number = dir[suffix];
+        auto directory = dir.load(std::memory_order_acquire);
+        auto bucket_number = directory->buckets[hash & get_mask(directory->global_depth)];
 
-    auto& bucket_page = buffer_manager.get_unversioned_page(buckets_file_id, bucket_number);
-    StringsHashBucket bucket(bucket_page);
+        uint64_t res;
+        {
+            auto& bucket_page = buffer_manager.get_unversioned_page(buckets_file_id, bucket_number);
+            StringsHashBucket bucket(bucket_page);
+            res = bucket.get_id(bytes, size, hash);
+        }
 
-    return bucket.get_id(bytes, size, hash);
+        // a split moves keys between buckets, the key may not have been found because of it
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (split_sequence.load(std::memory_order_relaxed) == sequence) {
+            return res;
+        }
+    }
 }
@@ -1,15 +1,32 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "storage/file_id.h"
 
+/*
+ * Extendible hash from strings to their ids.
+ *
+ * Lookups don't lock the hash: a split increments `split_sequence` before and after modifying the
+ * buckets and the directory, and a lookup that overlaps a split is retried. Inserts into different
+ * buckets run in parallel, each one holds the latch of its bucket, and splits are exclusive.
+ */
 class StringsHash {
 public:
     static constexpr auto MIN_GLOBAL_DEPTH = 8;
 
+    // inserts only wait for each other if their buckets use the same latch
+    static constexpr uint64_t BUCKET_LATCHES = 256;
+
     StringsHash(const std::string& filename);
     ~StringsHash();
 
@@ -21,23 +38,55 @@ public:
         return get_str_id(str.data(), str.size());
     }
 
-    // only call when you know string does not exist
-    void create_str_id(const char* bytes, uint64_t size, uint64_t new_id);
+    // Returns the id of the string. If it does not exist `create_id` is called to get its id,
+    // the latch of the bucket is held meanwhile so concurrent calls with the same string can't
+    // create it twice.
+    uint64_t get_or_create_str_id(const char* bytes,
+                                  uint64_t size,
+                                  const std::function<uint64_t()>& create_id);
 
 private:
-    const FileId buckets_file_id;
+    struct Directory {
+        // MIN_GLOBAL_DEPTH <= global_depth < 32
+        uint_fast8_t global_depth;
+
+        // array of size 2^global_depth
+        std::unique_ptr<uint32_t[]> buckets;
 
-    // MIN_GLOBAL_DEPTH <= global_depth < 32
-    uint_fast8_t global_depth;
+        Directory(uint_fast8_t global_depth) :
+            global_depth (global_depth),
+            buckets      (std::make_unique<uint32_t[]>(1ULL << global_depth)) { }
+    };
+
+    const FileId buckets_file_id;
 
     std::fstream dir_file;
 
     uint32_t total_pages;
 
-    // array of size 2^global_depth
-    uint32_t* dir;
+    // the current directory, it is replaced when the directory is duplicated
+    std::atomic<Directory*> dir;
+
+    // owns the current and the previous directories, a lookup may still be reading a previous one
+    std::vector<std::unique_ptr<Directory>> directories;
 
     bool directory_modified = false;
 
+    // odd while a split is modifying the buckets
+    std::atomic<uint64_t> split_sequence { 0 };
+
+    // shared by inserts, exclusive for splits
+    std::shared_mutex split_mutex;
+
+    std::array<std::mutex, BUCKET_LATCHES> bucket_latches;
+
+    // splits the bucket where the hash belongs if it is full, split_mutex must be locked exclusively
+    void split(uint64_t hash);
+
     void duplicate_dir();
+
+    static uint64_t get_mask(uint_fast8_t depth) {
+        // depth must be <= 64
+        return 0xFFFF'FFFF'FFFF'FFFFULL >> (64ULL - depth);
+    }
 };
@@ -3,7 +3,12 @@
 #include <cstring>
 #include <memory>
 
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
 #include "graph_models/object_id.h"
+#include "macros/count_zeros.h"
 #include "storage/buffer_manager.h"
 #include "storage/index/hash/strings_hash/strings_hash.h"
 #include "storage/string_manager.h"
@@ -28,12 +33,52 @@ StringsHashBucket::~StringsHashBucket() {
 
 uint64_t StringsHashBucket::get_id(const char* bytes, uint64_t size, uint64_t hash) const {
     auto hash_ = (hash >> StringsHash::MIN_GLOBAL_DEPTH) & hash_mask;
-    for (size_t i = 0; i < *key_count; ++i) {
+
+    // inserts publish the new key_count after writing the key
+    const uint32_t count = __atomic_load_n(key_count, __ATOMIC_ACQUIRE);
+
+    auto check_key = [&](size_t i) {
+        uint64_t arr_1_bits = arr1[i] >> 52ULL;
+        uint64_t id = (arr_1_bits << 32ULL) | static_cast<uint64_t>(arr2[i]);
+        return string_manager.bytes_eq(bytes, size, id) ? id : ObjectId::MASK_NOT_FOUND;
+    };
+
+    size_t i = 0;
+    // the stored hashes are compared several at a time and only the matches are checked
+#if defined(__AVX512F__)
+    const __m512i target512 = _mm512_set1_epi64(static_cast<int64_t>(hash_));
+    const __m512i mask512 = _mm512_set1_epi64(static_cast<int64_t>(hash_mask));
+    for (; i + 8 <= count; i += 8) {
+        auto keys = _mm512_and_si512(_mm512_loadu_si512(arr1 + i), mask512);
+        uint64_t matches = _mm512_cmpeq_epi64_mask(keys, target512);
+        while (matches != 0) {
+            auto id = check_key(i + MDB_COUNT_TRAILING_ZEROS_64(matches));
+            if (id != ObjectId::MASK_NOT_FOUND) {
+                return id;
+            }
+            matches &= matches - 1;
+        }
+    }
+#endif
+#if defined(__AVX2__)
+    const __m256i target256 = _mm256_set1_epi64x(static_cast<int64_t>(hash_));
+    const __m256i mask256 = _mm256_set1_epi64x(static_cast<int64_t>(hash_mask));
+    for (; i + 4 <= count; i += 4) {
+        auto keys = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(arr1 + i)), mask256);
+        uint64_t matches = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(keys, target256)));
+        while (matches != 0) {
+            auto id = check_key(i + MDB_COUNT_TRAILING_ZEROS_64(matches));
+            if (id != ObjectId::MASK_NOT_FOUND) {
+                return id;
+            }
+            matches &= matches - 1;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
         if ((arr1[i] & hash_mask) == hash_) {
-            // check if object is
-            uint64_t arr_1_bits = arr1[i] >> 52ULL;
-            uint64_t id = (arr_1_bits << 32ULL) | static_cast<uint64_t>(arr2[i]);
-            if (string_manager.bytes_eq(bytes, size, id)) {
+            auto id = check_key(i);
+            if (id != ObjectId::MASK_NOT_FOUND) {
                 return id;
             }
         }
@@ -89,7 +134,8 @@ void StringsHashBucket::create_str_id(uint64_t new_id, uint64_t hash) {
     arr1[*key_count] = new_arr1_val;
     arr2[*key_count] = static_cast<uint32_t>(new_id & 0xFF'FF'FF'FFUL);
 
-    ++(*key_count);
+    // lookups don't hold the latch, the key must be written before it is counted
+    __atomic_store_n(key_count, *key_count + 1, __ATOMIC_RELEASE);
     page.make_dirty();
 }
 
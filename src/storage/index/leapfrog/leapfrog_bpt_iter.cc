@@ -217,6 +217,13 @@ bool LeapfrogBptIter<N>::next_enumeration(Binding& binding) {
 }
 
 
+template <size_t N>
+uint64_t LeapfrogBptIter<N>::count_enumeration(Binding&) {
+    begin_enumeration();
+    return enum_bpt_iter.count();
+}
+
+
 template <size_t N>
 bool LeapfrogBptIter<N>::open_terms(Binding& input_binding) {
     Record<N> min;
@@ -28,6 +28,7 @@ public:
     void begin_enumeration() override;
     void reset_enumeration() override;
     bool next_enumeration(Binding&) override;
+    uint64_t count_enumeration(Binding&) override;
 
     // returns true if the terms and parent_binding were found
     bool open_terms(Binding& input_binding) override;
@@ -31,6 +31,17 @@ public:
     virtual void reset_enumeration() = 0;
     virtual bool next_enumeration(Binding&) = 0;
 
+    // returns the number of matches of the enumeration vars for the current intersection,
+    // the binding may be modified
+    virtual uint64_t count_enumeration(Binding& binding) {
+        uint64_t count = 0;
+        begin_enumeration();
+        while (next_enumeration(binding)) {
+            count++;
+        }
+        return count;
+    }
+
     const std::vector<std::unique_ptr<ScanRange>> initial_ranges;
 
     // returns the cardinality of the relation (initial_ranges + intersection + enumeration)
@@ -27,14 +27,29 @@ Record<N>* RandomAccessTable<N>::operator[](uint64_t pos) {
 
 template <size_t N>
 void RandomAccessTable<N>::append_record(const Record<N>& record) {
-    auto& last_block_page = buffer_manager.get_page_readonly(file_id, file_manager.count_pages(file_id));
-    auto last_block = make_unique<RandomAccessTableBlock<N>>(last_block_page);
-    if (*last_block->record_count < last_block->max_records) {
-        last_block = make_unique<RandomAccessTableBlock<N>>(buffer_manager.get_page_editable(file_id, file_manager.count_pages(file_id)));
-    } else {
-        last_block = make_unique<RandomAccessTableBlock<N>>(buffer_manager.append_vpage(file_id));
+    append_records({ record });
+}
+
+
+template <size_t N>
+void RandomAccessTable<N>::append_records(const std::vector<Record<N>>& records) {
+    if (records.empty()) {
+        return;
+    }
+    auto last_page_number = file_manager.count_pages(file_id) - 1;
+    auto last_block = make_unique<RandomAccessTableBlock<N>>(
+        buffer_manager.get_page_readonly(file_id, last_page_number));
+
+    for (auto& record : records) {
+        if (*last_block->record_count == last_block->max_records) {
+            last_block = make_unique<RandomAccessTableBlock<N>>(buffer_manager.append_vpage(file_id));
+        } else if (buffer_manager.need_edit_version(last_block->page)) {
+            last_block = make_unique<RandomAccessTableBlock<N>>(
+                buffer_manager.get_page_editable(file_id, last_block->page.get_page_number()));
+        }
+        last_block->append_record(record);
     }
-    last_block->append_record(record);
 }
 
+
 template class RandomAccessTable<3>;
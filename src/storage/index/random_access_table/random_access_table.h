@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "storage/file_id.h"
 #include "storage/index/record.h"
@@ -13,6 +14,9 @@ public:
 
     void append_record(const Record<N>&);
 
+    // appends the records in order, each block is edited once
+    void append_records(const std::vector<Record<N>>&);
+
     // in case of out-of-bounds returns nullptr
     // pointer is valid until next operator[] call or the destruction of this object
     Record<N>* operator[](uint64_t pos);
@@ -0,0 +1,441 @@
+#include "reachability_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+#include "graph_models/rdf_model/rdf_model.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/tensor_store/serialization.h"
+
+namespace {
+constexpr uint32_t NONE = UINT32_MAX;
+
+constexpr auto INDEX_EXTENSION = ".index";
+
+
+// Builds the adjacency lists of the edges (from, to) of a graph with n nodes
+void build_adjacency(uint32_t                                       n,
+                     const std::vector<std::pair<uint32_t, uint32_t>>& edges,
+                     std::vector<uint32_t>&                         offsets,
+                     std::vector<uint32_t>&                         targets)
+{
+    offsets.assign(n + 1, 0);
+    for (auto& [from, to] : edges) {
+        offsets[from + 1]++;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+    targets.resize(edges.size());
+    auto pos = offsets;
+    for (auto& [from, to] : edges) {
+        targets[pos[from]++] = to;
+    }
+}
+
+
+void write_vec(std::fstream& fs, const std::vector<uint32_t>& vec) {
+    Serialization::write_uint64(fs, vec.size());
+    Serialization::write_uint32_vec(fs, vec);
+}
+
+
+std::vector<uint32_t> read_vec(std::fstream& fs) {
+    auto size = Serialization::read_uint64(fs);
+    return Serialization::read_uint32_vec(fs, size);
+}
+} // namespace
+
+
+ReachabilityIndex::ReachabilityIndex(uint64_t predicate_id) :
+    predicate_id (predicate_id)
+{
+    // The nodes are numbered in the order they appear in the edges
+    std::vector<uint64_t> nodes;
+    robin_hood::unordered_flat_map<uint64_t, uint32_t> node_numbers;
+    auto get_number = [&](uint64_t node) {
+        auto [it, inserted] = node_numbers.try_emplace(node, nodes.size());
+        if (inserted) {
+            nodes.push_back(node);
+        }
+        return it->second;
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    bool interruption_requested = false;
+    auto iter = rdf_model.pos->get_range(&interruption_requested,
+                                         { predicate_id, 0, 0 },
+                                         { predicate_id, UINT64_MAX, UINT64_MAX });
+    for (auto record = iter.next(); record != nullptr; record = iter.next()) {
+        // pos records are (predicate, object, subject)
+        auto subject = get_number((*record)[2]);
+        auto object  = get_number((*record)[1]);
+        edges.emplace_back(subject, object);
+    }
+    node_numbers.clear();
+
+    const uint32_t n = nodes.size();
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    build_adjacency(n, edges, offsets, targets);
+
+    // Strongly connected components with an iterative Tarjan. A component is numbered after all the components
+    // it reaches, so the component numbers are a reverse topological order of the condensed graph
+    std::vector<uint32_t> comp(n, NONE);
+    uint32_t comp_count = 0;
+    {
+        std::vector<uint32_t> index(n, NONE);
+        std::vector<uint32_t> lowlink(n);
+        std::vector<uint32_t> stack;
+        std::vector<std::pair<uint32_t, uint32_t>> call_stack; // (node, position of its next edge)
+        uint32_t counter = 0;
+
+        for (uint32_t start = 0; start < n; start++) {
+            if (index[start] != NONE) {
+                continue;
+            }
+            index[start] = lowlink[start] = counter++;
+            stack.push_back(start);
+            call_stack.emplace_back(start, offsets[start]);
+
+            while (!call_stack.empty()) {
+                auto node = call_stack.back().first;
+                auto& edge_pos = call_stack.back().second;
+                if (edge_pos < offsets[node + 1]) {
+                    auto next = targets[edge_pos++];
+                    if (index[next] == NONE) {
+                        index[next] = lowlink[next] = counter++;
+                        stack.push_back(next);
+                        call_stack.emplace_back(next, offsets[next]);
+                    } else if (comp[next] == NONE) {
+                        lowlink[node] = std::min(lowlink[node], index[next]);
+                    }
+                    continue;
+                }
+
+                if (lowlink[node] == index[node]) {
+                    uint32_t member;
+                    do {
+                        member = stack.back();
+                        stack.pop_back();
+                        comp[member] = comp_count;
+                    } while (member != node);
+                    comp_count++;
+                }
+                call_stack.pop_back();
+                if (!call_stack.empty()) {
+                    auto parent = call_stack.back().first;
+                    lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+                }
+            }
+        }
+    }
+
+    // Group the nodes by component
+    comp_offsets.assign(comp_count + 1, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        comp_offsets[comp[i] + 1]++;
+    }
+    for (uint32_t c = 0; c < comp_count; c++) {
+        comp_offsets[c + 1] += comp_offsets[c];
+    }
+    comp_nodes.resize(n);
+    {
+        auto pos = comp_offsets;
+        for (uint32_t i = 0; i < n; i++) {
+            comp_nodes[pos[comp[i]]++] = nodes[i];
+        }
+    }
+
+    comp_cyclic.assign(comp_count, 0);
+    for (uint32_t c = 0; c < comp_count; c++) {
+        comp_cyclic[c] = comp_offsets[c + 1] - comp_offsets[c] > 1;
+    }
+
+    // Condensed DAG
+    std::vector<std::pair<uint32_t, uint32_t>> comp_edges;
+    for (auto& [from, to] : edges) {
+        if (comp[from] == comp[to]) {
+            if (from == to) {
+                comp_cyclic[comp[from]] = 1;
+            }
+        } else {
+            comp_edges.emplace_back(comp[from], comp[to]);
+        }
+    }
+    edges.clear();
+    edges.shrink_to_fit();
+    std::sort(comp_edges.begin(), comp_edges.end());
+    comp_edges.erase(std::unique(comp_edges.begin(), comp_edges.end()), comp_edges.end());
+
+    std::vector<uint32_t> sinks_first(comp_count);
+    for (uint32_t c = 0; c < comp_count; c++) {
+        sinks_first[c] = c;
+    }
+
+    build_adjacency(comp_count, comp_edges, offsets, targets);
+    directions[0] = build_direction(offsets, targets, sinks_first);
+
+    for (auto& [from, to] : comp_edges) {
+        std::swap(from, to);
+    }
+    std::reverse(sinks_first.begin(), sinks_first.end());
+    build_adjacency(comp_count, comp_edges, offsets, targets);
+    directions[1] = build_direction(offsets, targets, sinks_first);
+
+    set_node2comp();
+}
+
+
+ReachabilityIndex::Direction ReachabilityIndex::build_direction(const std::vector<uint32_t>& succ_offsets,
+                                                                const std::vector<uint32_t>& succ,
+                                                                const std::vector<uint32_t>& sinks_first)
+{
+    const uint32_t comp_count = sinks_first.size();
+
+    // Spanning forest, the parent of a component is the first component found that reaches it directly
+    std::vector<uint32_t> parent(comp_count, NONE);
+    for (auto it = sinks_first.rbegin(); it != sinks_first.rend(); ++it) {
+        for (auto i = succ_offsets[*it]; i < succ_offsets[*it + 1]; i++) {
+            if (parent[succ[i]] == NONE) {
+                parent[succ[i]] = *it;
+            }
+        }
+    }
+    std::vector<std::pair<uint32_t, uint32_t>> tree_edges;
+    for (uint32_t c = 0; c < comp_count; c++) {
+        if (parent[c] != NONE) {
+            tree_edges.emplace_back(parent[c], c);
+        }
+    }
+    std::vector<uint32_t> children_offsets;
+    std::vector<uint32_t> children;
+    build_adjacency(comp_count, tree_edges, children_offsets, children);
+
+    // Postorder of the forest. The subtree of c has the numbers [first[c], comp_post[c]]
+    Direction res;
+    res.comp_post.resize(comp_count);
+    res.post_comp.resize(comp_count);
+    std::vector<uint32_t> first(comp_count);
+    {
+        uint32_t counter = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> call_stack; // (component, position of its next child)
+        for (uint32_t root = 0; root < comp_count; root++) {
+            if (parent[root] != NONE) {
+                continue;
+            }
+            first[root] = counter;
+            call_stack.emplace_back(root, children_offsets[root]);
+            while (!call_stack.empty()) {
+                auto c = call_stack.back().first;
+                auto& child_pos = call_stack.back().second;
+                if (child_pos < children_offsets[c + 1]) {
+                    auto child = children[child_pos++];
+                    first[child] = counter;
+                    call_stack.emplace_back(child, children_offsets[child]);
+                } else {
+                    res.comp_post[c] = counter;
+                    res.post_comp[counter] = c;
+                    counter++;
+                    call_stack.pop_back();
+                }
+            }
+        }
+        assert(counter == comp_count);
+    }
+
+    // The intervals of a component are its subtree merged with the intervals of its successors
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> comp_intervals(comp_count);
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    for (auto c : sinks_first) {
+        candidates.clear();
+        candidates.emplace_back(first[c], res.comp_post[c]);
+        for (auto i = succ_offsets[c]; i < succ_offsets[c + 1]; i++) {
+            auto& succ_intervals = comp_intervals[succ[i]];
+            candidates.insert(candidates.end(), succ_intervals.begin(), succ_intervals.end());
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        auto& merged = comp_intervals[c];
+        for (auto& interval : candidates) {
+            if (!merged.empty() && interval.first <= merged.back().second + 1) {
+                merged.back().second = std::max(merged.back().second, interval.second);
+            } else {
+                merged.push_back(interval);
+            }
+        }
+        merged.shrink_to_fit();
+    }
+
+    res.interval_offsets.resize(comp_count + 1);
+    res.interval_offsets[0] = 0;
+    for (uint32_t c = 0; c < comp_count; c++) {
+        res.interval_offsets[c + 1] = res.interval_offsets[c] + comp_intervals[c].size();
+        for (auto& [begin, end] : comp_intervals[c]) {
+            res.intervals.push_back(begin);
+            res.intervals.push_back(end);
+        }
+    }
+    return res;
+}
+
+
+ReachabilityIndex::ReachabilityIndex(const std::string& path) {
+    std::fstream ifs(path, std::ios::in | std::ios::binary);
+    predicate_id = Serialization::read_uint64(ifs);
+
+    comp_offsets = read_vec(ifs);
+    comp_nodes   = Serialization::read_uint64_vec(ifs, Serialization::read_uint64(ifs));
+    comp_cyclic  = Serialization::read_uint8_vec(ifs, Serialization::read_uint64(ifs));
+
+    for (auto& direction : directions) {
+        direction.comp_post        = read_vec(ifs);
+        direction.post_comp        = read_vec(ifs);
+        direction.interval_offsets = read_vec(ifs);
+        direction.intervals        = read_vec(ifs);
+    }
+    assert(ifs.good());
+
+    set_node2comp();
+}
+
+
+void ReachabilityIndex::serialize(const std::string& path) const {
+    std::fstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    Serialization::write_uint64(ofs, predicate_id);
+
+    write_vec(ofs, comp_offsets);
+    Serialization::write_uint64(ofs, comp_nodes.size());
+    Serialization::write_uint64_vec(ofs, comp_nodes);
+    Serialization::write_uint64(ofs, comp_cyclic.size());
+    Serialization::write_uint8_vec(ofs, comp_cyclic);
+
+    for (auto& direction : directions) {
+        write_vec(ofs, direction.comp_post);
+        write_vec(ofs, direction.post_comp);
+        write_vec(ofs, direction.interval_offsets);
+        write_vec(ofs, direction.intervals);
+    }
+    assert(ofs.good());
+    ofs.close();
+}
+
+
+std::string ReachabilityIndex::get_path(uint64_t predicate_id) {
+    std::stringstream ss;
+    ss << std::hex << predicate_id << INDEX_EXTENSION;
+    return file_manager.get_file_path(REACHABILITY_DIR + "/" + ss.str());
+}
+
+
+std::vector<std::unique_ptr<ReachabilityIndex>> ReachabilityIndex::load_all() {
+    std::vector<std::unique_ptr<ReachabilityIndex>> res;
+
+    auto dir_path = file_manager.get_file_path(REACHABILITY_DIR);
+    if (!Filesystem::is_directory(dir_path)) {
+        return res;
+    }
+    for (auto& entry : Filesystem::directory_iterator(dir_path)) {
+        if (entry.is_regular_file() && entry.path().extension() == INDEX_EXTENSION) {
+            res.push_back(std::make_unique<ReachabilityIndex>(entry.path().string()));
+        }
+    }
+    return res;
+}
+
+
+void ReachabilityIndex::set_node2comp() {
+    node2comp.clear();
+    node2comp.reserve(comp_nodes.size());
+    for (uint32_t c = 0; c + 1 < comp_offsets.size(); c++) {
+        for (auto i = comp_offsets[c]; i < comp_offsets[c + 1]; i++) {
+            node2comp.emplace(comp_nodes[i], c);
+        }
+    }
+}
+
+
+bool ReachabilityIndex::reaches(uint64_t from, uint64_t to, bool inverse, bool plus) const {
+    if (!plus && from == to) {
+        return true;
+    }
+    auto from_it = node2comp.find(from);
+    auto to_it   = node2comp.find(to);
+    if (from_it == node2comp.end() || to_it == node2comp.end()) {
+        return false;
+    }
+    auto from_comp = from_it->second;
+    auto to_comp   = to_it->second;
+    if (from_comp == to_comp) {
+        return from != to || comp_cyclic[from_comp];
+    }
+
+    // search the last interval that begins before the number of the reached component
+    auto& direction = directions[inverse];
+    auto  post      = direction.comp_post[to_comp];
+    auto  low       = direction.interval_offsets[from_comp];
+    auto  high      = direction.interval_offsets[from_comp + 1];
+    while (low < high) {
+        auto mid = low + (high - low) / 2;
+        if (direction.intervals[2 * mid] <= post) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low > direction.interval_offsets[from_comp] && post <= direction.intervals[2 * (low - 1) + 1];
+}
+
+
+ReachabilityIndex::ReachedIter ReachabilityIndex::get_reached(uint64_t from, bool inverse, bool plus) const {
+    ReachedIter res;
+    res.index = this;
+    res.from  = from;
+
+    auto from_it = node2comp.find(from);
+    if (from_it == node2comp.end()) {
+        res.from_pending = !plus;
+        return res;
+    }
+    auto from_comp = from_it->second;
+    res.from_pending = !plus || comp_cyclic[from_comp];
+
+    // the intervals are disjoint, so each component is visited once. They include the component of `from`
+    res.direction    = &directions[inverse];
+    res.interval     = res.direction->interval_offsets[from_comp];
+    res.interval_end = res.direction->interval_offsets[from_comp + 1];
+    return res;
+}
+
+
+bool ReachabilityIndex::ReachedIter::next() {
+    if (from_pending) {
+        from_pending = false;
+        current = from;
+        return true;
+    }
+    while (true) {
+        while (node < node_end) {
+            auto node_id = index->comp_nodes[node++];
+            if (node_id != from) {
+                current = node_id;
+                return true;
+            }
+        }
+        if (post < post_end) {
+            auto c   = direction->post_comp[post++];
+            node     = index->comp_offsets[c];
+            node_end = index->comp_offsets[c + 1];
+        } else if (interval < interval_end) {
+            post     = direction->intervals[2 * interval];
+            post_end = direction->intervals[2 * interval + 1] + 1;
+            interval++;
+        } else {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "third_party/robin_hood/robin_hood.h"
+
+/*
+ * ReachabilityIndex stores the transitive closure of the edges of a single predicate of the RdfModel, so the paths
+ * `P*` and `P+` can be answered without searching the graph.
+ *
+ * The strongly connected components of the predicate graph are collapsed into a DAG. Each component receives a
+ * number in the postorder of a spanning forest of the DAG, and it keeps the sorted and disjoint intervals of numbers
+ * of the components it reaches. In hierarchies that are mostly trees almost every component has a single interval,
+ * so checking if a node reaches another one is a hash lookup and a binary search, and the reached nodes are
+ * enumerated by scanning the components of each interval. The intervals are kept for both directions of the edges.
+ *
+ * The index is built by `mdb-index-paths` and it is not updated: an update that inserts or deletes an edge of the
+ * predicate marks it as outdated and removes its file.
+ */
+class ReachabilityIndex {
+    struct Direction;
+
+public:
+    inline static const std::string REACHABILITY_DIR = "reachability";
+
+    // Enumerates the nodes reached from a node, each one once, scanning the intervals as they are returned
+    class ReachedIter {
+    public:
+        // Moves to the next reached node, returns false when there are no more nodes
+        bool next();
+
+        uint64_t get() const { return current; }
+
+    private:
+        friend class ReachabilityIndex;
+
+        const ReachabilityIndex* index = nullptr;
+        const Direction*         direction = nullptr;
+
+        uint64_t from = 0;
+        bool     from_pending = false;
+        uint64_t current = 0;
+
+        // remaining intervals, components of the current interval and nodes of the current component
+        uint32_t interval     = 0;
+        uint32_t interval_end = 0;
+        uint32_t post         = 0;
+        uint32_t post_end     = 0;
+        uint32_t node         = 0;
+        uint32_t node_end     = 0;
+    };
+
+    uint64_t predicate_id;
+
+    // Builds the index of the predicate reading the pos B+tree
+    ReachabilityIndex(uint64_t predicate_id);
+
+    // Loads an existing index from a file
+    ReachabilityIndex(const std::string& path);
+
+    // Path of the file where the index of the predicate is saved
+    static std::string get_path(uint64_t predicate_id);
+
+    // Loads all the indexes saved in the database folder
+    static std::vector<std::unique_ptr<ReachabilityIndex>> load_all();
+
+    void serialize(const std::string& path) const;
+
+    // Returns true if there is a path from `from` to `to`. With `plus` the path must have at least one edge,
+    // otherwise every node reaches itself. With `inverse` the edges are followed from the object to the subject
+    bool reaches(uint64_t from, uint64_t to, bool inverse, bool plus) const;
+
+    // Returns an iterator over the nodes reached from `from`. The parameters are the same of reaches().
+    // `from` is the first node when it is reached
+    ReachedIter get_reached(uint64_t from, bool inverse, bool plus) const;
+
+    uint64_t get_node_count() const { return comp_nodes.size(); }
+
+    uint64_t get_component_count() const { return comp_offsets.size() - 1; }
+
+    // Number of intervals of both directions
+    uint64_t get_interval_count() const {
+        return (directions[0].intervals.size() + directions[1].intervals.size()) / 2;
+    }
+
+    bool is_outdated() const { return outdated.load(std::memory_order_relaxed); }
+
+    // The edges of the predicate were modified, the index must not be used anymore
+    void set_outdated() { outdated.store(true, std::memory_order_relaxed); }
+
+private:
+    struct Direction {
+        // postorder number of each component, and the component with each number
+        std::vector<uint32_t> comp_post;
+        std::vector<uint32_t> post_comp;
+
+        // intervals of component c are the pairs [begin, end] in intervals[2*offsets[c] .. 2*offsets[c+1])
+        std::vector<uint32_t> interval_offsets;
+        std::vector<uint32_t> intervals;
+    };
+
+    // nodes of component c are comp_nodes[comp_offsets[c] .. comp_offsets[c+1])
+    std::vector<uint32_t> comp_offsets;
+    std::vector<uint64_t> comp_nodes;
+
+    // 1 if the component has a cycle, so its nodes reach themselves with at least one edge
+    std::vector<uint8_t> comp_cyclic;
+
+    // [0] follows the edges from subject to object, [1] from object to subject
+    Direction directions[2];
+
+    robin_hood::unordered_flat_map<uint64_t, uint32_t> node2comp;
+
+    std::atomic<bool> outdated { false };
+
+    // Builds the intervals of a direction, `succ` is the condensed DAG in that direction and
+    // `sinks_first` is an order where every component is after all the components it reaches
+    static Direction build_direction(const std::vector<uint32_t>& succ_offsets,
+                                     const std::vector<uint32_t>& succ,
+                                     const std::vector<uint32_t>& sinks_first);
+
+    void set_node2comp();
+};
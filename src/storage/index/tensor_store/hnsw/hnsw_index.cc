@@ -0,0 +1,410 @@
+#include "hnsw_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <queue>
+#include <random>
+#include <stdexcept>
+
+#include "storage/index/tensor_store/hnsw/hnsw_query_iter.h"
+#include "storage/index/tensor_store/lsh/metric.h"
+#include "storage/index/tensor_store/scalar_quantizer.h"
+#include "storage/index/tensor_store/serialization.h"
+#include "storage/index/tensor_store/tensor_store.h"
+#include "third_party/robin_hood/robin_hood.h"
+
+using namespace HNSW;
+using namespace LSH;
+
+HNSWIndex::HNSWIndex(const TensorStore& tensor_store_,
+                     MetricType         metric_type_,
+                     uint64_t           M_,
+                     uint64_t           ef_construction_,
+                     uint64_t           ef_search_) :
+    M               (M_),
+    ef_construction (ef_construction_),
+    ef_search       (ef_search_),
+    tensor_store    (tensor_store_),
+    metric_type     (metric_type_),
+    max_m0          (2 * M_),
+    entry_point     (NO_NODE),
+    max_level       (0)
+{
+    assert(M > 1);
+    assert(ef_construction > 0);
+    assert(ef_search > 0);
+
+    // Bind metric functions
+    switch (metric_type) {
+    case MetricType::ANGULAR: {
+        similarity_fn = &Metric::cosine_distance;
+        break;
+    }
+    case MetricType::EUCLIDEAN: {
+        similarity_fn = &Metric::euclidean_distance;
+        break;
+    }
+    default: { // MetricType::MANHATTAN:
+        similarity_fn = &Metric::manhattan_distance;
+        break;
+    }
+    }
+}
+
+
+HNSWIndex::HNSWIndex(const std::string& path, const TensorStore& tensor_store_) :
+    tensor_store (tensor_store_)
+{
+    deserialize(path);
+    assert(M > 1);
+    assert(ef_construction > 0);
+    assert(ef_search > 0);
+}
+
+
+void HNSWIndex::build() {
+    if (entry_point != NO_NODE)
+        throw std::runtime_error("Unexpected HNSWIndex::build() call: HNSWIndex is already built!");
+
+    // Sorted to make the node numbers independent from the unordered_map iteration order
+    object_ids.clear();
+    for (auto&& [object_id, _] : tensor_store.object_id2tensor_offset)
+        object_ids.emplace_back(object_id);
+    std::sort(object_ids.begin(), object_ids.end());
+
+    if (object_ids.size() >= NO_NODE)
+        throw std::runtime_error("Too many tensors for the HNSW index");
+
+    const auto num_nodes = static_cast<uint32_t>(object_ids.size());
+
+    slots.resize(num_nodes);
+    for (uint32_t node = 0; node < num_nodes; ++node)
+        slots[node] = tensor_store.get_slot(object_ids[node]);
+
+    build_tensors.resize(num_nodes);
+    for (uint32_t node = 0; node < num_nodes; ++node) {
+        build_tensors[node].resize(tensor_store.tensors_dim);
+        tensor_store.get(object_ids[node], build_tensors[node]);
+    }
+
+    // Draw the level of each node. A fixed seed makes builds reproducible
+    std::mt19937_64 random_engine(0);
+    std::uniform_real_distribution<double> uniform_distribution(0.0, 1.0);
+    const double level_mult = 1.0 / std::log(static_cast<double>(M));
+
+    levels.resize(num_nodes);
+    upper_links.resize(num_nodes);
+    for (uint32_t node = 0; node < num_nodes; ++node) {
+        auto level = std::floor(-std::log(1.0 - uniform_distribution(random_engine)) * level_mult);
+        levels[node] = static_cast<uint8_t>(std::min(level, 255.0));
+        upper_links[node].assign(levels[node] * (M + 1), 0);
+    }
+    level0_links.assign(num_nodes * (max_m0 + 1), 0);
+
+    for (uint32_t node = 0; node < num_nodes; ++node)
+        insert(node);
+
+    build_tensors.clear();
+    build_tensors.shrink_to_fit();
+}
+
+
+std::vector<std::pair<uint64_t, float>> HNSWIndex::query_top_k(
+    const std::vector<float>& query_tensor,
+    uint64_t                  k) const
+{
+    assert(k > 0);
+    assert(query_tensor.size() == tensor_store.tensors_dim);
+
+    if (entry_point == NO_NODE)
+        return {};
+
+    std::vector<float> tensor_buffer(tensor_store.tensors_dim);
+
+    auto entry   = greedy_descend(query_tensor, 0, tensor_buffer);
+    auto results = search_layer(query_tensor, { entry }, std::max(ef_search, k), 0, tensor_buffer);
+
+    std::vector<std::pair<uint64_t, float>> nearest_neighbors;
+    if (tensor_store.quantizer != nullptr) {
+        // The distances are approximate, re-rank the best ones
+        nearest_neighbors.reserve(results.size());
+        for (auto& [approximate_distance, node] : results)
+            nearest_neighbors.emplace_back(object_ids[node], approximate_distance);
+        tensor_store.quantizer->rerank(query_tensor, nearest_neighbors, k, similarity_fn);
+        return nearest_neighbors;
+    }
+
+    auto result_size = std::min(k, static_cast<uint64_t>(results.size()));
+    nearest_neighbors.reserve(result_size);
+    for (uint64_t i = 0; i < result_size; ++i)
+        nearest_neighbors.emplace_back(object_ids[results[i].second], results[i].first);
+
+    return nearest_neighbors;
+}
+
+
+std::unique_ptr<HNSWQueryIter> HNSWIndex::query_iter(const std::vector<float>& query_tensor) const {
+    assert(query_tensor.size() == tensor_store.tensors_dim);
+    return std::make_unique<HNSWQueryIter>(query_tensor, *this);
+}
+
+
+uint32_t* HNSWIndex::get_links(uint32_t node, uint32_t level) {
+    if (level == 0)
+        return &level0_links[node * (max_m0 + 1)];
+    return &upper_links[node][(level - 1) * (M + 1)];
+}
+
+
+const uint32_t* HNSWIndex::get_links(uint32_t node, uint32_t level) const {
+    if (level == 0)
+        return &level0_links[node * (max_m0 + 1)];
+    return &upper_links[node][(level - 1) * (M + 1)];
+}
+
+
+const std::vector<float>& HNSWIndex::get_tensor(uint32_t node, std::vector<float>& buffer) const {
+    if (!build_tensors.empty())
+        return build_tensors[node];
+    tensor_store.get(object_ids[node], buffer);
+    return buffer;
+}
+
+
+float HNSWIndex::distance(const std::vector<float>& query_tensor, uint32_t node, std::vector<float>& buffer) const {
+    if (build_tensors.empty() && tensor_store.quantizer != nullptr) {
+        auto codes = tensor_store.quantizer->get_slot_codes(slots[node]);
+        return tensor_store.quantizer->distance(metric_type, query_tensor, codes);
+    }
+    return similarity_fn(query_tensor, get_tensor(node, buffer));
+}
+
+
+HNSWIndex::Candidate HNSWIndex::greedy_descend(const std::vector<float>& query_tensor,
+                                               uint32_t                  to_level,
+                                               std::vector<float>&       buffer) const
+{
+    Candidate current(distance(query_tensor, entry_point, buffer), entry_point);
+
+    for (auto level = max_level; level > to_level; --level) {
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            const auto links = get_links(current.second, level);
+            for (uint32_t i = 1; i <= links[0]; ++i) {
+                const auto link_distance = distance(query_tensor, links[i], buffer);
+                if (link_distance < current.first) {
+                    current = { link_distance, links[i] };
+                    changed = true;
+                }
+            }
+        }
+    }
+    return current;
+}
+
+
+std::vector<HNSWIndex::Candidate> HNSWIndex::search_layer(const std::vector<float>&     query_tensor,
+                                                          const std::vector<Candidate>& entry_points,
+                                                          uint64_t                      ef,
+                                                          uint32_t                      level,
+                                                          std::vector<float>&           buffer) const
+{
+    robin_hood::unordered_flat_set<uint32_t> visited;
+
+    // Closest candidate on top
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    // Furthest result on top
+    std::priority_queue<Candidate> results;
+
+    for (auto& entry : entry_points) {
+        visited.insert(entry.second);
+        candidates.push(entry);
+        results.push(entry);
+        if (results.size() > ef)
+            results.pop();
+    }
+
+    while (!candidates.empty()) {
+        const auto candidate = candidates.top();
+        if (results.size() >= ef && candidate.first > results.top().first) {
+            // Every remaining candidate is further than the results
+            break;
+        }
+        candidates.pop();
+
+        const auto links = get_links(candidate.second, level);
+        for (uint32_t i = 1; i <= links[0]; ++i) {
+            const auto neighbor = links[i];
+            if (!visited.insert(neighbor).second)
+                continue;
+
+            const auto neighbor_distance = distance(query_tensor, neighbor, buffer);
+            if (results.size() < ef || neighbor_distance < results.top().first) {
+                candidates.emplace(neighbor_distance, neighbor);
+                results.emplace(neighbor_distance, neighbor);
+                if (results.size() > ef)
+                    results.pop();
+            }
+        }
+    }
+
+    std::vector<Candidate> res(results.size());
+    for (auto i = res.size(); i > 0; --i) {
+        res[i - 1] = results.top();
+        results.pop();
+    }
+    return res;
+}
+
+
+void HNSWIndex::select_neighbors(std::vector<Candidate>& candidates, uint64_t max_count) const {
+    if (candidates.size() <= max_count)
+        return;
+
+    std::vector<Candidate> selected;
+    selected.reserve(max_count);
+    for (auto& candidate : candidates) {
+        if (selected.size() == max_count)
+            break;
+
+        const auto& candidate_tensor = build_tensors[candidate.second];
+        bool keep = std::none_of(selected.begin(), selected.end(), [&](const Candidate& other) {
+            return similarity_fn(candidate_tensor, build_tensors[other.second]) < candidate.first;
+        });
+        if (keep)
+            selected.push_back(candidate);
+    }
+    candidates = std::move(selected);
+}
+
+
+void HNSWIndex::connect(uint32_t node, uint32_t level, const std::vector<Candidate>& neighbors) {
+    const auto max_count = max_neighbors(level);
+
+    auto links = get_links(node, level);
+    links[0] = neighbors.size();
+    for (uint32_t i = 0; i < neighbors.size(); ++i)
+        links[i + 1] = neighbors[i].second;
+
+    for (auto& [_, neighbor] : neighbors) {
+        auto neighbor_links = get_links(neighbor, level);
+        if (neighbor_links[0] < max_count) {
+            neighbor_links[++neighbor_links[0]] = node;
+            continue;
+        }
+
+        // The neighbor is full, choose again between its current neighbors and the new node
+        const auto& neighbor_tensor = build_tensors[neighbor];
+        std::vector<Candidate> candidates;
+        candidates.reserve(max_count + 1);
+        candidates.emplace_back(similarity_fn(neighbor_tensor, build_tensors[node]), node);
+        for (uint32_t i = 1; i <= neighbor_links[0]; ++i) {
+            candidates.emplace_back(similarity_fn(neighbor_tensor, build_tensors[neighbor_links[i]]),
+                                    neighbor_links[i]);
+        }
+        std::sort(candidates.begin(), candidates.end());
+        select_neighbors(candidates, max_count);
+
+        neighbor_links[0] = candidates.size();
+        for (uint32_t i = 0; i < candidates.size(); ++i)
+            neighbor_links[i + 1] = candidates[i].second;
+    }
+}
+
+
+void HNSWIndex::insert(uint32_t node) {
+    const uint32_t level = levels[node];
+
+    if (entry_point == NO_NODE) {
+        entry_point = node;
+        max_level   = level;
+        return;
+    }
+
+    const auto& tensor = build_tensors[node];
+    std::vector<float> unused_buffer;
+
+    std::vector<Candidate> entry_points = { greedy_descend(tensor, level, unused_buffer) };
+    for (auto current_level = std::min(level, max_level) + 1; current_level > 0; --current_level) {
+        auto results = search_layer(tensor, entry_points, ef_construction, current_level - 1, unused_buffer);
+
+        auto neighbors = results;
+        select_neighbors(neighbors, max_neighbors(current_level - 1));
+        connect(node, current_level - 1, neighbors);
+
+        entry_points = std::move(results);
+    }
+
+    if (level > max_level) {
+        entry_point = node;
+        max_level   = level;
+    }
+}
+
+
+void HNSWIndex::serialize(const std::string& path) const {
+    std::fstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    Serialization::write_uint64(ofs, M);
+    Serialization::write_uint64(ofs, ef_construction);
+    Serialization::write_uint64(ofs, ef_search);
+
+    // Serialize metric
+    Serialization::write_uint8(ofs, static_cast<uint8_t>(metric_type));
+
+    // Serialize the graph
+    Serialization::write_uint64(ofs, object_ids.size());
+    Serialization::write_uint64(ofs, entry_point);
+    Serialization::write_uint64(ofs, max_level);
+    Serialization::write_uint64_vec(ofs, object_ids);
+    Serialization::write_uint8_vec(ofs, levels);
+    Serialization::write_uint32_vec(ofs, level0_links);
+    for (auto& links : upper_links)
+        Serialization::write_uint32_vec(ofs, links);
+    assert(ofs.good());
+    ofs.close();
+}
+
+
+void HNSWIndex::deserialize(const std::string& path) {
+    std::fstream ifs(path, std::ios::in | std::ios::binary);
+    M               = Serialization::read_uint64(ifs);
+    ef_construction = Serialization::read_uint64(ifs);
+    ef_search       = Serialization::read_uint64(ifs);
+    max_m0          = 2 * M;
+
+    // Deserialize and bind similarity function
+    metric_type = static_cast<MetricType>(Serialization::read_uint8(ifs));
+    switch (metric_type) {
+    case MetricType::ANGULAR:
+        similarity_fn = &Metric::cosine_distance;
+        break;
+    case MetricType::EUCLIDEAN: {
+        similarity_fn = &Metric::euclidean_distance;
+        break;
+    }
+    default: { // MetricType::MANHATTAN
+        similarity_fn = &Metric::manhattan_distance;
+        break;
+    }
+    }
+
+    // Deserialize the graph
+    const auto num_nodes = Serialization::read_uint64(ifs);
+    entry_point  = Serialization::read_uint64(ifs);
+    max_level    = Serialization::read_uint64(ifs);
+    object_ids   = Serialization::read_uint64_vec(ifs, num_nodes);
+    levels       = Serialization::read_uint8_vec(ifs, num_nodes);
+    level0_links = Serialization::read_uint32_vec(ifs, num_nodes * (max_m0 + 1));
+    upper_links.resize(num_nodes);
+    for (uint64_t node = 0; node < num_nodes; ++node)
+        upper_links[node] = Serialization::read_uint32_vec(ifs, levels[node] * (M + 1));
+    assert(ifs.good());
+    ifs.close();
+
+    slots.resize(num_nodes);
+    for (uint64_t node = 0; node < num_nodes; ++node)
+        slots[node] = tensor_store.get_slot(object_ids[node]);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TensorStore;
+
+namespace LSH {
+enum class MetricType;
+} // namespace LSH
+
+namespace HNSW {
+class HNSWQueryIter;
+/*
+ * HNSWIndex is a Hierarchical Navigable Small World graph built over all the tensors of a TensorStore. It is an
+ * alternative to the LSH ForestIndex with better recall/latency tradeoffs for high-dimensional tensors.
+ *
+ * Every node is an object_id of the tensor store and it is present in the layers 0..level of the graph, where level
+ * is chosen randomly with an exponentially decaying probability. A query greedily descends from the entry point at the
+ * top layer down to layer 1 and then does a best-first search with a dynamic candidate list of size ef at layer 0.
+ *
+ * Parameters:
+ *   M               - maximum number of neighbors of a node in layers > 0. Layer 0 allows 2 * M neighbors
+ *   ef_construction - size of the candidate list when building the graph. Higher means a better graph
+ *   ef_search       - size of the candidate list when querying (at least k is used). Higher means better recall
+ */
+class HNSWIndex {
+    friend class HNSWQueryIter;
+
+public:
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    uint64_t M;
+    uint64_t ef_construction;
+    uint64_t ef_search;
+
+    // Initialize a new HNSW index
+    HNSWIndex(const TensorStore& tensor_store,
+              LSH::MetricType    metric_type,
+              uint64_t           M,
+              uint64_t           ef_construction,
+              uint64_t           ef_search);
+
+    // Load an existing HNSW index from a file
+    HNSWIndex(const std::string& path, const TensorStore& tensor_store);
+
+    // Build the graph with every tensor of the TensorStore
+    void build();
+
+    // Get the (approximate) top k most similar object_ids
+    std::vector<std::pair<uint64_t, float>> query_top_k(const std::vector<float>& query_tensor, uint64_t k) const;
+
+    // Get an iterator for all the object_ids in the graph
+    std::unique_ptr<HNSWQueryIter> query_iter(const std::vector<float>& query_tensor) const;
+
+    // Estimated number of distances computed by query_top_k
+    uint64_t estimate_candidates(uint64_t k) const {
+        return std::max(ef_search, k) * max_m0;
+    }
+
+    LSH::MetricType get_metric_type() const { return metric_type; }
+
+    uint64_t size() const { return object_ids.size(); }
+
+    // Serialize the graph to a file
+    void serialize(const std::string& path) const;
+
+private:
+    // distance and node
+    using Candidate = std::pair<float, uint32_t>;
+
+    const TensorStore& tensor_store;
+    LSH::MetricType    metric_type;
+
+    float (*similarity_fn)(const std::vector<float>&, const std::vector<float>&);
+
+    // Maximum number of neighbors in layer 0
+    uint64_t max_m0;
+
+    uint32_t entry_point;
+    uint32_t max_level;
+
+    // node -> object_id
+    std::vector<uint64_t> object_ids;
+
+    // node -> slot of the tensor in the TensorStore, used to find its quantized codes without a map lookup
+    std::vector<uint32_t> slots;
+
+    // node -> highest layer of the node
+    std::vector<uint8_t> levels;
+
+    // Neighbors at layer 0, each node has a fixed-size slot: [count, neighbor_1, ..., neighbor_max_m0]
+    std::vector<uint32_t> level0_links;
+
+    // Neighbors at layers 1..levels[node], each layer has a fixed-size slot: [count, neighbor_1, ..., neighbor_M]
+    std::vector<std::vector<uint32_t>> upper_links;
+
+    // Tensors of every node, only loaded while building to avoid going through the tensor buffer
+    std::vector<std::vector<float>> build_tensors;
+
+    uint32_t* get_links(uint32_t node, uint32_t level);
+    const uint32_t* get_links(uint32_t node, uint32_t level) const;
+
+    uint64_t max_neighbors(uint32_t level) const {
+        return level == 0 ? max_m0 : M;
+    }
+
+    // Return the tensor of the node, using buffer if it has to be read from the TensorStore
+    const std::vector<float>& get_tensor(uint32_t node, std::vector<float>& buffer) const;
+
+    // Distance used to navigate the graph. When querying a store with quantized tensors it is approximate
+    float distance(const std::vector<float>& query_tensor, uint32_t node, std::vector<float>& buffer) const;
+
+    // Greedy search from the entry point down to the given layer (exclusive), returns the closest node found
+    Candidate greedy_descend(const std::vector<float>& query_tensor,
+                             uint32_t                  to_level,
+                             std::vector<float>&       buffer) const;
+
+    // Best-first search at the given layer. Returns up to ef candidates ordered by distance (ascending)
+    std::vector<Candidate> search_layer(const std::vector<float>&     query_tensor,
+                                        const std::vector<Candidate>& entry_points,
+                                        uint64_t                      ef,
+                                        uint32_t                      level,
+                                        std::vector<float>&           buffer) const;
+
+    // Keep at most max_count of the candidates (ordered by distance) using the neighbor selection heuristic, that
+    // prefers neighbors that are not closer to an already selected neighbor than to the node
+    void select_neighbors(std::vector<Candidate>& candidates, uint64_t max_count) const;
+
+    // Set the neighbors of node at the given layer and add the reverse links, pruning them if necessary
+    void connect(uint32_t node, uint32_t level, const std::vector<Candidate>& neighbors);
+
+    void insert(uint32_t node);
+
+    // Deserialize the graph from a file
+    void deserialize(const std::string& path);
+};
+} // namespace HNSW
@@ -0,0 +1,70 @@
+#include "hnsw_query_iter.h"
+
+#include "macros/likely.h"
+#include "query/exceptions.h"
+#include "query/query_context.h"
+#include "storage/index/tensor_store/tensor_store.h"
+
+using namespace HNSW;
+
+HNSWQueryIter::HNSWQueryIter(const std::vector<float>& query_tensor_, const HNSWIndex& hnsw_index_) :
+    query_tensor (query_tensor_),
+    hnsw_index   (hnsw_index_)
+{
+    tensor_buffer.resize(hnsw_index.tensor_store.tensors_dim);
+}
+
+
+void HNSWQueryIter::begin() {
+    current        = nullptr;
+    next_unvisited = 0;
+    visited.assign(hnsw_index.size(), false);
+    candidates = decltype(candidates)();
+
+    if (hnsw_index.entry_point != HNSWIndex::NO_NODE) {
+        // The distance of the start node could be approximate, push_candidate computes the exact one
+        auto start = hnsw_index.greedy_descend(query_tensor, 0, tensor_buffer);
+        push_candidate(start.second);
+    }
+}
+
+
+bool HNSWQueryIter::next() {
+    if (MDB_unlikely(get_query_ctx().thread_info.interruption_requested)) {
+        throw InterruptedException();
+    }
+
+    if (candidates.empty()) {
+        // Continue with a node that was not reachable from the visited ones
+        while (next_unvisited < visited.size() && visited[next_unvisited])
+            ++next_unvisited;
+        if (next_unvisited == visited.size())
+            return false;
+        push_candidate(next_unvisited);
+    }
+
+    const auto candidate = candidates.top();
+    candidates.pop();
+
+    const auto links = hnsw_index.get_links(candidate.second, 0);
+    for (uint32_t i = 1; i <= links[0]; ++i) {
+        if (!visited[links[i]])
+            push_candidate(links[i]);
+    }
+
+    current_value = { hnsw_index.object_ids[candidate.second], candidate.first };
+    current       = &current_value;
+    return true;
+}
+
+
+void HNSWQueryIter::reset() {
+    begin();
+}
+
+
+void HNSWQueryIter::push_candidate(uint32_t node) {
+    visited[node] = true;
+    const auto& tensor = hnsw_index.get_tensor(node, tensor_buffer);
+    candidates.emplace(hnsw_index.similarity_fn(query_tensor, tensor), node);
+}
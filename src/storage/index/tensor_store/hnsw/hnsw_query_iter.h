@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "storage/index/tensor_store/hnsw/hnsw_index.h"
+#include "storage/index/tensor_store/tensor_query_iter.h"
+
+namespace HNSW {
+/*
+ * Iterates over all the object_ids of an HNSWIndex with an unbounded best-first search at layer 0, starting from the
+ * node found by descending the upper layers. Nodes are returned in approximately ascending order of distance to the
+ * query tensor. Nodes that are not reachable from the start node are visited afterwards, so no object_id is missed.
+ */
+class HNSWQueryIter : public TensorQueryIter {
+public:
+    HNSWQueryIter(const std::vector<float>& query_tensor, const HNSWIndex& hnsw_index);
+
+    void begin() override;
+
+    bool next() override;
+
+    void reset() override;
+
+private:
+    const std::vector<float> query_tensor;
+    const HNSWIndex&         hnsw_index;
+
+    std::vector<bool> visited;
+
+    // Closest candidate on top
+    std::priority_queue<HNSWIndex::Candidate,
+                        std::vector<HNSWIndex::Candidate>,
+                        std::greater<HNSWIndex::Candidate>> candidates;
+
+    // Smallest node that could be not visited yet
+    uint32_t next_unvisited;
+
+    std::pair<uint64_t, float> current_value;
+
+    // Used to prevent multiple allocations
+    std::vector<float> tensor_buffer;
+
+    void push_candidate(uint32_t node);
+};
+} // namespace HNSW
@@ -0,0 +1,150 @@
+#include "batch_metric.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#include "storage/index/tensor_store/lsh/metric.h"
+
+using namespace LSH;
+
+namespace {
+#if defined(__AVX2__) && defined(__FMA__)
+constexpr uint64_t LANES = 8;
+
+inline float reduce_add(__m256 v) {
+    auto res = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    res = _mm_hadd_ps(res, res);
+    res = _mm_hadd_ps(res, res);
+    return _mm_cvtss_f32(res);
+}
+#endif
+
+
+// Computes the distances between the tensor and B queries, the vectorized loop processes 8 dimensions of the
+// tensor and the B queries per iteration and the remaining dimensions are processed one by one.
+template <MetricType METRIC, uint64_t B>
+void block_distances(const float*        tensor,
+                     const float* const* queries,
+                     const float*        query_norms,
+                     uint64_t            dim,
+                     float*              out)
+{
+    uint64_t i           = 0;
+    float    acc[B]      = {};
+    float    tensor_norm = 0.0f;
+#if defined(__AVX2__) && defined(__FMA__)
+    const auto sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 acc_v[B];
+    for (uint64_t j = 0; j < B; ++j) {
+        acc_v[j] = _mm256_setzero_ps();
+    }
+    auto norm_v = _mm256_setzero_ps();
+
+    for (; i + LANES <= dim; i += LANES) {
+        auto t = _mm256_loadu_ps(tensor + i);
+        if constexpr (METRIC == MetricType::ANGULAR) {
+            norm_v = _mm256_fmadd_ps(t, t, norm_v);
+        }
+        for (uint64_t j = 0; j < B; ++j) {
+            auto q = _mm256_loadu_ps(queries[j] + i);
+            if constexpr (METRIC == MetricType::EUCLIDEAN) {
+                auto diff = _mm256_sub_ps(q, t);
+                acc_v[j] = _mm256_fmadd_ps(diff, diff, acc_v[j]);
+            } else if constexpr (METRIC == MetricType::MANHATTAN) {
+                acc_v[j] = _mm256_add_ps(acc_v[j], _mm256_andnot_ps(sign_mask, _mm256_sub_ps(q, t)));
+            } else {
+                acc_v[j] = _mm256_fmadd_ps(q, t, acc_v[j]);
+            }
+        }
+    }
+    for (uint64_t j = 0; j < B; ++j) {
+        acc[j] = reduce_add(acc_v[j]);
+    }
+    tensor_norm = reduce_add(norm_v);
+#endif
+    for (; i < dim; ++i) {
+        auto const t = tensor[i];
+        if constexpr (METRIC == MetricType::ANGULAR) {
+            tensor_norm += t * t;
+        }
+        for (uint64_t j = 0; j < B; ++j) {
+            auto const q = queries[j][i];
+            if constexpr (METRIC == MetricType::EUCLIDEAN) {
+                acc[j] += (q - t) * (q - t);
+            } else if constexpr (METRIC == MetricType::MANHATTAN) {
+                acc[j] += std::abs(q - t);
+            } else {
+                acc[j] += q * t;
+            }
+        }
+    }
+
+    for (uint64_t j = 0; j < B; ++j) {
+        if constexpr (METRIC == MetricType::EUCLIDEAN) {
+            out[j] = std::sqrt(acc[j]);
+        } else if constexpr (METRIC == MetricType::MANHATTAN) {
+            out[j] = acc[j];
+        } else {
+            // Same as Metric::cosine_distance
+            auto const denominator = std::sqrt(query_norms[j] * tensor_norm);
+            out[j] = denominator > 0.0f ? std::min(std::max(1.0f - acc[j] / denominator, 0.0f), 1.0f) : 1.0f;
+        }
+    }
+}
+
+
+template <MetricType METRIC>
+void distances(const float*        tensor,
+               const float* const* queries,
+               const float*        query_norms,
+               uint64_t            query_count,
+               uint64_t            dim,
+               float*              out)
+{
+    uint64_t q = 0;
+    for (; q + BatchMetric::BLOCK_SIZE <= query_count; q += BatchMetric::BLOCK_SIZE) {
+        block_distances<METRIC, BatchMetric::BLOCK_SIZE>(tensor, queries + q, query_norms + q, dim, out + q);
+    }
+    for (; q < query_count; ++q) {
+        block_distances<METRIC, 1>(tensor, queries + q, query_norms + q, dim, out + q);
+    }
+}
+} // namespace
+
+
+void BatchMetric::distances(MetricType          metric_type,
+                            const float*        tensor,
+                            const float* const* queries,
+                            const float*        query_norms,
+                            uint64_t            query_count,
+                            uint64_t            dim,
+                            float*              out)
+{
+    switch (metric_type) {
+    case MetricType::ANGULAR:
+        ::distances<MetricType::ANGULAR>(tensor, queries, query_norms, query_count, dim, out);
+        break;
+    case MetricType::EUCLIDEAN:
+        ::distances<MetricType::EUCLIDEAN>(tensor, queries, query_norms, query_count, dim, out);
+        break;
+    default: // MetricType::MANHATTAN
+        ::distances<MetricType::MANHATTAN>(tensor, queries, query_norms, query_count, dim, out);
+        break;
+    }
+}
+
+
+float BatchMetric::norm(const float* tensor, uint64_t dim) {
+    float res = 0.0f;
+    #ifdef _OPENMP
+    #pragma omp simd reduction(+ : res)
+    #endif
+    for (uint64_t i = 0; i < dim; ++i) {
+        res += tensor[i] * tensor[i];
+    }
+    return res;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace LSH {
+enum class MetricType;
+
+/*
+ * BatchMetric computes the distance between one tensor and many query tensors. The queries are processed in blocks
+ * of BLOCK_SIZE, so each part of the tensor is loaded once per block instead of once per query.
+ *
+ * The distances are the same ones computed by Metric (up to floating point rounding).
+ */
+class BatchMetric {
+public:
+    static constexpr uint64_t BLOCK_SIZE = 4;
+
+    // Writes in out[i] the distance between tensor and queries[i]. query_norms[i] must be the dot product of
+    // queries[i] with itself, it is only used by the angular metric
+    static void distances(MetricType          metric_type,
+                          const float*        tensor,
+                          const float* const* queries,
+                          const float*        query_norms,
+                          uint64_t            query_count,
+                          uint64_t            dim,
+                          float*              out);
+
+    // Dot product of the tensor with itself
+    static float norm(const float* tensor, uint64_t dim);
+};
+} // namespace LSH
@@ -0,0 +1,111 @@
+#include "filtered_index_top_k.h"
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#include "graph_models/quad_model/conversions.h"
+#include "macros/likely.h"
+#include "storage/index/tensor_store/tensor_store.h"
+
+using namespace LSH;
+
+FilteredIndexTopK::FilteredIndexTopK(std::unique_ptr<BindingIter> child_iter_,
+                                     VarId                        object_var_,
+                                     VarId                        similarity_var_,
+                                     std::vector<VarId>&&         child_vars_,
+                                     const TensorStore&           tensor_store_,
+                                     const std::vector<float>&    query_tensor_,
+                                     int64_t                      k_) :
+    object_var     (object_var_),
+    similarity_var (similarity_var_),
+    child_vars     (std::move(child_vars_)),
+    tensor_store   (tensor_store_),
+    query_tensor   (query_tensor_),
+    k              (k_),
+    child_iter     (std::move(child_iter_)) { }
+
+
+void FilteredIndexTopK::accept_visitor(BindingIterVisitor& visitor) {
+    visitor.visit(*this);
+}
+
+
+void FilteredIndexTopK::_begin(Binding& parent_binding) {
+    this->parent_binding = &parent_binding;
+    child_iter->begin(parent_binding);
+    search();
+}
+
+
+bool FilteredIndexTopK::_next() {
+    while (current_row == NO_ROW) {
+        if (MDB_unlikely(get_query_ctx().thread_info.interruption_requested))
+            throw InterruptedException();
+
+        if (current_index == top_k.size())
+            return false;
+
+        current_row = object2first_row.find(top_k[current_index].first)->second;
+        ++current_index;
+    }
+
+    auto row = &rows[current_row * child_vars.size()];
+    for (uint_fast32_t i = 0; i < child_vars.size(); i++) {
+        parent_binding->add(child_vars[i], ObjectId(row[i]));
+    }
+    parent_binding->add(object_var, ObjectId(top_k[current_index - 1].first));
+    parent_binding->add(similarity_var, MQL::Conversions::pack_float(top_k[current_index - 1].second));
+
+    current_row = next_row[current_row];
+    return true;
+}
+
+
+void FilteredIndexTopK::_reset() {
+    child_iter->reset();
+    search();
+}
+
+
+void FilteredIndexTopK::assign_nulls() {
+    child_iter->assign_nulls();
+    parent_binding->add(object_var, ObjectId::get_null());
+    parent_binding->add(similarity_var, ObjectId::get_null());
+}
+
+
+void FilteredIndexTopK::search() {
+    rows.clear();
+    next_row.clear();
+    object2first_row.clear();
+    allowed_ids.clear();
+    top_k.clear();
+    current_index = 0;
+    current_row   = NO_ROW;
+
+    while (child_iter->next()) {
+        for (auto var : child_vars) {
+            rows.push_back((*parent_binding)[var].id);
+        }
+
+        auto object_id = (*parent_binding)[object_var].id;
+        auto row       = next_row.size();
+        auto it        = object2first_row.find(object_id);
+        if (it == object2first_row.end()) {
+            next_row.push_back(NO_ROW);
+            object2first_row.insert({ object_id, row });
+            allowed_ids.push_back(object_id);
+        } else {
+            next_row.push_back(it->second);
+            it->second = row;
+        }
+    }
+
+    if (allowed_ids.empty())
+        return;
+
+    top_k = tensor_store.query_top_k(query_tensor, k, allowed_ids, [this](uint64_t object_id) {
+        return object2first_row.find(object_id) != object2first_row.end();
+    });
+}
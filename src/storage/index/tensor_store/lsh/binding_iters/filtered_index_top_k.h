@@ -0,0 +1,64 @@
+#pragma once
+
+#include "query/executor/binding_iter.h"
+#include "third_party/robin_hood/robin_hood.h"
+
+class TensorStore;
+
+namespace LSH {
+
+// Top k similarity search restricted to the objects returned by a basic graph pattern. The child is materialized
+// and its distinct objects are pushed down into the tensor store search, then every child row of each result is
+// returned ordered by similarity
+class FilteredIndexTopK : public BindingIter {
+public:
+    static constexpr uint64_t NO_ROW = UINT64_MAX;
+
+    const VarId              object_var;
+    const VarId              similarity_var;
+    const std::vector<VarId> child_vars;
+    const TensorStore&       tensor_store;
+    const std::vector<float> query_tensor;
+    const int64_t            k;
+
+    FilteredIndexTopK(std::unique_ptr<BindingIter> child_iter,
+                      VarId                        object_var,
+                      VarId                        similarity_var,
+                      std::vector<VarId>&&         child_vars,
+                      const TensorStore&           tensor_store,
+                      const std::vector<float>&    query_tensor,
+                      int64_t                      k);
+
+    void accept_visitor(BindingIterVisitor& visitor) override;
+    void _begin(Binding& parent_binding) override;
+    bool _next() override;
+    void _reset() override;
+    void assign_nulls() override;
+
+    std::unique_ptr<BindingIter> child_iter;
+
+private:
+    Binding* parent_binding;
+
+    // child_vars.size() values for each row of the child
+    std::vector<uint64_t> rows;
+
+    // Next row with the same object, NO_ROW if it is the last one
+    std::vector<uint64_t> next_row;
+
+    // object -> first row
+    robin_hood::unordered_map<uint64_t, uint64_t> object2first_row;
+
+    // Distinct objects of the child
+    std::vector<uint64_t> allowed_ids;
+
+    std::vector<std::pair<uint64_t, float>> top_k;
+
+    uint64_t current_index;
+
+    uint64_t current_row;
+
+    // Read the child and search its objects
+    void search();
+};
+} // namespace LSH
@@ -1,13 +1,13 @@
 #include "forest_index_top_all.h"
 
 #include "graph_models/quad_model/conversions.h"
-#include "storage/index/tensor_store/lsh/forest_index_query_iter.h"
+#include "storage/index/tensor_store/tensor_query_iter.h"
 
 using namespace LSH;
 
 ForestIndexTopAll::ForestIndexTopAll(VarId object_var_,
                                      VarId similarity_var_,
-                                     std::unique_ptr<ForestIndexQueryIter> query_iter_) :
+                                     std::unique_ptr<TensorQueryIter> query_iter_) :
     object_var     (object_var_),
     similarity_var (similarity_var_),
     query_iter     (std::move(query_iter_)) { }
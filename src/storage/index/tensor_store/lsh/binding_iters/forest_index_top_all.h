@@ -2,15 +2,17 @@
 
 #include "query/executor/binding_iter.h"
 
+class TensorQueryIter;
+
 namespace LSH {
-class ForestIndexQueryIter;
 
+// Returns every object of the tensor store ordered by similarity, it works with any TensorQueryIter
 class ForestIndexTopAll : public BindingIter {
 public:
     const VarId object_var;
     const VarId similarity_var;
 
-    ForestIndexTopAll(VarId object_var, VarId similarity_var, std::unique_ptr<ForestIndexQueryIter> query_iter);
+    ForestIndexTopAll(VarId object_var, VarId similarity_var, std::unique_ptr<TensorQueryIter> query_iter);
 
     void accept_visitor(BindingIterVisitor& visitor) override;
     void _begin(Binding& parent_binding) override;
@@ -19,7 +21,7 @@ public:
     void assign_nulls() override;
 
 private:
-    std::unique_ptr<LSH::ForestIndexQueryIter> query_iter;
+    std::unique_ptr<TensorQueryIter> query_iter;
 
     Binding* parent_binding;
 };
@@ -5,9 +5,11 @@
 #include <queue>
 
 #include "graph_models/object_id.h"
+#include "storage/index/tensor_store/lsh/batch_metric.h"
 #include "storage/index/tensor_store/lsh/forest_index_query_iter.h"
 #include "storage/index/tensor_store/lsh/metric.h"
 #include "storage/index/tensor_store/lsh/tree.h"
+#include "storage/index/tensor_store/scalar_quantizer.h"
 #include "storage/index/tensor_store/serialization.h"
 #include "storage/index/tensor_store/tensor_store.h"
 
@@ -41,8 +43,9 @@ ForestIndex::ForestIndex(const TensorStore& tensor_store_, MetricType metric_typ
     }
 
     // Initialize the trees
+    trees = std::make_shared<Trees>();
     for (uint_fast32_t i = 0; i < num_trees; ++i)
-        trees.push_back(std::make_unique<Tree>(tensor_store, metric_type, max_bucket_size, max_depth));
+        trees->push_back(create_tree());
 }
 
 
@@ -57,23 +60,118 @@ ForestIndex::ForestIndex(const std::string& path, const TensorStore& tensor_stor
 }
 
 
+ForestIndex::~ForestIndex() {
+    stop_compaction = true;
+    wait_compaction();
+}
+
+
+std::unique_ptr<Tree> ForestIndex::create_tree() const {
+    return std::make_unique<Tree>(tensor_store, metric_type, max_bucket_size, max_depth);
+}
+
+
 void ForestIndex::build() {
+    const auto object_ids = tensor_store.get_object_ids();
+
     #ifdef _OPENMP
     #pragma omp parallel for
     #endif
-    for (auto it = trees.begin(); it < trees.end(); ++it)
-        (*it)->build();
+    for (auto it = trees->begin(); it < trees->end(); ++it)
+        (*it)->build(object_ids);
 }
 
 
-std::vector<std::pair<uint64_t, float>> ForestIndex::query_top_k(
+void ForestIndex::insert(uint64_t object_id, const std::vector<float>& tensor) {
+    std::unique_lock lock(trees_mutex);
+    for (auto& tree : *trees)
+        tree->insert(object_id, tensor);
+
+    if (compacting)
+        compaction_inserts.push_back(object_id);
+}
+
+
+void ForestIndex::remove(uint64_t) {
+    std::unique_lock lock(trees_mutex);
+    ++tombstones;
+    check_compaction();
+}
+
+
+void ForestIndex::wait_compaction() {
+    if (compaction_thread.joinable())
+        compaction_thread.join();
+}
+
+
+void ForestIndex::check_compaction() {
+    if (compacting || tombstones <= COMPACTION_RATIO * tensor_store.size())
+        return;
+
+    // The previous compaction already finished, it only has to be joined
+    wait_compaction();
+
+    compacting            = true;
+    compaction_tombstones = tombstones;
+    compaction_inserts.clear();
+    compaction_thread = std::thread(&ForestIndex::compact, this);
+}
+
+
+void ForestIndex::compact() {
+    // Objects inserted from now on are also in compaction_inserts, Tree::insert ignores them if they are repeated
+    const auto object_ids = tensor_store.get_object_ids();
+
+    // The new trees are built without locking, queries and modifications use the current ones meanwhile
+    auto new_trees = std::make_shared<Trees>();
+    for (uint_fast32_t i = 0; i < num_trees && !stop_compaction; ++i) {
+        new_trees->push_back(create_tree());
+        new_trees->back()->build(object_ids);
+    }
+
+    std::unique_lock lock(trees_mutex);
+    compacting = false;
+    if (stop_compaction)
+        return;
+
+    std::vector<float> tensor_buffer(tensor_store.tensors_dim);
+    for (auto object_id : compaction_inserts) {
+        if (!tensor_store.get(object_id, tensor_buffer))
+            continue;
+        for (auto& tree : *new_trees)
+            tree->insert(object_id, tensor_buffer);
+    }
+    compaction_inserts.clear();
+
+    trees = std::move(new_trees);
+    tombstones -= compaction_tombstones;
+}
+
+
+namespace {
+// Keep the k nearest neighbors sorted by similarity
+void sort_top_k(std::vector<std::pair<uint64_t, float>>& nearest_neighbors, uint64_t k) {
+    auto result_size = std::min(k, static_cast<uint64_t>(nearest_neighbors.size())); // in MAC .size() is u32, and min cannot infer
+    std::partial_sort(nearest_neighbors.begin(),
+                      nearest_neighbors.begin() + result_size,
+                      nearest_neighbors.end(),
+                      [](const std::pair<uint64_t, float>& lhs, const std::pair<uint64_t, float>& rhs) {
+                          return lhs.second < rhs.second;
+                      });
+    nearest_neighbors.resize(result_size);
+}
+} // namespace
+
+
+robin_hood::unordered_flat_set<uint64_t> ForestIndex::get_candidates(
     const std::vector<float>& query_tensor,
     uint64_t                  k) const
 {
-    assert(k > 0);
-    assert(query_tensor.size() == tensor_store.tensors_dim);
+    const auto min_candidates = estimate_candidates(k);
 
-    const auto min_candidates = (num_trees < 3) ? 2 * k : num_trees * k;
+    std::shared_lock lock(trees_mutex);
+    const auto& forest = *trees;
 
     std::vector<TreeNode*>                   current_nodes;
     std::vector<uint_fast32_t>               current_depths;
@@ -85,7 +183,7 @@ std::vector<std::pair<uint64_t, float>> ForestIndex::query_top_k(
 
     // Descend on each tree and collect the initial candidates
     for (auto tree_idx = 0U; tree_idx < num_trees; ++tree_idx) {
-        auto [leaf, depth] = trees[tree_idx]->descend(query_tensor);
+        auto [leaf, depth] = forest[tree_idx]->descend(query_tensor);
         current_nodes.push_back(leaf);
         current_depths.push_back(depth);
         candidate_nearest_neighbors.insert(leaf->object_ids.begin(), leaf->object_ids.end());
@@ -109,31 +207,125 @@ std::vector<std::pair<uint64_t, float>> ForestIndex::query_top_k(
         }
         --current_maximum_depth;
     }
+    return candidate_nearest_neighbors;
+}
+
+
+std::vector<std::pair<uint64_t, float>> ForestIndex::query_top_k(
+    const std::vector<float>& query_tensor,
+    uint64_t                  k) const
+{
+    assert(k > 0);
+    assert(query_tensor.size() == tensor_store.tensors_dim);
+
+    const auto candidate_nearest_neighbors = get_candidates(query_tensor, k);
 
     // Compute similarities
     std::vector<std::pair<uint64_t, float>> nearest_neighbors;
     nearest_neighbors.reserve(candidate_nearest_neighbors.size());
 
+    if (tensor_store.quantizer != nullptr) {
+        // Score every candidate with the quantized tensors and re-rank only the best ones
+        for (const auto& object_id : candidate_nearest_neighbors) {
+            // Objects removed before the quantization are still in the trees until the next compaction
+            auto codes = tensor_store.quantizer->get_codes(object_id);
+            if (codes != nullptr) {
+                nearest_neighbors.emplace_back(object_id,
+                                               tensor_store.quantizer->distance(metric_type, query_tensor, codes));
+            }
+        }
+        tensor_store.quantizer->rerank(query_tensor, nearest_neighbors, k, similarity_fn);
+        return nearest_neighbors;
+    }
+
     std::vector<float> tensor_buffer(tensor_store.tensors_dim);
     for (const auto& object_id : candidate_nearest_neighbors) {
-        tensor_store.get(object_id, tensor_buffer);
-        nearest_neighbors.emplace_back(object_id, similarity_fn(query_tensor, tensor_buffer));
+        // Removed objects are still in the trees until the next compaction
+        if (tensor_store.get(object_id, tensor_buffer))
+            nearest_neighbors.emplace_back(object_id, similarity_fn(query_tensor, tensor_buffer));
     }
 
-    // Sort by similarity
-    auto result_size = std::min(k, static_cast<uint64_t>(nearest_neighbors.size())); // in MAC .size() is u32, and min cannot infer
-    std::partial_sort(nearest_neighbors.begin(),
-                      nearest_neighbors.begin() + result_size,
-                      nearest_neighbors.end(),
-                      [](const std::pair<uint64_t, float>& lhs, const std::pair<uint64_t, float>& rhs) {
-                          return lhs.second < rhs.second;
-                      });
-    nearest_neighbors.resize(result_size);
-
+    sort_top_k(nearest_neighbors, k);
     return nearest_neighbors;
 }
 
 
+std::vector<std::vector<std::pair<uint64_t, float>>> ForestIndex::query_top_k(
+    const std::vector<std::vector<float>>& query_tensors,
+    uint64_t                               k) const
+{
+    assert(k > 0);
+    std::vector<std::vector<std::pair<uint64_t, float>>> res(query_tensors.size());
+
+    if (tensor_store.quantizer != nullptr) {
+        // The quantized distances are already cheap, only the float tensors are worth sharing
+        for (uint64_t i = 0; i < query_tensors.size(); ++i)
+            res[i] = query_top_k(query_tensors[i], k);
+        return res;
+    }
+
+    const auto dim = tensor_store.tensors_dim;
+
+    // Pairs (object_id, query index), sorted so the queries of each candidate are together
+    std::vector<std::pair<uint64_t, uint32_t>> candidates;
+    std::vector<const float*>                  queries(query_tensors.size());
+    std::vector<float>                         query_norms(query_tensors.size(), 0.0f);
+
+    for (uint32_t i = 0; i < query_tensors.size(); ++i) {
+        assert(query_tensors[i].size() == dim);
+        queries[i] = query_tensors[i].data();
+        if (metric_type == MetricType::ANGULAR)
+            query_norms[i] = BatchMetric::norm(queries[i], dim);
+
+        const auto query_candidates = get_candidates(query_tensors[i], k);
+        res[i].reserve(query_candidates.size());
+        for (const auto& object_id : query_candidates)
+            candidates.emplace_back(object_id, i);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<float>        tensor_buffer(dim);
+    std::vector<const float*> batch_queries;
+    std::vector<float>        batch_norms;
+    std::vector<float>        distances;
+
+    for (uint64_t begin = 0; begin < candidates.size();) {
+        const auto object_id = candidates[begin].first;
+
+        auto end = begin;
+        batch_queries.clear();
+        batch_norms.clear();
+        for (; end < candidates.size() && candidates[end].first == object_id; ++end) {
+            batch_queries.push_back(queries[candidates[end].second]);
+            batch_norms.push_back(query_norms[candidates[end].second]);
+        }
+        distances.resize(batch_queries.size());
+
+        auto tensor = tensor_store.get_data(object_id, tensor_buffer);
+        if (tensor == nullptr) {
+            // Removed object, it is still in the trees until the next compaction
+            begin = end;
+            continue;
+        }
+        BatchMetric::distances(metric_type,
+                               tensor,
+                               batch_queries.data(),
+                               batch_norms.data(),
+                               batch_queries.size(),
+                               dim,
+                               distances.data());
+
+        for (auto i = begin; i < end; ++i)
+            res[candidates[i].second].emplace_back(object_id, distances[i - begin]);
+        begin = end;
+    }
+
+    for (auto& nearest_neighbors : res)
+        sort_top_k(nearest_neighbors, k);
+    return res;
+}
+
+
 std::unique_ptr<ForestIndexQueryIter> ForestIndex::query_iter(const std::vector<float>& query_tensor) const {
     assert(query_tensor.size() == tensor_store.tensors_dim);
     return std::make_unique<ForestIndexQueryIter>(query_tensor, *this);
@@ -151,7 +343,8 @@ void ForestIndex::serialize(const std::string& path) const
     Serialization::write_uint8(ofs, static_cast<uint8_t>(metric_type));
 
     // Serialize each tree adjacently
-    for (auto& tree : trees)
+    std::shared_lock lock(trees_mutex);
+    for (auto& tree : *trees)
         tree->serialize(ofs);
     assert(ofs.good());
     ofs.close();
@@ -182,8 +375,9 @@ void ForestIndex::deserialize(const std::string& path)
     }
 
     // Deserialize each tree
+    trees = std::make_shared<Trees>();
     for (uint_fast32_t i = 0; i < num_trees; ++i)
-        trees.push_back(std::make_unique<Tree>(ifs, tensor_store));
+        trees->push_back(std::make_unique<Tree>(ifs, tensor_store));
     assert(ifs.good());
     ifs.close();
 }
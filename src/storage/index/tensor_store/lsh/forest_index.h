@@ -1,9 +1,14 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <shared_mutex>
+#include <thread>
 #include <vector>
 
+#include "third_party/robin_hood/robin_hood.h"
+
 class TensorStore;
 
 namespace LSH {
@@ -13,11 +18,21 @@ enum class MetricType;
 /*
  * ForestIndex is the main class for creating an LSH Forest Index for a given TensorStore. After building the index, one
  * can iterate over all the indexed object_ids through a QueryIterator instance
+ *
+ * Objects can be inserted and removed while the index is queried. An insertion adds the object to a leaf of each tree
+ * (splitting the leaf if needed), while a removal only counts a tombstone: the object stays in the leaves and is
+ * skipped when the candidates are scored. When there are too many tombstones the trees are rebuilt in the background
+ * and replaced, queries that already started keep using the previous trees.
  */
 class ForestIndex {
     friend class ForestIndexQueryIter;
 
 public:
+    // The trees are rebuilt when the tombstones are more than this fraction of the objects
+    static constexpr double COMPACTION_RATIO = 0.25;
+
+    using Trees = std::vector<std::unique_ptr<Tree>>;
+
     uint64_t num_trees;
     uint64_t max_bucket_size;
     uint64_t max_depth;
@@ -32,12 +47,33 @@ public:
     // Load an existing forest index from a file
     ForestIndex(const std::string& path, const TensorStore& tensor_store);
 
+    // Waits for the compaction if it is running
+    ~ForestIndex();
+
     // Build the forest index from the TensorStore
     void build();
 
+    // Add an object whose tensor was written in the TensorStore
+    void insert(uint64_t object_id, const std::vector<float>& tensor);
+
+    // Mark an object as removed, its previous tensor no longer belongs to the TensorStore. It may start a compaction
+    void remove(uint64_t object_id);
+
     // Get the top k most similar object_ids from the forest using the SynchAscend algorithm
     std::vector<std::pair<uint64_t, float>> query_top_k(const std::vector<float>& query_tensor, uint64_t k) const;
 
+    // Get the top k most similar object_ids for each query. Each candidate is read once and its distances to all the
+    // queries that have it as candidate are computed together
+    std::vector<std::vector<std::pair<uint64_t, float>>>
+      query_top_k(const std::vector<std::vector<float>>& query_tensors, uint64_t k) const;
+
+    // Estimated number of candidates whose similarity is computed by query_top_k
+    uint64_t estimate_candidates(uint64_t k) const {
+        return (num_trees < 3) ? 2 * k : num_trees * k;
+    }
+
+    MetricType get_metric_type() const { return metric_type; }
+
     // Get an iterator for all the object_ids in the forest
     std::unique_ptr<ForestIndexQueryIter> query_iter(const std::vector<float>& query_tensor) const;
 
@@ -50,7 +86,45 @@ private:
 
     float (*similarity_fn)(const std::vector<float>&, const std::vector<float>&);
 
-    std::vector<std::unique_ptr<Tree>> trees;
+    // Replaced by the compaction, a query keeps a reference to the trees it uses
+    std::shared_ptr<Trees> trees;
+
+    // Shared to read the trees, exclusive to modify them or to replace them
+    mutable std::shared_mutex trees_mutex;
+
+    // Removed or replaced objects whose entries are still in the trees
+    uint64_t tombstones = 0;
+
+    std::thread compaction_thread;
+
+    bool compacting = false;
+
+    std::atomic<bool> stop_compaction { false };
+
+    // Objects inserted while the compaction runs, they are added to the new trees before replacing the old ones
+    std::vector<uint64_t> compaction_inserts;
+
+    // Tombstones counted before the compaction started, the new trees don't have them
+    uint64_t compaction_tombstones = 0;
+
+    std::unique_ptr<Tree> create_tree() const;
+
+    std::shared_ptr<Trees> get_trees() const {
+        std::shared_lock lock(trees_mutex);
+        return trees;
+    }
+
+    // Waits until the running compaction (if any) finishes
+    void wait_compaction();
+
+    // Starts the compaction if there are too many tombstones, trees_mutex must be locked exclusively
+    void check_compaction();
+
+    // Rebuild the trees with the current objects and replace the old ones
+    void compact();
+
+    // Collect the candidates of a query using the SynchAscend algorithm
+    robin_hood::unordered_flat_set<uint64_t> get_candidates(const std::vector<float>& query_tensor, uint64_t k) const;
 
     // Deserialize the tree from a file
     void deserialize(const std::string& path);
@@ -15,23 +15,29 @@ ForestIndexQueryIter::ForestIndexQueryIter(
     const ForestIndex& forest_index_
 ) :
     query_tensor(query_tensor_),
-    forest_index(forest_index_)
+    forest_index(forest_index_),
+    trees       (forest_index_.get_trees())
 {
     // Initialize containers with the right size
-    auto num_trees = forest_index.trees.size();
+    auto num_trees = trees->size();
     nodes.resize(num_trees);
     depths.resize(num_trees);
+    versions.resize(num_trees);
     buckets.resize(num_trees);
 }
 
 
 void ForestIndexQueryIter::begin() {
-    for (uint_fast32_t i = 0; i < forest_index.trees.size(); ++i) {
-        auto [leaf, depth] = forest_index.trees[i]->descend(query_tensor);
-        nodes[i]  = leaf;
-        depths[i] = depth;
+    std::shared_lock lock(forest_index.trees_mutex);
+    for (uint_fast32_t i = 0; i < trees->size(); ++i) {
+        auto [leaf, depth] = (*trees)[i]->descend(query_tensor);
+        nodes[i]    = leaf;
+        depths[i]   = depth;
+        versions[i] = (*trees)[i]->get_version();
         buckets[i].insert(leaf->object_ids.begin(), leaf->object_ids.end());
     }
+    lock.unlock();
+
     current_maximum_depth = *std::max_element(depths.begin(), depths.end());
     current               = nullptr;
     intersect_buckets();
@@ -64,8 +70,16 @@ bool ForestIndexQueryIter::next() {
         }
 
         // Try to get an intersection
+        std::shared_lock lock(forest_index.trees_mutex);
         for (uint_fast32_t i = 0; i < nodes.size(); ++i) {
             if (depths[i] == current_maximum_depth) {
+                // After a split the node may have moved down, the node at its depth is searched again. Nodes
+                // above the leaves are never moved, so its ancestors are the same
+                const auto& tree = *(*trees)[i];
+                if (tree.get_version() != versions[i]) {
+                    nodes[i]    = tree.descend(query_tensor, depths[i]);
+                    versions[i] = tree.get_version();
+                }
                 TreeNode*             sibling             = nodes[i]->sibling();
                 std::vector<uint64_t> sibling_descendants = Tree::descendants(sibling);
                 buckets[i].insert(sibling_descendants.begin(), sibling_descendants.end());
@@ -73,6 +87,7 @@ bool ForestIndexQueryIter::next() {
                 --depths[i];
             }
         }
+        lock.unlock();
         --current_maximum_depth;
         intersect_buckets();
     }
@@ -121,7 +136,9 @@ void ForestIndexQueryIter::intersect_buckets() {
     // Fill the stack
     std::vector<float> tensor_buffer(forest_index.tensor_store.tensors_dim);
     for (const auto& object_id : intersection_bucket) {
-        forest_index.tensor_store.get(object_id, tensor_buffer);
+        // Removed objects are still in the trees until the next compaction
+        if (!forest_index.tensor_store.get(object_id, tensor_buffer))
+            continue;
         const float similarity = forest_index.similarity_fn(query_tensor, tensor_buffer);
         stack.emplace_back(object_id, similarity);
     }
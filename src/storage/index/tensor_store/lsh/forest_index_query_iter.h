@@ -1,40 +1,41 @@
 #include <cstdint>
-
+#include <memory>
 #include <vector>
 
+#include "storage/index/tensor_store/lsh/forest_index.h"
+#include "storage/index/tensor_store/tensor_query_iter.h"
 #include "third_party/robin_hood/robin_hood.h"
 
 namespace LSH {
-class ForestIndex;
 class TreeNode;
 /*
  * TODO: Description
  */
-class ForestIndexQueryIter {
+class ForestIndexQueryIter : public TensorQueryIter {
 public:
-    // Current value
-    std::pair<uint64_t, float>* current;
-
     ForestIndexQueryIter(const std::vector<float>& query_tensor, const ForestIndex& forest_index);
 
-    // Initialize the iterator
-    void begin();
+    void begin() override;
 
-    // Returns true if a new element exists and was set into current, false otherwise
-    bool next();
+    bool next() override;
 
-    // Reset the iterator
-    void reset();
+    void reset() override;
 
 private:
     const std::vector<float> query_tensor;
     const ForestIndex&       forest_index;
 
+    // The trees are kept even if a compaction replaces them while iterating
+    std::shared_ptr<ForestIndex::Trees> trees;
+
     // Current state of each tree
     uint_fast32_t              current_maximum_depth;
     std::vector<TreeNode*>     nodes;
     std::vector<uint_fast32_t> depths;
 
+    // Version of each tree when its node was obtained, insertions may split the trees between calls to next()
+    std::vector<uint64_t> versions;
+
     // Buckets of object ids for each tree
     std::vector<robin_hood::unordered_flat_set<uint64_t>> buckets;
 
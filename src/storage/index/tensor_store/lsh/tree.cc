@@ -1,5 +1,6 @@
 #include "tree.h"
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <numeric>
@@ -67,21 +68,31 @@ std::vector<uint64_t> Tree::descendants(TreeNode* node) {
 }
 
 
-void Tree::build() {
+void Tree::build(const std::vector<uint64_t>& object_ids) {
     if (root != nullptr)
         throw std::runtime_error("Unexpected Tree::build() call: Tree is already built!");
 
-    // Fill the initial node with all the objects in the tensor store
-    std::vector<uint64_t> object_ids;
-    for (auto&& [object_id, _] : tensor_store.object_id2tensor_offset)
-        object_ids.emplace_back(object_id);
-    auto tmp = new LeafNode(nullptr, std::move(object_ids));
-
-    // Bind the root
+    // Fill the initial node with all the objects and bind the root
+    auto tmp = new LeafNode(nullptr, std::vector<uint64_t>(object_ids));
     root = tmp;
 
     // Create splits while possible
-    std::vector<std::pair<LeafNode*, uint_fast32_t>> node_depth_stack = { { tmp, 0 } };
+    split(tmp, 0);
+}
+
+
+void Tree::insert(uint64_t object_id, const std::vector<float>& tensor) {
+    auto [leaf, depth] = descend(tensor);
+    if (std::find(leaf->object_ids.begin(), leaf->object_ids.end(), object_id) != leaf->object_ids.end())
+        return;
+
+    leaf->object_ids.push_back(object_id);
+    split(leaf, depth);
+}
+
+
+void Tree::split(LeafNode* leaf_node, uint_fast32_t depth) {
+    std::vector<std::pair<LeafNode*, uint_fast32_t>> node_depth_stack = { { leaf_node, depth } };
     while (node_depth_stack.size() > 0) {
         auto [current_node, current_depth] = node_depth_stack.back();
         node_depth_stack.pop_back();
@@ -108,6 +119,17 @@ std::pair<LeafNode*, uint64_t> Tree::descend(const std::vector<float>& query_ten
 }
 
 
+TreeNode* Tree::descend(const std::vector<float>& query_tensor, uint64_t depth) const {
+    assert(query_tensor.size() == tensors_dim);
+    TreeNode* current_node = root;
+    for (uint64_t current_depth = 0; current_depth < depth; ++current_depth) {
+        assert(current_node->type() != TreeNodeType::LEAF);
+        current_node = current_node->children[current_node->side(query_tensor)];
+    }
+    return current_node;
+}
+
+
 void Tree::serialize(std::fstream& fs) const {
     // Serialize sizes
     Serialization::write_uint64(fs, tensors_dim);
@@ -189,6 +211,8 @@ void Tree::deserialize(std::fstream& fs) {
 
 
 std::pair<LeafNode*, LeafNode*> Tree::create_split(LeafNode* leaf_node) {
+    ++version;
+
     // Create the new split node
     TreeNode* new_parent;
     switch (metric_type) {
@@ -208,7 +232,8 @@ std::pair<LeafNode*, LeafNode*> Tree::create_split(LeafNode* leaf_node) {
     std::vector<uint64_t> left_object_ids;
     std::vector<uint64_t> right_object_ids;
     for (auto& object_id : leaf_node->object_ids) {
-        tensor_store.get(object_id, tensor_buffer);
+        if (!tensor_store.get(object_id, tensor_buffer))
+            continue;
         if (new_parent->side(tensor_buffer))
             right_object_ids.emplace_back(object_id);
         else
@@ -244,21 +269,38 @@ std::pair<LeafNode*, LeafNode*> Tree::create_split(LeafNode* leaf_node) {
 
 std::pair<std::vector<float>, float> Tree::generate_plane(const std::vector<uint64_t>& object_ids) {
     assert(object_ids.size() > 1);
-    uint64_t centroid_index_a = get_uniform_uint64(0, object_ids.size() - 1);
-    uint64_t centroid_index_b = get_uniform_uint64(0, object_ids.size() - 2);
-    centroid_index_b += (centroid_index_b >= centroid_index_a); // prevents centroid_a == centroid_b
-
     std::vector<float> centroid_a(tensor_store.tensors_dim);
     std::vector<float> centroid_b(tensor_store.tensors_dim);
-    tensor_store.get(object_ids[centroid_index_a], centroid_a);
-    tensor_store.get(object_ids[centroid_index_b], centroid_b);
+
+    // Removed objects are still in the leaves until the next compaction, so the centroids are the first objects that
+    // exist starting from random positions
+    const auto num_objects = object_ids.size();
+    uint64_t centroid_index_a = get_uniform_uint64(0, num_objects - 1);
+    uint64_t checked = 0;
+    while (checked < num_objects && !tensor_store.get(object_ids[centroid_index_a], centroid_a)) {
+        centroid_index_a = (centroid_index_a + 1) % num_objects;
+        ++checked;
+    }
+    uint64_t centroid_index_b = get_uniform_uint64(0, num_objects - 1);
+    checked = 0;
+    while (checked < num_objects
+           && (centroid_index_b == centroid_index_a || !tensor_store.get(object_ids[centroid_index_b], centroid_b)))
+    {
+        centroid_index_b = (centroid_index_b + 1) % num_objects;
+        ++checked;
+    }
+    if (checked == num_objects) {
+        // Less than two objects exist, any plane leaves them in the same child
+        return std::make_pair(std::vector<float>(tensors_dim, 0.0f), 0.0f);
+    }
 
     uint64_t num_points_a = 1;
     uint64_t num_points_b = 1;
 
     for (uint_fast32_t epochs = 0; epochs < GENERATE_PLANE_EPOCHS; ++epochs) {
         uint64_t k        = get_uniform_uint64(0, object_ids.size() - 1);
-        tensor_store.get(object_ids[k], tensor_buffer);
+        if (!tensor_store.get(object_ids[k], tensor_buffer))
+            continue;
 
         float similarity_ak = similarity_fn(centroid_a, tensor_buffer);
         float similarity_bk = similarity_fn(centroid_b, tensor_buffer);
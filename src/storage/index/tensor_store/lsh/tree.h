@@ -51,12 +51,23 @@ public:
 
     ~Tree();
 
-    // Build the tree for the TensorStore
-    void build();
+    // Build the tree with the given objects of the TensorStore
+    void build(const std::vector<uint64_t>& object_ids);
+
+    // Add an object to the leaf of its tensor, splitting the leaf if it becomes too big. Objects already in the tree
+    // (e.g. an updated tensor) are not removed from their previous leaf
+    void insert(uint64_t object_id, const std::vector<float>& tensor);
 
     // Get the leaf with the longest prefix match and its depth for the hashed query tensor
     std::pair<LeafNode*, uint64_t> descend(const std::vector<float>& query_tensor) const;
 
+    // Get the node at the given depth in the path of the hashed query tensor, the leaf can't be shallower
+    TreeNode* descend(const std::vector<float>& query_tensor, uint64_t depth) const;
+
+    // Incremented by every split. A split reuses the leaf as a child one level deeper, so the nodes obtained
+    // before it may no longer be at the depth they were
+    uint64_t get_version() const { return version; }
+
     // Serialize the tree into a filestream
     void serialize(std::fstream& fs) const;
 
@@ -71,10 +82,16 @@ private:
 
     TreeNode* root;
 
+    uint64_t version = 0;
+
     // Used to prevent multiple allocations
     std::vector<float> tensor_buffer;
 
-    // Split the leaf node into two children. Return a reference to each one ({ left, right })
+    // Split the leaf node and its descendants until they are small enough or reach max_depth
+    void split(LeafNode* leaf_node, uint_fast32_t depth);
+
+    // Split the leaf node into two children. Return a reference to each one ({ left, right }). Objects that no longer
+    // exist in the tensor store are dropped
     std::pair<LeafNode*, LeafNode*> create_split(LeafNode* leaf_node);
 
     // Returns the best plane for the split. It returns its normal and offset
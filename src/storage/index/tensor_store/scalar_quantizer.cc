@@ -0,0 +1,273 @@
+#include "scalar_quantizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#if defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__))
+#include <immintrin.h>
+#endif
+
+#include "storage/index/tensor_store/lsh/metric.h"
+#include "storage/index/tensor_store/serialization.h"
+#include "storage/index/tensor_store/tensor_store.h"
+
+using namespace LSH;
+
+namespace {
+// Each kernel decodes the codes (min + code * scale) and computes the metric against the float query, the vectorized
+// loop processes 16 (AVX-512) or 8 (AVX2) dimensions per iteration and the remaining ones are processed one by one.
+
+#if defined(__AVX512F__)
+inline __m512 decode(const uint8_t* codes, const float* min, const float* scale) {
+    auto c = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(codes))));
+    return _mm512_fmadd_ps(c, _mm512_loadu_ps(scale), _mm512_loadu_ps(min));
+}
+constexpr uint64_t LANES = 16;
+#elif defined(__AVX2__) && defined(__FMA__)
+inline __m256 decode(const uint8_t* codes, const float* min, const float* scale) {
+    auto c = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(codes))));
+    return _mm256_fmadd_ps(c, _mm256_loadu_ps(scale), _mm256_loadu_ps(min));
+}
+
+inline float reduce_add(__m256 v) {
+    auto res = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    res = _mm_hadd_ps(res, res);
+    res = _mm_hadd_ps(res, res);
+    return _mm_cvtss_f32(res);
+}
+constexpr uint64_t LANES = 8;
+#endif
+
+
+float euclidean_distance(const float* query, const uint8_t* codes, const float* min, const float* scale, uint64_t dim) {
+    uint64_t i   = 0;
+    float    res = 0.0f;
+#if defined(__AVX512F__)
+    auto acc = _mm512_setzero_ps();
+    for (; i + LANES <= dim; i += LANES) {
+        auto diff = _mm512_sub_ps(_mm512_loadu_ps(query + i), decode(codes + i, min + i, scale + i));
+        acc = _mm512_fmadd_ps(diff, diff, acc);
+    }
+    res = _mm512_reduce_add_ps(acc);
+#elif defined(__AVX2__) && defined(__FMA__)
+    auto acc = _mm256_setzero_ps();
+    for (; i + LANES <= dim; i += LANES) {
+        auto diff = _mm256_sub_ps(_mm256_loadu_ps(query + i), decode(codes + i, min + i, scale + i));
+        acc = _mm256_fmadd_ps(diff, diff, acc);
+    }
+    res = reduce_add(acc);
+#endif
+    for (; i < dim; ++i) {
+        auto const diff = query[i] - (min[i] + codes[i] * scale[i]);
+        res += diff * diff;
+    }
+    return std::sqrt(res);
+}
+
+
+float manhattan_distance(const float* query, const uint8_t* codes, const float* min, const float* scale, uint64_t dim) {
+    uint64_t i   = 0;
+    float    res = 0.0f;
+#if defined(__AVX512F__)
+    auto acc = _mm512_setzero_ps();
+    for (; i + LANES <= dim; i += LANES) {
+        auto diff = _mm512_sub_ps(_mm512_loadu_ps(query + i), decode(codes + i, min + i, scale + i));
+        acc = _mm512_add_ps(acc, _mm512_abs_ps(diff));
+    }
+    res = _mm512_reduce_add_ps(acc);
+#elif defined(__AVX2__) && defined(__FMA__)
+    const auto sign_mask = _mm256_set1_ps(-0.0f);
+    auto acc = _mm256_setzero_ps();
+    for (; i + LANES <= dim; i += LANES) {
+        auto diff = _mm256_sub_ps(_mm256_loadu_ps(query + i), decode(codes + i, min + i, scale + i));
+        acc = _mm256_add_ps(acc, _mm256_andnot_ps(sign_mask, diff));
+    }
+    res = reduce_add(acc);
+#endif
+    for (; i < dim; ++i) {
+        res += std::abs(query[i] - (min[i] + codes[i] * scale[i]));
+    }
+    return res;
+}
+
+
+float cosine_distance(const float* query, const uint8_t* codes, const float* min, const float* scale, uint64_t dim) {
+    uint64_t i  = 0;
+    float    aa = 0.0f;
+    float    bb = 0.0f;
+    float    ab = 0.0f;
+#if defined(__AVX512F__)
+    auto aa_acc = _mm512_setzero_ps();
+    auto bb_acc = _mm512_setzero_ps();
+    auto ab_acc = _mm512_setzero_ps();
+    for (; i + LANES <= dim; i += LANES) {
+        auto a = _mm512_loadu_ps(query + i);
+        auto b = decode(codes + i, min + i, scale + i);
+        aa_acc = _mm512_fmadd_ps(a, a, aa_acc);
+        bb_acc = _mm512_fmadd_ps(b, b, bb_acc);
+        ab_acc = _mm512_fmadd_ps(a, b, ab_acc);
+    }
+    aa = _mm512_reduce_add_ps(aa_acc);
+    bb = _mm512_reduce_add_ps(bb_acc);
+    ab = _mm512_reduce_add_ps(ab_acc);
+#elif defined(__AVX2__) && defined(__FMA__)
+    auto aa_acc = _mm256_setzero_ps();
+    auto bb_acc = _mm256_setzero_ps();
+    auto ab_acc = _mm256_setzero_ps();
+    for (; i + LANES <= dim; i += LANES) {
+        auto a = _mm256_loadu_ps(query + i);
+        auto b = decode(codes + i, min + i, scale + i);
+        aa_acc = _mm256_fmadd_ps(a, a, aa_acc);
+        bb_acc = _mm256_fmadd_ps(b, b, bb_acc);
+        ab_acc = _mm256_fmadd_ps(a, b, ab_acc);
+    }
+    aa = reduce_add(aa_acc);
+    bb = reduce_add(bb_acc);
+    ab = reduce_add(ab_acc);
+#endif
+    for (; i < dim; ++i) {
+        auto const b = min[i] + codes[i] * scale[i];
+        aa += query[i] * query[i];
+        bb += b * b;
+        ab += query[i] * b;
+    }
+    // Same as Metric::cosine_distance
+    auto const denominator = std::sqrt(aa * bb);
+    if (denominator > 0.0f)
+        return std::min(std::max(1.0f - ab / denominator, 0.0f), 1.0f);
+    return 1.0f;
+}
+} // namespace
+
+
+ScalarQuantizer::ScalarQuantizer(const TensorStore& tensor_store_) :
+    tensor_store (tensor_store_)
+{
+    build();
+}
+
+
+ScalarQuantizer::ScalarQuantizer(const std::string& path, const TensorStore& tensor_store_) :
+    tensor_store (tensor_store_)
+{
+    deserialize(path);
+}
+
+
+void ScalarQuantizer::build() {
+    const auto dim = tensor_store.tensors_dim;
+
+    std::vector<float> max(dim, std::numeric_limits<float>::lowest());
+    min.assign(dim, std::numeric_limits<float>::max());
+
+    // First pass: range of each dimension
+    std::vector<float> tensor_buffer(dim);
+    for (auto&& [object_id, _] : tensor_store.object_id2tensor_offset) {
+        tensor_store.get(object_id, tensor_buffer);
+        for (uint64_t i = 0; i < dim; ++i) {
+            min[i] = std::min(min[i], tensor_buffer[i]);
+            max[i] = std::max(max[i], tensor_buffer[i]);
+        }
+    }
+
+    scale.resize(dim);
+    for (uint64_t i = 0; i < dim; ++i)
+        scale[i] = (max[i] - min[i]) / 255.0f;
+
+    // Second pass: encode each tensor in its slot. After removals the slots have holes, so there can be more slots
+    // than tensors
+    const auto slot_count = tensor_store.tensors_end / (dim * sizeof(float));
+    codes.assign(slot_count * dim, 0);
+    for (auto&& [object_id, _] : tensor_store.object_id2tensor_offset) {
+        tensor_store.get(object_id, tensor_buffer);
+        auto tensor_codes = &codes[tensor_store.get_slot(object_id) * dim];
+        for (uint64_t i = 0; i < dim; ++i) {
+            if (scale[i] > 0.0f) {
+                auto code = std::round((tensor_buffer[i] - min[i]) / scale[i]);
+                tensor_codes[i] = static_cast<uint8_t>(std::min(std::max(code, 0.0f), 255.0f));
+            }
+        }
+    }
+}
+
+
+const uint8_t* ScalarQuantizer::get_codes(uint64_t object_id) const {
+    auto it = tensor_store.object_id2tensor_offset.find(object_id);
+    if (it == tensor_store.object_id2tensor_offset.end())
+        return nullptr;
+
+    const auto slot = it->second / (tensor_store.tensors_dim * sizeof(float));
+    assert((slot + 1) * tensor_store.tensors_dim <= codes.size());
+    return get_slot_codes(slot);
+}
+
+
+float ScalarQuantizer::distance(MetricType                metric_type,
+                                const std::vector<float>& query_tensor,
+                                const uint8_t*            tensor_codes) const
+{
+    assert(query_tensor.size() == tensor_store.tensors_dim);
+    assert(tensor_codes != nullptr);
+
+    switch (metric_type) {
+    case MetricType::ANGULAR:
+        return cosine_distance(query_tensor.data(), tensor_codes, min.data(), scale.data(), min.size());
+    case MetricType::EUCLIDEAN:
+        return euclidean_distance(query_tensor.data(), tensor_codes, min.data(), scale.data(), min.size());
+    default: // MetricType::MANHATTAN
+        return manhattan_distance(query_tensor.data(), tensor_codes, min.data(), scale.data(), min.size());
+    }
+}
+
+
+void ScalarQuantizer::rerank(const std::vector<float>&                query_tensor,
+                             std::vector<std::pair<uint64_t, float>>& candidates,
+                             uint64_t                                 k,
+                             float (*similarity_fn)(const std::vector<float>&, const std::vector<float>&)) const
+{
+    auto by_distance = [](const std::pair<uint64_t, float>& lhs, const std::pair<uint64_t, float>& rhs) {
+        return lhs.second < rhs.second;
+    };
+
+    auto rerank_size = std::min(k * RERANK_FACTOR, static_cast<uint64_t>(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + rerank_size, candidates.end(), by_distance);
+    candidates.resize(rerank_size);
+
+    std::vector<float> tensor_buffer(tensor_store.tensors_dim);
+    for (auto& [object_id, distance] : candidates) {
+        tensor_store.get(object_id, tensor_buffer);
+        distance = similarity_fn(query_tensor, tensor_buffer);
+    }
+
+    auto result_size = std::min(k, rerank_size);
+    std::partial_sort(candidates.begin(), candidates.begin() + result_size, candidates.end(), by_distance);
+    candidates.resize(result_size);
+}
+
+
+void ScalarQuantizer::serialize(const std::string& path) const {
+    std::fstream ofs(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    Serialization::write_uint64(ofs, min.size());
+    Serialization::write_uint64(ofs, codes.size());
+    Serialization::write_float_vec(ofs, min);
+    Serialization::write_float_vec(ofs, scale);
+    Serialization::write_uint8_vec(ofs, codes);
+    assert(ofs.good());
+    ofs.close();
+}
+
+
+void ScalarQuantizer::deserialize(const std::string& path) {
+    std::fstream ifs(path, std::ios::in | std::ios::binary);
+    auto dim        = Serialization::read_uint64(ifs);
+    auto codes_size = Serialization::read_uint64(ifs);
+    min   = Serialization::read_float_vec(ifs, dim);
+    scale = Serialization::read_float_vec(ifs, dim);
+    codes = Serialization::read_uint8_vec(ifs, codes_size);
+    assert(dim == tensor_store.tensors_dim);
+    assert(ifs.good());
+    ifs.close();
+}
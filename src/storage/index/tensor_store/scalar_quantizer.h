@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class TensorStore;
+
+namespace LSH {
+enum class MetricType;
+} // namespace LSH
+
+/*
+ * ScalarQuantizer keeps an in-memory int8 copy of every tensor of a TensorStore, using a quarter of the space of the
+ * float32 tensors. Each dimension is quantized independently with its own range:
+ *
+ *     value ~= min[dim] + code * scale[dim]
+ *
+ * The vector indexes use it to compute approximate distances for their candidates (with explicit AVX-512/AVX2
+ * kernels when available) and then re-rank only the best candidates with the float32 tensors.
+ *
+ * The codes of a tensor are stored in the same slot that the tensor has in the .tensors file, so the codes of an
+ * object are found through the TensorStore mapping.
+ */
+class ScalarQuantizer {
+public:
+    // How many candidates per requested result are re-ranked with the float32 tensors
+    static constexpr uint64_t RERANK_FACTOR = 4;
+
+    // Quantize every tensor of the store
+    explicit ScalarQuantizer(const TensorStore& tensor_store);
+
+    // Load existing codes from a file
+    ScalarQuantizer(const std::string& path, const TensorStore& tensor_store);
+
+    // Return the codes of the tensor of the given object, nullptr if it does not exist
+    const uint8_t* get_codes(uint64_t object_id) const;
+
+    // Return the codes of the tensor stored in the given slot of the .tensors file
+    const uint8_t* get_slot_codes(uint64_t slot) const {
+        return &codes[slot * min.size()];
+    }
+
+    // Approximate distance between query_tensor and a quantized tensor
+    float distance(LSH::MetricType metric_type, const std::vector<float>& query_tensor, const uint8_t* codes) const;
+
+    // Receives candidates (object_id, approximate distance), keeps the best k * RERANK_FACTOR, computes their exact
+    // distance with the float32 tensors and leaves the best k ordered by distance
+    void rerank(const std::vector<float>&                query_tensor,
+                std::vector<std::pair<uint64_t, float>>& candidates,
+                uint64_t                                 k,
+                float (*similarity_fn)(const std::vector<float>&, const std::vector<float>&)) const;
+
+    uint64_t size_in_bytes() const { return codes.size(); }
+
+    void serialize(const std::string& path) const;
+
+private:
+    const TensorStore& tensor_store;
+
+    std::vector<float> min;
+    std::vector<float> scale;
+
+    // tensors_dim codes for each slot of the .tensors file
+    std::vector<uint8_t> codes;
+
+    void build();
+
+    void deserialize(const std::string& path);
+};
@@ -36,6 +36,11 @@ void Serialization::write_float_vec(std::fstream& fs, const std::vector<float>&
 }
 
 
+void Serialization::write_uint32_vec(std::fstream& fs, const std::vector<uint32_t>& vec) {
+    fs.write(reinterpret_cast<const char*>(vec.data()), sizeof(uint32_t) * vec.size());
+}
+
+
 void Serialization::write_uint64_vec(std::fstream& fs, const std::vector<uint64_t>& vec) {
     fs.write(reinterpret_cast<const char*>(vec.data()), sizeof(uint64_t) * vec.size());
 }
@@ -101,6 +106,13 @@ std::vector<float> Serialization::read_float_vec(std::fstream& fs, uint64_t size
 }
 
 
+std::vector<uint32_t> Serialization::read_uint32_vec(std::fstream& fs, uint64_t size) {
+    std::vector<uint32_t> res(size);
+    fs.read(reinterpret_cast<char*>(res.data()), sizeof(uint32_t) * size);
+    return res;
+}
+
+
 std::vector<uint64_t> Serialization::read_uint64_vec(std::fstream& fs, uint64_t size) {
     std::vector<uint64_t> res(size);
     fs.read(reinterpret_cast<char*>(res.data()), sizeof(uint64_t) * size);
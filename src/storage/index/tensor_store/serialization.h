@@ -14,6 +14,7 @@ public:
     static void write_string(std::fstream& fs, const std::string& value);
     static void write_uint8_vec(std::fstream& fs, const std::vector<uint8_t>& vec);
     static void write_float_vec(std::fstream& fs, const std::vector<float>& vec);
+    static void write_uint32_vec(std::fstream& fs, const std::vector<uint32_t>& vec);
     static void write_uint64_vec(std::fstream& fs, const std::vector<uint64_t>& vec);
     static void write_uint642uint64_unordered_map(std::fstream& fs, const std::unordered_map<uint64_t, uint64_t>& map);
 
@@ -24,6 +25,7 @@ public:
     static std::string                            read_string(std::fstream& fs);
     static std::vector<uint8_t>                   read_uint8_vec(std::fstream& fs, uint64_t size);
     static std::vector<float>                     read_float_vec(std::fstream& fs, uint64_t size);
+    static std::vector<uint32_t>                  read_uint32_vec(std::fstream& fs, uint64_t size);
     static std::vector<uint64_t>                  read_uint64_vec(std::fstream& fs, uint64_t size);
     static std::unordered_map<uint64_t, uint64_t> read_uint642uint64_unordered_map(std::fstream& fs, uint64_t size);
 };
@@ -4,6 +4,7 @@
 
 #include "macros/aligned_alloc.h"
 #include "misc/fatal_error.h"
+#include "misc/metrics.h"
 #include "storage/file_manager.h"
 
 using namespace std;
@@ -91,17 +92,22 @@ TensorPage& TensorBufferManager::get_tensor_page_available() {
 TensorPage& TensorBufferManager::get_page(uint_fast32_t page_number) noexcept {
     const PageId page_id(file_id, page_number);
 
+    std::lock_guard<std::mutex> lock(pages_mutex);
     auto it = pages_map.find(page_id);
 
     if (it == pages_map.end()) {
+        metrics.tensor_pool.misses.fetch_add(1, std::memory_order_relaxed);
+
         auto& page = get_tensor_page_available();
 
         if (page.page_id.file_id.id != FileId::UNASSIGNED) {
             pages_map.erase(page.page_id);
+            metrics.tensor_pool.evictions.fetch_add(1, std::memory_order_relaxed);
         }
 
         if (page.dirty) {
             file_manager.flush(page);
+            metrics.tensor_pool.dirty_flushes.fetch_add(1, std::memory_order_relaxed);
         }
         page.reassign(page_id);
 
@@ -110,6 +116,7 @@ TensorPage& TensorBufferManager::get_page(uint_fast32_t page_number) noexcept {
 
         return page;
     } else { // page is the buffer
+        metrics.tensor_pool.hits.fetch_add(1, std::memory_order_relaxed);
         TensorPage* page = it->second;
         page->pin();
         return *it->second;
@@ -118,6 +125,7 @@ TensorPage& TensorBufferManager::get_page(uint_fast32_t page_number) noexcept {
 
 
 TensorPage& TensorBufferManager::append_page() {
+    std::lock_guard<std::mutex> lock(pages_mutex);
     auto& new_page    = get_tensor_page_available();
     auto  page_number = file_manager.append_page(file_id, new_page.get_bytes());
     PageId page_id(file_id, page_number);
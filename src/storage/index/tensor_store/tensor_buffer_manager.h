@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 #include "storage/file_id.h"
 #include "tensor_page.h"
 #include "third_party/robin_hood/robin_hood.h"
@@ -10,7 +12,9 @@
  *
  * Unlike the global buffer_manager, this class manages a single TensorStore per instance.
  *
- * NOTE: We do not need a mutex because we do not support insertions during the server execution
+ * Getting and appending pages is protected by a mutex, so the pages can be read by many threads (e.g. the trees of
+ * a forest index are built in parallel). Loaded tensor stores are read through a mapping of the tensors file and only
+ * use a TensorBufferManager when they are modified.
  */
 class TensorBufferManager {
 public:
@@ -72,6 +76,9 @@ private:
     // Used to search the index in the `buffer_pool` of a certain page
     robin_hood::unordered_map<PageId, TensorPage*> pages_map;
 
+    // Protects pages_map, clock_pos and the assignment of the pages
+    std::mutex pages_mutex;
+
     // Returns an unpinned page from the tensor_page_pool
     TensorPage& get_tensor_page_available();
 };
@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "storage/page/page_id.h"
+#include "storage/page/page_size.h"
 
 /* TensorPage is an adaptation of the regular Page class from src/storage/page.h, specifically for handling tensor files
  * and interact with the TensorBufferManager
@@ -13,7 +14,7 @@ class TensorPage {
     friend class FileManager;
 
 public:
-    static constexpr size_t SIZE = 4096;
+    static constexpr size_t SIZE = DATABASE_PAGE_SIZE;
 
     // contains file_id and page_number of this page
     PageId page_id;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+/*
+ * TensorQueryIter is the interface for iterating over all the object_ids of a TensorStore vector index, ordered
+ * (exactly or approximately, depending on the index) by their similarity to a query tensor
+ */
+class TensorQueryIter {
+public:
+    // Current value
+    std::pair<uint64_t, float>* current;
+
+    virtual ~TensorQueryIter() = default;
+
+    // Initialize the iterator
+    virtual void begin() = 0;
+
+    // Returns true if a new element exists and was set into current, false otherwise
+    virtual bool next() = 0;
+
+    // Reset the iterator
+    virtual void reset() = 0;
+};
@@ -1,16 +1,25 @@
 #include "tensor_store.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "query/exceptions.h"
 #include "storage/file_manager.h"
 #include "storage/filesystem.h"
+#include "storage/index/tensor_store/hnsw/hnsw_index.h"
+#include "storage/index/tensor_store/hnsw/hnsw_query_iter.h"
 #include "storage/index/tensor_store/lsh/forest_index.h"
 #include "storage/index/tensor_store/lsh/forest_index_query_iter.h"
+#include "storage/index/tensor_store/lsh/metric.h"
 #include "storage/index/tensor_store/lsh/tree.h"
+#include "storage/index/tensor_store/scalar_quantizer.h"
 #include "storage/index/tensor_store/serialization.h"
 #include "storage/index/tensor_store/tensor_buffer_manager.h"
 
@@ -19,7 +28,9 @@ TensorStore::TensorStore(const std::string& name_, uint64_t tensors_dim_, uint64
     tensors_dim(tensors_dim_),
     tensors_file_id(FileId::UNASSIGNED),
     mapping_path(file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".mapping")),
-    index_path(file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".index")) {
+    index_path(file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".index")),
+    hnsw_path(file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".hnsw")),
+    quantized_path(file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".sq8")) {
     if (tensors_dim < 1)
         throw std::invalid_argument("Tensor dimension must be at least 1");
 
@@ -46,29 +57,36 @@ TensorStore::TensorStore(const std::string& name_, uint64_t tensors_dim_, uint64
 }
 
 
-TensorStore::TensorStore(const std::string& name_, uint64_t tensor_buffer_page_size_in_bytes, bool preload) :
+TensorStore::TensorStore(const std::string& name_, uint64_t, bool preload) :
     name(name_),
     tensors_file_id (FileId::UNASSIGNED),
     mapping_path    (file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".mapping")),
-    index_path      (file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".index")) {
+    index_path      (file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".index")),
+    hnsw_path       (file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".hnsw")),
+    quantized_path  (file_manager.get_file_path(TENSOR_STORES_DIR + "/" + name_ + ".sq8")) {
     if (!exists(name))
         throw std::invalid_argument("Tensor store " + name + " does not exist");
 
     // Load tensors file
     tensors_file_id = file_manager.get_file_id(TENSOR_STORES_DIR + "/" + name + ".tensors");
 
-    // Load object_id2tensor_offset and forest_index (if it exists) from disk
+    // Load object_id2tensor_offset and the indexes (if they exist) from disk
     deserialize();
     assert(tensors_dim > 0);
 
-    set_tensor_buffer_manager(tensor_buffer_page_size_in_bytes, preload);
+    // The tensors are read from the mapping and modifications are written to the file, without a buffer manager
+    map_tensors(preload);
 }
 
 
 TensorStore::~TensorStore() {
-    // Save object_id2tensor_offset and forest_index to disk
-    // Disabled because no updates will occur during server execution
-    // serialize();
+    // Save the modifications done while the server was running
+    if (modified)
+        serialize();
+
+    // The compaction of the forest index may be reading the tensors
+    forest_index.reset();
+    unmap_tensors();
 }
 
 
@@ -82,16 +100,24 @@ bool TensorStore::exists(const std::string& name) {
 
 
 bool TensorStore::contains(uint64_t object_id) const {
+    std::shared_lock lock(mapping_mutex);
     return object_id2tensor_offset.find(object_id) != object_id2tensor_offset.end();
 }
 
 
 bool TensorStore::get(uint64_t object_id, std::vector<float>& vec) const {
     assert(vec.size() == tensors_dim && "Vector size must match tensor dimension");
+    std::shared_lock lock(mapping_mutex);
     auto it = object_id2tensor_offset.find(object_id);
     if (it == object_id2tensor_offset.end())
         return false;
 
+    if (tensor_buffer_manager == nullptr) {
+        assert(it->second + sizeof(float) * vec.size() <= tensors_data_size);
+        std::memcpy(vec.data(), tensors_data + it->second, sizeof(float) * vec.size());
+        return true;
+    }
+
     auto vec_bytes      = reinterpret_cast<char*>(vec.data());
     auto vec_bytes_size = vec.size() * sizeof(float);
 
@@ -105,7 +131,7 @@ bool TensorStore::get(uint64_t object_id, std::vector<float>& vec) const {
     while (remaining > 0) {
         size_t max_read   = (TensorPage::SIZE - page_offset);
         char* current_ptr = current_page->get_bytes() + page_offset;
-        if (remaining < max_read) {
+        if (remaining <= max_read) {
             // All the remaining bytes are in the current page
             std::memcpy(&vec_bytes[vec_bytes_size - remaining], current_ptr, remaining);
             tensor_buffer_manager->unpin(*current_page);
@@ -116,6 +142,7 @@ bool TensorStore::get(uint64_t object_id, std::vector<float>& vec) const {
             tensor_buffer_manager->unpin(*current_page);
             remaining -= max_read;
             ++page_number;
+            page_offset  = 0;
             current_page = &tensor_buffer_manager->get_page(page_number);
         }
     }
@@ -124,33 +151,119 @@ bool TensorStore::get(uint64_t object_id, std::vector<float>& vec) const {
 }
 
 
+const float* TensorStore::get_data(uint64_t object_id, std::vector<float>& buffer) const {
+    if (tensor_buffer_manager == nullptr) {
+        std::shared_lock lock(mapping_mutex);
+        auto it = object_id2tensor_offset.find(object_id);
+        if (it == object_id2tensor_offset.end())
+            return nullptr;
+        assert(it->second + sizeof(float) * tensors_dim <= tensors_data_size);
+        return reinterpret_cast<const float*>(tensors_data + it->second);
+    }
+    return get(object_id, buffer) ? buffer.data() : nullptr;
+}
+
+
+uint64_t TensorStore::get_slot(uint64_t object_id) const {
+    assert(contains(object_id));
+    std::shared_lock lock(mapping_mutex);
+    return object_id2tensor_offset.at(object_id) / (sizeof(float) * tensors_dim);
+}
+
+
 void TensorStore::insert(uint64_t object_id, const std::vector<float>& tensor) {
     assert(tensor.size() == tensors_dim);
-    uint64_t tensor_offset;
-    auto     it = object_id2tensor_offset.find(object_id);
-    if (it != object_id2tensor_offset.end()) {
-        // Replace an existing tensor
-        tensor_offset = it->second;
-    } else {
-        // Insert a new tensor
-        tensor_offset = object_id2tensor_offset.size() * sizeof(float) * tensors_dim;
-        object_id2tensor_offset.insert({ object_id, tensor_offset });
+    check_modifiable();
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+
+    // The tensor is written before it is visible in the mapping, so readers never see it incomplete
+    const auto tensor_offset = tensors_end;
+    write_tensor(tensor_offset, tensor);
+
+    bool replaced;
+    {
+        std::unique_lock lock(mapping_mutex);
+        replaced = !object_id2tensor_offset.insert_or_assign(object_id, tensor_offset).second;
+        tensors_end += sizeof(float) * tensors_dim;
+        modified = true;
+    }
+
+    if (forest_index != nullptr) {
+        if (replaced)
+            forest_index->remove(object_id);
+        forest_index->insert(object_id, tensor);
     }
+}
+
+
+bool TensorStore::remove(uint64_t object_id) {
+    check_modifiable();
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+    {
+        std::unique_lock lock(mapping_mutex);
+        if (object_id2tensor_offset.erase(object_id) == 0)
+            return false;
+        modified = true;
+    }
+
+    if (forest_index != nullptr)
+        forest_index->remove(object_id);
+    return true;
+}
+
+
+void TensorStore::check_modifiable() const {
+    // The HNSW graph and the quantized codes are built only once with all the tensors
+    if (hnsw_index != nullptr || quantizer != nullptr) {
+        throw LogicException("Tensor store \"" + name + "\" can't be modified because it has an HNSW index or "
+                             "quantized tensors");
+    }
+}
 
+
+void TensorStore::write_tensor(uint64_t tensor_offset, const std::vector<float>& tensor) {
     auto vec_bytes      = reinterpret_cast<const char*>(tensor.data());
     auto vec_bytes_size = tensor.size() * sizeof(float);
 
+    if (tensor_buffer_manager == nullptr) {
+        const auto tensor_end = tensor_offset + vec_bytes_size;
+        if (tensor_end > tensors_file_size) {
+            // Keep the file size a multiple of the page size, as the buffer manager expects
+            const auto new_file_size = (tensor_end + TensorPage::SIZE - 1) / TensorPage::SIZE * TensorPage::SIZE;
+            if (ftruncate(tensors_file_id.id, new_file_size) != 0)
+                throw std::runtime_error("Could not resize the tensors file of \"" + name + "\"");
+            tensors_file_size = new_file_size;
+        }
+        if (tensor_end > tensors_data_size) {
+            std::unique_lock lock(mapping_mutex);
+            remap_tensors(tensor_end);
+        }
+
+        // The mapping is shared, so it sees the written bytes
+        size_t written = 0;
+        while (written < vec_bytes_size) {
+            auto res = pwrite(tensors_file_id.id,
+                              vec_bytes + written,
+                              vec_bytes_size - written,
+                              tensor_offset + written);
+            if (res < 0)
+                throw std::runtime_error("Could not write the tensors file of \"" + name + "\"");
+            written += res;
+        }
+        return;
+    }
+
     // Start from the corresponding page and offset
     auto page_number         = tensor_offset / TensorPage::SIZE;
     auto page_offset         = tensor_offset % TensorPage::SIZE;
     TensorPage* current_page = &tensor_buffer_manager->get_or_append_page(page_number);
 
     // Write the tensor directly from the vector bytes
-    size_t remaining = sizeof(float) * tensor.size();
+    size_t remaining = vec_bytes_size;
     while (remaining > 0) {
         size_t max_write  = (TensorPage::SIZE - page_offset);
         char* current_ptr = current_page->get_bytes() + page_offset;
-        if (remaining < max_write) {
+        if (remaining <= max_write) {
             // All the remaining bytes fit in the current page
             std::memcpy(current_ptr, &vec_bytes[vec_bytes_size - remaining], remaining);
             current_page->make_dirty();
@@ -163,6 +276,7 @@ void TensorStore::insert(uint64_t object_id, const std::vector<float>& tensor) {
             tensor_buffer_manager->unpin(*current_page);
             remaining -= max_write;
             ++page_number;
+            page_offset  = 0;
             current_page = &tensor_buffer_manager->get_or_append_page(page_number);
         }
     }
@@ -170,10 +284,21 @@ void TensorStore::insert(uint64_t object_id, const std::vector<float>& tensor) {
 
 
 size_t TensorStore::size() const {
+    std::shared_lock lock(mapping_mutex);
     return object_id2tensor_offset.size();
 }
 
 
+std::vector<uint64_t> TensorStore::get_object_ids() const {
+    std::shared_lock lock(mapping_mutex);
+    std::vector<uint64_t> object_ids;
+    object_ids.reserve(object_id2tensor_offset.size());
+    for (auto&& [object_id, _] : object_id2tensor_offset)
+        object_ids.push_back(object_id);
+    return object_ids;
+}
+
+
 void TensorStore::build_forest_index(LSH::MetricType metric_type, uint64_t num_trees, uint64_t max_bucket_size, uint64_t max_depth) {
     if (size() == 0)
         throw std::logic_error("Cannot build forest index because the store is empty!");
@@ -183,34 +308,179 @@ void TensorStore::build_forest_index(LSH::MetricType metric_type, uint64_t num_t
 }
 
 
+void TensorStore::build_hnsw_index(LSH::MetricType metric_type, uint64_t M, uint64_t ef_construction, uint64_t ef_search) {
+    if (size() == 0)
+        throw std::logic_error("Cannot build HNSW index because the store is empty!");
+    hnsw_index = std::make_unique<HNSW::HNSWIndex>(*this, metric_type, M, ef_construction, ef_search);
+    hnsw_index->build();
+}
+
+
+void TensorStore::build_quantized_tensors() {
+    if (size() == 0)
+        throw std::logic_error("Cannot build quantized tensors because the store is empty!");
+    quantizer = std::make_unique<ScalarQuantizer>(*this);
+}
+
+
 std::vector<std::pair<uint64_t, float>>
   TensorStore::query_top_k(const std::vector<float>& query_tensor, int64_t k) const {
-    if (forest_index == nullptr)
-        throw LogicException("Forest index is not built for this tensor store \"" + name + "\"");
+    if (forest_index == nullptr && hnsw_index == nullptr)
+        throw LogicException("No index is built for this tensor store \"" + name + "\"");
     if (k <= 0)
         throw LogicException("k must be positive");
+    if (hnsw_index != nullptr)
+        return hnsw_index->query_top_k(query_tensor, uint64_t(k));
     return forest_index->query_top_k(query_tensor, uint64_t(k));
 }
 
 
-std::unique_ptr<LSH::ForestIndexQueryIter> TensorStore::query_iter(const std::vector<float>& query_tensor) const {
-    if (forest_index == nullptr)
-        throw LogicException("Forest index is not built for this tensor store \"" + name + "\"");
+std::vector<std::vector<std::pair<uint64_t, float>>>
+  TensorStore::query_top_k(const std::vector<std::vector<float>>& query_tensors, int64_t k) const {
+    if (forest_index == nullptr && hnsw_index == nullptr)
+        throw LogicException("No index is built for this tensor store \"" + name + "\"");
+    if (k <= 0)
+        throw LogicException("k must be positive");
+    if (hnsw_index != nullptr) {
+        std::vector<std::vector<std::pair<uint64_t, float>>> res;
+        res.reserve(query_tensors.size());
+        for (auto& query_tensor : query_tensors)
+            res.push_back(hnsw_index->query_top_k(query_tensor, uint64_t(k)));
+        return res;
+    }
+    return forest_index->query_top_k(query_tensors, uint64_t(k));
+}
+
+
+std::vector<std::pair<uint64_t, float>>
+  TensorStore::query_top_k(const std::vector<float>&            query_tensor,
+                           int64_t                              k,
+                           const std::vector<uint64_t>&         allowed_ids,
+                           const std::function<bool(uint64_t)>& is_allowed) const {
+    if (forest_index == nullptr && hnsw_index == nullptr)
+        throw LogicException("No index is built for this tensor store \"" + name + "\"");
+    if (k <= 0)
+        throw LogicException("k must be positive");
+    if (allowed_ids.empty())
+        return {};
+
+    // Costs are estimated as the number of distance computations. The index has to find k / selectivity
+    // candidates to expect k of them to be allowed. The allowed objects may not all be in the store, so the
+    // selectivity can't be more than 1
+    const double selectivity = std::min(1.0, static_cast<double>(allowed_ids.size()) / size());
+    const double scan_cost   = allowed_ids.size();
+    const double index_cost  = (hnsw_index != nullptr ? hnsw_index->estimate_candidates(k)
+                                                       : forest_index->estimate_candidates(k)) / selectivity;
+
+    uint64_t expanded_k = std::ceil(k / selectivity);
+    if (scan_cost <= index_cost || expanded_k >= size())
+        return scan_top_k(query_tensor, k, allowed_ids);
+
+    // Post-filter, doubling k while the index does not return enough allowed objects
+    while (expanded_k < size()) {
+        auto candidates = query_top_k(query_tensor, expanded_k);
+
+        std::vector<std::pair<uint64_t, float>> nearest_neighbors;
+        for (auto& candidate : candidates) {
+            if (is_allowed(candidate.first)) {
+                nearest_neighbors.push_back(candidate);
+                if (nearest_neighbors.size() == uint64_t(k))
+                    return nearest_neighbors;
+            }
+        }
+        expanded_k *= 2;
+    }
+
+    // Searching more candidates in the index costs more than scanning all the allowed objects
+    return scan_top_k(query_tensor, k, allowed_ids);
+}
+
+
+std::vector<std::pair<uint64_t, float>>
+  TensorStore::scan_top_k(const std::vector<float>&    query_tensor,
+                          uint64_t                     k,
+                          const std::vector<uint64_t>& object_ids) const {
+    auto metric_type = hnsw_index != nullptr ? hnsw_index->get_metric_type() : forest_index->get_metric_type();
+
+    float (*similarity_fn)(const std::vector<float>&, const std::vector<float>&);
+    switch (metric_type) {
+    case LSH::MetricType::ANGULAR: {
+        similarity_fn = &LSH::Metric::cosine_distance;
+        break;
+    }
+    case LSH::MetricType::EUCLIDEAN: {
+        similarity_fn = &LSH::Metric::euclidean_distance;
+        break;
+    }
+    default: { // MetricType::MANHATTAN
+        similarity_fn = &LSH::Metric::manhattan_distance;
+        break;
+    }
+    }
+
+    std::vector<std::pair<uint64_t, float>> nearest_neighbors;
+    nearest_neighbors.reserve(object_ids.size());
+
+    if (quantizer != nullptr) {
+        for (auto object_id : object_ids) {
+            auto codes = quantizer->get_codes(object_id);
+            if (codes != nullptr)
+                nearest_neighbors.emplace_back(object_id, quantizer->distance(metric_type, query_tensor, codes));
+        }
+        quantizer->rerank(query_tensor, nearest_neighbors, k, similarity_fn);
+        return nearest_neighbors;
+    }
+
+    std::vector<float> tensor_buffer(tensors_dim);
+    for (auto object_id : object_ids) {
+        if (get(object_id, tensor_buffer))
+            nearest_neighbors.emplace_back(object_id, similarity_fn(query_tensor, tensor_buffer));
+    }
+
+    auto result_size = std::min(k, static_cast<uint64_t>(nearest_neighbors.size()));
+    std::partial_sort(nearest_neighbors.begin(),
+                      nearest_neighbors.begin() + result_size,
+                      nearest_neighbors.end(),
+                      [](const std::pair<uint64_t, float>& lhs, const std::pair<uint64_t, float>& rhs) {
+                          return lhs.second < rhs.second;
+                      });
+    nearest_neighbors.resize(result_size);
+    return nearest_neighbors;
+}
+
+
+std::unique_ptr<TensorQueryIter> TensorStore::query_iter(const std::vector<float>& query_tensor) const {
+    if (forest_index == nullptr && hnsw_index == nullptr)
+        throw LogicException("No index is built for this tensor store \"" + name + "\"");
+    if (hnsw_index != nullptr)
+        return hnsw_index->query_iter(query_tensor);
     return forest_index->query_iter(query_tensor);
 }
 
 
 void TensorStore::serialize() const {
     // Serialize mapping
-    std::fstream ofs(mapping_path, std::ios::out | std::ios::binary | std::ios::trunc);
-    Serialization::write_uint64(ofs, tensors_dim);
-    Serialization::write_uint64(ofs, object_id2tensor_offset.size());
-    Serialization::write_uint642uint64_unordered_map(ofs, object_id2tensor_offset);
-    ofs.close();
+    {
+        std::shared_lock lock(mapping_mutex);
+        std::fstream ofs(mapping_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        Serialization::write_uint64(ofs, tensors_dim);
+        Serialization::write_uint64(ofs, object_id2tensor_offset.size());
+        Serialization::write_uint642uint64_unordered_map(ofs, object_id2tensor_offset);
+        ofs.close();
+        modified = false;
+    }
 
     // Serialize forest index
     if (forest_index != nullptr)
         forest_index->serialize(index_path);
+
+    // Serialize HNSW index
+    if (hnsw_index != nullptr)
+        hnsw_index->serialize(hnsw_path);
+
+    // Serialize quantized tensors
+    if (quantizer != nullptr)
+        quantizer->serialize(quantized_path);
 }
 
 
@@ -222,9 +492,21 @@ void TensorStore::deserialize() {
     object_id2tensor_offset = Serialization::read_uint642uint64_unordered_map(ifs, object_id2tensor_offset_size);
     ifs.close();
 
+    // New tensors are written after the last one, the space of the removed ones is not reused
+    for (auto&& [object_id, tensor_offset] : object_id2tensor_offset)
+        tensors_end = std::max(tensors_end, tensor_offset + sizeof(float) * tensors_dim);
+
     // Deserialize forest index
     if (Filesystem::is_regular_file(index_path))
         forest_index = std::make_unique<LSH::ForestIndex>(index_path, *this);
+
+    // Deserialize HNSW index
+    if (Filesystem::is_regular_file(hnsw_path))
+        hnsw_index = std::make_unique<HNSW::HNSWIndex>(hnsw_path, *this);
+
+    // Deserialize quantized tensors
+    if (Filesystem::is_regular_file(quantized_path))
+        quantizer = std::make_unique<ScalarQuantizer>(quantized_path, *this);
 }
 
 
@@ -232,3 +514,44 @@ void TensorStore::set_tensor_buffer_manager(uint64_t tensor_buffer_page_size_in_
     const auto tensor_page_buffer_pool_size = tensor_buffer_page_size_in_bytes / TensorPage::SIZE;
     tensor_buffer_manager= std::make_unique<TensorBufferManager>(tensors_file_id, tensor_page_buffer_pool_size, preload);
 }
+
+
+void TensorStore::map_tensors(bool preload) {
+    tensors_file_size = lseek(tensors_file_id.id, 0, SEEK_END);
+    if (tensors_file_size == 0)
+        return;
+
+    remap_tensors(tensors_file_size);
+
+    // Queries read the candidates in no particular order, so the read-ahead is only useful for preloading
+    if (preload)
+        madvise(const_cast<char*>(tensors_data), tensors_file_size, MADV_WILLNEED);
+}
+
+
+void TensorStore::remap_tensors(uint64_t min_size) {
+    // Reserve twice the size so a growing file is mapped again only a few times
+    const auto new_size = std::max(2 * tensors_data_size,
+                                   (min_size + TensorPage::SIZE - 1) / TensorPage::SIZE * TensorPage::SIZE);
+
+    auto data = mmap(nullptr, new_size, PROT_READ, MAP_SHARED, tensors_file_id.id, 0);
+    if (data == MAP_FAILED)
+        throw std::runtime_error("Could not map the tensors of \"" + name + "\"");
+    madvise(data, new_size, MADV_RANDOM);
+
+    if (tensors_data != nullptr)
+        old_tensors_data.emplace_back(tensors_data, tensors_data_size);
+    tensors_data      = reinterpret_cast<const char*>(data);
+    tensors_data_size = new_size;
+}
+
+
+void TensorStore::unmap_tensors() {
+    if (tensors_data != nullptr)
+        munmap(const_cast<char*>(tensors_data), tensors_data_size);
+    for (auto&& [data, data_size] : old_tensors_data)
+        munmap(const_cast<char*>(data), data_size);
+    old_tensors_data.clear();
+    tensors_data      = nullptr;
+    tensors_data_size = 0;
+}
@@ -1,7 +1,12 @@
 #pragma once
 /*
  * TensorStore is an on-disk map between object ids and float tensors. The supported operations are insert (also
- * with replacement) and get. It has its own buffer manager for each instance.
+ * with replacement), remove and get. A new tensor store has its own buffer manager. A loaded tensor store maps the
+ * .tensors file read-only, so any number of threads can read it, and writes the tensors inserted while the server runs
+ * directly to the file.
+ *
+ * Insertions always append the tensor to the .tensors file, so a reader of the previous tensor of an object is not
+ * affected when it is replaced. The space of replaced and removed tensors is not reused.
  * The TensorStore disk storage are the .tensors and .mapping files:
  *
  * {tensor_store_name}.tensors - stores all the tensor data as an adjacently-arranged vector of floats
@@ -10,20 +15,34 @@
  * between object_id2tensor_offset map for being loaded into memory
  *
  * {tensor_store_name}.index   - stores the forest index serialized if it was previously built
+ *
+ * {tensor_store_name}.hnsw    - stores the HNSW index serialized if it was previously built. When both indexes
+ * exist, queries use the HNSW index
+ *
+ * {tensor_store_name}.sq8     - stores the int8 quantized tensors if they were previously built. When they exist,
+ * the indexes score their candidates with them and re-rank the best ones with the float tensors
  */
 
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "storage/file_id.h"
 
+class ScalarQuantizer;
 class TensorBufferManager;
+class TensorQueryIter;
+
+namespace HNSW {
+class HNSWIndex;
+} // namespace HNSW
 
 namespace LSH {
 class ForestIndex;
-class ForestIndexQueryIter;
 class Tree;
 enum class MetricType;
 } // namespace LSH
@@ -31,6 +50,8 @@ enum class MetricType;
 class TensorStore {
 public:
     friend class LSH::Tree;
+    friend class HNSW::HNSWIndex;
+    friend class ScalarQuantizer;
 
     inline static const std::string TENSOR_STORES_DIR = "tensor_stores";
 
@@ -40,8 +61,12 @@ public:
     const std::string name;
     uint64_t          tensors_dim;
 
-    // Vector index
+    // Vector indexes
     std::unique_ptr<LSH::ForestIndex> forest_index;
+    std::unique_ptr<HNSW::HNSWIndex>  hnsw_index;
+
+    // In-memory quantized tensors used by the vector indexes
+    std::unique_ptr<ScalarQuantizer> quantizer;
 
     // Initialize a new tensor store
     TensorStore(const std::string& name, uint64_t tensors_dim, uint64_t tensor_page_buffer_size_in_bytes);
@@ -49,7 +74,7 @@ public:
     // Load an existing tensor store with a given name
     TensorStore(const std::string& name, uint64_t tensor_page_buffer_size_in_bytes, bool preload);
 
-    // Trigger the serialization before being destroyed
+    // Serialize the tensor store if it was modified after the last serialization
     ~TensorStore();
 
     // Check if a tensor with the given id exists
@@ -59,19 +84,53 @@ public:
     // if the tensor is found, false otherwise
     bool get(uint64_t object_id, std::vector<float>& vec) const;
 
-    // Insert a new tensor or replace an existing one
+    // Get the tensor data of the given object id, it points to the mapped tensors file when possible, otherwise the
+    // tensor is written into buffer (buffer.size() == tensors_dim). Return nullptr if the tensor is not found
+    const float* get_data(uint64_t object_id, std::vector<float>& buffer) const;
+
+    // Position of the tensor of object_id in the .tensors file (its offset divided by the tensor size). The tensor
+    // must exist
+    uint64_t get_slot(uint64_t object_id) const;
+
+    // Insert a new tensor or replace an existing one, updating the forest index if it exists. Stores with an HNSW
+    // index or quantized tensors can't be modified
     void insert(uint64_t object_id, const std::vector<float>& tensor);
 
+    // Remove the tensor of the given object id. Return false if it does not exist
+    bool remove(uint64_t object_id);
+
     size_t size() const;
 
+    // Ids of all the objects with a tensor
+    std::vector<uint64_t> get_object_ids() const;
+
     // Build and set a forest index with the entire tensor store
     void build_forest_index(LSH::MetricType metric_type, uint64_t num_trees, uint64_t max_bucket_size, uint64_t max_depth);
 
+    // Build and set an HNSW index with the entire tensor store
+    void build_hnsw_index(LSH::MetricType metric_type, uint64_t M, uint64_t ef_construction, uint64_t ef_search);
+
+    // Build and set the int8 quantized tensors with the entire tensor store
+    void build_quantized_tensors();
+
     std::vector<std::pair<uint64_t, float>> query_top_k(const std::vector<float>& query_tensor, int64_t k) const;
 
-    std::unique_ptr<LSH::ForestIndexQueryIter> query_iter(const std::vector<float>& query_tensor) const;
+    // Get the top k most similar object_ids for each one of the query tensors. With a forest index the candidates
+    // shared by the queries are read once and their distances are computed in blocks of queries
+    std::vector<std::vector<std::pair<uint64_t, float>>>
+      query_top_k(const std::vector<std::vector<float>>& query_tensors, int64_t k) const;
+
+    // Get the top k most similar object_ids between the allowed ones. Depending on the estimated cost, the allowed
+    // objects are scanned (pre-filter) or the index results are filtered, expanding k until k of them are allowed
+    // (post-filter). allowed_ids must not have duplicates and is_allowed must be true only for them
+    std::vector<std::pair<uint64_t, float>> query_top_k(const std::vector<float>&            query_tensor,
+                                                        int64_t                              k,
+                                                        const std::vector<uint64_t>&         allowed_ids,
+                                                        const std::function<bool(uint64_t)>& is_allowed) const;
 
-    // Serialize the tensor store (mapping and forest index if it exists)
+    std::unique_ptr<TensorQueryIter> query_iter(const std::vector<float>& query_tensor) const;
+
+    // Serialize the tensor store (mapping and the indexes that exist)
     void serialize() const;
 
 private:
@@ -79,15 +138,55 @@ private:
 
     std::string mapping_path;
     std::string index_path;
+    std::string hnsw_path;
+    std::string quantized_path;
 
+    // Only new tensor stores use a buffer manager, loaded ones use tensors_data
     std::unique_ptr<TensorBufferManager> tensor_buffer_manager;
 
+    // Read-only mapping of the tensors file. It may be bigger than the file, so the file can grow without mapping it
+    // again every time. The previous mappings are kept in old_tensors_data because readers may still use them
+    const char* tensors_data      = nullptr;
+    uint64_t    tensors_data_size = 0;
+    uint64_t    tensors_file_size = 0;
+
+    std::vector<std::pair<const char*, uint64_t>> old_tensors_data;
 
     // Mapping between object id and its tensor bytes offset in the file (bytes)
     std::unordered_map<uint64_t, uint64_t> object_id2tensor_offset;
 
+    // Offset where the next tensor is written
+    uint64_t tensors_end = 0;
+
+    // Protects object_id2tensor_offset and the mapping of the tensors, it is exclusive only to modify them
+    mutable std::shared_mutex mapping_mutex;
+
+    // Only one insertion or removal at a time
+    std::mutex write_mutex;
+
+    // True if there are modifications that are not serialized
+    mutable bool modified = false;
+
+    // Exact top k between the given objects, scoring them with the quantized tensors if they exist
+    std::vector<std::pair<uint64_t, float>> scan_top_k(const std::vector<float>&    query_tensor,
+                                                       uint64_t                     k,
+                                                       const std::vector<uint64_t>& object_ids) const;
+
     // Deserialize the tensor store
     void deserialize();
 
     void set_tensor_buffer_manager(uint64_t tensor_buffer_page_size_in_bytes, bool preload);
+
+    // Throws if the store has something that can't be updated
+    void check_modifiable() const;
+
+    // Write the tensor at the given offset of the .tensors file
+    void write_tensor(uint64_t tensor_offset, const std::vector<float>& tensor);
+
+    void map_tensors(bool preload);
+
+    // Map the tensors file with at least the given size, mapping_mutex must be locked exclusively
+    void remap_tensors(uint64_t min_size);
+
+    void unmap_tensors();
 };
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+// Size of the pages of every file of the database (VPage, UPage, PPage and TensorPage).
+// The capacities of the B+trees, hashes and tables are computed from it at compile time, so it is
+// chosen when building (cmake -DMDB_PAGE_SIZE=16384). The catalog records the page size a database
+// was created with and a database can only be opened by binaries built with the same page size.
+#ifndef MDB_PAGE_SIZE
+#define MDB_PAGE_SIZE 4096
+#endif
+
+static constexpr size_t DATABASE_PAGE_SIZE = MDB_PAGE_SIZE;
+
+static_assert(DATABASE_PAGE_SIZE >= 4096 && DATABASE_PAGE_SIZE <= 64*1024,
+              "MDB_PAGE_SIZE must be between 4 KB and 64 KB");
+static_assert((DATABASE_PAGE_SIZE & (DATABASE_PAGE_SIZE - 1)) == 0,
+              "MDB_PAGE_SIZE must be a power of 2");
@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "storage/page/page_id.h"
+#include "storage/page/page_size.h"
 
 // Private Page. Used for temporal pages that don't need to be synchronized
 // because the only can be used by one thread (worker)
@@ -10,7 +11,7 @@ class PPage {
 friend class BufferManager;
 friend class FileManager;
 public:
-    static constexpr size_t SIZE = 4096;
+    static constexpr size_t SIZE = DATABASE_PAGE_SIZE;
 
     // contains file_id and page_number of this page
     PageId page_id;
@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "storage/page/page_id.h"
+#include "storage/page/page_size.h"
 
 // Unversioned Page. Used for pages of structures where updates don't
 // generate conflicts with reads. This might imply that the structure
@@ -18,7 +19,7 @@ class UPage {
 friend class BufferManager;
 friend class FileManager;
 public:
-    static constexpr size_t SIZE = 4096;
+    static constexpr size_t SIZE = DATABASE_PAGE_SIZE;
 
     // contains file_id and page_number of this page
     PageId page_id;
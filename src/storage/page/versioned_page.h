@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "storage/page/page_id.h"
+#include "storage/page/page_size.h"
 
 // Versioned Page. Used for pages that can be used concurrently in different
 // places and need different versions (Multi-version concurrency control)
@@ -14,7 +15,7 @@ class VPage {
 friend class BufferManager;
 friend class FileManager;
 public:
-    static constexpr size_t SIZE = 4096;
+    static constexpr size_t SIZE = DATABASE_PAGE_SIZE;
 
     // contains file_id and page_number of this page
     PageId page_id;
@@ -44,6 +45,10 @@ private:
     // true if data in memory is different from disk
     bool dirty;
 
+    // true if the BufferManager keeps a delta of this version, the frame can then be reused
+    // while queries still read the version
+    bool has_delta;
+
     VPage() noexcept :
         page_id(FileId(FileId::UNASSIGNED), 0),
         next_version(nullptr),
@@ -51,7 +56,8 @@ private:
         bytes(nullptr),
         pins(0),
         second_chance(false),
-        dirty(false) { }
+        dirty(false),
+        has_delta(false) { }
 
     void pin() noexcept {
         pins++;
@@ -71,6 +77,7 @@ private:
         this->pins          = 0;
         this->second_chance = false;
         this->dirty         = false;
+        this->has_delta     = false;
     }
 
     void set_bytes(char* bytes) {
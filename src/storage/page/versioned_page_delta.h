@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "storage/page/versioned_page.h"
+
+// Content of an old version of a versioned page, stored as the byte ranges where it differs from the
+// next version of the page. The BufferManager keeps it when an update commits, so the frame of the old
+// version can be reused while queries still read it, and materializes it again into a frame on pin.
+class VPageDelta {
+public:
+    // version whose content is restored
+    uint64_t version_number;
+
+    // `bytes` has the content of the version and `next_bytes` the content of the next version
+    VPageDelta(uint64_t version_number, const char* bytes, const char* next_bytes) :
+        version_number (version_number)
+    {
+        auto words      = reinterpret_cast<const uint64_t*>(bytes);
+        auto next_words = reinterpret_cast<const uint64_t*>(next_bytes);
+
+        uint32_t i = 0;
+        while (i < WORDS) {
+            if (words[i] == next_words[i]) {
+                i++;
+                continue;
+            }
+            // a range takes as much memory as a word, so ranges separated by MAX_GAP equal words are merged
+            uint32_t end = i + 1;
+            for (uint32_t j = end; j < WORDS && j <= end + MAX_GAP; j++) {
+                if (words[j] != next_words[j]) {
+                    end = j + 1;
+                }
+            }
+
+            ranges.push_back({ i, end - i });
+            data.insert(data.end(), words + i, words + end);
+            i = end;
+        }
+        data.shrink_to_fit();
+        ranges.shrink_to_fit();
+    }
+
+    // Transforms the content of the next version into the content of this version
+    void apply(char* bytes) const {
+        auto words = reinterpret_cast<uint64_t*>(bytes);
+        auto src   = data.data();
+        for (auto& range : ranges) {
+            std::memcpy(words + range.word_offset, src, range.word_count * sizeof(uint64_t));
+            src += range.word_count;
+        }
+        assert(src == data.data() + data.size());
+    }
+
+    // bytes of memory used by the delta
+    uint64_t size() const {
+        return sizeof(VPageDelta) + ranges.capacity() * sizeof(Range) + data.capacity() * sizeof(uint64_t);
+    }
+
+private:
+    static constexpr uint32_t WORDS = VPage::SIZE / sizeof(uint64_t);
+
+    static constexpr uint32_t MAX_GAP = 1;
+
+    struct Range {
+        uint32_t word_offset;
+        uint32_t word_count;
+    };
+
+    std::vector<Range> ranges;
+
+    // words of every range, one after the other
+    std::vector<uint64_t> data;
+};
@@ -0,0 +1,104 @@
+/*
+ * RunningVersions keeps the versions used by the running queries and updates, so the BufferManager
+ * knows which old page versions can be discarded.
+ *
+ * Each VersionScope owns a slot of a fixed array that stores its version. Registering, releasing and
+ * checking if a version is in use are lock-free, so the page replacement doesn't need to lock anything
+ * besides the pool mutex to decide if an old version can be discarded.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+class RunningVersions {
+public:
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+
+    // maximum number of queries and updates running at the same time
+    static constexpr uint64_t MAX_SLOTS = 1024;
+
+    RunningVersions() {
+        for (auto& slot : slots) {
+            slot.store(EMPTY, std::memory_order_relaxed);
+        }
+    }
+
+    // Stores the version in a free slot and returns the slot. Waits if all slots are in use
+    uint64_t acquire(uint64_t version) {
+        while (true) {
+            for (uint64_t i = 0; i < MAX_SLOTS; i++) {
+                if (slots[i].load(std::memory_order_relaxed) != EMPTY) {
+                    continue;
+                }
+                // end is moved before storing the version, so a concurrent is_running can't miss it
+                auto current_end = end.load();
+                while (current_end < i + 1 && !end.compare_exchange_weak(current_end, i + 1)) { }
+
+                auto expected = EMPTY;
+                if (slots[i].compare_exchange_strong(expected, version)) {
+                    return i;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // Replaces the version of an acquired slot
+    void set(uint64_t slot, uint64_t version) {
+        slots[slot].store(version);
+    }
+
+    void release(uint64_t slot) {
+        slots[slot].store(EMPTY);
+    }
+
+    bool is_running(uint64_t version) const {
+        const auto slots_end = end.load();
+        for (uint64_t i = 0; i < slots_end; i++) {
+            if (slots[i].load() == version) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns true if a version in [from, to) is in use
+    bool is_running(uint64_t from, uint64_t to) const {
+        const auto slots_end = end.load();
+        for (uint64_t i = 0; i < slots_end; i++) {
+            auto version = slots[i].load();
+            if (from <= version && version < to) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns the number of distinct versions in use
+    uint64_t count() const {
+        uint64_t res = 0;
+        const auto slots_end = end.load();
+        for (uint64_t i = 0; i < slots_end; i++) {
+            auto version = slots[i].load();
+            if (version == EMPTY) {
+                continue;
+            }
+            bool seen = false;
+            for (uint64_t j = 0; j < i && !seen; j++) {
+                seen = slots[j].load() == version;
+            }
+            res += seen ? 0 : 1;
+        }
+        return res;
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, MAX_SLOTS> slots;
+
+    // slots after this position were never used
+    std::atomic<uint64_t> end { 0 };
+};
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <mutex>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include "graph_models/object_id.h"
 #include "query/exceptions.h"
@@ -51,19 +52,7 @@ StringManager::StringManager(uint64_t max_initial_populate_size) :
 
     string_blocks.reserve(64*1024); // for 8TB max string file size (with block size 64MB)
 
-    for (uint64_t i = 0; i < populate_blocks; i++) {
-        // mmap will return correct alignment
-        auto bytes = reinterpret_cast<char*>(mmap(NULL,
-                                                  STRING_BLOCK_SIZE,
-                                                  PROT_READ|PROT_WRITE,
-                                                  MAP_SHARED MAP_POPULATE_,
-                                                  str_file_id.id,
-                                                  i*STRING_BLOCK_SIZE));
-        // TODO: try madvise random and measure for performance changes
-        string_blocks.push_back(bytes);
-    }
-
-    for (uint64_t i = populate_blocks; i < number_of_blocks; i++) {
+    for (uint64_t i = 0; i < number_of_blocks; i++) {
         // mmap will return correct alignment
         auto bytes = reinterpret_cast<char*>(mmap(NULL,
                                                   STRING_BLOCK_SIZE,
@@ -76,10 +65,39 @@ StringManager::StringManager(uint64_t max_initial_populate_size) :
     }
 
     last_block_offset = *reinterpret_cast<uint64_t*>(string_blocks[0]);
+    strings_end = (number_of_blocks - 1) * STRING_BLOCK_SIZE + last_block_offset;
+
+    // The first blocks are loaded in the background instead of using MAP_POPULATE, that makes the
+    // startup wait until all of them are read
+    if (populate_blocks > 0) {
+        std::vector<char*> blocks(string_blocks.begin(), string_blocks.begin() + populate_blocks);
+        loader.run([blocks = std::move(blocks)](BackgroundLoader& loader) {
+            populate(loader, blocks);
+        });
+    }
+}
+
+
+void StringManager::populate(BackgroundLoader& loader, const std::vector<char*>& blocks) {
+    const auto os_page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+    for (auto block : blocks) {
+        // start the read-ahead of the whole block, then touch every page so it is mapped
+        madvise(block, STRING_BLOCK_SIZE, MADV_WILLNEED);
+
+        volatile char sink = 0;
+        for (uint64_t offset = 0; offset < STRING_BLOCK_SIZE; offset += os_page_size) {
+            if (offset % (1024 * 1024) == 0 && loader.is_stopped()) {
+                return;
+            }
+            sink = sink + block[offset];
+        }
+    }
 }
 
 
 StringManager::~StringManager() {
+    loader.stop();
     for (auto block : string_blocks) {
         munmap(block, STRING_BLOCK_SIZE);
     }
@@ -115,13 +133,18 @@ void StringManager::print(std::ostream& os, uint64_t id) const {
 }
 
 bool StringManager::bytes_eq(const char* bytes, uint64_t size, uint64_t id) const {
+    const auto end = strings_end.load(std::memory_order_acquire);
+    if (id >= end) {
+        return false;
+    }
+
     char* current_block = string_blocks[id/STRING_BLOCK_SIZE];
     char* ptr = current_block + (id % STRING_BLOCK_SIZE);
 
     uint64_t bytes_for_len;
     uint64_t len = get_string_len(ptr, &bytes_for_len);
 
-    if (len != size) {
+    if (len != size || id + bytes_for_len + len > end) {
         return false;
     }
 
@@ -133,7 +156,6 @@ bool StringManager::bytes_eq(const char* bytes, uint64_t size, uint64_t id) cons
 
 
 uint64_t StringManager::get_bytes_id(const char* bytes, uint64_t size) const {
-    std::shared_lock lock(mutex);
     return str_hash.get_str_id(bytes, size);
 }
 
@@ -150,15 +172,19 @@ std::unique_ptr<CharIter> StringManager::get_char_iter(uint64_t id) const {
 
 
 uint64_t StringManager::get_or_create(const char* bytes, uint64_t size) {
-    {
-        std::shared_lock lock(mutex);
-        auto existing_id = str_hash.get_str_id(bytes, size);
-        if (existing_id != ObjectId::MASK_NOT_FOUND) {
-            return existing_id;
-        }
+    auto existing_id = str_hash.get_str_id(bytes, size);
+    if (existing_id != ObjectId::MASK_NOT_FOUND) {
+        return existing_id;
     }
 
-    // need to create
+    // the string is appended only if it is still missing once the latch of its bucket is held
+    return str_hash.get_or_create_str_id(bytes, size, [&]() { return append(bytes, size); });
+}
+
+
+uint64_t StringManager::append(const char* bytes, uint64_t size) {
+    std::lock_guard<std::mutex> lock(append_mutex);
+
     uint64_t bytes_for_len = get_bytes_for_len(size);
 
     // create new block if len can't be encoded in current last block
@@ -206,10 +232,8 @@ uint64_t StringManager::get_or_create(const char* bytes, uint64_t size) {
     update_last_block_offset();
     // TODO: should have some kind of WAL for recovery of the string file
 
-    {
-        std::unique_lock lock(mutex);
-        str_hash.create_str_id(bytes, size, res);
-    }
+    strings_end.store((string_blocks.size() - 1) * STRING_BLOCK_SIZE + last_block_offset,
+                      std::memory_order_release);
     return res;
 }
 
@@ -1,13 +1,15 @@
 #pragma once
 
 #include <cstdint>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <ostream>
-#include <shared_mutex>
 #include <string>
 #include <vector>
 
 #include "macros/count_zeros.h"
+#include "storage/background_loader.h"
 #include "storage/char_iter.h"
 #include "storage/file_id.h"
 #include "storage/index/hash/strings_hash/strings_hash.h"
@@ -28,7 +30,7 @@ public:
     static constexpr uint64_t DEFAULT_LOAD_STR = 2ULL * 1024 * 1024 * 1024;
 
     // necessary to be called before first usage
-    // max_initial_populate_size in Bytes
+    // max_initial_populate_size in Bytes, they are loaded in the background
     static void init(uint64_t max_initial_populate_size);
 
     ~StringManager();
@@ -43,7 +45,7 @@ public:
         return get_bytes_id(str.data(), str.size());
     }
 
-    // !!! NOT THREAD-SAFE !!!
+    // Lookups are lock-free, new strings are appended one at a time
     uint64_t get_or_create(const char* bytes, uint64_t size);
 
     bool bytes_eq(const char* bytes, uint64_t size, uint64_t id) const;
@@ -123,6 +125,9 @@ private:
 
     void append_new_block();
 
+    // writes the string at the end of the strings file and returns its id
+    uint64_t append(const char* bytes, uint64_t size);
+
     inline void update_last_block_offset() {
         auto ptr = reinterpret_cast<uint64_t*>(string_blocks[0]);
         *ptr = last_block_offset;
@@ -136,8 +141,17 @@ private:
 
     std::vector<char*> string_blocks;
 
-    // for str_hash read/writes
-    mutable std::shared_mutex mutex;
+    // end of the written strings, a concurrent lookup may read a bad id and this is used to discard it
+    std::atomic<uint64_t> strings_end;
+
+    // for appending strings
+    std::mutex append_mutex;
+
+    // populates the first blocks after the initialization
+    BackgroundLoader loader;
+
+    // reads the blocks into memory, returns early if the loader is stopped
+    static void populate(BackgroundLoader& loader, const std::vector<char*>& blocks);
 };
 
 extern StringManager& string_manager; // global object
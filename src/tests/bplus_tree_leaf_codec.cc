@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/bplus_tree/bplus_tree_leaf_codec.h"
+
+typedef bool TestFunction();
+
+// A buffer with the size and the alignment of a page
+struct Page {
+    std::vector<uint64_t> words = std::vector<uint64_t>(VPage::SIZE / sizeof(uint64_t), 0);
+
+    char* bytes() { return reinterpret_cast<char*>(words.data()); }
+};
+
+
+// Sorted records, the values of each column are base + (random number of at most bits[col] bits)
+template <std::size_t N>
+std::vector<uint64_t> make_records(uint32_t count,
+                                   const std::array<uint64_t, N>& base,
+                                   const std::array<uint64_t, N>& bits,
+                                   std::mt19937_64& gen)
+{
+    std::vector<std::array<uint64_t, N>> records(count);
+    for (auto& record : records) {
+        for (std::size_t col = 0; col < N; col++) {
+            auto mask = bits[col] == 64 ? UINT64_MAX : (1ULL << bits[col]) - 1;
+            record[col] = base[col] + (gen() & mask);
+        }
+    }
+    std::sort(records.begin(), records.end());
+
+    std::vector<uint64_t> res;
+    for (auto& record : records) {
+        res.insert(res.end(), record.begin(), record.end());
+    }
+    return res;
+}
+
+
+// Encodes the records and decodes every column of every record
+template <std::size_t N>
+bool round_trip(const std::vector<uint64_t>& records, const std::string& name) {
+    const auto count = static_cast<uint32_t>(records.size() / N);
+
+    Page page;
+    if (!CompressedLeaf<N>::encode(records.data(), count, page.bytes())) {
+        std::cerr << name << ": " << count << " records did not fit\n";
+        return true;
+    }
+    if (!CompressedLeaf<N>::is_compressed(page.bytes())) {
+        std::cerr << name << ": the page is not marked as compressed\n";
+        return true;
+    }
+    auto value_count = *reinterpret_cast<uint32_t*>(page.bytes()) & ~CompressedLeaf<N>::FLAG;
+    if (value_count != count) {
+        std::cerr << name << ": value_count is " << value_count << ", expected " << count << "\n";
+        return true;
+    }
+
+    CompressedLeaf<N> leaf;
+    leaf.load(page.bytes());
+    for (uint32_t pos = 0; pos < count; pos++) {
+        for (uint32_t col = 0; col < N; col++) {
+            if (leaf.get(pos, col) != records[pos*N + col]) {
+                std::cerr << name << ": record " << pos << ", column " << col << " decoded as "
+                          << leaf.get(pos, col) << ", expected " << records[pos*N + col] << "\n";
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+template <std::size_t N>
+const uint8_t* get_bits(Page& page) {
+    return reinterpret_cast<const uint8_t*>(page.bytes() + CompressedLeaf<N>::BITS_OFFSET);
+}
+
+
+// The first column has the same value in every record, so it is only stored in the base
+// and a leaf holds many more records than the raw format
+bool constant_column() {
+    auto error = false;
+
+    std::mt19937_64 gen(1);
+    const uint32_t count = 3 * BPlusTree<3>::leaf_max_records;
+    auto records = make_records<3>(count, { 0x0100'0000'0000'1234, 5, 1000 }, { 0, 4, 10 }, gen);
+
+    if (round_trip<3>(records, "constant_column")) {
+        error = true;
+    }
+
+    Page page;
+    CompressedLeaf<3>::encode(records.data(), count, page.bytes());
+    if (get_bits<3>(page)[0] != 0) {
+        error = true;
+        std::cerr << "constant_column: the constant column uses "
+                  << static_cast<int>(get_bits<3>(page)[0]) << " bits\n";
+    }
+    return error;
+}
+
+
+// Columns with differences up to 64 bits, packed values cross the boundaries of the words
+bool wide_deltas() {
+    auto error = false;
+
+    std::mt19937_64 gen(2);
+    const std::vector<std::array<uint64_t, 3>> widths = {
+        { 64, 64, 64 },
+        { 63, 1, 64 },
+        { 13, 37, 64 },
+        { 0, 64, 7 },
+        { 33, 33, 33 },
+    };
+    for (auto& bits : widths) {
+        auto record_bits = bits[0] + bits[1] + bits[2];
+        auto max_count = static_cast<uint32_t>(CompressedLeaf<3>::DATA_WORDS * 64 / record_bits);
+
+        // the extreme values of each column make the number of bits exact
+        auto records = make_records<3>(max_count - 2, { 0, 0, 0 }, bits, gen);
+        std::array<uint64_t, 3> min_record;
+        std::array<uint64_t, 3> max_record;
+        for (std::size_t col = 0; col < 3; col++) {
+            min_record[col] = 0;
+            max_record[col] = bits[col] == 64 ? UINT64_MAX : (1ULL << bits[col]) - 1;
+        }
+        records.insert(records.begin(), min_record.begin(), min_record.end());
+        records.insert(records.end(), max_record.begin(), max_record.end());
+
+        if (round_trip<3>(records, "wide_deltas")) {
+            error = true;
+            continue;
+        }
+
+        // one more record doesn't fit, and the page is not modified
+        Page page;
+        CompressedLeaf<3>::encode(records.data(), max_count, page.bytes());
+        auto copy = page.words;
+        records.insert(records.end(), max_record.begin(), max_record.end());
+        if (CompressedLeaf<3>::encode(records.data(), max_count + 1, page.bytes())) {
+            error = true;
+            std::cerr << "wide_deltas: " << max_count + 1 << " records of " << record_bits
+                      << " bits were encoded\n";
+        }
+        if (page.words != copy) {
+            error = true;
+            std::cerr << "wide_deltas: a failed encoding modified the page\n";
+        }
+    }
+
+    // with every column using 64 bits the raw format holds more records, leaves
+    // fall back to it before splitting
+    std::vector<uint64_t> full(3 * BPlusTree<3>::leaf_max_records, UINT64_MAX);
+    full[0] = 0;
+    full[1] = 0;
+    full[2] = 0;
+    Page page;
+    if (CompressedLeaf<3>::encode(full.data(), BPlusTree<3>::leaf_max_records, page.bytes())) {
+        error = true;
+        std::cerr << "wide_deltas: a full raw leaf with 64 bits columns fits compressed\n";
+    }
+    return error;
+}
+
+
+template <std::size_t N>
+bool empty_leaf() {
+    Page page;
+    page.words.assign(page.words.size(), UINT64_MAX);
+    if (!CompressedLeaf<N>::encode(nullptr, 0, page.bytes())) {
+        std::cerr << "empty_leaf: encoding 0 records failed\n";
+        return true;
+    }
+    auto value_count = *reinterpret_cast<uint32_t*>(page.bytes());
+    if (value_count != CompressedLeaf<N>::FLAG) {
+        std::cerr << "empty_leaf: value_count is " << value_count << "\n";
+        return true;
+    }
+    for (std::size_t col = 0; col < N; col++) {
+        if (get_bits<N>(page)[col] != 0) {
+            std::cerr << "empty_leaf: column " << col << " uses bits\n";
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// The bulk import uses the sizer to decide where a leaf ends, the records it accepts
+// must be encodable and the first one it rejects must not
+template <std::size_t N>
+bool sizer_matches_encode() {
+    auto error = false;
+
+    std::mt19937_64 gen(N);
+    std::uniform_int_distribution<uint64_t> bits_dist(0, 64);
+
+    for (int repetition = 0; repetition < 50; repetition++) {
+        std::array<uint64_t, N> bits;
+        std::array<uint64_t, N> base;
+        for (std::size_t col = 0; col < N; col++) {
+            bits[col] = bits_dist(gen);
+            base[col] = bits[col] == 64 ? 0 : gen() >> bits[col];
+        }
+        auto records = make_records<N>(4 * VPage::SIZE, base, bits, gen);
+
+        CompressedLeafSizer<N> sizer;
+        uint32_t count = 0;
+        while (count < records.size() / N) {
+            std::array<uint64_t, N> record;
+            std::copy_n(&records[count*N], N, record.begin());
+            if (!sizer.add(record)) {
+                break;
+            }
+            count++;
+        }
+        if (sizer.get_count() != count) {
+            error = true;
+            std::cerr << "sizer_matches_encode: get_count is " << sizer.get_count()
+                      << ", " << count << " records were added\n";
+        }
+
+        std::vector<uint64_t> accepted(records.begin(), records.begin() + count*N);
+        if (round_trip<N>(accepted, "sizer_matches_encode")) {
+            error = true;
+        }
+
+        Page page;
+        if (count < records.size() / N && CompressedLeaf<N>::encode(records.data(), count + 1, page.bytes())) {
+            error = true;
+            std::cerr << "sizer_matches_encode: the sizer rejected record " << count
+                      << " but it can be encoded\n";
+        }
+    }
+    return error;
+}
+
+
+int main() {
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&constant_column);
+    tests.push_back(&wide_deltas);
+    tests.push_back(&empty_leaf<1>);
+    tests.push_back(&empty_leaf<4>);
+    tests.push_back(&sizer_matches_encode<1>);
+    tests.push_back(&sizer_matches_encode<2>);
+    tests.push_back(&sizer_matches_encode<3>);
+    tests.push_back(&sizer_matches_encode<4>);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    return error;
+}
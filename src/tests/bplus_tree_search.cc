@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/bplus_tree/bplus_tree_search.h"
+
+typedef bool TestFunction();
+
+// Values of the columns, includes the values around the sign bit as the SIMD scan compares
+// unsigned values with signed comparisons
+const std::vector<uint64_t> VALUES = {
+    0, 1, 2, 0x7FFF'FFFF'FFFF'FFFF, 0x8000'0000'0000'0000, 0x8000'0000'0000'0001, UINT64_MAX - 1, UINT64_MAX
+};
+
+
+// Sorted records, the first columns take only a few different values so many records share them
+template <std::size_t N>
+std::vector<Record<N>> make_records(uint_fast32_t count, std::mt19937& gen) {
+    std::uniform_int_distribution<std::size_t> dist(0, VALUES.size() - 1);
+
+    std::vector<Record<N>> records(count);
+    for (auto& record : records) {
+        for (std::size_t i = 0; i < N; i++) {
+            record[i] = VALUES[dist(gen)];
+        }
+    }
+    std::sort(records.begin(), records.end());
+    return records;
+}
+
+
+// Every record of the page, and keys that differ from them in one column
+template <std::size_t N>
+std::vector<Record<N>> make_keys(const std::vector<Record<N>>& records) {
+    std::vector<Record<N>> keys(records.begin(), records.end());
+    for (auto& record : records) {
+        for (std::size_t i = 0; i < N; i++) {
+            auto key = record;
+            key[i]--;
+            keys.push_back(key);
+            key[i] += 2;
+            keys.push_back(key);
+        }
+    }
+    Record<N> min_key;
+    Record<N> max_key;
+    min_key.fill(0);
+    max_key.fill(UINT64_MAX);
+    keys.push_back(min_key);
+    keys.push_back(max_key);
+    return keys;
+}
+
+
+template <std::size_t N>
+bool compare_with_std(const std::vector<Record<N>>& records, const std::vector<Record<N>>& keys) {
+    const auto count = static_cast<uint_fast32_t>(records.size());
+    const auto data = reinterpret_cast<const uint64_t*>(records.data());
+
+    for (auto& key : keys) {
+        auto lower = std::lower_bound(records.begin(), records.end(), key) - records.begin();
+        auto upper = std::upper_bound(records.begin(), records.end(), key) - records.begin();
+
+        auto received_lower = BPlusTreeSearch::count_before<N, false>(data, count, key);
+        auto received_upper = BPlusTreeSearch::count_before<N, true>(data, count, key);
+
+        if (received_lower != static_cast<uint_fast32_t>(lower)
+            || received_upper != static_cast<uint_fast32_t>(upper))
+        {
+            std::cerr << "N=" << N << ", " << count << " records, key " << key
+                      << ": received (" << received_lower << ", " << received_upper
+                      << "), expected (" << lower << ", " << upper << ")\n";
+            return true;
+        }
+    }
+    return false;
+}
+
+
+template <std::size_t N>
+bool count_before() {
+    constexpr auto WINDOW = BPlusTreeSearch::WINDOW;
+    // nearly empty pages, the boundaries of the window and of the SIMD scan, and full pages
+    const std::vector<uint_fast32_t> counts = {
+        0, 1, 2, 3, 4, 5, 7,
+        WINDOW - 1, WINDOW, WINDOW + 1, 2*WINDOW - 1, 2*WINDOW, 2*WINDOW + 1, 4*WINDOW + 3,
+        100,
+        BPlusTree<N>::dir_max_records - 1, BPlusTree<N>::dir_max_records,
+        BPlusTree<N>::leaf_max_records - 1, BPlusTree<N>::leaf_max_records,
+    };
+
+    std::mt19937 gen(N);
+    auto error = false;
+
+    for (auto count : counts) {
+        for (int repetition = 0; repetition < 5; repetition++) {
+            auto records = make_records<N>(count, gen);
+            if (compare_with_std<N>(records, make_keys<N>(records))) {
+                error = true;
+            }
+        }
+
+        // all records equal in every column but the last one
+        std::vector<Record<N>> records(count);
+        for (uint_fast32_t i = 0; i < count; i++) {
+            records[i].fill(0x8000'0000'0000'0000);
+            records[i][N - 1] = 2*i + 1;
+        }
+        if (compare_with_std<N>(records, make_keys<N>(records))) {
+            error = true;
+        }
+    }
+    return error;
+}
+
+
+int main() {
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&count_before<1>);
+    tests.push_back(&count_before<2>);
+    tests.push_back(&count_before<3>);
+    tests.push_back(&count_before<4>);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    return error;
+}
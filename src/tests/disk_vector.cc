@@ -0,0 +1,181 @@
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "import/disk_vector.h"
+#include "macros/aligned_alloc.h"
+#include "storage/filesystem.h"
+
+typedef bool TestFunction();
+
+typedef std::array<uint64_t, 2> Record;
+
+const std::string TEST_FOLDER = "disk_vector_test";
+
+constexpr uint64_t BLOCK_SIZE = VPage::SIZE * 2 * sizeof(uint64_t);
+
+// the smallest buffer, merges 2 runs at a time
+constexpr uint64_t BUFFER_SIZE = 6 * BLOCK_SIZE;
+
+constexpr uint64_t RUN_TUPLES = BUFFER_SIZE / sizeof(Record);
+
+// 9 runs (the last one is not full) need the intermediate passes 9 -> 5 -> 3 -> 2
+constexpr uint64_t TUPLE_COUNT = 9 * RUN_TUPLES - 1000;
+
+
+// Saves the records it receives. The first time it is called (i.e. in the final merge)
+// it checks if the files of the intermediate passes exist
+class CollectStat : public Import::StatsProcessor<2> {
+public:
+    CollectStat(const std::string& filename, uint64_t throw_at = UINT64_MAX) :
+        filename (filename),
+        throw_at (throw_at) { }
+
+    std::vector<Record> records;
+
+    bool merge_files_found = false;
+
+    void process_tuple(const Record& record) override {
+        if (records.empty()) {
+            merge_files_found = Filesystem::exists(filename + ".merge0")
+                             && Filesystem::exists(filename + ".merge1");
+        }
+        if (records.size() == throw_at) {
+            throw std::runtime_error("process_tuple failed");
+        }
+        records.push_back(record);
+    }
+
+private:
+    std::string filename;
+
+    uint64_t throw_at;
+};
+
+
+// Fills the disk vector with TUPLE_COUNT random records with many duplicates,
+// returns the records sorted and without duplicates
+std::vector<Record> fill(Import::DiskVector<2>& disk_vector) {
+    std::mt19937 gen(1234);
+    std::uniform_int_distribution<uint64_t> first_dist(0, 2000);
+    std::uniform_int_distribution<uint64_t> second_dist(0, 50);
+
+    std::vector<Record> expected;
+    for (uint64_t i = 0; i < TUPLE_COUNT; i++) {
+        Record record { first_dist(gen), second_dist(gen) };
+        expected.push_back(record);
+        disk_vector.push_back(std::move(record));
+    }
+    disk_vector.finish_appends();
+
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    return expected;
+}
+
+
+bool multi_pass_merge() {
+    auto error = false;
+
+    const auto filename = TEST_FOLDER + "/multi_pass.dat";
+    auto buffer = reinterpret_cast<char*>(MDB_ALIGNED_ALLOC(VPage::SIZE, BUFFER_SIZE));
+
+    Import::DiskVector<2> disk_vector(filename);
+    auto expected = fill(disk_vector);
+    disk_vector.start_indexing(buffer, BUFFER_SIZE, { 0, 1 });
+
+    CollectStat stat(filename);
+    disk_vector.create_bpt(TEST_FOLDER + "/multi_pass", { 0, 1 }, stat);
+
+    if (!stat.merge_files_found) {
+        error = true;
+        std::cerr << "The merge did not use two intermediate passes\n";
+    }
+    if (stat.records != expected) {
+        error = true;
+        std::cerr << "Merge returned " << stat.records.size() << " records, expected "
+                  << expected.size() << " sorted records\n";
+    }
+
+    // the second permutation reorders the columns of the runs before merging them
+    for (auto& record : expected) {
+        std::swap(record[0], record[1]);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    CollectStat inverted_stat(filename);
+    disk_vector.create_bpt(TEST_FOLDER + "/multi_pass_inverted", { 1, 0 }, inverted_stat);
+
+    if (inverted_stat.records != expected) {
+        error = true;
+        std::cerr << "Merge of the inverted permutation returned " << inverted_stat.records.size()
+                  << " records, expected " << expected.size() << " sorted records\n";
+    }
+
+    disk_vector.finish_indexing();
+    MDB_ALIGNED_FREE(buffer);
+
+    if (Filesystem::exists(filename + ".merge0") || Filesystem::exists(filename + ".merge1")) {
+        error = true;
+        std::cerr << "Files of the intermediate passes were not removed\n";
+    }
+    return error;
+}
+
+
+bool merge_files_removed_on_error() {
+    auto error = false;
+
+    const auto filename = TEST_FOLDER + "/merge_error.dat";
+    auto buffer = reinterpret_cast<char*>(MDB_ALIGNED_ALLOC(VPage::SIZE, BUFFER_SIZE));
+
+    Import::DiskVector<2> disk_vector(filename);
+    fill(disk_vector);
+    disk_vector.start_indexing(buffer, BUFFER_SIZE, { 0, 1 });
+
+    CollectStat stat(filename, 1000);
+    try {
+        disk_vector.create_bpt(TEST_FOLDER + "/merge_error", { 0, 1 }, stat);
+        error = true;
+        std::cerr << "The exception of the stats processor was not propagated\n";
+    } catch (const std::runtime_error&) {
+        // expected
+    }
+
+    if (!stat.merge_files_found) {
+        error = true;
+        std::cerr << "The merge did not use two intermediate passes\n";
+    }
+    if (Filesystem::exists(filename + ".merge0") || Filesystem::exists(filename + ".merge1")) {
+        error = true;
+        std::cerr << "Files of the intermediate passes were not removed after an error\n";
+    }
+
+    disk_vector.finish_indexing();
+    MDB_ALIGNED_FREE(buffer);
+    return error;
+}
+
+
+int main() {
+    Filesystem::remove_all(TEST_FOLDER);
+    Filesystem::create_directories(TEST_FOLDER);
+
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&multi_pass_merge);
+    tests.push_back(&merge_files_removed_on_error);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    Filesystem::remove_all(TEST_FOLDER);
+
+    return error;
+}
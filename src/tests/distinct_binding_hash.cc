@@ -0,0 +1,180 @@
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "graph_models/object_id.h"
+#include "query/query_context.h"
+#include "storage/buffer_manager.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/index/hash/distinct_binding_hash/distinct_binding_hash.h"
+
+typedef bool TestFunction();
+
+const std::string DB_FOLDER = "distinct_binding_hash_test_db";
+
+constexpr uint64_t TUPLE_SIZE = 3;
+
+// memory budget small enough to spill after a few thousand tuples
+constexpr uint64_t SMALL_BUDGET = 64 * 1024;
+
+// with 1024 initial buckets the spilled hash needs to split buckets to hold these tuples
+constexpr uint64_t INSERTIONS = 400'000;
+
+
+// Random tuples from a small domain, so there are many duplicates
+std::vector<std::vector<ObjectId>> make_tuples(uint64_t count, uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_int_distribution<uint64_t> dist(1, 80);
+
+    std::vector<std::vector<ObjectId>> tuples;
+    tuples.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        std::vector<ObjectId> tuple;
+        for (uint64_t j = 0; j < TUPLE_SIZE; j++) {
+            tuple.push_back(ObjectId(dist(gen)));
+        }
+        tuples.push_back(std::move(tuple));
+    }
+    return tuples;
+}
+
+
+// Inserts the same tuples into a hash that spills and into a hash that stays in memory,
+// both must report the same duplicates
+bool spill_matches_in_memory() {
+    auto error = false;
+
+    DistinctBindingHash<ObjectId> spilled(TUPLE_SIZE, SMALL_BUDGET);
+    DistinctBindingHash<ObjectId> in_memory(TUPLE_SIZE);
+
+    std::set<std::vector<uint64_t>> expected;
+
+    auto tuples = make_tuples(INSERTIONS, 1);
+    uint64_t mismatches = 0;
+    uint64_t spilled_distinct = 0;
+
+    for (auto& tuple : tuples) {
+        auto spilled_res = spilled.is_in_or_insert(tuple);
+        auto in_memory_res = in_memory.is_in_or_insert(tuple);
+
+        std::vector<uint64_t> ids;
+        for (auto& oid : tuple) {
+            ids.push_back(oid.id);
+        }
+        auto expected_res = !expected.insert(ids).second;
+
+        if (spilled_res != in_memory_res || spilled_res != expected_res) {
+            mismatches++;
+        }
+        if (!spilled_res) {
+            spilled_distinct++;
+        }
+    }
+
+    if (!spilled.is_spilled() || in_memory.is_spilled()) {
+        error = true;
+        std::cerr << "Expected only the hash with the small budget to spill\n";
+    }
+    if (mismatches > 0) {
+        error = true;
+        std::cerr << mismatches << " insertions differ between the spilled and the in-memory hash\n";
+    }
+    if (spilled_distinct != expected.size()) {
+        error = true;
+        std::cerr << "The spilled hash has " << spilled_distinct << " distinct tuples, expected "
+                  << expected.size() << "\n";
+    }
+
+    // is_in with tuples inserted and not inserted
+    mismatches = 0;
+    for (auto& tuple : make_tuples(50'000, 2)) {
+        if (spilled.is_in(tuple) != in_memory.is_in(tuple)) {
+            mismatches++;
+        }
+        std::vector<ObjectId> missing = tuple;
+        missing[0] = ObjectId(missing[0].id + 1000);
+        if (spilled.is_in(missing) || in_memory.is_in(missing)) {
+            mismatches++;
+        }
+    }
+    if (mismatches > 0) {
+        error = true;
+        std::cerr << mismatches << " lookups differ between the spilled and the in-memory hash\n";
+    }
+    return error;
+}
+
+
+// After a reset the spilled hash goes back to memory and can spill again
+bool reset_after_spill() {
+    auto error = false;
+
+    DistinctBindingHash<ObjectId> hash(TUPLE_SIZE, SMALL_BUDGET);
+
+    auto tuples = make_tuples(INSERTIONS / 4, 3);
+    for (auto& tuple : tuples) {
+        hash.is_in_or_insert(tuple);
+    }
+    if (!hash.is_spilled()) {
+        error = true;
+        std::cerr << "Expected the hash to spill\n";
+    }
+
+    hash.reset();
+    if (hash.is_spilled()) {
+        error = true;
+        std::cerr << "The hash is still spilled after a reset\n";
+    }
+    if (hash.is_in(tuples[0])) {
+        error = true;
+        std::cerr << "A tuple inserted before the reset was found\n";
+    }
+
+    uint64_t mismatches = 0;
+    for (auto& tuple : tuples) {
+        hash.is_in_or_insert(tuple);
+    }
+    for (auto& tuple : tuples) {
+        if (!hash.is_in(tuple)) {
+            mismatches++;
+        }
+    }
+    if (!hash.is_spilled() || mismatches > 0) {
+        error = true;
+        std::cerr << "Inserting again after a reset lost " << mismatches << " tuples\n";
+    }
+    return error;
+}
+
+
+int main() {
+    Filesystem::remove_all(DB_FOLDER);
+    FileManager::init(DB_FOLDER);
+    // a small private buffer, so the buckets of the spilled hashes are evicted to their file
+    BufferManager::init(BufferManager::DEFAULT_VERSIONED_PAGES_BUFFER_SIZE / 64,
+                        1024 * PPage::SIZE,
+                        BufferManager::DEFAULT_UNVERSIONED_PAGES_BUFFER_SIZE / 64,
+                        1);
+
+    QueryContext qc;
+    QueryContext::set_query_ctx(&qc);
+
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&spill_matches_in_memory);
+    tests.push_back(&reset_after_spill);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    Filesystem::remove_all(DB_FOLDER);
+
+    return error;
+}
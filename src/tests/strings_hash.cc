@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "graph_models/object_id.h"
+#include "macros/aligned_alloc.h"
+#include "storage/buffer_manager.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/index/hash/strings_hash/strings_hash_bulk_ondisk_import.h"
+#include "storage/string_manager.h"
+
+typedef bool TestFunction();
+
+const std::string DB_FOLDER = "strings_hash_test_db";
+
+// inserted before the threads start, their ids must never change
+constexpr uint64_t PRELOADED = 50'000;
+
+// inserted by every writer thread in a different order, much more than what the
+// initial 256 buckets hold, so buckets are split and the directory is duplicated
+constexpr uint64_t INSERTED = 300'000;
+
+constexpr uint64_t WRITERS = 4;
+
+constexpr uint64_t READERS = 4;
+
+
+std::string make_string(const std::string& prefix, uint64_t i) {
+    return prefix + " string number " + std::to_string(i);
+}
+
+
+// A database folder with an empty strings file and an empty strings hash
+void create_empty_db() {
+    Filesystem::remove_all(DB_FOLDER);
+    Filesystem::create_directories(DB_FOLDER);
+
+    std::fstream strings_file;
+    strings_file.open(DB_FOLDER + "/strings.dat", std::ios::out|std::ios::binary);
+    std::vector<char> block(StringManager::STRING_BLOCK_SIZE, 0);
+    uint64_t last_block_offset = StringManager::METADATA_SIZE;
+    std::memcpy(block.data(), &last_block_offset, sizeof(last_block_offset));
+    strings_file.write(block.data(), block.size());
+    strings_file.close();
+
+    const uint64_t buffer_size = 1024 * UPage::SIZE;
+    auto buffer = reinterpret_cast<char*>(MDB_ALIGNED_ALLOC(UPage::SIZE, buffer_size));
+    {
+        StringsHashBulkOnDiskImport strings_hash(DB_FOLDER + "/str_hash", buffer, buffer_size);
+    }
+    MDB_ALIGNED_FREE(buffer);
+}
+
+
+// Writers call get_or_create on the same strings concurrently while readers look up the
+// strings that existed before, every string must get a single id that never changes
+bool concurrent_inserts_and_lookups() {
+    auto error = false;
+
+    std::vector<uint64_t> preloaded_ids(PRELOADED);
+    for (uint64_t i = 0; i < PRELOADED; i++) {
+        auto str = make_string("preloaded", i);
+        preloaded_ids[i] = string_manager.get_or_create(str.data(), str.size());
+    }
+
+    std::vector<std::vector<uint64_t>> inserted_ids(WRITERS, std::vector<uint64_t>(INSERTED));
+    std::atomic<uint64_t> writers_running { WRITERS };
+    std::atomic<uint64_t> lookup_errors { 0 };
+    std::atomic<uint64_t> lookups { 0 };
+
+    std::vector<std::thread> threads;
+    for (uint64_t w = 0; w < WRITERS; w++) {
+        threads.emplace_back([&, w]() {
+            std::vector<uint64_t> order(INSERTED);
+            for (uint64_t i = 0; i < INSERTED; i++) {
+                order[i] = i;
+            }
+            std::shuffle(order.begin(), order.end(), std::mt19937(w));
+
+            for (auto i : order) {
+                auto str = make_string("inserted", i);
+                inserted_ids[w][i] = string_manager.get_or_create(str.data(), str.size());
+            }
+            writers_running--;
+        });
+    }
+    for (uint64_t r = 0; r < READERS; r++) {
+        threads.emplace_back([&, r]() {
+            std::mt19937 gen(WRITERS + r);
+            std::uniform_int_distribution<uint64_t> dist(0, PRELOADED - 1);
+            uint64_t local_lookups = 0;
+            while (writers_running > 0) {
+                auto i = dist(gen);
+                auto str = make_string("preloaded", i);
+                if (string_manager.get_str_id(str) != preloaded_ids[i]) {
+                    lookup_errors++;
+                }
+                auto missing = make_string("missing", i);
+                if (string_manager.get_str_id(missing) != ObjectId::MASK_NOT_FOUND) {
+                    lookup_errors++;
+                }
+                local_lookups++;
+            }
+            lookups += local_lookups;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (lookups == 0) {
+        error = true;
+        std::cerr << "The readers finished before doing any lookup\n";
+    }
+    if (lookup_errors > 0) {
+        error = true;
+        std::cerr << lookup_errors << " of " << lookups << " lookups during the inserts were wrong\n";
+    }
+
+    // all writers must have received the same id for each string
+    uint64_t different_ids = 0;
+    for (uint64_t i = 0; i < INSERTED; i++) {
+        for (uint64_t w = 1; w < WRITERS; w++) {
+            if (inserted_ids[w][i] != inserted_ids[0][i]) {
+                different_ids++;
+            }
+        }
+    }
+    if (different_ids > 0) {
+        error = true;
+        std::cerr << different_ids << " strings got different ids in different threads\n";
+    }
+
+    // ids are unique, so no string was appended twice
+    std::vector<uint64_t> all_ids(inserted_ids[0].begin(), inserted_ids[0].end());
+    all_ids.insert(all_ids.end(), preloaded_ids.begin(), preloaded_ids.end());
+    std::sort(all_ids.begin(), all_ids.end());
+    if (std::adjacent_find(all_ids.begin(), all_ids.end()) != all_ids.end()) {
+        error = true;
+        std::cerr << "Different strings have the same id\n";
+    }
+
+    // after the inserts every string is found with its id, and the id points to the string
+    uint64_t wrong_ids = 0;
+    for (uint64_t i = 0; i < INSERTED; i++) {
+        auto str = make_string("inserted", i);
+        auto id = inserted_ids[0][i];
+        if (string_manager.get_str_id(str) != id || !string_manager.str_eq(str, id)) {
+            wrong_ids++;
+        }
+    }
+    for (uint64_t i = 0; i < PRELOADED; i++) {
+        auto str = make_string("preloaded", i);
+        if (string_manager.get_str_id(str) != preloaded_ids[i]) {
+            wrong_ids++;
+        }
+    }
+    if (wrong_ids > 0) {
+        error = true;
+        std::cerr << wrong_ids << " strings are not found with their id after the inserts\n";
+    }
+    return error;
+}
+
+
+int main() {
+    create_empty_db();
+
+    FileManager::init(DB_FOLDER);
+    // fewer unversioned pages than buckets, so the buckets are evicted and read again
+    BufferManager::init(BufferManager::DEFAULT_VERSIONED_PAGES_BUFFER_SIZE / 64,
+                        BufferManager::DEFAULT_PRIVATE_PAGES_BUFFER_SIZE,
+                        512 * UPage::SIZE,
+                        1);
+    StringManager::init(0);
+
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&concurrent_inserts_and_lookups);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    Filesystem::remove_all(DB_FOLDER);
+
+    return error;
+}
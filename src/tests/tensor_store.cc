@@ -0,0 +1,182 @@
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "query/exceptions.h"
+#include "query/query_context.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/index/tensor_store/lsh/metric.h"
+#include "storage/index/tensor_store/tensor_store.h"
+
+typedef bool TestFunction();
+
+constexpr uint64_t DIM          = 16;
+constexpr uint64_t BUFFER_SIZE  = 16ULL * 1024 * 1024;
+constexpr uint64_t TENSOR_COUNT = 500;
+
+const std::string DB_FOLDER = "tensor_store_test_db";
+
+
+std::vector<float> make_tensor(uint64_t seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+
+    std::vector<float> tensor(DIM);
+    for (auto& value : tensor) {
+        value = dist(gen);
+    }
+    return tensor;
+}
+
+
+// Creates a store with the objects 1..TENSOR_COUNT, tensor of object i is make_tensor(i)
+void create_store(const std::string& name) {
+    TensorStore tensor_store(name, DIM, BUFFER_SIZE);
+    for (uint64_t id = 1; id <= TENSOR_COUNT; id++) {
+        tensor_store.insert(id, make_tensor(id));
+    }
+    tensor_store.serialize();
+}
+
+
+// Checks that each object in ids is its own nearest neighbor and that no removed object is returned
+// (ids_and_seeds are pairs of object id and the seed of its tensor)
+bool check_queries(const TensorStore&                                tensor_store,
+                   const std::vector<std::pair<uint64_t, uint64_t>>& ids_and_seeds,
+                   uint64_t                                          removed_end)
+{
+    auto error = false;
+
+    for (auto& [id, seed] : ids_and_seeds) {
+        auto res = tensor_store.query_top_k(make_tensor(seed), 10);
+        if (res.empty() || res[0].first != id || res[0].second != 0.0f) {
+            error = true;
+            std::cerr << "Object " << id << " is not its own nearest neighbor\n";
+        }
+        for (auto& [object_id, distance] : res) {
+            if (object_id <= removed_end) {
+                error = true;
+                std::cerr << "Removed object " << object_id << " returned by a query\n";
+            }
+        }
+    }
+    return error;
+}
+
+
+bool insert_replace_remove() {
+    create_store("modify");
+
+    TensorStore tensor_store("modify", BUFFER_SIZE, false);
+    tensor_store.build_forest_index(LSH::MetricType::EUCLIDEAN, 4, 16, 20);
+
+    auto error = false;
+
+    // remove 1..50, replace 51..100 and insert enough objects to split the leaves
+    for (uint64_t id = 1; id <= 50; id++) {
+        if (!tensor_store.remove(id)) {
+            error = true;
+            std::cerr << "Could not remove object " << id << "\n";
+        }
+    }
+    if (tensor_store.remove(1)) {
+        error = true;
+        std::cerr << "Object 1 removed twice\n";
+    }
+    for (uint64_t id = 51; id <= 100; id++) {
+        tensor_store.insert(id, make_tensor(id + 10'000));
+    }
+    for (uint64_t id = TENSOR_COUNT + 1; id <= TENSOR_COUNT + 300; id++) {
+        tensor_store.insert(id, make_tensor(id));
+    }
+
+    if (tensor_store.size() != TENSOR_COUNT + 250) {
+        error = true;
+        std::cerr << "Size is " << tensor_store.size() << ", expected " << TENSOR_COUNT + 250 << "\n";
+    }
+
+    std::vector<float> tensor(DIM);
+    if (tensor_store.contains(1) || tensor_store.get(50, tensor)) {
+        error = true;
+        std::cerr << "Removed objects are still in the store\n";
+    }
+    if (!tensor_store.get(51, tensor) || tensor != make_tensor(10'051)) {
+        error = true;
+        std::cerr << "Object 51 does not have its new tensor\n";
+    }
+    if (!tensor_store.get(TENSOR_COUNT + 1, tensor) || tensor != make_tensor(TENSOR_COUNT + 1)) {
+        error = true;
+        std::cerr << "Object " << TENSOR_COUNT + 1 << " does not have its tensor\n";
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> ids_and_seeds;
+    for (uint64_t id = 51; id <= TENSOR_COUNT + 300; id += 7) {
+        ids_and_seeds.emplace_back(id, id <= 100 ? id + 10'000 : id);
+    }
+    if (check_queries(tensor_store, ids_and_seeds, 50)) {
+        error = true;
+    }
+    return error;
+}
+
+
+bool quantize_after_modifications() {
+    create_store("quantize");
+
+    TensorStore tensor_store("quantize", BUFFER_SIZE, false);
+    tensor_store.build_forest_index(LSH::MetricType::EUCLIDEAN, 4, 16, 20);
+
+    // the removed objects stay in the trees, and the replaced tensors get slots after the last tensor
+    for (uint64_t id = 1; id <= 50; id++) {
+        tensor_store.remove(id);
+    }
+    for (uint64_t id = 51; id <= 100; id++) {
+        tensor_store.insert(id, make_tensor(id + 10'000));
+    }
+
+    tensor_store.build_quantized_tensors();
+
+    auto error = false;
+
+    std::vector<std::pair<uint64_t, uint64_t>> ids_and_seeds;
+    for (uint64_t id = 51; id <= TENSOR_COUNT; id += 7) {
+        ids_and_seeds.emplace_back(id, id <= 100 ? id + 10'000 : id);
+    }
+    if (check_queries(tensor_store, ids_and_seeds, 50)) {
+        error = true;
+    }
+
+    try {
+        tensor_store.insert(TENSOR_COUNT + 1, make_tensor(TENSOR_COUNT + 1));
+        error = true;
+        std::cerr << "A store with quantized tensors was modified\n";
+    } catch (const LogicException&) {
+        // expected
+    }
+    return error;
+}
+
+
+int main() {
+    Filesystem::remove_all(DB_FOLDER);
+    FileManager::init(DB_FOLDER);
+
+    QueryContext qc;
+    QueryContext::set_query_ctx(&qc);
+
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&insert_replace_remove);
+    tests.push_back(&quantize_after_modifications);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    return error;
+}
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "misc/metrics.h"
+#include "query/query_context.h"
+#include "storage/buffer_manager.h"
+#include "storage/file_manager.h"
+#include "storage/filesystem.h"
+#include "storage/page/versioned_page_delta.h"
+
+typedef bool TestFunction();
+
+const std::string DB_FOLDER = "versioned_pages_test_db";
+
+constexpr uint64_t WORDS = VPage::SIZE / sizeof(uint64_t);
+
+// frames of the versioned buffer, reading every page of the file evicts the old versions
+constexpr uint64_t POOL_PAGES = 16;
+
+constexpr uint64_t FILE_PAGES = 4 * POOL_PAGES;
+
+// updates of the first page while a query reads each of its versions
+constexpr uint64_t UPDATES = 6;
+
+
+// Content of a page before the updates
+uint64_t initial_word(uint64_t page_number, uint64_t word) {
+    return page_number * WORDS + word + 1;
+}
+
+
+// Content of the first page after `updates` updates, update u modifies a word and a range of words
+std::vector<uint64_t> expected_first_page(uint64_t updates) {
+    std::vector<uint64_t> words(WORDS);
+    for (uint64_t w = 0; w < WORDS; w++) {
+        words[w] = initial_word(0, w);
+    }
+    for (uint64_t u = 1; u <= updates; u++) {
+        words[u] = UINT64_MAX - u;
+        for (uint64_t w = WORDS / 2; w < WORDS / 2 + 4 * u; w++) {
+            words[w] = u;
+        }
+    }
+    return words;
+}
+
+
+bool check_first_page(FileId file_id, uint64_t version, uint64_t updates) {
+    auto& qc = get_query_ctx();
+    qc.start_version  = version;
+    qc.result_version = version;
+
+    auto& page = buffer_manager.get_page_readonly(file_id, 0);
+    auto words = reinterpret_cast<const uint64_t*>(page.get_bytes());
+    auto expected = expected_first_page(updates);
+    auto error = !std::equal(expected.begin(), expected.end(), words);
+    buffer_manager.unpin(page);
+
+    if (error) {
+        std::cerr << "version " << version << " of the page doesn't have " << updates << " updates\n";
+    }
+    return error;
+}
+
+
+// Reads every page of the file with the last version, so the frames of the old versions are reused
+void read_all_pages(FileId file_id) {
+    auto& qc = get_query_ctx();
+    qc.start_version  = buffer_manager.get_last_stable_version();
+    qc.result_version = qc.start_version;
+
+    for (uint64_t i = 0; i < FILE_PAGES; i++) {
+        auto& page = buffer_manager.get_page_readonly(file_id, i);
+        buffer_manager.unpin(page);
+    }
+}
+
+
+// Random pages modified in different patterns, applying the delta to the new page gives the old page
+bool delta_round_trip() {
+    auto error = false;
+
+    std::mt19937_64 gen(1);
+    std::vector<uint64_t> old_words(WORDS);
+    std::vector<uint64_t> new_words(WORDS);
+    auto old_bytes = reinterpret_cast<char*>(old_words.data());
+    auto new_bytes = reinterpret_cast<char*>(new_words.data());
+
+    // each pattern returns whether the word is modified
+    const std::vector<std::pair<std::string, std::function<bool(uint64_t)>>> patterns = {
+        { "no words",        [](uint64_t)   { return false; } },
+        { "first word",      [](uint64_t w) { return w == 0; } },
+        { "last word",       [](uint64_t w) { return w == WORDS - 1; } },
+        { "every word",      [](uint64_t)   { return true; } },
+        { "every 2nd word",  [](uint64_t w) { return w % 2 == 0; } },
+        { "every 3rd word",  [](uint64_t w) { return w % 3 == 0; } },
+        { "a range",         [](uint64_t w) { return w >= 10 && w < 20; } },
+        { "random words",    [&gen](uint64_t) { return gen() % 5 == 0; } },
+    };
+    for (auto& [name, is_modified] : patterns) {
+        for (uint64_t w = 0; w < WORDS; w++) {
+            new_words[w] = gen();
+            old_words[w] = is_modified(w) ? gen() : new_words[w];
+        }
+        VPageDelta delta(1, old_bytes, new_bytes);
+        delta.apply(new_bytes);
+        if (new_words != old_words) {
+            error = true;
+            std::cerr << "delta_round_trip: applying the delta of " << name << " gives a wrong page\n";
+        }
+    }
+
+    // a delta only stores the modified words
+    for (uint64_t w = 0; w < WORDS; w++) {
+        old_words[w] = new_words[w];
+    }
+    old_words[WORDS / 2] = 0;
+    VPageDelta delta(1, old_bytes, new_bytes);
+    if (delta.size() > sizeof(VPageDelta) + 2 * sizeof(uint64_t)) {
+        error = true;
+        std::cerr << "delta_round_trip: the delta of 1 word uses " << delta.size() << " bytes\n";
+    }
+    return error;
+}
+
+
+// Queries read every version of a page while the frames of the old versions are reused, the versions
+// are materialized again from their deltas
+bool old_versions_after_eviction() {
+    auto error = false;
+    auto& qc = get_query_ctx();
+
+    auto file_id = file_manager.get_file_id("versioned_pages.dat");
+    {
+        auto scope = buffer_manager.init_version_editable();
+        qc.start_version  = scope->start_version;
+        qc.result_version = scope->start_version + 1;
+        for (uint64_t i = 0; i < FILE_PAGES; i++) {
+            auto& page = buffer_manager.append_vpage(file_id);
+            auto words = reinterpret_cast<uint64_t*>(page.get_bytes());
+            for (uint64_t w = 0; w < WORDS; w++) {
+                words[w] = initial_word(i, w);
+            }
+            buffer_manager.unpin(page);
+        }
+    }
+    const auto first_version = buffer_manager.get_last_stable_version();
+
+    // a query starts on each version before the next update
+    std::vector<std::unique_ptr<BufferManager::VersionScope>> queries;
+    for (uint64_t u = 1; u <= UPDATES; u++) {
+        queries.push_back(buffer_manager.init_version_readonly());
+        if (check_first_page(file_id, first_version + u - 1, u - 1)) {
+            error = true;
+        }
+
+        auto scope = buffer_manager.init_version_editable();
+        qc.start_version  = scope->start_version;
+        qc.result_version = scope->start_version + 1;
+
+        auto& page = buffer_manager.get_page_editable(file_id, 0);
+        auto words = reinterpret_cast<uint64_t*>(page.get_bytes());
+        words[u] = UINT64_MAX - u;
+        for (uint64_t w = WORDS / 2; w < WORDS / 2 + 4 * u; w++) {
+            words[w] = u;
+        }
+        buffer_manager.unpin(page);
+    }
+
+    if (metrics.page_delta_bytes == 0) {
+        error = true;
+        std::cerr << "old_versions_after_eviction: no deltas were kept\n";
+    }
+
+    const auto materializations = metrics.page_delta_materializations.load();
+    for (int repetition = 0; repetition < 2; repetition++) {
+        for (uint64_t v = 1; v <= UPDATES + 1; v++) {
+            read_all_pages(file_id);
+            if (check_first_page(file_id, first_version + v - 1, v - 1)) {
+                error = true;
+            }
+        }
+    }
+    if (metrics.page_delta_materializations == materializations) {
+        error = true;
+        std::cerr << "old_versions_after_eviction: no version was materialized\n";
+    }
+
+    // once the queries finish, the next update discards the deltas
+    queries.clear();
+    {
+        auto scope = buffer_manager.init_version_editable();
+        qc.start_version  = scope->start_version;
+        qc.result_version = scope->start_version + 1;
+        auto& page = buffer_manager.get_page_editable(file_id, 0);
+        buffer_manager.unpin(page);
+    }
+    if (metrics.page_delta_bytes != 0) {
+        error = true;
+        std::cerr << "old_versions_after_eviction: " << metrics.page_delta_bytes
+                  << " bytes of deltas were kept after the queries finished\n";
+    }
+    if (check_first_page(file_id, buffer_manager.get_last_stable_version(), UPDATES)) {
+        error = true;
+    }
+    return error;
+}
+
+
+int main() {
+    Filesystem::remove_all(DB_FOLDER);
+    Filesystem::create_directories(DB_FOLDER);
+
+    FileManager::init(DB_FOLDER);
+    BufferManager::init(POOL_PAGES * VPage::SIZE,
+                        POOL_PAGES * PPage::SIZE,
+                        POOL_PAGES * UPage::SIZE,
+                        1);
+
+    QueryContext qc;
+    QueryContext::set_query_ctx(&qc);
+
+    std::vector<TestFunction*> tests;
+
+    tests.push_back(&delta_round_trip);
+    tests.push_back(&old_versions_after_eviction);
+
+    auto error = false;
+
+    for (auto& test_func : tests) {
+        if (test_func()) {
+            error = true;
+        }
+    }
+
+    Filesystem::remove_all(DB_FOLDER);
+
+    return error;
+}
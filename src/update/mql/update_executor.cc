@@ -0,0 +1,289 @@
+#include "update_executor.h"
+
+#include <algorithm>
+
+#include "graph_models/quad_model/quad_model.h"
+#include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/random_access_table/random_access_table.h"
+#include "storage/string_manager.h"
+#include "storage/tmp_manager.h"
+
+using namespace MQL;
+
+namespace {
+constexpr uint64_t CLEAR_TMP_MASK = ~(ObjectId::MOD_MASK | ObjectId::MASK_EXTERNAL_ID);
+
+
+template <std::size_t N>
+void sort_records(std::vector<Record<N>>& records) {
+    std::sort(records.begin(), records.end());
+    records.erase(std::unique(records.begin(), records.end()), records.end());
+}
+
+
+// returns true if the B+tree has a record starting with the first `prefix` columns of the record
+template <std::size_t N>
+bool has_prefix(const BPlusTree<N>& bpt, const Record<N>& record, std::size_t prefix) {
+    Record<N> min = record;
+    Record<N> max = record;
+    for (std::size_t i = prefix; i < N; i++) {
+        min[i] = 0;
+        max[i] = UINT64_MAX;
+    }
+    bool interruption_requested = false;
+    auto it = bpt.get_range(&interruption_requested, min, max);
+    return it.next() != nullptr;
+}
+
+
+// Inserts the sorted records, returning the ones that were not in the B+tree
+template <std::size_t N>
+std::vector<Record<N>> insert_sorted(BPlusTree<N>& bpt, const std::vector<Record<N>>& records) {
+    std::vector<Record<N>> res;
+    for (auto& record : records) {
+        if (bpt.insert(record)) {
+            res.push_back(record);
+        }
+    }
+    return res;
+}
+
+
+// Inserts the sorted records, they must not be in the B+tree. Before inserting the first record of each
+// distinct value of the first `prefix` columns, `on_new_prefix` is called if the B+tree didn't have that value
+template <std::size_t N, typename F>
+void insert_sorted_new(BPlusTree<N>& bpt, const std::vector<Record<N>>& records, std::size_t prefix, F on_new_prefix) {
+    for (std::size_t i = 0; i < records.size(); i++) {
+        auto& record = records[i];
+        if (i == 0 || !std::equal(record.begin(), record.begin() + prefix, records[i - 1].begin())) {
+            if (!has_prefix(bpt, record, prefix)) {
+                on_new_prefix(record);
+            }
+        }
+        bpt.insert(record);
+    }
+}
+
+
+template <std::size_t N>
+void insert_sorted_new(BPlusTree<N>& bpt, const std::vector<Record<N>>& records) {
+    for (auto& record : records) {
+        bpt.insert(record);
+    }
+}
+} // namespace
+
+
+ObjectId UpdateExecutor::materialize(ObjectId oid) {
+    if (oid.is_tmp()) {
+        auto& str = tmp_manager.get_str(oid.id & ObjectId::MASK_EXTERNAL_ID);
+        auto new_external_id = string_manager.get_or_create(str.data(), str.size());
+
+        oid.id = (oid.id & CLEAR_TMP_MASK) | ObjectId::MOD_EXTERNAL | new_external_id;
+    }
+    return oid;
+}
+
+
+void UpdateExecutor::visit(OpInsert& op_insert) {
+    std::vector<Record<1>> nodes;
+    std::vector<Record<2>> labels;
+    std::vector<Record<3>> properties;
+    std::vector<Record<4>> edges;
+
+    for (auto& op_label : op_insert.labels) {
+        auto node  = materialize(op_label.node.get_OID());
+        auto label = materialize(op_label.label.get_OID());
+        labels.push_back({ node.id, label.id });
+        nodes.push_back({ node.id });
+    }
+
+    for (auto& op_property : op_insert.properties) {
+        auto obj   = materialize(op_property.node.get_OID());
+        auto key   = materialize(op_property.key);
+        auto value = materialize(op_property.value.get_OID());
+        properties.push_back({ obj.id, key.id, value.id });
+        if ((obj.id & ObjectId::GENERIC_TYPE_MASK) != ObjectId::MASK_EDGE) {
+            nodes.push_back({ obj.id });
+        }
+    }
+
+    // every inserted edge is a new one, the ids are consecutive and the first edge has the id 1
+    auto next_edge = quad_model.catalog().connections_count + 1;
+    for (auto& op_edge : op_insert.edges) {
+        auto from = materialize(op_edge.from.get_OID());
+        auto to   = materialize(op_edge.to.get_OID());
+        auto type = materialize(op_edge.type.get_OID());
+        edges.push_back({ from.id, to.id, type.id, next_edge++ | ObjectId::MASK_EDGE });
+        nodes.push_back({ from.id });
+        nodes.push_back({ to.id });
+        nodes.push_back({ type.id });
+    }
+
+    insert_edges(edges);
+    insert_nodes(nodes);
+    insert_labels(labels);
+    insert_properties(properties);
+
+    if (nodes_inserted + labels_inserted + properties_inserted + edges_inserted > 0) {
+        quad_model.catalog().has_changes = true;
+    }
+}
+
+
+void UpdateExecutor::insert_nodes(std::vector<Record<1>>& nodes) {
+    auto& catalog = quad_model.catalog();
+
+    sort_records(nodes);
+    auto new_nodes = insert_sorted(*quad_model.nodes, nodes);
+
+    for (auto& node : new_nodes) {
+        if ((node[0] & ObjectId::TYPE_MASK) == ObjectId::MASK_ANON_INLINED) {
+            catalog.anonymous_nodes_count = std::max(catalog.anonymous_nodes_count,
+                                                     node[0] & ObjectId::VALUE_MASK);
+        }
+    }
+    catalog.identifiable_nodes_count += new_nodes.size();
+    nodes_inserted += new_nodes.size();
+}
+
+
+void UpdateExecutor::insert_labels(std::vector<Record<2>>& labels) {
+    auto& catalog = quad_model.catalog();
+
+    sort_records(labels);
+    auto new_labels = insert_sorted(*quad_model.node_label, labels);
+
+    for (auto& record : new_labels) {
+        std::swap(record[0], record[1]);
+        if (catalog.label2total_count[record[0]]++ == 0) {
+            catalog.distinct_labels++;
+        }
+    }
+    std::sort(new_labels.begin(), new_labels.end());
+    insert_sorted_new(*quad_model.label_node, new_labels);
+
+    catalog.label_count += new_labels.size();
+    labels_inserted += new_labels.size();
+}
+
+
+void UpdateExecutor::insert_properties(std::vector<Record<3>>& properties) {
+    auto& catalog = quad_model.catalog();
+
+    sort_records(properties);
+    auto new_properties = insert_sorted(*quad_model.object_key_value, properties);
+
+    for (auto& record : new_properties) {
+        record = { record[1], record[2], record[0] };
+        if (catalog.key2total_count[record[0]]++ == 0) {
+            catalog.distinct_keys++;
+        }
+    }
+    std::sort(new_properties.begin(), new_properties.end());
+    insert_sorted_new(*quad_model.key_value_object, new_properties, 2, [&](const Record<3>& record) {
+        catalog.key2distinct[record[0]]++;
+    });
+
+    catalog.properties_count += new_properties.size();
+    properties_inserted += new_properties.size();
+}
+
+
+void UpdateExecutor::insert_edges(std::vector<Record<4>>& edges) {
+    if (edges.empty()) {
+        return;
+    }
+    auto& catalog = quad_model.catalog();
+
+    std::vector<Record<3>> table_records;
+    std::vector<Record<3>> equal_from_to;
+    std::vector<Record<3>> equal_from_type;
+    std::vector<Record<3>> equal_to_type;
+    std::vector<Record<2>> equal_from_to_type;
+    std::vector<Record<3>> equal_from_to_inverted;
+    std::vector<Record<3>> equal_from_type_inverted;
+    std::vector<Record<3>> equal_to_type_inverted;
+
+    for (auto& [from, to, type, edge] : edges) {
+        // the edges are in the order of their ids, that is the order of the table
+        table_records.push_back({ from, to, type });
+
+        if (catalog.type2total_count[type]++ == 0) {
+            catalog.distinct_type++;
+        }
+
+        if (from == to) {
+            equal_from_to.push_back({ from, type, edge });
+            equal_from_to_inverted.push_back({ type, from, edge });
+            catalog.equal_from_to_count++;
+            catalog.type2equal_from_to_count[type]++;
+
+            if (from == type) {
+                equal_from_to_type.push_back({ from, edge });
+                catalog.equal_from_to_type_count++;
+                catalog.type2equal_from_to_type_count[type]++;
+            }
+        }
+        if (from == type) {
+            equal_from_type.push_back({ from, to, edge });
+            equal_from_type_inverted.push_back({ to, from, edge });
+            catalog.equal_from_type_count++;
+            catalog.type2equal_from_type_count[type]++;
+        }
+        if (to == type) {
+            equal_to_type.push_back({ to, from, edge });
+            equal_to_type_inverted.push_back({ from, to, edge });
+            catalog.equal_to_type_count++;
+            catalog.type2equal_to_type_count[type]++;
+        }
+    }
+    quad_model.edge_table->append_records(table_records);
+
+    // The edges are new, so only their first columns can be already in the B+trees
+    std::sort(edges.begin(), edges.end());
+    insert_sorted_new(*quad_model.from_to_type_edge, edges, 1, [&](const Record<4>&) {
+        catalog.distinct_from++;
+    });
+
+    for (auto& record : edges) {
+        record = { record[1], record[2], record[0], record[3] };
+    }
+    std::sort(edges.begin(), edges.end());
+    insert_sorted_new(*quad_model.to_type_from_edge, edges, 1, [&](const Record<4>&) {
+        catalog.distinct_to++;
+    });
+
+    // (to, type, from, edge) -> (type, from, to, edge)
+    for (auto& record : edges) {
+        record = { record[1], record[2], record[0], record[3] };
+    }
+    std::sort(edges.begin(), edges.end());
+    insert_sorted_new(*quad_model.type_from_to_edge, edges);
+
+    // (type, from, to, edge) -> (type, to, from, edge)
+    for (auto& record : edges) {
+        std::swap(record[1], record[2]);
+    }
+    std::sort(edges.begin(), edges.end());
+    insert_sorted_new(*quad_model.type_to_from_edge, edges);
+
+    std::sort(equal_from_to.begin(), equal_from_to.end());
+    std::sort(equal_from_type.begin(), equal_from_type.end());
+    std::sort(equal_to_type.begin(), equal_to_type.end());
+    std::sort(equal_from_to_type.begin(), equal_from_to_type.end());
+    std::sort(equal_from_to_inverted.begin(), equal_from_to_inverted.end());
+    std::sort(equal_from_type_inverted.begin(), equal_from_type_inverted.end());
+    std::sort(equal_to_type_inverted.begin(), equal_to_type_inverted.end());
+
+    insert_sorted_new(*quad_model.equal_from_to, equal_from_to);
+    insert_sorted_new(*quad_model.equal_from_type, equal_from_type);
+    insert_sorted_new(*quad_model.equal_to_type, equal_to_type);
+    insert_sorted_new(*quad_model.equal_from_to_type, equal_from_to_type);
+    insert_sorted_new(*quad_model.equal_from_to_inverted, equal_from_to_inverted);
+    insert_sorted_new(*quad_model.equal_from_type_inverted, equal_from_type_inverted);
+    insert_sorted_new(*quad_model.equal_to_type_inverted, equal_to_type_inverted);
+
+    catalog.connections_count += edges.size();
+    edges_inserted += edges.size();
+}
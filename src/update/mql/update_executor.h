@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "query/parser/op/mql/op_insert.h"
+#include "storage/index/record.h"
+
+namespace MQL {
+
+// Executes the inserts of a query against the quad model. The records of every index are staged first, then each
+// index is sorted once and its records are inserted in key order, so consecutive insertions descend through the same
+// pages of the B+tree instead of a random path for every record.
+class UpdateExecutor : public OpVisitor {
+public:
+    void visit(MQL::OpInsert&) override;
+
+    uint_fast32_t nodes_inserted      = 0;
+    uint_fast32_t labels_inserted     = 0;
+    uint_fast32_t properties_inserted = 0;
+    uint_fast32_t edges_inserted      = 0;
+
+private:
+    // moves the string of a tmp ObjectId to the string_manager, other ObjectIds are returned unchanged
+    static ObjectId materialize(ObjectId oid);
+
+    void insert_nodes(std::vector<Record<1>>& nodes);
+    void insert_labels(std::vector<Record<2>>& labels);
+    void insert_properties(std::vector<Record<3>>& properties);
+    void insert_edges(std::vector<Record<4>>& edges);
+};
+} // namespace MQL
@@ -6,7 +6,9 @@
 #include "graph_models/rdf_model/conversions.h"
 #include "graph_models/rdf_model/rdf_model.h"
 #include "graph_models/rdf_model/rdf_object_id.h"
+#include "storage/filesystem.h"
 #include "storage/index/bplus_tree/bplus_tree.h"
+#include "storage/index/reachability/reachability_index.h"
 #include "storage/string_manager.h"
 #include "storage/tmp_manager.h"
 
@@ -212,6 +214,15 @@ bool UpdateExecutor::transform_if_tmp(ObjectId& oid) {
 }
 
 
+void UpdateExecutor::invalidate_reachability_index(ObjectId predicate) {
+    auto it = rdf_model.reachability_indexes.find(predicate.id);
+    if (it != rdf_model.reachability_indexes.end() && !it->second->is_outdated()) {
+        it->second->set_outdated();
+        Filesystem::remove_all(ReachabilityIndex::get_path(predicate.id));
+    }
+}
+
+
 void UpdateExecutor::visit(SPARQL::OpInsertData& op_insert_data) {
     // to receive the data
     for (auto& triple : op_insert_data.triples) {
@@ -247,6 +258,7 @@ void UpdateExecutor::visit(SPARQL::OpInsertData& op_insert_data) {
         if (is_new_record) {
             rdf_model.catalog().insert_triple(S.id, P.id, O.id);
             triples_inserted++;
+            invalidate_reachability_index(P);
 
             Record<3> record_pos = { P.id, O.id, S.id };
             rdf_model.pos->insert(record_pos);
@@ -283,17 +295,17 @@ void UpdateExecutor::visit(SPARQL::OpInsertData& op_insert_data) {
             }
             if (S == O) {
                 Record<2> record_eq_so = { S.id, P.id };
-                rdf_model.equal_sp->insert(record_eq_so);
+                rdf_model.equal_so->insert(record_eq_so);
 
                 Record<2> record_eq_so_inv = { P.id, S.id };
-                rdf_model.equal_sp_inverted->insert(record_eq_so_inv);
+                rdf_model.equal_so_inverted->insert(record_eq_so_inv);
             }
             if (P == O) {
                 Record<2> record_eq_po = { P.id, S.id };
-                rdf_model.equal_sp->insert(record_eq_po);
+                rdf_model.equal_po->insert(record_eq_po);
 
                 Record<2> record_eq_po_inv = { S.id, P.id };
-                rdf_model.equal_sp_inverted->insert(record_eq_po_inv);
+                rdf_model.equal_po_inverted->insert(record_eq_po_inv);
             }
         }
     }
@@ -337,6 +349,7 @@ void UpdateExecutor::visit(SPARQL::OpDeleteData& op_delete_data) {
         if (exists) {
             rdf_model.catalog().delete_triple(S.id, P.id, O.id);
             triples_deleted++;
+            invalidate_reachability_index(P);
 
             Record<3> record_pos = { P.id, O.id, S.id };
             rdf_model.pos->delete_record(record_pos);
@@ -374,18 +387,18 @@ void UpdateExecutor::visit(SPARQL::OpDeleteData& op_delete_data) {
             }
             if (S == O) {
                 Record<2> record_eq_so = { S.id, P.id };
-                rdf_model.equal_sp->delete_record(record_eq_so);
+                rdf_model.equal_so->delete_record(record_eq_so);
 
                 Record<2> record_eq_so_inv = { P.id, S.id };
-                rdf_model.equal_sp_inverted->delete_record(record_eq_so_inv);
+                rdf_model.equal_so_inverted->delete_record(record_eq_so_inv);
 
             }
             if (P == O) {
                 Record<2> record_eq_po = { P.id, S.id };
-                rdf_model.equal_sp->delete_record(record_eq_po);
+                rdf_model.equal_po->delete_record(record_eq_po);
 
                 Record<2> record_eq_po_inv = { S.id, P.id };
-                rdf_model.equal_sp_inverted->delete_record(record_eq_po_inv);
+                rdf_model.equal_po_inverted->delete_record(record_eq_po_inv);
             }
         }
     }
@@ -25,6 +25,9 @@ private:
     // returns true if oid was transformed
     bool transform_if_tmp(ObjectId& oid);
 
+    // the reachability index of the predicate (if any) no longer matches its edges
+    static void invalidate_reachability_index(ObjectId predicate);
+
     // helper for string with lang and string with datatype.
     // returns true if oid was transformed
     bool try_transform_inline(ObjectId& oid, std::vector<std::string>& catalog_list, char split);
@@ -30,7 +30,8 @@ def get_test_suites() -> list[TestSuite]:
 
         test_list: list[Test] = []
 
-        for query in test_dir.glob("**/*.mql"):
+        # sorted, so tests of a suite that modifies the database run in a known order
+        for query in sorted(test_dir.glob("**/*.mql")):
             expected = query.with_suffix(".csv")
             has_bad_suffix = len(query.suffixes) >= 2 and query.suffixes[-2] == ".bad"
 
@@ -61,7 +62,8 @@ def get_test_suites() -> list[TestSuite]:
 def get_results_from_csv(string: str) -> Result:
     result_data = csv.reader(string.splitlines())
 
-    variables = next(result_data)
+    # queries that modify the database return no output
+    variables = next(result_data, [])
     bindings: Bindings = list(result_data)
 
     return Result(variables, bindings)
@@ -43,13 +43,20 @@ LOGGING_LEVELS = {
 # Test suites to run
 TEST_SUITES: list[str] = [
     "aggs",
+    "count-all",
     "dates",
     "is",
     "simple",
     "paths",
     "bad_queries",
     "escape-unicode",
+    "insert",
 ]
 
+# Test suites that modify their database, it is created again each time they run
+UPDATE_TEST_SUITES: set[str] = {
+    "insert",
+}
+
 # Tests with the following query files fill be ignored
 IGNORED_TESTS: set[str] = set()
@@ -17,7 +17,7 @@ from .file_handler import (
 from .logging import Level, log
 from .options import IGNORED_TESTS
 from .options import OUTPUT_COLUMN_WIDTH as CW
-from .options import TEST_SUITE_DIR
+from .options import TEST_SUITE_DIR, UPDATE_TEST_SUITES
 from .server_utils import create_db, execute_query, kill_server, start_server
 from .types import (
     BadTest,
@@ -169,7 +169,7 @@ def execute_tests(
         log_file = None
 
         if not client_only:
-            database = create_db(create_db_executable, data)
+            database = create_db(create_db_executable, data, recreate=test_suite.name in UPDATE_TEST_SUITES)
             server, log_file = start_server(server_executable, database)
 
         for test in tests_:
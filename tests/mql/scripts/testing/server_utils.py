@@ -1,5 +1,6 @@
 from __future__ import annotations
 
+import shutil
 import socket
 import subprocess
 import sys
@@ -22,13 +23,16 @@ from .options import (
 from .types import ExecutionStats, ServerCrashedException, Test
 
 
-def create_db(create_db_executable: Path, qm_file: Path):
+def create_db(create_db_executable: Path, qm_file: Path, recreate: bool = False):
     if not qm_file.is_file():
         log(Level.ERROR, f"File not found {qm_file}")
         sys.exit(1)
 
     db_dir = TESTING_DBS_DIR / qm_file.with_suffix("").relative_to(TEST_SUITE_DIR)
 
+    if recreate and db_dir.exists():
+        shutil.rmtree(db_dir)
+
     if db_dir.exists():
         log(Level.WARNING, f'Database "{db_dir.relative_to(TESTING_DBS_DIR)}" already exists')
     else:
@@ -25,6 +25,7 @@ from .types import (
     Test,
     TestSuite,
     Triple,
+    UpdateTest,
     Value,
 )
 
@@ -159,7 +160,15 @@ def get_internal_tests() -> TestSuite:
         if not prefixes.is_file():
             prefixes = None
 
-        for query in test_dir.glob("good_queries/**/*.rq"):
+        # the updates (.ru) modify the database for the queries after them, so the tests are
+        # executed in the order of their file names
+        for query in sorted(test_dir.glob("good_queries/**/*.r[qu]")):
+            if query.suffix == ".ru":
+                test = UpdateTest(query=query, data=data, prefixes=prefixes)
+                log(Level.DEBUG, str(test))
+                test_list.append(test)
+                continue
+
             if query_has_keywords(query, ["describe", "construct"]):
                 expected = query.with_suffix(".ttl")
                 if not expected.is_file():
@@ -20,6 +20,7 @@ SERVER_LOGS_DIR = ROOT_TEST_DIR / "tmp/server-logs"
 
 # Executables
 CREATE_DB_EXECUTABLE = CWD / "build/Debug/bin/mdb-import"
+INDEX_PATHS_EXECUTABLE = CWD / "build/Debug/bin/mdb-index-paths"
 SERVER_EXECUTABLE = CWD / "build/Debug/bin/mdb-server"
 
 # Empty database used for some tests
@@ -59,6 +60,7 @@ INTERNAL_TESTS: List[str] = [
     "misc",
     "bind_official",
     "compression-old",
+    "compressed-leaves",
     "construct",
     "datetime",
     "describe",
@@ -70,6 +72,11 @@ INTERNAL_TESTS: List[str] = [
     "nested",
     "optional",
     "paths",
+    "paths-index",
+    "join-filter",
+    "memoize",
+    "distinct",
+    "count-all",
     "union",
     "print",
     "schemes",
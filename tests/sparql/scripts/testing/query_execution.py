@@ -38,6 +38,7 @@ from .server_utils import (
     create_db,
     execute_bad_query,
     execute_query,
+    execute_update,
     kill_server,
     start_server,
 )
@@ -52,6 +53,7 @@ from .types import (
     Test,
     TestSuite,
     Triple,
+    UpdateTest,
     Value,
 )
 
@@ -155,7 +157,7 @@ def skip_tests(tests: List[Test], stats: ExecutionStats) -> List[Test]:
                 log(Level.SKIPPED, "non-ttl database", str(test))
                 continue
 
-        elif isinstance(test, BadTest):
+        elif isinstance(test, (BadTest, UpdateTest)):
             pass
 
         else:
@@ -247,6 +249,14 @@ def execute_bad_test(server: Optional[Popen[bytes]], test: BadTest, stats: Execu
         stats.error += 1
 
 
+def execute_update_test(server: Optional[Popen[bytes]], test: UpdateTest, stats: ExecutionStats):
+    log(Level.DEBUG, str(test))
+
+    if execute_update(server, test, stats):
+        log(Level.CORRECT, str(test))
+        stats.correct += 1
+
+
 def execute_tests(
     test_suite: TestSuite,
     *,
@@ -281,7 +291,9 @@ def execute_tests(
         log_file = None
 
         if not client_only:
-            data_path = create_db(create_db_executable, data, prefixes)
+            # updates leave the database modified, so it can't be reused in the next execution
+            recreate = any(isinstance(test, UpdateTest) for test in tests_)
+            data_path = create_db(create_db_executable, data, prefixes, recreate)
             server, log_file = start_server(server_executable, data_path)
 
         for test in tests_:
@@ -295,6 +307,8 @@ def execute_tests(
                         execute_query_test(server, test, stats)
                 elif isinstance(test, BadTest):
                     execute_bad_test(server, test, stats)
+                elif isinstance(test, UpdateTest):
+                    execute_update_test(server, test, stats)
                 else:
                     raise TypeError(f"Unknown test type: {type(test)}")
 
@@ -1,6 +1,7 @@
 from __future__ import annotations
 
 import json
+import shutil
 import socket
 import subprocess
 import sys
@@ -21,6 +22,7 @@ from .options import (
     CWD,
     EMPTY_DB_DATA,
     HOST,
+    INDEX_PATHS_EXECUTABLE,
     PORT,
     SERVER_LOGS_DIR,
     SLEEP_DELAY,
@@ -34,10 +36,17 @@ from .types import (
     ServerCrashedException,
     ServerErrorException,
     Test,
+    UpdateTest,
 )
 
 
-def create_db(create_db_executable: Path, rdf_file: Optional[Path], prefixes_file: Optional[Path] = None):
+def create_db(
+    create_db_executable: Path,
+    rdf_file: Optional[Path],
+    prefixes_file: Optional[Path] = None,
+    recreate: bool = False,
+):
+    """If recreate is True an existing database is deleted, e.g. because updates modified it"""
     if rdf_file is None:
         rdf_file = EMPTY_DB_DATA
 
@@ -48,6 +57,10 @@ def create_db(create_db_executable: Path, rdf_file: Optional[Path], prefixes_fil
     db_dir = TESTING_DBS_DIR / rdf_file.relative_to(TEST_SUITE_DIR)
     db_dir = db_dir.parent / rdf_file.stem
 
+    if recreate and db_dir.exists():
+        shutil.rmtree(db_dir)
+        log(Level.DEBUG, f'Database "{db_dir}" deleted')
+
     if db_dir.exists():
         log(Level.WARNING, f'Database "{db_dir.relative_to(TESTING_DBS_DIR)}" already exists')
     else:
@@ -58,12 +71,27 @@ def create_db(create_db_executable: Path, rdf_file: Optional[Path], prefixes_fil
                 sys.exit(1)
             cmd.extend(["--prefixes", str(prefixes_file)])
 
+        # Options for mdb-import listed in <name>_import_options.txt, e.g. --compressed-leaves
+        import_options = rdf_file.with_name(f"{rdf_file.stem}_import_options.txt")
+        if import_options.is_file():
+            with import_options.open(encoding="utf-8") as file:
+                cmd.extend(file.read().split())
+
         try:
             subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
             log(Level.DEBUG, f'Database "{db_dir}" created')
         except subprocess.CalledProcessError as exc:
             raise exc
 
+        # Predicates listed in <name>_indexed_paths.txt get a reachability index
+        indexed_paths = rdf_file.with_name(f"{rdf_file.stem}_indexed_paths.txt")
+        if indexed_paths.is_file():
+            with indexed_paths.open(encoding="utf-8") as file:
+                predicates = file.read().split()
+            cmd = [str(INDEX_PATHS_EXECUTABLE), str(db_dir), *predicates]
+            subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            log(Level.DEBUG, f'Reachability indexes of "{db_dir}" created')
+
     return db_dir
 
 
@@ -191,3 +219,35 @@ def execute_bad_query(server: Optional[Popen[bytes]], test: BadTest, stats: Exec
         return False
     except ServerErrorException:
         return True
+
+
+def execute_update(server: Optional[Popen[bytes]], test: UpdateTest, stats: ExecutionStats) -> bool:
+    """Returns True if the update was executed, False otherwise"""
+    with test.query.open(encoding="utf-8") as file:
+        update_str = file.read()
+    log(Level.DEBUG, f"update_str: {update_str}")
+    sparql_wrapper = SPARQLWrapper(
+        f"http://{HOST}:{PORT}/sparql",
+        updateEndpoint=f"http://{HOST}:{PORT}/update",
+    )
+
+    sparql_wrapper.setMethod("POST")
+    sparql_wrapper.setRequestMethod("postdirectly")
+    sparql_wrapper.setQuery(update_str)
+
+    try:
+        sparql_wrapper.query()
+    except (QueryBadFormed, EndPointInternalError, RemoteDisconnected) as exc:
+        if server and server.poll() is not None:
+            stats.error += 1
+            log(Level.ERROR, str(test), "Server crashed")
+            raise ServerCrashedException from exc
+        stats.error += 1
+        log(Level.ERROR, str(test), "Server returned error")
+        return False
+    except (URLError, ConnectionResetError) as exc:
+        stats.error += 1
+        log(Level.ERROR, str(test), "Server crashed")
+        raise ServerCrashedException from exc
+
+    return True
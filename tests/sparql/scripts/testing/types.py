@@ -230,6 +230,22 @@ class QueryTest(Test):
         return " ".join(strings)
 
 
+class UpdateTest(Test):
+    def __init__(
+        self,
+        *,
+        query: Path,
+        data: Optional[Path] = None,
+        prefixes: Optional[Path] = None,
+    ):
+        super().__init__(query=query)
+        self.data = data
+        self.prefixes = prefixes
+
+    def __str__(self):
+        return f"UpdateTest: {self.query.relative_to(CWD)}"
+
+
 class TestSuite:
     def __init__(self, name: str, tests: List[Test]):
         self.name = name